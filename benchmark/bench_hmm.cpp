@@ -0,0 +1,296 @@
+//
+// File: bench_hmm.cpp
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include <Bpp/Numeric/Hmm/RescaledHmmLikelihood.h>
+#include <Bpp/Numeric/Hmm/LogsumHmmLikelihood.h>
+#include <Bpp/Numeric/Hmm/LowMemoryRescaledHmmLikelihood.h>
+#include <Bpp/Numeric/Matrix/Matrix.h>
+#include <Bpp/Numeric/VectorTools.h>
+#include <Bpp/App/ApplicationTools.h>
+#include <Bpp/Utils/AttributesTools.h>
+#include <Bpp/Exceptions.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+#include <memory>
+#include "SimpleHmm.h"
+
+/*
+ * Benchmark of the HMM likelihood classes on synthetic workloads.
+ *
+ * Options are passed as name=value pairs:
+ * - structures:      transition matrices, among dense, autocorrelation and sparse.
+ * - states:          numbers of hidden states.
+ * - sites:           numbers of positions.
+ * - segments:        numbers of independent segments, delimited by evenly spaced break points.
+ * - implementations: likelihood classes, among rescaled, logsum and lowmemory.
+ * - repeats:         number of repetitions of each timing, the minimum being reported.
+ * - threads:         number of threads used by the likelihood classes.
+ * - seed:            random seed for the simulated data.
+ * - output:          JSON output file.
+ *
+ * For instance: bench_hmm states=2,10,1000 sites=1000,100000000 segments=1,1000 output=hmm.json
+ *
+ * Timings are in seconds, and null when the operation is not supported by the class.
+ * The peak resident memory (in kB) is reset before each workload on Linux, and is null on
+ * systems where it is not available.
+ */
+
+typedef chrono::steady_clock Clock;
+
+double secondsSince(const Clock::time_point& start)
+{
+  return chrono::duration<double>(Clock::now() - start).count();
+}
+
+double timeOperation(const function<void ()>& operation)
+{
+  try {
+    Clock::time_point start = Clock::now();
+    operation();
+    return secondsSince(start);
+  } catch (Exception& e) {
+    return NumConstants::NaN();
+  }
+}
+
+void keepMinimum(double& best, double time)
+{
+  if (!std::isnan(time) && (std::isnan(best) || time < best))
+    best = time;
+}
+
+void resetPeakMemory()
+{
+  ofstream clearRefs("/proc/self/clear_refs");
+  if (clearRefs)
+    clearRefs << "5";
+}
+
+double getPeakMemory()
+{
+  ifstream status("/proc/self/status");
+  string line;
+  while (getline(status, line))
+  {
+    if (line.compare(0, 6, "VmHWM:") == 0)
+    {
+      double kb = NumConstants::NaN();
+      istringstream(line.substr(6)) >> kb;
+      return kb;
+    }
+  }
+  return NumConstants::NaN();
+}
+
+string toJson(double x)
+{
+  if (std::isnan(x) || std::isinf(x))
+    return "null";
+  ostringstream oss;
+  oss << setprecision(12) << x;
+  return oss.str();
+}
+
+/*
+ * Dense and sparse matrices are circulant, hence doubly stochastic with uniform equilibrium frequencies.
+ * The autocorrelation matrix has a diagonal plus rank one structure.
+ */
+HmmTransitionMatrix* buildTransitions(const string& structure, const HmmStateAlphabet* alphabet)
+{
+  size_t n = alphabet->getNumberOfStates();
+  if (structure == "autocorrelation")
+  {
+    AutoCorrelationTransitionMatrix* trans = new AutoCorrelationTransitionMatrix(alphabet);
+    for (size_t i = 0; i < n; ++i)
+      trans->setParameterValue("lambda" + TextTools::toString(i + 1), 0.9);
+    return trans;
+  }
+  vector<double> row(n, 0.);
+  HmmTransitionMatrix::Structure type;
+  if (structure == "dense")
+  {
+    for (size_t d = 0; d < n; ++d)
+      row[d] = 1. / (1. + static_cast<double>(d));
+    type = HmmTransitionMatrix::DENSE;
+  }
+  else if (structure == "sparse")
+  {
+    row[1 % n] += 1.;
+    row[n - 1] += 1.;
+    type = HmmTransitionMatrix::SPARSE;
+  }
+  else
+    throw Exception("bench_hmm: unknown transition structure '" + structure + "'.");
+  double sum = VectorTools::sum(row);
+  RowMatrix<double> pij(n, n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      pij(i, j) = (i == j ? 0.9 : 0.) + 0.1 * row[(j + n - i) % n] / sum;
+  return new FixedHmmTransitionMatrix(alphabet, pij, vector<double>(n, 1. / static_cast<double>(n)), type);
+}
+
+HmmLikelihood* buildLikelihood(const string& implementation, const string& structure, size_t nbStates, const vector<double>& data)
+{
+  SimpleHmmStateAlphabet* alphabet = new SimpleHmmStateAlphabet(nbStates);
+  HmmTransitionMatrix* trans = buildTransitions(structure, alphabet);
+  GaussianHmmEmissionProbabilities* emissions = new GaussianHmmEmissionProbabilities(alphabet, data, 2.);
+  if (implementation == "rescaled")
+    return new RescaledHmmLikelihood(alphabet, trans, emissions, "");
+  if (implementation == "logsum")
+    return new LogsumHmmLikelihood(alphabet, trans, emissions, "");
+  if (implementation == "lowmemory")
+    return new LowMemoryRescaledHmmLikelihood(alphabet, trans, emissions, "");
+  delete emissions;
+  delete trans;
+  delete alphabet;
+  throw Exception("bench_hmm: unknown implementation '" + implementation + "'.");
+}
+
+int main(int args, char** argv)
+{
+  try {
+    map<string, string> params = AttributesTools::parseOptions(args, argv);
+    vector<string> structures = ApplicationTools::getVectorParameter<string>("structures", params, ',', "dense,autocorrelation,sparse", "", true, 1);
+    vector<size_t> states = ApplicationTools::getVectorParameter<size_t>("states", params, ',', "2,10,100", "", true, 1);
+    vector<size_t> sites = ApplicationTools::getVectorParameter<size_t>("sites", params, ',', "1000,100000", "", true, 1);
+    vector<size_t> segments = ApplicationTools::getVectorParameter<size_t>("segments", params, ',', "1,100", "", true, 1);
+    vector<string> implementations = ApplicationTools::getVectorParameter<string>("implementations", params, ',', "rescaled,logsum,lowmemory", "", true, 1);
+    size_t repeats = ApplicationTools::getParameter<size_t>("repeats", params, 3, "", true, 1);
+    size_t nbThreads = ApplicationTools::getParameter<size_t>("threads", params, 1, "", true, 1);
+    int seed = ApplicationTools::getIntParameter("seed", params, 1, "", true, 1);
+    string output = ApplicationTools::getStringParameter("output", params, "hmm_benchmark.json", "", true, 1);
+    if (repeats == 0)
+      throw Exception("bench_hmm: at least one repeat is required.");
+    for (size_t im = 0; im < implementations.size(); ++im)
+      if (implementations[im] != "rescaled" && implementations[im] != "logsum" && implementations[im] != "lowmemory")
+        throw Exception("bench_hmm: unknown implementation '" + implementations[im] + "'.");
+    for (size_t st = 0; st < structures.size(); ++st)
+      if (structures[st] != "dense" && structures[st] != "autocorrelation" && structures[st] != "sparse")
+        throw Exception("bench_hmm: unknown transition structure '" + structures[st] + "'.");
+
+    ofstream out(output.c_str());
+    if (!out)
+      throw Exception("bench_hmm: cannot open output file '" + output + "'.");
+    out << "{" << endl;
+    out << "  \"benchmark\": \"hmm\"," << endl;
+    out << "  \"repeats\": " << repeats << "," << endl;
+    out << "  \"threads\": " << nbThreads << "," << endl;
+    out << "  \"results\": [";
+    bool first = true;
+
+    for (size_t st = 0; st < structures.size(); ++st)
+    {
+      for (size_t k = 0; k < states.size(); ++k)
+      {
+        for (size_t n = 0; n < sites.size(); ++n)
+        {
+          //Same data for all implementations and break points:
+          RandomTools::setSeed(static_cast<long>(seed));
+          SimpleHmmStateAlphabet simAlphabet(states[k]);
+          unique_ptr<HmmTransitionMatrix> simTrans(buildTransitions(structures[st], &simAlphabet));
+          vector<double> data = simulateGaussianHmmData(dynamic_cast<const AbstractHmmTransitionMatrix&>(*simTrans), sites[n], 2.);
+
+          for (size_t s = 0; s < segments.size(); ++s)
+          {
+            vector<size_t> breakPoints;
+            for (size_t b = 1; b < segments[s]; ++b)
+              breakPoints.push_back(b * sites[n] / segments[s]);
+
+            for (size_t im = 0; im < implementations.size(); ++im)
+            {
+              ApplicationTools::displayMessage(structures[st] + " states=" + TextTools::toString(states[k]) +
+                  " sites=" + TextTools::toString(sites[n]) + " segments=" + TextTools::toString(segments[s]) +
+                  " " + implementations[im]);
+              resetPeakMemory();
+              unique_ptr<HmmLikelihood> lik;
+              double buildTime = timeOperation([&]() {
+                  lik.reset(buildLikelihood(implementations[im], structures[st], states[k], data));
+                  lik->setNumberOfThreads(nbThreads);
+                  lik->setBreakPoints(breakPoints);
+                });
+              vector<string> variables = lik->getParameters().getParameterNames();
+              double likTime = NumConstants::NaN(), d1Time = NumConstants::NaN(), d2Time = NumConstants::NaN();
+              double gradientTime = NumConstants::NaN(), posteriorTime = NumConstants::NaN();
+              for (size_t r = 0; r < repeats; ++r)
+              {
+                //Changing an emission parameter invalidates all sites and derivatives:
+                double theta = (r % 2 == 0 ? 2.1 : 2.);
+                keepMinimum(likTime, timeOperation([&]() {
+                    lik->setParameterValue("theta", theta);
+                    lik->getValue();
+                  }));
+                keepMinimum(d1Time, timeOperation([&]() { lik->getFirstOrderDerivative("theta"); }));
+                keepMinimum(d2Time, timeOperation([&]() { lik->getSecondOrderDerivative("theta"); }));
+                keepMinimum(gradientTime, timeOperation([&]() {
+                    vector<double> gradient;
+                    lik->getGradient(variables, gradient);
+                  }));
+                keepMinimum(posteriorTime, timeOperation([&]() {
+                    vector< vector<double> > probs;
+                    lik->getHiddenStatesPosteriorProbabilities(probs, false);
+                  }));
+              }
+              double logL = lik->getLogLikelihood();
+              lik.reset();
+              double peakMemory = getPeakMemory();
+
+              out << (first ? "" : ",") << endl;
+              first = false;
+              out << "    {\"structure\": \"" << structures[st] << "\", \"states\": " << states[k]
+                  << ", \"sites\": " << sites[n] << ", \"segments\": " << segments[s]
+                  << ", \"implementation\": \"" << implementations[im] << "\", \"logL\": " << toJson(logL)
+                  << ", \"build_s\": " << toJson(buildTime) << ", \"likelihood_s\": " << toJson(likTime)
+                  << ", \"d1_s\": " << toJson(d1Time) << ", \"d2_s\": " << toJson(d2Time)
+                  << ", \"gradient_s\": " << toJson(gradientTime) << ", \"posterior_s\": " << toJson(posteriorTime)
+                  << ", \"peak_memory_kb\": " << toJson(peakMemory) << "}";
+            }
+          }
+        }
+      }
+    }
+    out << endl << "  ]" << endl << "}" << endl;
+    out.close();
+  } catch (exception& e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -39,6 +39,7 @@
 */
 
 #include <algorithm>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -38,6 +38,7 @@
 */
 
 #include "BppOParametrizableFormat.h"
+#include "../Numeric/ParameterListView.h"
 
 using namespace bpp;
 
@@ -82,7 +83,7 @@ void BppOParametrizableFormat::write(const ParameterAliasable* parametrizable,
                                      bool printLocalAliases,
                                      bool printComma) const
 {
-  ParameterList pl = parametrizable->getIndependentParameters().createSubList(names);
+  ParameterListView pl(parametrizable->getIndependentParameters(), names);
   int p = out.getPrecision();
   out.setPrecision(12);
   bool flag = printComma;
@@ -40,13 +40,75 @@
 #include "AbstractParameterAliasable.h"
 #include "VectorTools.h"
 
+// From the STL:
+#include <atomic>
+
 using namespace bpp;
 using namespace std;
 
+/******************************************************************************/
+
+void CompiledAliasParameterListener::checkAliases_(const std::string& method)
+{
+  unsigned long version = Parameter::getNumberOfNameChanges();
+  if (pl_->size() == listSize_ && version == nameVersion_)
+    return;
+  for (size_t i = 0; i < aliases_.size(); i++)
+  {
+    if (aliases_[i] >= pl_->size() || (*pl_)[aliases_[i]].getName() != names_[i])
+      throw Exception("AbstractParameterAliasable::CompiledAliasParameterListener::" + method + ". Error, aliased parameter have change, maybe because it was renamed, or a parameter was removed?");
+  }
+  listSize_ = pl_->size();
+  nameVersion_ = version;
+}
+
+void CompiledAliasParameterListener::parameterValueChanged(ParameterEvent& event)
+{
+  if (*propagating_)
+    return;
+  checkAliases_("parameterValueChanged");
+  double value = event.getParameter()->Parameter::getValue();
+  *propagating_ = true;
+  try
+  {
+    for (size_t i = 0; i < aliases_.size(); i++)
+      (*pl_)[aliases_[i]].setValue(value);
+  }
+  catch (...)
+  {
+    *propagating_ = false;
+    throw;
+  }
+  *propagating_ = false;
+}
+
+void CompiledAliasParameterListener::parameterConstraintChanged(ParameterEvent& event)
+{
+  if (*propagating_)
+    return;
+  checkAliases_("parameterConstraintChanged");
+  *propagating_ = true;
+  try
+  {
+    for (size_t i = 0; i < aliases_.size(); i++)
+      (*pl_)[aliases_[i]].setConstraint(event.getParameter()->getConstraint());
+  }
+  catch (...)
+  {
+    *propagating_ = false;
+    throw;
+  }
+  *propagating_ = false;
+}
+
+/******************************************************************************/
+
 AbstractParameterAliasable::AbstractParameterAliasable(const AbstractParameterAliasable& ap) :
   AbstractParametrizable(ap),
   independentParameters_(),
-  aliasListenersRegister_()
+  aliasListenersRegister_(),
+  compiledAliases_(),
+  propagatingAliases_(false)
 {
   for (size_t i = 0; i < ap.independentParameters_.size(); i++)
     independentParameters_.shareParameter(getSharedParameter(getParameterNameWithoutNamespace(ap.independentParameters_[i].getName())));
@@ -59,26 +121,29 @@ AbstractParameterAliasable::AbstractParameterAliasable(const AbstractParameterAl
     AliasParameterListener* listener = it->second->clone();
     listener->setParameterList(&getParameters_());
     aliasListenersRegister_[it->first] = listener;
-    // Now correct parameters with appropriate pointers:
-    for (unsigned int i = 0; i < getNumberOfParameters(); ++i)
-    {
-      if (getParameters_()[i].hasParameterListener(it->first))
-      {
-        getParameters_()[i].removeParameterListener(it->first);
-        getParameters_()[i].addParameterListener(listener, false);
-      }
-    }
   }
+  // The copied parameters still point toward the listeners of ap:
+  removeCompiledAliases_(ap);
+  compileAliases_();
 }
 
 AbstractParameterAliasable& AbstractParameterAliasable::operator=(const AbstractParameterAliasable& ap)
 {
+  clearCompiledAliases_();
   AbstractParametrizable::operator=(ap);
   
+  independentParameters_.reset();
   for (size_t i=0; i<ap.independentParameters_.size(); i++)
     independentParameters_.shareParameter(getSharedParameter(getParameterNameWithoutNamespace(ap.independentParameters_[i].getName())));
 
   // Actualize the register with adequate pointers:
+  for (map<string, AliasParameterListener*>::iterator it = aliasListenersRegister_.begin();
+       it != aliasListenersRegister_.end();
+       it++)
+  {
+    delete it->second;
+  }
+  aliasListenersRegister_.clear();
   for (map<string, AliasParameterListener*>::const_iterator it = ap.aliasListenersRegister_.begin();
        it != ap.aliasListenersRegister_.end();
        it++)
@@ -86,21 +151,15 @@ AbstractParameterAliasable& AbstractParameterAliasable::operator=(const Abstract
     AliasParameterListener* listener = it->second->clone();
     listener->setParameterList(&getParameters_());
     aliasListenersRegister_[it->first] = listener;
-    // Now correct parameters with appropriate pointers:
-    for (unsigned int i = 0; i < getNumberOfParameters(); ++i)
-    {
-      if (getParameters_()[i].hasParameterListener(it->first))
-      {
-        getParameters_()[i].removeParameterListener(it->first);
-        getParameters_()[i].addParameterListener(listener, false);
-      }
-    }
   }
+  removeCompiledAliases_(ap);
+  compileAliases_();
   return *this;
 }
 
 AbstractParameterAliasable::~AbstractParameterAliasable()
 {
+  clearCompiledAliases_();
   // Delete the registry content:
   for (map<string, AliasParameterListener*>::iterator it = aliasListenersRegister_.begin();
        it != aliasListenersRegister_.end();
@@ -110,6 +169,80 @@ AbstractParameterAliasable::~AbstractParameterAliasable()
   }
 }
 
+/******************************************************************************/
+
+void AbstractParameterAliasable::clearCompiledAliases_()
+{
+  for (size_t i = 0; i < compiledAliases_.size(); i++)
+  {
+    compiledAliases_[i].first->removeParameterListener(compiledAliases_[i].second->getId());
+    delete compiledAliases_[i].second;
+  }
+  compiledAliases_.clear();
+}
+
+void AbstractParameterAliasable::removeCompiledAliases_(const AbstractParameterAliasable& ap)
+{
+  for (size_t i = 0; i < ap.compiledAliases_.size(); i++)
+  {
+    const string& name = ap.compiledAliases_[i].first->getName();
+    if (getParameters().hasParameter(name))
+      getParameters_().getParameter(name).removeParameterListener(ap.compiledAliases_[i].second->getId());
+  }
+}
+
+void AbstractParameterAliasable::compileAliases_()
+{
+  static atomic<unsigned long> nbCompiledListeners(0);
+
+  clearCompiledAliases_();
+  if (aliasListenersRegister_.size() == 0)
+    return;
+
+  // Direct aliases of each parameter, by position.
+  // Relationships involving removed parameters are ignored:
+  const ParameterList& pl = getParameters();
+  vector< vector<size_t> > direct(pl.size());
+  for (map<string, AliasParameterListener*>::const_iterator it = aliasListenersRegister_.begin();
+       it != aliasListenersRegister_.end();
+       it++)
+  {
+    string from = getNamespace() + it->second->getFrom();
+    if (pl.hasParameter(from) && pl.hasParameter(it->second->getName()))
+      direct[pl.whichParameterHasName(from)].push_back(pl.whichParameterHasName(it->second->getName()));
+  }
+
+  // Flatten the alias chains, in the order the listeners used to be called:
+  vector<bool> visited(pl.size());
+  for (size_t i = 0; i < pl.size(); i++)
+  {
+    if (direct[i].size() == 0)
+      continue;
+    vector<size_t> aliases;
+    vector<size_t> stack(direct[i].rbegin(), direct[i].rend());
+    visited.assign(pl.size(), false);
+    visited[i] = true;
+    while (stack.size() > 0)
+    {
+      size_t j = stack.back();
+      stack.pop_back();
+      if (visited[j])
+        continue;
+      visited[j] = true;
+      aliases.push_back(j);
+      stack.insert(stack.end(), direct[j].rbegin(), direct[j].rend());
+    }
+    CompiledAliasParameterListener* listener = new CompiledAliasParameterListener(
+        "__aliases_" + TextTools::toString(nbCompiledListeners++), &getParameters_(), aliases, &propagatingAliases_);
+    // The parameter will not own the listener, the bookkeeping being achieved by compiledAliases_:
+    shared_ptr<Parameter> parameter = pl.getSharedParameter(i);
+    parameter->addParameterListener(listener, false);
+    compiledAliases_.push_back(pair<shared_ptr<Parameter>, CompiledAliasParameterListener*>(parameter, listener));
+  }
+}
+
+/******************************************************************************/
+
 void AbstractParameterAliasable::aliasParameters(const std::string& p1, const std::string& p2)
 {
   // In case this is the first time we call this method:
@@ -156,9 +289,8 @@ void AbstractParameterAliasable::aliasParameters(const std::string& p1, const st
 
   aliasListenersRegister_[id] = aliasListener;
 
-  // Now we add it to the appropriate parameter, that is p1.
-  // The parameter will not own the listener, the bookkeeping being achieved by the register:
-  param1->addParameterListener(aliasListener, false);
+  // Values are propagated by the compiled listeners, which are now rebuilt:
+  compileAliases_();
   
   // Finally we remove p2 from the list of independent parameters:
   independentParameters_.deleteParameter(getNamespace() + p2);
@@ -224,9 +356,9 @@ void AbstractParameterAliasable::unaliasParameters(const std::string& p1, const
   if (it == aliasListenersRegister_.end())
     throw Exception("AbstractParameterAliasable::unaliasParameters. Parameter " + p2 + " is not aliased to parameter " + p1 + ".");
   // Remove the listener:
-  getParameter_(p1).removeParameterListener(id);
   delete it->second;
   aliasListenersRegister_.erase(it);
+  compileAliases_();
   // Finally we re-add p2 to the list of independent parameters:
   independentParameters_.shareParameter(getSharedParameter(p2));
 }
@@ -249,6 +381,7 @@ void AbstractParameterAliasable::setNamespace(const std::string& prefix)
 
 // Finally we notify the mother class:
   AbstractParametrizable::setNamespace(prefix);
+  compileAliases_();
 }
 
 vector<string> AbstractParameterAliasable::getAlias(const string& name) const
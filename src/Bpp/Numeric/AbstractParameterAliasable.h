@@ -45,11 +45,16 @@
 
 // From the STL:
 #include <map>
+#include <vector>
+#include <memory>
 
 namespace bpp
 {
 /**
  * @brief Inner listener class used by AbstractParameterAliasable.
+ *
+ * One such listener records each alias relationship. Values are not propagated
+ * through these listeners, but through CompiledAliasParameterListener objects.
  */
   class AliasParameterListener :
     public ParameterListener
@@ -125,6 +130,91 @@ namespace bpp
     const std::string& getAlias() const { return (*pl_)[alias_].getName(); }
   };
 
+/**
+ * @brief Inner listener class used by AbstractParameterAliasable to propagate values.
+ *
+ * A listener is attached to each parameter with aliases, and stores the positions of all
+ * parameters aliased to it, directly or not. A value or constraint change is then copied
+ * to all of them in a single loop. Nested notifications from the same object are ignored,
+ * as all the aliased parameters are already updated by the first listener.
+ *
+ * Positions are checked against the parameter names only when parameters were renamed or
+ * the size of the list changed since the last check.
+ */
+  class CompiledAliasParameterListener :
+    public ParameterListener
+  {
+  private:
+    std::string id_;
+    ParameterList* pl_;
+    std::vector<size_t> aliases_;
+    std::vector<std::string> names_;
+    size_t listSize_;
+    unsigned long nameVersion_;
+    bool* propagating_;
+
+  public:
+    /**
+     * @param id The identifier of the listener.
+     * @param pl The list of parameters of the aliasable object.
+     * @param aliases The positions in pl of all parameters aliased to the listened parameter.
+     * @param propagating A flag shared by all the listeners of the aliasable object.
+     */
+    CompiledAliasParameterListener(const std::string& id, ParameterList* pl, const std::vector<size_t>& aliases, bool* propagating) :
+      id_(id),
+      pl_(pl),
+      aliases_(aliases),
+      names_(aliases.size()),
+      listSize_(pl->size()),
+      nameVersion_(Parameter::getNumberOfNameChanges()),
+      propagating_(propagating)
+    {
+      for (size_t i = 0; i < aliases_.size(); i++)
+        names_[i] = (*pl_)[aliases_[i]].getName();
+    }
+
+    CompiledAliasParameterListener(const CompiledAliasParameterListener& capl) :
+      id_(capl.id_),
+      pl_(capl.pl_),
+      aliases_(capl.aliases_),
+      names_(capl.names_),
+      listSize_(capl.listSize_),
+      nameVersion_(capl.nameVersion_),
+      propagating_(capl.propagating_)
+    {}
+
+    CompiledAliasParameterListener& operator=(const CompiledAliasParameterListener& capl)
+    {
+      id_          = capl.id_;
+      pl_          = capl.pl_;
+      aliases_     = capl.aliases_;
+      names_       = capl.names_;
+      listSize_    = capl.listSize_;
+      nameVersion_ = capl.nameVersion_;
+      propagating_ = capl.propagating_;
+      return *this;
+    }
+
+    CompiledAliasParameterListener* clone() const { return new CompiledAliasParameterListener(*this); }
+
+  public:
+    const std::string& getId() const { return id_; }
+
+    /**
+     * @return The positions of all parameters aliased to the listened parameter.
+     */
+    const std::vector<size_t>& getAliases() const { return aliases_; }
+
+    void parameterNameChanged(ParameterEvent& event) {}
+
+    void parameterValueChanged(ParameterEvent& event);
+
+    void parameterConstraintChanged(ParameterEvent& event);
+
+  private:
+    void checkAliases_(const std::string& method);
+  };
+
 /**
  * @brief A partial implementation of the Parametrizable interface.
  *
@@ -148,11 +238,20 @@ namespace bpp
      */
     std::map<std::string, AliasParameterListener*> aliasListenersRegister_;
 
+    /**
+     * Listeners propagating values to aliased parameters, with the parameter they are attached to.
+     * They are rebuilt from the register each time aliases or parameters change.
+     */
+    std::vector< std::pair<std::shared_ptr<Parameter>, CompiledAliasParameterListener*> > compiledAliases_;
+    bool propagatingAliases_;
+
   public:
     AbstractParameterAliasable(const std::string& prefix) :
       AbstractParametrizable(prefix),
       independentParameters_(),
-      aliasListenersRegister_()
+      aliasListenersRegister_(),
+      compiledAliases_(),
+      propagatingAliases_(false)
     {}
 
     AbstractParameterAliasable(const AbstractParameterAliasable& ap);
@@ -230,6 +329,23 @@ namespace bpp
     //   independentParameters_.matchParametersValues(getParameters());
     // }
 
+  protected:
+    /**
+     * @brief Build the listeners propagating values to aliased parameters.
+     *
+     * This method is called automatically when aliases or parameters are modified through
+     * this class, and should be called by derived classes modifying the parameter list directly.
+     */
+    void compileAliases_();
+
+  private:
+    void clearCompiledAliases_();
+
+    /**
+     * @brief Remove from the parameters of this object the compiled listeners of another object.
+     */
+    void removeCompiledAliases_(const AbstractParameterAliasable& ap);
+
   protected:
     void addParameter_(Parameter* parameter)
     {
@@ -250,6 +366,8 @@ namespace bpp
       AbstractParametrizable::includeParameters_(parameters);
       for (size_t i=0; i<parameters.size(); i++)
         independentParameters_.shareParameter(getSharedParameter(getParameterNameWithoutNamespace(parameters[i].getName())));
+      if (aliasListenersRegister_.size() > 0)
+        compileAliases_();
     }
 
 
@@ -259,6 +377,8 @@ namespace bpp
       AbstractParametrizable::deleteParameter_(index);
       if (independentParameters_.hasParameter(name))
         independentParameters_.deleteParameter(name);
+      if (aliasListenersRegister_.size() > 0)
+        compileAliases_();
     }
 
     void deleteParameter_(std::string& name)
@@ -266,6 +386,8 @@ namespace bpp
       AbstractParametrizable::deleteParameter_(name);
       if (independentParameters_.hasParameter(name))
         independentParameters_.deleteParameter(name);
+      if (aliasListenersRegister_.size() > 0)
+        compileAliases_();
     }
 
     void deleteParameters_(const std::vector<std::string>& names)
@@ -280,6 +402,7 @@ namespace bpp
 
     void resetParameters_()
     {
+      clearCompiledAliases_();
       AbstractParametrizable::resetParameters_();
       independentParameters_.reset();
     }
@@ -42,6 +42,7 @@
 #define _ABSTRACTPARAMETRIZABLE_H_
 
 #include "Parametrizable.h"
+#include "ParameterChangeSet.h"
 
 //From the STL:
 #include <map>
@@ -57,7 +58,9 @@ namespace bpp
  * The abstract fireParameterChanged() method is provided so that the derived class
  * know when a parameter has changed, and can be updated.
  * All methods call the corresponding method in ParameterList and then call the
- * fireParameterChanged() method.
+ * fireParameterIndicesChanged() method, which by default calls fireParameterChanged().
+ * Classes with many parameters can override fireParameterIndicesChanged() instead,
+ * in order to know which parameters changed by position, without comparing names.
  */
   class AbstractParametrizable:
     public virtual Parametrizable
@@ -94,27 +97,31 @@ namespace bpp
     void setAllParametersValues(const ParameterList & parameters)
     {
       parameters_.setAllParametersValues(parameters);
-      fireParameterChanged(parameters);
+      ParameterChangeSet changed(parameters_.size());
+      changed.addAll();
+      fireParameterIndicesChanged(parameters, changed);
     }
 
     void setParameterValue(const std::string& name, double value)
     {
+      size_t index = parameters_.whichParameterHasName(prefix_ + name);
       parameters_.setParameterValue(prefix_ + name, value);
-      fireParameterChanged(parameters_.createSubList(prefix_ + name));
+      fireParameterIndicesChanged(parameters_.createSubList(index), ParameterChangeSet(parameters_.size(), std::vector<size_t>(1, index)));
     }
 
     void setParametersValues(const ParameterList& parameters)
     { 
-      parameters_.setParametersValues(parameters);
-      fireParameterChanged(parameters);
+      std::vector<size_t> updatedPositions;
+      parameters_.setParametersValues(parameters, updatedPositions);
+      fireParameterIndicesChanged(parameters, ParameterChangeSet(parameters_.size(), updatedPositions));
     }
 
     bool matchParametersValues(const ParameterList& parameters)
     {
-      std::unique_ptr< std::vector<size_t> >updatedParameters(new std::vector<size_t>());
-      bool test = parameters_.matchParametersValues(parameters, updatedParameters.get());
+      std::vector<size_t> updatedParameters, updatedPositions;
+      bool test = parameters_.matchParametersValues(parameters, &updatedParameters, updatedPositions);
       if (test) 
-        fireParameterChanged(parameters.shareSubList(*updatedParameters));
+        fireParameterIndicesChanged(parameters.shareSubList(updatedParameters), ParameterChangeSet(parameters_.size(), updatedPositions));
       return test;
     }
 
@@ -133,6 +140,22 @@ namespace bpp
      */
   
     virtual void fireParameterChanged(const ParameterList& parameters) {};
+
+    /**
+     * @brief Notify the class when one or several parameters have changed, by position.
+     *
+     * This method is called by all methods modifying parameter values. The default
+     * implementation calls fireParameterChanged(parameters), so that derived classes only
+     * need to override one of the two methods. Classes overriding this method should also
+     * override fireParameterChanged() consistently, as it can be called directly.
+     *
+     * @param parameters A ParameterList object with parameters that changed.
+     * @param changed The positions of the changed parameters in the list returned by getParameters().
+     */
+    virtual void fireParameterIndicesChanged(const ParameterList& parameters, const ParameterChangeSet& changed)
+    {
+      fireParameterChanged(parameters);
+    }
   
   
 
@@ -243,7 +266,7 @@ namespace bpp
       return parameters_.getSharedParameter(i);
     }
   
-    std::shared_ptr<Parameter>& getSharedParameter(size_t i)
+    const std::shared_ptr<Parameter>& getSharedParameter(size_t i)
     {
       return parameters_.getSharedParameter(i);
     }
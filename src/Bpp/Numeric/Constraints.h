@@ -44,6 +44,8 @@
 #include <string>
 #include <iostream>
 #include <typeinfo>
+#include <vector>
+#include <memory>
 
 // From Utils:
 #include "../Clonable.h"
@@ -429,6 +431,132 @@ namespace bpp
                inclUpperBound_ && inclLowerBound_));
     }
 
+    /**
+     * @brief Check a set of values against a set of intervals.
+     *
+     * The k-th interval applies to values[positions[k]]. Strict bounds are
+     * flagged by a non-null value in the corresponding array.
+     * As with isCorrect(), NaN values are never correct.
+     *
+     * @param n The number of intervals.
+     * @param values The values to check.
+     * @param positions The positions of the values to check.
+     * @param lowerBounds, upperBounds The bounds of the intervals.
+     * @param strictLowerBounds, strictUpperBounds Tell if the bounds are excluded.
+     * @return True if all values are in their interval.
+     */
+    static bool areCorrect(size_t n, const double* values, const size_t* positions,
+        const double* lowerBounds, const double* upperBounds,
+        const unsigned char* strictLowerBounds, const unsigned char* strictUpperBounds)
+    {
+      // No branch in the loop, so that it can be vectorized:
+      bool incorrect = false;
+      for (size_t k = 0; k < n; ++k)
+      {
+        double value = values[positions[k]];
+        incorrect |= !(value >= lowerBounds[k]) | !(value <= upperBounds[k])
+          | ((strictLowerBounds[k] != 0) & (value == lowerBounds[k]))
+          | ((strictUpperBounds[k] != 0) & (value == upperBounds[k]));
+      }
+      return !incorrect;
+    }
+
+  };
+
+/**
+ * @brief A set of constraints, with interval constraints stored as arrays of bounds.
+ *
+ * The i-th constraint applies to the i-th value of the arrays to check, and can be null.
+ * Interval constraints are copied when added, and checked in a single pass over the values, using
+ * IntervalConstraint::areCorrect(). Other constraints are checked one by one.
+ */
+  class ConstraintArray
+  {
+  private:
+    size_t size_;
+    std::vector<size_t> positions_;
+    std::vector<double> lowerBounds_, upperBounds_;
+    std::vector<unsigned char> strictLowerBounds_, strictUpperBounds_;
+    std::vector< std::pair<size_t, std::shared_ptr<Constraint> > > others_;
+
+  public:
+    ConstraintArray() :
+      size_(0), positions_(), lowerBounds_(), upperBounds_(), strictLowerBounds_(), strictUpperBounds_(), others_() {}
+
+    virtual ~ConstraintArray() {}
+
+  public:
+    /**
+     * @brief Append a constraint.
+     *
+     * @param constraint The constraint to add, or 0 if the corresponding values are not constrained.
+     */
+    void addConstraint(const std::shared_ptr<Constraint>& constraint)
+    {
+      // Derived classes may redefine isCorrect(), and are checked one by one:
+      const IntervalConstraint* interval = constraint && typeid(*constraint) == typeid(IntervalConstraint) ?
+        dynamic_cast<const IntervalConstraint*>(constraint.get()) : 0;
+      if (interval)
+      {
+        positions_.push_back(size_);
+        lowerBounds_.push_back(interval->getLowerBound());
+        upperBounds_.push_back(interval->getUpperBound());
+        strictLowerBounds_.push_back(interval->strictLowerBound());
+        strictUpperBounds_.push_back(interval->strictUpperBound());
+      }
+      else if (constraint)
+        others_.push_back(std::make_pair(size_, constraint));
+      size_++;
+    }
+
+    size_t size() const { return size_; }
+
+    /**
+     * @return True if all values match their constraint.
+     * @param values The values to check, one per constraint.
+     */
+    bool areCorrect(const double* values) const
+    {
+      if (!IntervalConstraint::areCorrect(positions_.size(), values, positions_.data(),
+            lowerBounds_.data(), upperBounds_.data(), strictLowerBounds_.data(), strictUpperBounds_.data()))
+        return false;
+      for (size_t k = 0; k < others_.size(); ++k)
+      {
+        if (!others_[k].second->isCorrect(values[others_[k].first]))
+          return false;
+      }
+      return true;
+    }
+
+    bool areCorrect(const std::vector<double>& values) const
+    {
+      if (values.size() != size_)
+        throw BadSizeException("ConstraintArray::areCorrect.", values.size(), size_);
+      return areCorrect(values.data());
+    }
+
+    /**
+     * @return The position of the first value not matching its constraint, or size() if all values are correct.
+     * @param values The values to check, one per constraint.
+     */
+    size_t findIncorrect(const std::vector<double>& values) const
+    {
+      size_t first = size_;
+      if (areCorrect(values))
+        return first;
+      for (size_t k = 0; k < positions_.size(); ++k)
+      {
+        if (positions_[k] < first && !IntervalConstraint::areCorrect(1, values.data(), &positions_[k],
+              &lowerBounds_[k], &upperBounds_[k], &strictLowerBounds_[k], &strictUpperBounds_[k]))
+          first = positions_[k];
+      }
+      for (size_t k = 0; k < others_.size(); ++k)
+      {
+        if (others_[k].first < first && !others_[k].second->isCorrect(values[others_[k].first]))
+          first = others_[k].first;
+      }
+      return first;
+    }
   };
 
 
@@ -0,0 +1,115 @@
+//
+// File: AbstractNumericalDerivative.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "AbstractNumericalDerivative.h"
+#include "../../Utils/ThreadTools.h"
+
+// From the STL:
+#include <mutex>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+void AbstractNumericalDerivative::setNumberOfThreads(size_t nbThreads)
+{
+  if (nbThreads == 0)
+    throw Exception("AbstractNumericalDerivative::setNumberOfThreads. At least one thread is required.");
+  nbThreads_ = nbThreads;
+}
+
+/******************************************************************************/
+
+void AbstractNumericalDerivative::parallelFor_(size_t nbTasks, const std::function<void (size_t, Function&, vector<size_t>&)>& task)
+{
+  size_t nbWorkers = min(nbThreads_, nbTasks);
+  while (workers_.size() < nbWorkers)
+  {
+    Function* f = function_->independentClone();
+    // Analytical derivatives are not needed at trial points:
+    DerivableFirstOrder* f1 = dynamic_cast<DerivableFirstOrder*>(f);
+    if (f1)
+      f1->enableFirstOrderDerivatives(false);
+    DerivableSecondOrder* f2 = dynamic_cast<DerivableSecondOrder*>(f);
+    if (f2)
+      f2->enableSecondOrderDerivatives(false);
+    workers_.push_back(make_shared<Worker_>(f));
+  }
+
+  const ParameterList& point = function_->getParameters();
+  vector<size_t> available(nbWorkers);
+  for (size_t w = 0; w < nbWorkers; ++w)
+  {
+    available[w] = nbWorkers - w - 1;
+    workers_[w]->updated = false;
+  }
+  mutex availableMutex;
+
+  ThreadTools::parallelFor(nbTasks, nbWorkers, [&](size_t t) {
+    size_t w;
+    {
+      lock_guard<mutex> lock(availableMutex);
+      w = available.back();
+      available.pop_back();
+    }
+    Worker_& worker = *workers_[w];
+    try
+    {
+      if (!worker.updated)
+      {
+        worker.function->setParameters(point);
+        worker.modified.clear();
+        worker.updated = true;
+      }
+      task(t, *worker.function, worker.modified);
+    }
+    catch (...)
+    {
+      // The state of the clone is unknown:
+      worker.updated = false;
+      lock_guard<mutex> lock(availableMutex);
+      available.push_back(w);
+      throw;
+    }
+    lock_guard<mutex> lock(availableMutex);
+    available.push_back(w);
+  });
+}
+
+/******************************************************************************/
+
@@ -41,12 +41,16 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _ABSTRACTNUMERICALDERIVATIVE_H_
 
 #include "Functions.h"
+#include "BatchFunction.h"
 #include "../Matrix/Matrix.h"
+#include "../ParameterBinding.h"
 
 //From the STL:
 #include <map>
 #include <vector>
 #include <string>
+#include <memory>
+#include <functional>
 
 namespace bpp
 {
@@ -62,6 +66,17 @@ namespace bpp
  * In the first case, all derivatives will be computed numerically.
  * In the second case, first order derivative will be computed numerically only if no appropriate analytical derivative is available, second order derivative will always be computed numerically.
  * In the last case, first and second order derivative will be computed numerically only if no appropriate analytical derivative is available.
+ *
+ * The evaluations at trial points are independent, and can be computed in parallel (see setNumberOfThreads).
+ * In that case, each thread evaluates its own copy of the wrapped function, made with Function::independentClone(),
+ * so that wrappers also get their own copy of the function they wrap. Clones are created on first use and kept for later computations: before being used
+ * for a new point, each of them is updated with the current parameter values of the wrapped function, but any other
+ * change in the state of the wrapped function is not propagated (call resetFunctionPool in that case).
+ * Each derivative is computed by a single thread, from the same trial points as in sequential mode, so that
+ * results do not depend on the number of threads.
+ *
+ * If the wrapped function implements the BatchFunction interface, all trial points within the constraints of the
+ * variables are evaluated at once instead, and threads are not used. Other trial points are then evaluated one at a time.
  */
 class AbstractNumericalDerivative:
   public DerivableSecondOrder,
@@ -73,31 +88,49 @@ class AbstractNumericalDerivative:
     double h_;
     std::vector<std::string> variables_;
     mutable std::map<std::string, size_t> index_; //Store positions in array corresponding to variable names.
+    ParameterBinding variablesBinding_; //Positions of the variables in the last list of parameters.
+    std::vector<size_t> variablePositions_;
+    std::vector<ParameterList> trialParameters_; //Copy of each variable, modified to evaluate the function at trial points.
     std::vector<double> der1_;
     std::vector<double> der2_;
     RowMatrix<double> crossDer2_;
     bool computeD1_, computeD2_, computeCrossD2_;
+    size_t nbThreads_;
+
+    /**
+     * @brief A clone of the wrapped function, used by one thread at a time.
+     */
+    struct Worker_
+    {
+      std::unique_ptr<Function> function;
+      std::vector<size_t> modified; //Indices of the variables which may still have a trial value in the clone.
+      bool updated; //Tells if the clone was updated for the current point.
+      Worker_(Function* f): function(f), modified(), updated(false) {}
+    };
+    std::vector<std::shared_ptr<Worker_> > workers_;
     
   public:
     AbstractNumericalDerivative(Function* function):
       FunctionWrapper(function), function1_(0), function2_(0),
-      h_(0.0001), variables_(), index_(), der1_(), der2_(), crossDer2_(),
-      computeD1_(true), computeD2_(true), computeCrossD2_(false) {}
+      h_(0.0001), variables_(), index_(), variablesBinding_(), variablePositions_(), trialParameters_(), der1_(), der2_(), crossDer2_(),
+      computeD1_(true), computeD2_(true), computeCrossD2_(false), nbThreads_(1), workers_() {}
 
     AbstractNumericalDerivative(DerivableFirstOrder* function):
       FunctionWrapper(function), function1_(function), function2_(0),
-      h_(0.0001), variables_(), index_(), der1_(), der2_(), crossDer2_(),
-      computeD1_(true), computeD2_(true), computeCrossD2_(false) {}
+      h_(0.0001), variables_(), index_(), variablesBinding_(), variablePositions_(), trialParameters_(), der1_(), der2_(), crossDer2_(),
+      computeD1_(true), computeD2_(true), computeCrossD2_(false), nbThreads_(1), workers_() {}
 
     AbstractNumericalDerivative(DerivableSecondOrder* function):
       FunctionWrapper(function), function1_(function), function2_(function),
-      h_(0.0001), variables_(), index_(), der1_(), der2_(), crossDer2_(),
-      computeD1_(true), computeD2_(true), computeCrossD2_(false) {}
+      h_(0.0001), variables_(), index_(), variablesBinding_(), variablePositions_(), trialParameters_(), der1_(), der2_(), crossDer2_(),
+      computeD1_(true), computeD2_(true), computeCrossD2_(false), nbThreads_(1), workers_() {}
 
     AbstractNumericalDerivative(const AbstractNumericalDerivative& ad):
       FunctionWrapper(ad), function1_(ad.function1_), function2_(ad.function2_),
-      h_(ad.h_), variables_(ad.variables_), index_(ad.index_), der1_(ad.der1_), der2_(ad.der2_), crossDer2_(ad.crossDer2_),
-      computeD1_(ad.computeD1_), computeD2_(ad.computeD2_), computeCrossD2_(ad.computeCrossD2_) {}
+      h_(ad.h_), variables_(ad.variables_), index_(ad.index_),
+      variablesBinding_(ad.variablesBinding_), variablePositions_(ad.variablePositions_), trialParameters_(ad.trialParameters_), der1_(ad.der1_), der2_(ad.der2_), crossDer2_(ad.crossDer2_),
+      computeD1_(ad.computeD1_), computeD2_(ad.computeD2_), computeCrossD2_(ad.computeCrossD2_),
+      nbThreads_(ad.nbThreads_), workers_() {}
 
     AbstractNumericalDerivative& operator=(const AbstractNumericalDerivative& ad)
     {
@@ -107,12 +140,17 @@ class AbstractNumericalDerivative:
       h_ = ad.h_;
       variables_ = ad.variables_;
       index_ = ad.index_;
+      variablesBinding_ = ad.variablesBinding_;
+      variablePositions_ = ad.variablePositions_;
+      trialParameters_ = ad.trialParameters_;
       der1_ = ad.der1_;
       der2_ = ad.der2_;
       crossDer2_ = ad.crossDer2_;
       computeD1_ = ad.computeD1_;
       computeD2_ = ad.computeD2_;
       computeCrossD2_ = ad.computeCrossD2_;
+      nbThreads_ = ad.nbThreads_;
+      workers_.clear();
       return *this;
     }
 
@@ -120,6 +158,14 @@ class AbstractNumericalDerivative:
 
     AbstractNumericalDerivative* clone() const = 0;
 
+    Function* independentClone() const
+    {
+      std::unique_ptr<AbstractNumericalDerivative> ad(dynamic_cast<AbstractNumericalDerivative*>(FunctionWrapper::independentClone()));
+      ad->function1_ = function1_ ? dynamic_cast<DerivableFirstOrder*>(ad->function_) : 0;
+      ad->function2_ = function2_ ? dynamic_cast<DerivableSecondOrder*>(ad->function_) : 0;
+      return ad.release();
+    }
+
   public:
     /**
      * @brief Set the interval value used in numerical approximation.
@@ -134,6 +180,28 @@ class AbstractNumericalDerivative:
      * @return The interval value used in numerical approximation.
      */
     double getInterval() const { return h_; }
+
+    /**
+     * @brief Set the number of threads used to evaluate the function at trial points.
+     *
+     * Default value is 1 (sequential computation).
+     *
+     * @param nbThreads The number of threads to use.
+     * @throw Exception If nbThreads is 0.
+     */
+    void setNumberOfThreads(size_t nbThreads);
+
+    /**
+     * @return The number of threads used to evaluate the function at trial points.
+     */
+    size_t getNumberOfThreads() const { return nbThreads_; }
+
+    /**
+     * @brief Delete the clones of the wrapped function used for parallel computations.
+     *
+     * This must be called when the state of the wrapped function changed otherwise than by setting parameter values.
+     */
+    void resetFunctionPool() { workers_.clear(); }
     
     /**
      * @brief Set the list of parameters to derivate numerically.
@@ -146,6 +214,10 @@ class AbstractNumericalDerivative:
       index_.clear();
       for(size_t i = 0; i < variables_.size(); i++)
         index_[variables_[i]] = i;
+      variablesBinding_ = ParameterBinding();
+      variablePositions_.assign(variables_.size(), 0);
+      trialParameters_.clear();
+      trialParameters_.resize(variables_.size());
       der1_.resize(variables_.size());
       der2_.resize(variables_.size());
       crossDer2_.resize(variables_.size(), variables_.size());
@@ -259,6 +331,158 @@ class AbstractNumericalDerivative:
      * as the inner parameters of the function will be changed when computing the numerical derivatives.
      */
     virtual void updateDerivatives(const ParameterList parameters) = 0;
+
+    /**
+     * @return True if trial points are evaluated in parallel.
+     */
+    bool isParallel_() const
+    {
+      return nbThreads_ > 1 && !dynamic_cast<const BatchFunction*>(function_);
+    }
+
+    /**
+     * @brief Tell if a trial value matches the constraint of a variable.
+     */
+    static bool isCorrect_(const Parameter& parameter, double value)
+    {
+      return !parameter.hasConstraint() || parameter.getConstraint()->isCorrect(value);
+    }
+
+    /**
+     * @brief Get a trial point, as a list with a copy of a variable set to a trial value.
+     */
+    static ParameterList getTrialPoint_(const Parameter& parameter, double value)
+    {
+      ParameterList p;
+      p.addParameter(parameter);
+      p[0].setValue(value);
+      return p;
+    }
+
+    /**
+     * @brief Get a trial point, as a list with a copy of two variables set to trial values.
+     */
+    static ParameterList getTrialPoint_(const Parameter& parameter1, double value1, const Parameter& parameter2, double value2)
+    {
+      ParameterList p = getTrialPoint_(parameter1, value1);
+      p.addParameter(parameter2);
+      p[1].setValue(value2);
+      return p;
+    }
+
+    /**
+     * @brief Get the position of each variable to derivate in a list of parameters.
+     *
+     * Positions are cached (see ParameterBinding), and only recomputed when the names in the list change.
+     *
+     * @param parameters The list of parameters.
+     * @return The position of each variable in the list, or the size of the list if the variable is not in it.
+     */
+    const std::vector<size_t>& getVariablePositions_(const ParameterList& parameters)
+    {
+      if (!variablesBinding_.isValidForSource(parameters))
+      {
+        variablesBinding_.bind(parameters, variables_);
+        variablePositions_.assign(variables_.size(), parameters.size());
+        for (size_t k = 0; k < variablesBinding_.size(); k++)
+          variablePositions_[variablesBinding_.getTargetPosition(k)] = variablesBinding_.getSourcePosition(k);
+      }
+      return variablePositions_;
+    }
+
+    /**
+     * @brief Get a list with a copy of a variable, to evaluate the function at trial points.
+     *
+     * The variable is only copied the first time, or when its constraint or precision changed,
+     * so that trial points only modify the value of the copy. The value of the copy is reset
+     * to the one of the variable.
+     *
+     * @param i The index of the variable.
+     * @param parameter The variable in the current list of parameters.
+     * @return A list with the copy of the variable as its only parameter.
+     */
+    ParameterList& getTrialParameters_(size_t i, const Parameter& parameter)
+    {
+      ParameterList& trial = trialParameters_[i];
+      if (trial.size() == 0
+          || trial[0].getName() != parameter.getName()
+          || trial[0].getConstraint() != parameter.getConstraint()
+          || trial[0].getPrecision() != parameter.getPrecision())
+      {
+        trial.reset();
+        trial.addParameter(parameter);
+      }
+      else if (trial[0].getValue() != parameter.getValue())
+        trial[0].setValue(parameter.getValue());
+      return trial;
+    }
+
+    /**
+     * @brief Get a list sharing the copies of two variables, to evaluate the function at the
+     * first trial point of a variable while resetting the previous one.
+     *
+     * @param i The index of the variable, whose copy was obtained with getTrialParameters_(i, parameter).
+     * @param last The index of the previous variable.
+     * @param lastParameter The previous variable in the current list of parameters.
+     */
+    ParameterList getTrialParameters_(size_t i, size_t last, const Parameter& lastParameter)
+    {
+      ParameterList p;
+      p.shareParameters(trialParameters_[i]);
+      p.shareParameters(getTrialParameters_(last, lastParameter));
+      return p;
+    }
+
+    /**
+     * @brief Set trial parameters in a function, also resetting previously modified variables the first time.
+     *
+     * @param function The function to evaluate.
+     * @param trial The trial parameters.
+     * @param previous A list of parameters to set together with the trial ones, or 0.
+     * It is set to 0 once parameters have been successfully set.
+     */
+    static void setTrialParameters_(Function& function, const ParameterList& trial, const ParameterList*& previous)
+    {
+      if (previous)
+      {
+        ParameterList p;
+        p.shareParameters(trial);
+        p.shareParameters(*previous);
+        function.setParameters(p);
+        previous = 0;
+      }
+      else
+        function.setParameters(trial);
+    }
+
+    /**
+     * @brief Get a copy of the variables which may still have a trial value in a clone of the function.
+     *
+     * @param parameters The current list of parameters.
+     * @param modified Indices of the modified variables.
+     * @param i, j Indices of variables which will be set anyway, and are not included.
+     * @return A list with the copies of the variables, with their current value.
+     */
+    ParameterList getResetParameters_(const ParameterList& parameters, const std::vector<size_t>& modified, size_t i, size_t j) const
+    {
+      ParameterList p;
+      for (size_t k = 0; k < modified.size(); ++k)
+        if (modified[k] != i && modified[k] != j)
+          p.addParameter(parameters[variablePositions_[modified[k]]]);
+      return p;
+    }
+
+    /**
+     * @brief Run independent tasks in parallel, each one on a clone of the wrapped function.
+     *
+     * Clones are updated with the current parameter values of the wrapped function before their first use.
+     * Each task gets a clone which is not used by any other task at the same time, and the list of variables
+     * which may still have a trial value in it. Tasks must update this list.
+     *
+     * @param nbTasks The number of tasks.
+     * @param task The task to run, with its index, the clone to use and the list of modified variables.
+     */
+    void parallelFor_(size_t nbTasks, const std::function<void (size_t, Function&, std::vector<size_t>&)>& task);
     
 };
 
@@ -54,6 +54,7 @@ using namespace bpp;
 AbstractOptimizer::AbstractOptimizer(Function* function):
   function_(function),
   parameters_(),
+  functionBinding_(),
   messageHandler_(ApplicationTools::message.get()),
   profiler_(ApplicationTools::message.get()),
   constraintPolicy_(AutoParameter::CONSTRAINTS_KEEP),
@@ -70,6 +71,7 @@ AbstractOptimizer::AbstractOptimizer(Function* function):
 AbstractOptimizer::AbstractOptimizer(const AbstractOptimizer& opt):
   function_(opt.function_),
   parameters_(opt.parameters_),
+  functionBinding_(opt.functionBinding_),
   messageHandler_(opt.messageHandler_),
   profiler_(opt.profiler_),
   constraintPolicy_(opt.constraintPolicy_),
@@ -113,6 +115,7 @@ AbstractOptimizer& AbstractOptimizer::operator=(const AbstractOptimizer& opt)
 {
   function_               = opt.function_;
   parameters_             = opt.parameters_;
+  functionBinding_        = opt.functionBinding_;
   messageHandler_         = opt.messageHandler_;
   profiler_               = opt.profiler_;
   constraintPolicy_       = opt.constraintPolicy_;
@@ -193,7 +196,7 @@ double AbstractOptimizer::step()
   if (listenerModifiesParameters())
   {
     if (!updateParameters_)
-      parameters_.matchParametersValues(function_->getParameters());
+      matchFunctionParametersValues_();
     //else already done!
      //_currentValue = function_->getValue();
     //Often useless, but avoid some bizare behaviour in particular cases:
@@ -288,6 +291,16 @@ void AbstractOptimizer::printMessage(const std::string& message)
 
 /******************************************************************************/
 
+bool AbstractOptimizer::matchFunctionParametersValues_()
+{
+  const ParameterList& pl = function_->getParameters();
+  if (!functionBinding_.isValidFor(pl, parameters_))
+    functionBinding_.bind(pl, parameters_);
+  return functionBinding_.apply(pl, parameters_);
+}
+
+/******************************************************************************/
+
 void AbstractOptimizer::autoParameter()
 {
   for (unsigned int i = 0; i < parameters_.size(); i++)
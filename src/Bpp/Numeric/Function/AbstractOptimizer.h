@@ -41,6 +41,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _ABSTRACTOPTIMIZER_H_
 
 #include "Optimizer.h"
+#include "../ParameterBinding.h"
 
 namespace bpp
 {
@@ -70,6 +71,11 @@ class AbstractOptimizer:
      * @brief The parameters that will be optimized.
      */
     ParameterList parameters_;
+
+    /**
+     * @brief Correspondence between the parameters of the function and the optimized parameters.
+     */
+    ParameterBinding functionBinding_;
   
     /**
      * @brief The message handler.
@@ -376,6 +382,17 @@ class AbstractOptimizer:
 
   protected:
     ParameterList& getParameters_() { return parameters_; }
+
+    /**
+     * @brief Update the optimized parameters with the current values of the function parameters.
+     *
+     * This is equivalent to getParameters_().matchParametersValues(getFunction()->getParameters()),
+     * but parameter names are only resolved when one of the lists changes (see ParameterBinding).
+     *
+     * @return True if at least one value changed.
+     */
+    bool matchFunctionParametersValues_();
+
     Parameter& getParameter_(size_t i) { return parameters_[i]; }
     Function* getFunction_() { return function_; }
     void setDefaultStopCondition_(OptimizationStopCondition* osc)
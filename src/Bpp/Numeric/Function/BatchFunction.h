@@ -0,0 +1,111 @@
+//
+// File: BatchFunction.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _BATCHFUNCTION_H_
+#define _BATCHFUNCTION_H_
+
+#include "Functions.h"
+#include "FunctionTools.h"
+
+// From the STL:
+#include <vector>
+#include <string>
+
+namespace bpp
+{
+
+/**
+ * @brief Interface for functions which can be evaluated at several points at once.
+ *
+ * The Function interface evaluates one point at a time. This optional extension allows
+ * a function to share work between several points, for instance precomputations which do
+ * not depend on the points, or vectorized computations across points.
+ *
+ * Each point is a list of parameters, which are set in turn to the given values,
+ * all other parameters keeping the value they had before the call. After the call, the
+ * function is left at the last point.
+ *
+ * The default implementation evaluates the points one after the other, see FunctionTools::evaluateSequentially.
+ * Callers should use FunctionTools::evaluate, which works with any function and uses this interface when available.
+ */
+class BatchFunction:
+  public virtual Function
+{
+  public:
+    BatchFunction() {}
+    virtual ~BatchFunction() {}
+
+    BatchFunction* clone() const = 0;
+
+  public:
+    /**
+     * @brief Evaluate the function at several points.
+     *
+     * @param points The points where to evaluate the function.
+     * @param values [out] The value of the function at each point.
+     * @throw ConstraintException If a parameter value does not match its constraint.
+     */
+    virtual void getValues(const std::vector<ParameterList>& points, std::vector<double>& values)
+    {
+      FunctionTools::evaluateSequentially(*this, points, values);
+    }
+
+    /**
+     * @brief Evaluate the function and its first order derivatives at several points.
+     *
+     * The default implementation requires the function to implement the DerivableFirstOrder interface.
+     *
+     * @param points The points where to evaluate the function.
+     * @param variables The names of the variables to derivate.
+     * @param values [out] The value of the function at each point.
+     * @param gradients [out] For each point, the first order derivative for each variable.
+     * @throw ConstraintException If a parameter value does not match its constraint.
+     * @throw Exception If derivatives can't be computed.
+     */
+    virtual void getValuesAndGradients(const std::vector<ParameterList>& points, const std::vector<std::string>& variables, std::vector<double>& values, VVdouble& gradients)
+    {
+      DerivableFirstOrder* function = dynamic_cast<DerivableFirstOrder*>(this);
+      if (!function)
+        throw Exception("BatchFunction::getValuesAndGradients. The function is not derivable.");
+      FunctionTools::evaluateSequentially(*function, points, variables, values, gradients);
+    }
+};
+
+} //end of namespace bpp.
+
+#endif //_BATCHFUNCTION_H_
+
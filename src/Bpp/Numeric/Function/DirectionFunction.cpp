@@ -39,6 +39,7 @@
 */
 
 #include "DirectionFunction.h"
+#include "../NumConstants.h"
 
 using namespace bpp;
 using namespace std;
@@ -47,11 +48,18 @@ using namespace std;
 
 void DirectionFunction::setParameters(const ParameterList & params)
 {
-  params_ = params;
+  if (binding_.isValidFor(params, params_))
+    binding_.apply(params, params_);
+  else
+  {
+    params_ = params;
+    binding_.bind(params, params_);
+  }
   double x = params_[0].getValue();
-  for(unsigned int j = 0; j < p_.size(); j++)
+  //Other parameters keep their initial value:
+  for(size_t k = 0; k < moving_.size(); k++)
     {
-      //      cout << p_[j].getValue() << " " << x << " " << xi_[j] << endl;
+      size_t j = moving_[k];
       xt_[j].setValue((p_[j].getValue()) + x * xi_[j]);
     }
   function_->setParameters(xt_);
@@ -66,6 +74,45 @@ double DirectionFunction::getValue() const
 
 /******************************************************************************/
 
+double DirectionFunction::evaluate(const ParameterSnapshot& snapshot) const
+{
+  double x;
+  if (params_.size() > 0 && snapshot.hasParameter(params_[0].getName()))
+    x = snapshot.getParameterValue(params_[0].getName());
+  else if (snapshot.size() == 1)
+    x = snapshot.getValue(0);
+  else
+    throw Exception("DirectionFunction::evaluate. The snapshot does not contain the position on the line.");
+  if (!schema_)
+    throw Exception("DirectionFunction::evaluate. The function was not initialized.");
+  vector<double> values(p_.size());
+  for (size_t j = 0; j < p_.size(); j++)
+    values[j] = p_[j].getValue();
+  for (size_t k = 0; k < moving_.size(); k++)
+  {
+    size_t j = moving_[k];
+    double value = values[j] + x * xi_[j];
+    std::shared_ptr<Constraint> constraint = p_[j].getConstraint();
+    if (constraint && !constraint->isCorrect(value))
+    {
+      if (constraintPolicy_ != AutoParameter::CONSTRAINTS_AUTO)
+        throw ConstraintException("DirectionFunction::evaluate", &p_[j], value);
+      //Same as AutoParameter::setValue, without the message:
+      double limit = constraint->getAcceptedLimit(value);
+      if (constraint->isCorrect(limit))
+        value = limit;
+      else if (constraint->isCorrect(limit + NumConstants::TINY()))
+        value = limit + NumConstants::TINY();
+      else
+        value = limit - NumConstants::TINY();
+    }
+    values[j] = value;
+  }
+  return function_->evaluate(ParameterSnapshot(schema_, values));
+}
+
+/******************************************************************************/
+
 const ParameterList & DirectionFunction::getParameters() const
 {
   return params_;
@@ -80,6 +127,11 @@ void DirectionFunction::init(const ParameterList & p, const vector<double> & xi)
   if(constraintPolicy_ == AutoParameter::CONSTRAINTS_AUTO)   autoParameter();
   else if(constraintPolicy_ == AutoParameter::CONSTRAINTS_IGNORE) ignoreConstraints();
   xt_ = p_;
+  schema_.reset(new ParameterSchema(p_));
+  moving_.clear();
+  for(size_t j = 0; j < xi_.size() && j < p_.size(); j++)
+    if (xi_[j] != 0.)
+      moving_.push_back(j);
 }
 
 /******************************************************************************/
@@ -44,6 +44,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "Functions.h"
 #include "../Parametrizable.h"
 #include "../AutoParameter.h"
+#include "../ParameterBinding.h"
 #include "../../App/ApplicationTools.h"
 #include "../../Io/OutputStream.h"
 
@@ -57,19 +58,23 @@ class DirectionFunction:
   private:
     mutable ParameterList params_, p_, xt_;
     std::vector<double> xi_;
+    ParameterBinding binding_; //From the parameter of the line to params_.
+    std::vector<size_t> moving_; //Positions of the parameters with a non-null direction.
+    std::shared_ptr<const ParameterSchema> schema_; //Schema of p_, for evaluate().
     Function* function_;
+    std::shared_ptr<Function> ownedFunction_; //Set in copies made with independentClone(), shared by their copies.
     std::string constraintPolicy_;
     OutputStream* messenger_;
       
   public:
     DirectionFunction(Function* function = 0) :
-      params_(), p_(), xt_(), xi_(),
-      function_(function), constraintPolicy_(AutoParameter::CONSTRAINTS_KEEP),
+      params_(), p_(), xt_(), xi_(), binding_(), moving_(), schema_(),
+      function_(function), ownedFunction_(), constraintPolicy_(AutoParameter::CONSTRAINTS_KEEP),
       messenger_(ApplicationTools::message.get()) {}
 
     DirectionFunction(const DirectionFunction& df) :
       ParametrizableAdapter(df), params_(df.params_), p_(df.p_), xt_(df.p_), xi_(df.xi_),
-      function_(df.function_), constraintPolicy_(df.constraintPolicy_), messenger_(df.messenger_) {}
+      binding_(df.binding_), moving_(df.moving_), schema_(df.schema_), function_(df.function_), ownedFunction_(df.ownedFunction_), constraintPolicy_(df.constraintPolicy_), messenger_(df.messenger_) {}
 
     DirectionFunction& operator=(const DirectionFunction& df)
     {
@@ -78,7 +83,11 @@ class DirectionFunction:
       p_ = df.p_;
       xt_ = df.p_;
       xi_ = df.xi_;
+      binding_ = df.binding_;
+      moving_ = df.moving_;
+      schema_ = df.schema_;
       function_ = df.function_;
+      ownedFunction_ = df.ownedFunction_;
       constraintPolicy_ = df.constraintPolicy_;
       messenger_ = df.messenger_;
       return *this;
@@ -93,6 +102,29 @@ class DirectionFunction:
     double getValue() const;
     const ParameterList & getParameters() const;
 
+    /**
+     * @brief Evaluate the underlying function along the direction without modifying it.
+     *
+     * The position on the line is the value of the snapshot parameter with the name of the
+     * current line parameter, or the only value of the snapshot. Constraints are handled
+     * according to the constraint policy, as in setParameters().
+     */
+    double evaluate(const ParameterSnapshot& snapshot) const;
+
+    /**
+     * @return A copy of the direction function, with an independent copy of the underlying function that it owns.
+     */
+    Function* independentClone() const
+    {
+      std::unique_ptr<DirectionFunction> df(clone());
+      if (function_)
+      {
+        df->ownedFunction_.reset(function_->independentClone());
+        df->function_ = df->ownedFunction_.get();
+      }
+      return df.release();
+    }
+
   public: // Specific methods:
     void init(const ParameterList & p, const std::vector<double> & xi);
     void autoParameter();
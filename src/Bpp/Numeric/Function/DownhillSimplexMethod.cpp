@@ -38,6 +38,7 @@
 */
 
 #include "DownhillSimplexMethod.h"
+#include "FunctionTools.h"
 #include "../NumTools.h"
 
 using namespace bpp;
@@ -86,14 +87,21 @@ void DownhillSimplexMethod::doInit(const ParameterList& params)
       //simplex_[i][j].setValue(getParameters()[j].getValue() * (1. + (j == i - 1 ? lambda : 0.)));
       simplex_[i][j].setValue(getParameters()[j].getValue() + (j == i - 1 ? lambda : 0.));
     }
-    //Compute the corresponding f value:
-    y_[i] = getFunction()->f(simplex_[i]);
-    nbEval_++;
   }
-  //Last function evaluation, setting current value:
   simplex_[0] = getParameters();
-  y_[0] = getFunction()->f(simplex_[0]);
-  nbEval_++;
+
+  //Compute the corresponding f values, the last evaluation setting the current value:
+  vector<ParameterList> points;
+  for (size_t i = 1; i < nDim + 1; i++)
+    points.push_back(simplex_[i]);
+  points.push_back(simplex_[0]);
+  Vdouble values;
+  FunctionTools::evaluate(*getFunction(), points, values);
+  for (size_t i = 0; i < nDim + 1; i++)
+  {
+    y_[i] = values[i == 0 ? nDim : i - 1];
+    nbEval_++;
+  }
 	
   pSum_ = getPSum();
 }
@@ -152,16 +160,26 @@ double DownhillSimplexMethod::doStep()
     yTry = tryExtrapolation(0.5);
     if (yTry >= ySave)
     {
+      // Contract around the lowest point, and evaluate all new points at once:
+      vector<ParameterList> points;
       for (size_t i = 0; i < mpts; i++)
       {
         if (i != iLowest_)
         {
           for (size_t j = 0; j < nDim; j++)
           {
-            pSum_[j].setValue(0.5 * (simplex_[i][j].getValue() + simplex_[iLowest_][j].getValue()));
-            simplex_[i][j].setValue(pSum_[j].getValue());
+            simplex_[i][j].setValue(0.5 * (simplex_[i][j].getValue() + simplex_[iLowest_][j].getValue()));
           }
-          y_[i] = getFunction()->f(pSum_);
+          points.push_back(simplex_[i]);
+        }
+      }
+      Vdouble values;
+      FunctionTools::evaluate(*getFunction(), points, values);
+      for (size_t i = 0, k = 0; i < mpts; i++)
+      {
+        if (i != iLowest_)
+        {
+          y_[i] = values[k++];
           nbEval_++;
         }
       }
@@ -45,91 +45,94 @@ void FivePointsNumericalDerivative::updateDerivatives(const ParameterList parame
 {
   if (computeD1_ && variables_.size() > 0)
   {
+    // In parallel, trial points are evaluated on clones, so that analytical derivatives can be computed at once:
     if (function1_)
-      function1_->enableFirstOrderDerivatives(false);
+      function1_->enableFirstOrderDerivatives(isParallel_());
     if (function2_)
-      function2_->enableSecondOrderDerivatives(false);
+      function2_->enableSecondOrderDerivatives(isParallel_() && computeD2_);
     function_->setParameters(parameters);
     f3_ = function_->getValue();
-    string lastVar;
-    bool functionChanged = false;
-    ParameterList p;
-    bool start = true;
-    for (unsigned int i = 0; i < variables_.size(); i++)
+    const vector<size_t>& positions = getVariablePositions_(parameters);
+    vector<bool> done(variables_.size(), false);
+    size_t last = variables_.size();
+    if (dynamic_cast<BatchFunction*>(function_))
     {
-      string var = variables_[i];
-      if (!parameters.hasParameter(var))
-        continue;
-      if (!start)
-      {
-        vector<string> vars(2);
-        vars[0] = var;
-        vars[1] = lastVar;
-        p = parameters.createSubList(vars);
-      }
-      else
+      // Evaluate at once the trial points of all variables which are not close to their bounds:
+      vector<ParameterList> points;
+      vector<size_t> index;
+      for (size_t i = 0; i < variables_.size(); ++i)
       {
-        p = parameters.createSubList(var);
-        start = true;
-      }
-      lastVar = var;
-      functionChanged = true;
-      double value = function_->getParameterValue(var);
-      double h = (1. + std::abs(value)) * h_;
-      // Compute four other points:
-      try
-      {
-        p[0].setValue(value - 2 * h);
-        function_->setParameters(p);
-        f1_ = function_->getValue();
-        try
-        {
-          p[0].setValue(value + 2 * h);
-          function_->setParameters(p);
-          f5_ = function_->getValue();
-          // No limit raised, use central approximation:
-          p[0].setValue(value - h);
-          function_->setParameters(p);
-          f2_ = function_->getValue();
-          p[0].setValue(value + h);
-          function_->setParameters(p);
-          f4_ = function_->getValue();
-          der1_[i] = (f1_ - 8. * f2_ + 8. * f4_ - f5_) / (12. * h);
-          der2_[i] = (-f1_ + 16. * f2_ - 30. * f3_ + 16. * f4_ - f5_) / (12. * h * h);
-        }
-        catch (ConstraintException& ce)
+        if (positions[i] == parameters.size())
+          continue;
+        const Parameter& parameter = parameters[positions[i]];
+        double value = parameter.getValue();
+        double h = (1. + std::abs(value)) * h_;
+        if (isCorrect_(parameter, value - 2 * h) && isCorrect_(parameter, value + 2 * h)
+            && isCorrect_(parameter, value - h) && isCorrect_(parameter, value + h))
         {
-          // Right limit raised, use backward approximation:
-          p[0].setValue(value - h);
-          function_->setParameters(p);
-          f2_ = function_->getValue();
-          p[0].setValue(value - 2 * h);
-          function_->setParameters(p);
-          f1_ = function_->getValue();
-          der1_[i] = (f3_ - f2_) / h;
-          der2_[i] = (f3_ - 2. * f2_ + f1_) / (h * h);
+          points.push_back(getTrialPoint_(parameter, value - 2 * h));
+          points.push_back(getTrialPoint_(parameter, value + 2 * h));
+          points.push_back(getTrialPoint_(parameter, value - h));
+          points.push_back(getTrialPoint_(parameter, value + h));
+          index.push_back(i);
         }
       }
-      catch (ConstraintException& ce)
+      Vdouble values;
+      FunctionTools::evaluate(*function_, points, values);
+      for (size_t k = 0; k < index.size(); ++k)
       {
-        // Left limit raised, use forward approximation:
-        p[0].setValue(value + h);
-        function_->setParameters(p);
-        f4_ = function_->getValue();
-        p[0].setValue(value + 2 * h);
-        function_->setParameters(p);
-        f5_ = function_->getValue();
-        der1_[i] = (f4_ - f3_) / h;
-        der2_[i] = (f5_ - 2. * f4_ + f3_) / (h * h);
+        size_t i = index[k];
+        double h = (1. + std::abs(parameters[positions[i]].getValue())) * h_;
+        double f1 = values[4 * k], f5 = values[4 * k + 1], f2 = values[4 * k + 2], f4 = values[4 * k + 3];
+        der1_[i] = (f1 - 8. * f2 + 8. * f4 - f5) / (12. * h);
+        der2_[i] = (-f1 + 16. * f2 - 30. * f3_ + 16. * f4 - f5) / (12. * h * h);
+        done[i] = true;
+        last = i;
       }
     }
+    else if (isParallel_())
+    {
+      vector<size_t> tasks;
+      for (size_t i = 0; i < variables_.size(); ++i)
+        if (positions[i] < parameters.size())
+          tasks.push_back(i);
+      parallelFor_(tasks.size(), [&](size_t t, Function& function, vector<size_t>& modified) {
+        size_t i = tasks[t];
+        ParameterList p;
+        p.addParameter(parameters[positions[i]]);
+        ParameterList reset = getResetParameters_(parameters, modified, i, i);
+        const ParameterList* previous = reset.size() > 0 ? &reset : 0;
+        computeDerivatives_(function, i, p, previous);
+        if (previous)
+          function.setParameters(*previous);
+        modified.assign(1, i);
+      });
+      return;
+    }
+
+    for (size_t i = 0; i < variables_.size(); ++i)
+    {
+      size_t pos = positions[i];
+      if (pos == parameters.size() || done[i])
+        continue;
+      ParameterList& p = getTrialParameters_(i, parameters[pos]);
+      // Also reset previous parameter with the first trial point:
+      ParameterList reset;
+      if (last < variables_.size())
+        reset.shareParameters(getTrialParameters_(last, parameters[positions[last]]));
+      const ParameterList* previous = reset.size() > 0 ? &reset : 0;
+      computeDerivatives_(*function_, i, p, previous);
+      if (previous)
+        function_->setParameters(*previous);
+      last = i;
+    }
     // Reset last parameter and compute analytical derivatives if any.
     if (function1_)
       function1_->enableFirstOrderDerivatives(computeD1_);
     if (function2_)
       function2_->enableSecondOrderDerivatives(computeD2_);
-    if (functionChanged)
-      function_->setParameters(parameters.createSubList(lastVar));
+    if (last < variables_.size())
+      function_->setParameters(getTrialParameters_(last, parameters[positions[last]]));
   }
   else
   {
@@ -144,3 +147,59 @@ void FivePointsNumericalDerivative::updateDerivatives(const ParameterList parame
   }
 }
 
+/******************************************************************************/
+
+void FivePointsNumericalDerivative::computeDerivatives_(Function& function, size_t i, ParameterList& p, const ParameterList*& previous)
+{
+  double value = p[0].getValue();
+  double h = (1. + std::abs(value)) * h_;
+  // Compute four other points:
+  try
+  {
+    p[0].setValue(value - 2 * h);
+    setTrialParameters_(function, p, previous);
+    double f1 = function.getValue();
+    try
+    {
+      p[0].setValue(value + 2 * h);
+      function.setParameters(p);
+      double f5 = function.getValue();
+      // No limit raised, use central approximation:
+      p[0].setValue(value - h);
+      function.setParameters(p);
+      double f2 = function.getValue();
+      p[0].setValue(value + h);
+      function.setParameters(p);
+      double f4 = function.getValue();
+      der1_[i] = (f1 - 8. * f2 + 8. * f4 - f5) / (12. * h);
+      der2_[i] = (-f1 + 16. * f2 - 30. * f3_ + 16. * f4 - f5) / (12. * h * h);
+    }
+    catch (ConstraintException& ce)
+    {
+      // Right limit raised, use backward approximation:
+      p[0].setValue(value - h);
+      function.setParameters(p);
+      double f2 = function.getValue();
+      p[0].setValue(value - 2 * h);
+      function.setParameters(p);
+      f1 = function.getValue();
+      der1_[i] = (f3_ - f2) / h;
+      der2_[i] = (f3_ - 2. * f2 + f1) / (h * h);
+    }
+  }
+  catch (ConstraintException& ce)
+  {
+    // Left limit raised, use forward approximation:
+    p[0].setValue(value + h);
+    setTrialParameters_(function, p, previous);
+    double f4 = function.getValue();
+    p[0].setValue(value + 2 * h);
+    function.setParameters(p);
+    double f5 = function.getValue();
+    der1_[i] = (f4 - f3_) / h;
+    der2_[i] = (f5 - 2. * f4 + f3_) / (h * h);
+  }
+}
+
+/******************************************************************************/
+
@@ -86,30 +86,18 @@ class FivePointsNumericalDerivative :
   public AbstractNumericalDerivative
 {
 private:
-  double f1_, f2_, f3_, f4_, f5_;
+  double f3_;
 
 public:
   FivePointsNumericalDerivative(Function* function) :
     AbstractNumericalDerivative(function),
-    f1_(),
-    f2_(),
-    f3_(),
-    f4_(),
-    f5_() {}
+    f3_() {}
   FivePointsNumericalDerivative(DerivableFirstOrder* function) :
     AbstractNumericalDerivative(function),
-    f1_(),
-    f2_(),
-    f3_(),
-    f4_(),
-    f5_() {}
+    f3_() {}
   FivePointsNumericalDerivative(DerivableSecondOrder* function) :
     AbstractNumericalDerivative(function),
-    f1_(),
-    f2_(),
-    f3_(),
-    f4_(),
-    f5_() {}
+    f3_() {}
   virtual ~FivePointsNumericalDerivative() {}
 
   FivePointsNumericalDerivative* clone() const { return new FivePointsNumericalDerivative(*this); }
@@ -127,6 +115,17 @@ public:
 
 protected:
   void updateDerivatives(const ParameterList parameters);
+
+private:
+  /**
+   * @brief Compute the derivatives for one variable.
+   *
+   * @param function The function to evaluate.
+   * @param i The index of the variable.
+   * @param p A list with a copy of the variable, used to set trial values.
+   * @param previous Parameters to reset together with the first trial point, or 0 (see setTrialParameters_).
+   */
+  void computeDerivatives_(Function& function, size_t i, ParameterList& p, const ParameterList*& previous);
 };
 } // end of namespace bpp.
 
@@ -38,12 +38,17 @@ knowledge of the CeCILL license and that you accept its terms.
 */
 
 #include "FunctionTools.h"
+#include "BatchFunction.h"
 #include "../../App/ApplicationTools.h"
+#include "../../Utils/ThreadTools.h"
 
 using namespace bpp;
 
 //From the STL;
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
 using namespace std;
 
 void ParameterGrid::addDimension(const std::string& name, const Vdouble& values)
@@ -77,6 +82,19 @@ size_t ParameterGrid::getTotalNumberOfPoints() const
   return n;
 }
 
+Vdouble ParameterGrid::getPoint(size_t index) const
+{
+  size_t nbPoints = getTotalNumberOfPoints();
+  if (index >= nbPoints) throw IndexOutOfBoundsException("ParameterGrid::getPoint().", index, 0, nbPoints == 0 ? 0 : nbPoints - 1);
+  Vdouble point(grid_.size());
+  for (size_t i = 0; i < grid_.size(); i++)
+  {
+    point[i] = grid_[i][index % grid_[i].size()];
+    index /= grid_[i].size();
+  }
+  return point;
+}
+
 VVdouble* FunctionTools::computeGrid(
     Function& function,
     const ParameterGrid& grid)
@@ -86,55 +104,224 @@ VVdouble* FunctionTools::computeGrid(
   VVdouble* data = new VVdouble();
   if(n == 0) return data; //Empty data table returned.
 
-  VVdouble points = grid.getPoints();
+  const VVdouble& points = grid.getPoints();
 
   //Get the parameter list. this may throw an exception if the grid does not
   //match the function parameters...
   ParameterList pl = function.getParameters().createSubList(grid.getDimensionNames());
-  for(unsigned int i = 0; i < n; i++)
-    pl.setParameterValue(grid.getDimensionName(i), grid.getPointsForDimension(i)[0]);
 
-  //Iterate over all dimensions:
-  unsigned int currentDimension = 0;
-  vector<unsigned int> currentPointInDimension(n);
+  //Points are evaluated in batches, one for each combination of values of all dimensions but the first one:
+  vector<ParameterList> batch(points[0].size(), pl);
+  Vdouble values;
+  vector<size_t> currentPointInDimension(n);
   vector<double> row(n + 1);
   size_t nbPoints = grid.getTotalNumberOfPoints();
   ApplicationTools::displayMessage("Computing likelihood profile...");
-  for (unsigned int i = 0; true ; i++)
+  for (size_t i = 0; true ; i += batch.size())
   {
-    ApplicationTools::displayGauge(i, nbPoints - 1, '=');
-    //We start by adding the current point to the table:
-    for (unsigned int j = 0; j < n; j++)
-      row[j] = pl[j].getValue();
-    row[n] = function.f(pl);
-    data->push_back(row);
+    for (size_t k = 0; k < batch.size(); k++)
+    {
+      batch[k].setParameterValue(grid.getDimensionName(0), points[0][k]);
+      for (unsigned int j = 1; j < n; j++)
+        batch[k].setParameterValue(grid.getDimensionName(j), points[j][currentPointInDimension[j]]);
+    }
+    evaluate(function, batch, values);
+    for (size_t k = 0; k < batch.size(); k++)
+    {
+      for (unsigned int j = 0; j < n; j++)
+        row[j] = batch[k].getParameterValue(grid.getDimensionName(j));
+      row[n] = values[k];
+      data->push_back(row);
+    }
+    ApplicationTools::displayGauge(i + batch.size() - 1, nbPoints - 1, '=');
 
     //Now increment iterator:
-    bool dimensionChanged = false;
+    size_t currentDimension = 1;
     while (currentDimension < n && currentPointInDimension[currentDimension] == points[currentDimension].size() - 1)
     {
+      currentPointInDimension[currentDimension] = 0;
       currentDimension++;
-      dimensionChanged = true;
     }
     //Stopping condition:
     if (currentDimension == n) break;
-
     currentPointInDimension[currentDimension]++;
-    if (dimensionChanged)
+  }
+  ApplicationTools::displayMessage("\n");
+  //and we are done:
+  return data;
+}
+
+/******************************************************************************/
+
+void FunctionTools::computeGrid(
+    Function& function,
+    const ParameterGrid& grid,
+    const std::function<void (size_t, const Vdouble&)>& callback,
+    size_t nbThreads,
+    size_t chunkSize,
+    size_t firstPoint)
+{
+  if (chunkSize == 0) throw Exception("FunctionTools::computeGrid(). Chunks must contain at least one point.");
+  size_t nbPoints = grid.getTotalNumberOfPoints();
+  if (firstPoint >= nbPoints) return;
+  size_t n = grid.getNumberOfDimensions();
+  const VVdouble& values = grid.getPoints();
+
+  //Get the parameter list. this may throw an exception if the grid does not
+  //match the function parameters...
+  ParameterList pl = function.getParameters().createSubList(grid.getDimensionNames());
+  vector<size_t> positions(n);
+  for (unsigned int j = 0; j < n; j++)
+    positions[j] = pl.whichParameterHasName(grid.getDimensionName(j));
+
+  //One copy of the function for each thread:
+  size_t nbChunks = (nbPoints - firstPoint + chunkSize - 1) / chunkSize;
+  nbThreads = min(nbThreads, nbChunks);
+  vector< unique_ptr<Function> > clones;
+  vector<Function*> available(1, &function);
+  for (size_t t = 1; t < nbThreads; t++)
+  {
+    clones.push_back(unique_ptr<Function>(function.independentClone()));
+    available.push_back(clones.back().get());
+  }
+
+  //Chunks which are done, waiting for the previous ones to be passed to the callback function:
+  map<size_t, Vdouble> pending;
+  size_t nextChunk = 0;
+  mutex chunksMutex;
+
+  ThreadTools::parallelFor(nbChunks, nbThreads, [&](size_t c) {
+    size_t first = firstPoint + c * chunkSize;
+    size_t last = min(first + chunkSize, nbPoints);
+    vector<ParameterList> points(last - first, pl);
+    for (size_t i = first; i < last; i++)
+    {
+      size_t index = i;
+      for (size_t j = 0; j < n; j++)
+      {
+        points[i - first][positions[j]].setValue(values[j][index % values[j].size()]);
+        index /= values[j].size();
+      }
+    }
+
+    Function* f;
+    {
+      lock_guard<mutex> lock(chunksMutex);
+      f = available.back();
+      available.pop_back();
+    }
+    Vdouble chunk;
+    try
     {
-      for (unsigned int j = 0; j < currentDimension; j++)
-        currentPointInDimension[j] = 0;
-      currentDimension = 0;
+      evaluate(*f, points, chunk);
     }
-   
-    //Set the new parameter value:
-    for (unsigned int j = 0; j < points.size(); j++)
+    catch (...)
     {
-      pl.setParameterValue(grid.getDimensionName(j), points[j][currentPointInDimension[j]]);
+      lock_guard<mutex> lock(chunksMutex);
+      available.push_back(f);
+      throw;
     }
+
+    lock_guard<mutex> lock(chunksMutex);
+    available.push_back(f);
+    pending[c].swap(chunk);
+    while (!pending.empty() && pending.begin()->first == nextChunk)
+    {
+      callback(firstPoint + nextChunk * chunkSize, pending.begin()->second);
+      pending.erase(pending.begin());
+      nextChunk++;
+    }
+  });
+}
+
+/******************************************************************************/
+
+void FunctionTools::computeGrid(
+    Function& function,
+    const ParameterGrid& grid,
+    Vdouble& values,
+    size_t& nextPoint,
+    size_t nbThreads,
+    size_t chunkSize)
+{
+  size_t nbPoints = grid.getTotalNumberOfPoints();
+  if (values.size() < nbPoints)
+    values.resize(nbPoints);
+  computeGrid(function, grid, [&values, &nextPoint](size_t first, const Vdouble& chunk) {
+      copy(chunk.begin(), chunk.end(), values.begin() + static_cast<ptrdiff_t>(first));
+      nextPoint = first + chunk.size();
+    }, nbThreads, chunkSize, nextPoint);
+}
+
+/******************************************************************************/
+
+void FunctionTools::evaluate(Function& function, const std::vector<ParameterList>& points, Vdouble& values)
+{
+  BatchFunction* batchFunction = dynamic_cast<BatchFunction*>(&function);
+  if (batchFunction)
+    batchFunction->getValues(points, values);
+  else
+    evaluateSequentially(function, points, values);
+}
+
+/******************************************************************************/
+
+void FunctionTools::evaluate(DerivableFirstOrder& function, const std::vector<ParameterList>& points, const std::vector<std::string>& variables, Vdouble& values, VVdouble& gradients)
+{
+  BatchFunction* batchFunction = dynamic_cast<BatchFunction*>(&function);
+  if (batchFunction)
+    batchFunction->getValuesAndGradients(points, variables, values, gradients);
+  else
+    evaluateSequentially(function, points, variables, values, gradients);
+}
+
+/******************************************************************************/
+
+void FunctionTools::evaluateSequentially(Function& function, const std::vector<ParameterList>& points, Vdouble& values)
+{
+  values.resize(points.size());
+  ParameterList modified;
+  for (size_t k = 0; k < points.size(); k++)
+  {
+    setPoint_(function, points[k], modified);
+    values[k] = function.getValue();
+  }
+}
+
+/******************************************************************************/
+
+void FunctionTools::evaluateSequentially(DerivableFirstOrder& function, const std::vector<ParameterList>& points, const std::vector<std::string>& variables, Vdouble& values, VVdouble& gradients)
+{
+  values.resize(points.size());
+  gradients.resize(points.size());
+  ParameterList modified;
+  for (size_t k = 0; k < points.size(); k++)
+  {
+    setPoint_(function, points[k], modified);
+    values[k] = function.getValue();
+    gradients[k].resize(variables.size());
+    for (size_t j = 0; j < variables.size(); j++)
+      gradients[k][j] = function.getFirstOrderDerivative(variables[j]);
   }
-  ApplicationTools::displayMessage("\n");
-  //and we are done:
-  return data;
 }
 
+/******************************************************************************/
+
+void FunctionTools::setPoint_(Function& function, const ParameterList& point, ParameterList& modified)
+{
+  // Reset parameters which are not in this point:
+  ParameterList pl;
+  pl.shareParameters(point);
+  for (size_t i = 0; i < modified.size(); i++)
+    if (!point.hasParameter(modified[i].getName()))
+      pl.shareParameter(modified.getSharedParameter(i));
+  // Remember the current value of parameters which are modified for the first time:
+  const ParameterList& current = function.getParameters();
+  for (size_t i = 0; i < point.size(); i++)
+    if (!modified.hasParameter(point[i].getName()) && current.hasParameter(point[i].getName()))
+      modified.addParameter(current.getParameter(point[i].getName()));
+  function.setParameters(pl);
+}
+
+/******************************************************************************/
+
@@ -43,6 +43,9 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "Functions.h"
 #include "../VectorTools.h"
 
+// From the STL:
+#include <functional>
+
 namespace bpp
 {
 
@@ -87,6 +90,18 @@ class ParameterGrid
     size_t getTotalNumberOfPoints() const;
 
     const VVdouble& getPoints() const { return grid_; }
+
+    /**
+     * @brief Get the coordinates of a point in the grid.
+     *
+     * Points are numbered with the first dimension varying fastest, as in FunctionTools::computeGrid.
+     *
+     * @param index The index of the point, in [0, getTotalNumberOfPoints()[.
+     * @return The value of each dimension at this point.
+     * @throw IndexOutOfBoundsException If the index is not valid.
+     */
+    Vdouble getPoint(size_t index) const;
+
     const Vdouble& getPointsForDimension(unsigned int i) const;
     const Vdouble& getPointsForDimension(const std::string& name) const;
 };
@@ -114,6 +129,117 @@ class FunctionTools
     static VVdouble* computeGrid(
         Function& function,
         const ParameterGrid& grid);
+
+    /**
+     * @brief Evaluates a function on all points in a given grid, in parallel.
+     *
+     * Points are numbered as in ParameterGrid::getPoint, and split into chunks of consecutive points.
+     * Chunks are dispatched dynamically to the threads, each thread evaluating its own copy of the
+     * function (see FunctionTools::evaluate, so that functions implementing the BatchFunction interface
+     * get all the points of a chunk at once). Copies are made once per call with Function::independentClone(),
+     * so that wrappers get their own copy of the function they wrap, and each of them is reused for all
+     * the chunks of its thread. One of the threads uses the function itself.
+     *
+     * The values of each chunk are passed to the callback function in the order of the points, one chunk at a time,
+     * so that the points already evaluated are always all the ones before a given index. In case of an exception
+     * (including one thrown by the callback), no more chunks are passed to the callback, and the evaluation can be
+     * resumed from the first point which was not passed.
+     *
+     * @param function   The function to use for the evaluation. Only the parameters in the grid are modified,
+     * the others keeping their current value. The state of the function after the call is not specified.
+     * @param grid       The grid defining the set of points to evaluate.
+     * @param callback   The function called with the index of the first point of each chunk, and the values at all points in the chunk.
+     * @param nbThreads  The number of threads to use.
+     * @param chunkSize  The number of points in each chunk.
+     * @param firstPoint The index of the first point to evaluate, to resume a previous evaluation.
+     * @throw Exception If the parameter names in the grid do not match
+     * the ones in the function, or a constraint is matched, etc.
+     */
+    static void computeGrid(
+        Function& function,
+        const ParameterGrid& grid,
+        const std::function<void (size_t, const Vdouble&)>& callback,
+        size_t nbThreads = 1,
+        size_t chunkSize = 1000,
+        size_t firstPoint = 0);
+
+    /**
+     * @brief Evaluates a function on all points in a given grid, in parallel, into a buffer.
+     *
+     * @param function   The function to use for the evaluation.
+     * @param grid       The grid defining the set of points to evaluate.
+     * @param values     [in,out] The value of the function at each point, numbered as in ParameterGrid::getPoint.
+     * The vector is resized to the number of points in the grid if needed. Values before nextPoint are not modified.
+     * @param nextPoint  [in,out] The index of the first point to evaluate, to resume a previous evaluation.
+     * It is updated as points are evaluated: on return, or after an exception, it is the index of the first point not evaluated.
+     * @param nbThreads  The number of threads to use.
+     * @param chunkSize  The number of points in each chunk.
+     * @see computeGrid(Function&, const ParameterGrid&, const std::function<void (size_t, const Vdouble&)>&, size_t, size_t, size_t)
+     */
+    static void computeGrid(
+        Function& function,
+        const ParameterGrid& grid,
+        Vdouble& values,
+        size_t& nextPoint,
+        size_t nbThreads = 1,
+        size_t chunkSize = 1000);
+
+    /**
+     * @brief Evaluates a function at several points.
+     *
+     * Each point is a list of parameters, which are set in turn to the given values,
+     * all other parameters keeping the value they had before the call. After the call,
+     * the function is left at the last point.
+     * If the function implements the BatchFunction interface, all points are passed to it at once.
+     *
+     * @param function The function to evaluate.
+     * @param points   The points where to evaluate the function.
+     * @param values   [out] The value of the function at each point.
+     * @throw ConstraintException If a parameter value does not match its constraint.
+     */
+    static void evaluate(Function& function, const std::vector<ParameterList>& points, Vdouble& values);
+
+    /**
+     * @brief Evaluates a function and its first order derivatives at several points.
+     *
+     * @param function  The function to evaluate.
+     * @param points    The points where to evaluate the function.
+     * @param variables The names of the variables to derivate.
+     * @param values    [out] The value of the function at each point.
+     * @param gradients [out] For each point, the first order derivative for each variable.
+     * @see evaluate
+     */
+    static void evaluate(DerivableFirstOrder& function, const std::vector<ParameterList>& points, const std::vector<std::string>& variables, Vdouble& values, VVdouble& gradients);
+
+    /**
+     * @brief Evaluates a function at several points, one after the other.
+     *
+     * This is the default implementation of the BatchFunction interface.
+     *
+     * @see evaluate
+     */
+    static void evaluateSequentially(Function& function, const std::vector<ParameterList>& points, Vdouble& values);
+
+    /**
+     * @brief Evaluates a function and its first order derivatives at several points, one after the other.
+     *
+     * This is the default implementation of the BatchFunction interface.
+     *
+     * @see evaluate
+     */
+    static void evaluateSequentially(DerivableFirstOrder& function, const std::vector<ParameterList>& points, const std::vector<std::string>& variables, Vdouble& values, VVdouble& gradients);
+
+  private:
+    /**
+     * @brief Set the parameters of a function to the next point.
+     *
+     * @param function The function to evaluate.
+     * @param point    The next point.
+     * @param modified The parameters set by previous points, with their value before the first point.
+     * They are reset if they are not in the next point, and the parameters of the next point are added,
+     * unless they are not in the list of parameters of the function (see ParametrizableAdapter).
+     */
+    static void setPoint_(Function& function, const ParameterList& point, ParameterList& modified);
 };
 
 } //end of namespace bpp
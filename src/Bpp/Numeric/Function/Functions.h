@@ -41,6 +41,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _FUNCTIONS_H_
 
 #include "../ParameterList.h"
+#include "../ParameterSnapshot.h"
 #include "../Parametrizable.h"
 #include "../AbstractParametrizable.h"
 #include "../ParameterExceptions.h"
@@ -51,6 +52,7 @@ knowledge of the CeCILL license and that you accept its terms.
 
 // From the STL:
 #include <cmath>
+#include <memory>
 
 namespace bpp
 {
@@ -81,6 +83,10 @@ namespace bpp
  * @endcode
  * for convinience.
  *
+ * The evaluate() method computes the value of the function at a given point without
+ * modifying the function, so that several threads can evaluate the same function at
+ * different points.
+ *
  * @see Parameter, ParameterList
  */
 class Function:
@@ -119,6 +125,43 @@ class Function:
       setParameters(parameters);
       return getValue();
     }
+
+    /**
+     * @brief Get the value of the function at a given point, without modifying the function.
+     *
+     * Parameters of the function which are not in the snapshot keep their current value.
+     * Calls to this method can be made concurrently from several threads, but not concurrently
+     * with methods modifying the function, like setParameters().
+     *
+     * The default implementation makes a copy of the function with independentClone() at every call,
+     * sets all parameters of the snapshot and evaluates the copy. This is as costly as building the function,
+     * and should be overridden by functions with a cheaper re-entrant evaluation. To evaluate many points
+     * in parallel, one independent copy per thread is usually preferable.
+     *
+     * @param snapshot The values of the parameters to use.
+     * @return The value of the function at the given point.
+     * @throw Exception If an error occured.
+     */
+    virtual double evaluate(const ParameterSnapshot& snapshot) const
+    {
+      std::unique_ptr<Function> copy(independentClone());
+      copy->setParameters(snapshot.createParameterList());
+      return copy->getValue();
+    }
+
+    /**
+     * @brief Get a copy of the function which does not share any modifiable data with this one.
+     *
+     * The copy can be modified and evaluated in another thread while this function is used.
+     * The default implementation calls clone(), and must be overridden by functions sharing
+     * data with their copies, like wrappers, which then wrap an independent copy of the wrapped function.
+     *
+     * @return A new copy of the function, to be deleted by the caller.
+     */
+    virtual Function* independentClone() const
+    {
+      return dynamic_cast<Function*>(clone());
+    }
 };
 
 /**
@@ -269,12 +312,18 @@ class FunctionWrapper:
   protected:
     Function* function_;
 
+    /**
+     * @brief The wrapped function, if it is owned by the wrapper (see independentClone()), shared with its copies.
+     */
+    std::shared_ptr<Function> ownedFunction_;
+
   public:
-    FunctionWrapper(Function* function) : function_(function) {}
-    FunctionWrapper(const FunctionWrapper& fw) : function_(fw.function_) {}
+    FunctionWrapper(Function* function) : function_(function), ownedFunction_() {}
+    FunctionWrapper(const FunctionWrapper& fw) : function_(fw.function_), ownedFunction_(fw.ownedFunction_) {}
     FunctionWrapper& operator=(const FunctionWrapper& fw)
     {
       function_ = fw.function_;
+      ownedFunction_ = fw.ownedFunction_;
       return *this;
     }
 
@@ -308,6 +357,22 @@ class FunctionWrapper:
     {
       return function_->f(parameters);
     }
+
+    double evaluate(const ParameterSnapshot& snapshot) const
+    {
+      return function_->evaluate(snapshot);
+    }
+
+    /**
+     * @return A copy of the wrapper, wrapping an independent copy of the wrapped function that it owns.
+     */
+    Function* independentClone() const
+    {
+      std::unique_ptr<FunctionWrapper> fw(dynamic_cast<FunctionWrapper*>(clone()));
+      fw->ownedFunction_.reset(function_->independentClone());
+      fw->function_ = fw->ownedFunction_.get();
+      return fw.release();
+    }
     
     double getParameterValue(const std::string& name) const
     {
@@ -462,6 +527,18 @@ class InfinityFunctionWrapper:
       setParameters(parameters);
       return getValue();
     }
+
+    double evaluate(const ParameterSnapshot& snapshot) const
+    {
+      try
+      {
+        return function_->evaluate(snapshot);
+      }
+      catch(ConstraintException& ce)
+      {
+        return -log(0.);
+      }
+    }
           
     void setAllParametersValues(const ParameterList & parameters)
     {
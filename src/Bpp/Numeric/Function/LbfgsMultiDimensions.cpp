@@ -0,0 +1,326 @@
+//
+// File: LbfgsMultiDimensions.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "LbfgsMultiDimensions.h"
+#include "OneDimensionOptimizationTools.h"
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+string LbfgsMultiDimensions::LINE_SEARCH_BACKTRACKING = "backtracking";
+string LbfgsMultiDimensions::LINE_SEARCH_STRONG_WOLFE = "strong Wolfe";
+
+/******************************************************************************/
+
+LbfgsMultiDimensions::LbfgsMultiDimensions(DerivableFirstOrder* function, size_t historySize) :
+  AbstractOptimizer(function),
+  historySize_(historySize),
+  lineSearch_(LINE_SEARCH_BACKTRACKING),
+  Up_(),
+  Lo_(),
+  p_(),
+  gradient_(),
+  xi_(),
+  dg_(),
+  s_(),
+  y_(),
+  rho_(),
+  alpha_(),
+  historyStart_(0),
+  historyLength_(0),
+  f1dim_(function)
+{
+  if (historySize == 0)
+    throw Exception("LbfgsMultiDimensions. History size must be positive.");
+  setDefaultStopCondition_(new FunctionStopCondition(this));
+  setStopCondition(*getDefaultStopCondition());
+  setOptimizationProgressCharacter(".");
+}
+
+/******************************************************************************/
+
+void LbfgsMultiDimensions::doInit(const ParameterList& params)
+{
+  size_t nbParams = params.size();
+  p_.resize(nbParams);
+  gradient_.resize(nbParams);
+  xi_.resize(nbParams);
+  dg_.resize(nbParams);
+  Up_.resize(nbParams);
+  Lo_.resize(nbParams);
+
+  s_.assign(historySize_, Vdouble(nbParams));
+  y_.assign(historySize_, Vdouble(nbParams));
+  rho_.resize(historySize_);
+  alpha_.resize(historySize_);
+  historyStart_ = 0;
+  historyLength_ = 0;
+
+  for (size_t i = 0; i < nbParams; i++)
+  {
+    std::shared_ptr<Constraint> cp = params[i].getConstraint();
+    if (!cp)
+    {
+      Up_[i] = NumConstants::VERY_BIG();
+      Lo_[i] = -NumConstants::VERY_BIG();
+    }
+    else
+    {
+      Up_[i] = cp->getAcceptedLimit(NumConstants::VERY_BIG()) - NumConstants::TINY();
+      Lo_[i] = cp->getAcceptedLimit(-NumConstants::VERY_BIG()) + NumConstants::TINY();
+    }
+  }
+
+  getFunction_()->enableFirstOrderDerivatives(true);
+  getFunction_()->setParameters(params);
+
+  getGradient(gradient_);
+}
+
+/******************************************************************************/
+
+double LbfgsMultiDimensions::doStep()
+{
+  double f;
+  size_t n = getParameters().size();
+
+  for (size_t i = 0; i < n; i++)
+  {
+    p_[i] = getParameters()[i].getValue();
+  }
+
+  computeDirection_();
+  setDirection_();
+
+  double slope = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    slope += xi_[i] * gradient_[i];
+  }
+  if (slope >= 0 && historyLength_ > 0)
+  {
+    // Restart from the steepest descent direction:
+    historyLength_ = 0;
+    computeDirection_();
+    setDirection_();
+    slope = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      slope += xi_[i] * gradient_[i];
+    }
+  }
+  if (slope >= 0)
+  {
+    // Null gradient, or all descent directions are blocked by the bounds:
+    tolIsReached_ = true;
+    return currentValue_;
+  }
+
+  dg_ = gradient_;
+  if (lineSearch_ == LINE_SEARCH_STRONG_WOLFE)
+  {
+    f = currentValue_;
+    nbEval_ += OneDimensionOptimizationTools::strongWolfeLineSearch(getFunction_(),
+                                                                    getParameters_(), xi_,
+                                                                    gradient_, f,
+                                                                    getMaximumStep_());
+  }
+  else
+  {
+    // Derivatives are not disabled during the line search: functions computing them when
+    // parameters change would not update them when re-evaluated at the last trial point.
+    nbEval_ += OneDimensionOptimizationTools::lineSearch(f1dim_,
+                                                         getParameters_(), xi_,
+                                                         gradient_,
+                                                         0, 0,
+                                                         getVerbose() > 0 ? getVerbose() - 1 : 0);
+    f = getFunction()->f(getParameters());
+    getGradient(gradient_);
+  }
+
+  if (f > currentValue_) {
+    printMessage("!!! Function increase !!!");
+    printMessage("!!! Optimization might have failed. Try to reparametrize your function to remove constraints.");
+    tolIsReached_ = true;
+    return f;
+  }
+
+  if (tolIsReached_)
+  {
+    return f;
+  }
+
+  // Update the history with the new step and gradient change:
+  size_t k = (historyStart_ + historyLength_) % historySize_;
+  Vdouble& s = s_[k];
+  Vdouble& y = y_[k];
+  double sy = 0, ss = 0, yy = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    s[i] = getParameters()[i].getValue() - p_[i];
+    y[i] = gradient_[i] - dg_[i];
+    sy += s[i] * y[i];
+    ss += s[i] * s[i];
+    yy += y[i] * y[i];
+  }
+  // Same curvature condition as in BfgsMultiDimensions:
+  if (sy > sqrt(1e-7 * ss * yy))
+  {
+    rho_[k] = 1. / sy;
+    if (historyLength_ < historySize_)
+      historyLength_++;
+    else
+      historyStart_ = (historyStart_ + 1) % historySize_;
+  }
+
+  return f;
+}
+
+/******************************************************************************/
+
+void LbfgsMultiDimensions::getGradient(std::vector<double>& gradient) const
+{
+  for (size_t i = 0; i < gradient.size(); i++)
+  {
+    gradient[i] = getFunction()->getFirstOrderDerivative(getParameters()[i].getName());
+  }
+}
+
+/******************************************************************************/
+
+void LbfgsMultiDimensions::computeDirection_()
+{
+  size_t n = xi_.size();
+  // Variables at a bound with a gradient pointing outside are kept fixed (active set):
+  vector<bool> active(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    active[i] = (gradient_[i] < 0 && p_[i] - NumConstants::TINY() * gradient_[i] >= Up_[i])
+      || (gradient_[i] > 0 && p_[i] - NumConstants::TINY() * gradient_[i] <= Lo_[i]);
+    xi_[i] = active[i] ? 0. : gradient_[i];
+  }
+
+  // Two-loop recursion, from the newest to the oldest step...
+  for (size_t h = historyLength_; h > 0; h--)
+  {
+    size_t k = (historyStart_ + h - 1) % historySize_;
+    double a = 0;
+    for (size_t i = 0; i < n; i++)
+      a += s_[k][i] * xi_[i];
+    a *= rho_[k];
+    alpha_[k] = a;
+    for (size_t i = 0; i < n; i++)
+      xi_[i] -= a * y_[k][i];
+  }
+
+  // ... scaled by the initial approximation of the inverse hessian...
+  if (historyLength_ > 0)
+  {
+    size_t k = (historyStart_ + historyLength_ - 1) % historySize_;
+    double yy = 0;
+    for (size_t i = 0; i < n; i++)
+      yy += y_[k][i] * y_[k][i];
+    double gamma = 1. / (rho_[k] * yy);
+    for (size_t i = 0; i < n; i++)
+      xi_[i] *= gamma;
+  }
+
+  // ... and back from the oldest to the newest step:
+  for (size_t h = 0; h < historyLength_; h++)
+  {
+    size_t k = (historyStart_ + h) % historySize_;
+    double b = 0;
+    for (size_t i = 0; i < n; i++)
+      b += y_[k][i] * xi_[i];
+    b *= rho_[k];
+    for (size_t i = 0; i < n; i++)
+      xi_[i] += (alpha_[k] - b) * s_[k][i];
+  }
+
+  for (size_t i = 0; i < n; i++)
+  {
+    xi_[i] = active[i] ? 0. : -xi_[i];
+  }
+}
+
+/******************************************************************************/
+
+void LbfgsMultiDimensions::setDirection_()
+{
+  size_t nbParams = getParameters().size();
+
+  double v = 1, alpmax = 1;
+  for (size_t i = 0; i < nbParams; i++)
+  {
+    if ((xi_[i] > 0) && (p_[i] + NumConstants::TINY() * xi_[i] < Up_[i]))
+      v = (Up_[i] - p_[i]) / xi_[i];
+    else if ((xi_[i] < 0) && (p_[i] + NumConstants::TINY() * xi_[i] > Lo_[i]))
+      v = (Lo_[i] - p_[i]) / xi_[i];
+    if (v < alpmax)
+      alpmax = v;
+  }
+
+  for (size_t i = 0; i < nbParams; i++)
+  {
+    if (p_[i] + NumConstants::TINY() * xi_[i] >= Up_[i])
+      xi_[i] = Up_[i] - p_[i];
+    else if (p_[i] + NumConstants::TINY() * xi_[i] <= Lo_[i])
+      xi_[i] = Lo_[i] - p_[i];
+    else
+      xi_[i] *= alpmax;
+  }
+}
+
+/******************************************************************************/
+
+double LbfgsMultiDimensions::getMaximumStep_() const
+{
+  double maxStep = OneDimensionOptimizationTools::GLIMIT;
+  for (size_t i = 0; i < xi_.size(); i++)
+  {
+    if (xi_[i] > 0 && (Up_[i] - p_[i]) < maxStep * xi_[i])
+      maxStep = (Up_[i] - p_[i]) / xi_[i];
+    else if (xi_[i] < 0 && (Lo_[i] - p_[i]) > maxStep * xi_[i])
+      maxStep = (Lo_[i] - p_[i]) / xi_[i];
+  }
+  return maxStep;
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,176 @@
+//
+// File: LbfgsMultiDimensions.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _LBFGSMULTIDIMENSIONS_H_
+#define _LBFGSMULTIDIMENSIONS_H_
+
+#include "AbstractOptimizer.h"
+#include "DirectionFunction.h"
+#include "../VectorTools.h"
+
+namespace bpp
+{
+
+  /**
+   * @brief Limited-memory Broyden–Fletcher–Goldfarb–Shanno (L-BFGS) optimization method.
+   *
+   * Contrary to BfgsMultiDimensions, the inverse hessian is not stored, but computed from
+   * the last m steps and gradient changes using the two-loop recursion described in:
+   *
+   * <pre>
+   * Nocedal J. and Wright S. J., Numerical Optimization, 2nd edition (2006). Springer. Algorithm 7.4.
+   * </pre>
+   *
+   * Memory and time per step are therefore in O(mn) instead of O(n²), for n parameters.
+   * Bounds of the parameters are handled as in BfgsMultiDimensions.
+   *
+   * Two line searches are available: the one of OneDimensionOptimizationTools::lineSearch,
+   * which does not use derivatives (LINE_SEARCH_BACKTRACKING, the default), and
+   * OneDimensionOptimizationTools::strongWolfeLineSearch, which computes the gradient at
+   * each trial point (LINE_SEARCH_STRONG_WOLFE).
+   *
+   * Like any other optimizer, it can be used within a MetaOptimizer, for the parameters
+   * with first order derivatives.
+   */
+  class LbfgsMultiDimensions:
+    public AbstractOptimizer
+  {
+  public:
+    static std::string LINE_SEARCH_BACKTRACKING;
+    static std::string LINE_SEARCH_STRONG_WOLFE;
+
+  protected:
+    size_t historySize_;
+    std::string lineSearch_;
+
+    // vectors of the Lower & Upper bounds of the parameters
+    Vdouble Up_, Lo_;
+
+    mutable Vdouble p_, gradient_, xi_, dg_;
+
+    // Last steps and gradient changes, in a circular buffer:
+    std::vector<Vdouble> s_, y_;
+    Vdouble rho_, alpha_;
+    size_t historyStart_, historyLength_;
+
+    mutable DirectionFunction f1dim_;
+
+  public:
+    /**
+     * @param function The function to optimize.
+     * @param historySize The number of steps used to approximate the inverse hessian.
+     */
+    LbfgsMultiDimensions(DerivableFirstOrder* function, size_t historySize = 5);
+
+    virtual ~LbfgsMultiDimensions() {}
+
+    LbfgsMultiDimensions* clone() const { return new LbfgsMultiDimensions(*this); }
+
+  public:
+
+    /**
+     * @name From AbstractOptimizer.
+     *
+     * @{
+     */
+    const DerivableFirstOrder* getFunction() const
+    {
+      return dynamic_cast<const DerivableFirstOrder*>(AbstractOptimizer::getFunction());
+    }
+    DerivableFirstOrder* getFunction()
+    {
+      return dynamic_cast<DerivableFirstOrder*>(AbstractOptimizer::getFunction());
+    }
+    void doInit(const ParameterList& params);
+
+    double doStep();
+    /** @} */
+
+    void getGradient(std::vector<double>& gradient) const;
+
+    /**
+     * @brief Set the number of steps used to approximate the inverse hessian.
+     *
+     * The change takes effect at the next call to init().
+     */
+    void setHistorySize(size_t historySize)
+    {
+      if (historySize == 0)
+        throw Exception("LbfgsMultiDimensions::setHistorySize. History size must be positive.");
+      historySize_ = historySize;
+    }
+    size_t getHistorySize() const { return historySize_; }
+
+    /**
+     * @param lineSearch Either LINE_SEARCH_BACKTRACKING or LINE_SEARCH_STRONG_WOLFE.
+     */
+    void setLineSearch(const std::string& lineSearch)
+    {
+      if (lineSearch != LINE_SEARCH_BACKTRACKING && lineSearch != LINE_SEARCH_STRONG_WOLFE)
+        throw Exception("LbfgsMultiDimensions::setLineSearch. Unknown line search: " + lineSearch);
+      lineSearch_ = lineSearch;
+    }
+    const std::string& getLineSearch() const { return lineSearch_; }
+
+  protected:
+    DerivableFirstOrder* getFunction_()
+    {
+      return dynamic_cast<DerivableFirstOrder*>(AbstractOptimizer::getFunction_());
+    }
+
+  private:
+    /**
+     * Computes the search direction from the gradient and the history.
+     */
+    void computeDirection_();
+
+    /**
+     * Sets the direction for linesearch in case of bounds
+     * To be used after gradient_ & p_ are computed
+     */
+    void setDirection_();
+
+    /**
+     * @return The largest step along xi_ within the bounds.
+     */
+    double getMaximumStep_() const;
+  };
+
+} //end of namespace bpp.
+
+#endif //_LBFGSMULTIDIMENSIONS_H_
+
@@ -0,0 +1,545 @@
+//
+// File: LbfgsbMultiDimensions.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "LbfgsbMultiDimensions.h"
+#include "OneDimensionOptimizationTools.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+LbfgsbMultiDimensions::LbfgsbMultiDimensions(DerivableFirstOrder* function, size_t historySize) :
+  AbstractOptimizer(function),
+  historySize_(historySize),
+  pgtol_(1e-8),
+  Up_(),
+  Lo_(),
+  x_(),
+  gradient_(),
+  xcp_(),
+  d_(),
+  c_(),
+  dg_(),
+  s_(),
+  y_(),
+  historyStart_(0),
+  historyLength_(0),
+  theta_(1.),
+  m_()
+{
+  if (historySize == 0)
+    throw Exception("LbfgsbMultiDimensions. History size must be positive.");
+  setDefaultStopCondition_(new FunctionStopCondition(this));
+  setStopCondition(*getDefaultStopCondition());
+  setOptimizationProgressCharacter(".");
+}
+
+/******************************************************************************/
+
+void LbfgsbMultiDimensions::doInit(const ParameterList& params)
+{
+  size_t nbParams = params.size();
+  x_.resize(nbParams);
+  gradient_.resize(nbParams);
+  xcp_.resize(nbParams);
+  d_.resize(nbParams);
+  dg_.resize(nbParams);
+  Up_.resize(nbParams);
+  Lo_.resize(nbParams);
+
+  s_.assign(historySize_, Vdouble(nbParams));
+  y_.assign(historySize_, Vdouble(nbParams));
+  historyStart_ = 0;
+  historyLength_ = 0;
+  updateMiddleMatrix_();
+
+  for (size_t i = 0; i < nbParams; i++)
+  {
+    std::shared_ptr<Constraint> cp = params[i].getConstraint();
+    const IntervalConstraint* ic = dynamic_cast<const IntervalConstraint*>(cp.get());
+    if (!cp)
+    {
+      Up_[i] = NumConstants::PINF();
+      Lo_[i] = NumConstants::MINF();
+    }
+    else if (ic)
+    {
+      Up_[i] = ic->finiteUpperBound() ? ic->getAcceptedLimit(NumConstants::PINF()) - NumConstants::TINY() : NumConstants::PINF();
+      Lo_[i] = ic->finiteLowerBound() ? ic->getAcceptedLimit(NumConstants::MINF()) + NumConstants::TINY() : NumConstants::MINF();
+    }
+    else
+    {
+      Up_[i] = cp->getAcceptedLimit(NumConstants::VERY_BIG()) - NumConstants::TINY();
+      Lo_[i] = cp->getAcceptedLimit(-NumConstants::VERY_BIG()) + NumConstants::TINY();
+    }
+  }
+
+  getFunction_()->enableFirstOrderDerivatives(true);
+  getFunction_()->setParameters(params);
+
+  getGradient(gradient_);
+}
+
+/******************************************************************************/
+
+double LbfgsbMultiDimensions::doStep()
+{
+  size_t n = getParameters().size();
+
+  for (size_t i = 0; i < n; i++)
+  {
+    x_[i] = getParameters()[i].getValue();
+  }
+
+  if (getProjectedGradientNorm() <= pgtol_)
+  {
+    tolIsReached_ = true;
+    return currentValue_;
+  }
+
+  computeCauchyPoint_();
+  minimizeSubspace_();
+
+  double slope = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    slope += d_[i] * gradient_[i];
+  }
+  if (slope >= 0 && historyLength_ > 0)
+  {
+    // Restart without history:
+    historyLength_ = 0;
+    updateMiddleMatrix_();
+    computeCauchyPoint_();
+    minimizeSubspace_();
+    slope = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      slope += d_[i] * gradient_[i];
+    }
+  }
+  if (slope >= 0)
+  {
+    tolIsReached_ = true;
+    return currentValue_;
+  }
+
+  dg_ = gradient_;
+  double f = currentValue_;
+  nbEval_ += OneDimensionOptimizationTools::strongWolfeLineSearch(getFunction_(),
+                                                                  getParameters_(), d_,
+                                                                  gradient_, f,
+                                                                  getMaximumStep_());
+
+  if (f > currentValue_) {
+    printMessage("!!! Function increase !!!");
+    tolIsReached_ = true;
+    return f;
+  }
+
+  if (tolIsReached_)
+  {
+    return f;
+  }
+
+  // Update the history with the new step and gradient change:
+  size_t k = (historyStart_ + historyLength_) % historySize_;
+  Vdouble& s = s_[k];
+  Vdouble& y = y_[k];
+  double sy = 0, yy = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    s[i] = getParameters()[i].getValue() - x_[i];
+    y[i] = gradient_[i] - dg_[i];
+    sy += s[i] * y[i];
+    yy += y[i] * y[i];
+  }
+  if (sy > numeric_limits<double>::epsilon() * yy)
+  {
+    if (historyLength_ < historySize_)
+      historyLength_++;
+    else
+      historyStart_ = (historyStart_ + 1) % historySize_;
+    updateMiddleMatrix_();
+  }
+
+  return f;
+}
+
+/******************************************************************************/
+
+void LbfgsbMultiDimensions::getGradient(std::vector<double>& gradient) const
+{
+  for (size_t i = 0; i < gradient.size(); i++)
+  {
+    gradient[i] = getFunction()->getFirstOrderDerivative(getParameters()[i].getName());
+  }
+}
+
+/******************************************************************************/
+
+double LbfgsbMultiDimensions::getProjectedGradientNorm() const
+{
+  double norm = 0;
+  for (size_t i = 0; i < gradient_.size(); i++)
+  {
+    double x = getParameters()[i].getValue();
+    double projected = min(max(x - gradient_[i], Lo_[i]), Up_[i]) - x;
+    norm = max(norm, abs(projected));
+  }
+  return norm;
+}
+
+/******************************************************************************/
+
+void LbfgsbMultiDimensions::updateMiddleMatrix_()
+{
+  size_t k = historyLength_;
+  if (k == 0)
+  {
+    theta_ = 1.;
+    m_.resize(0, 0);
+    return;
+  }
+  size_t n = x_.size();
+  auto dot = [n](const Vdouble& u, const Vdouble& v) {
+    double r = 0;
+    for (size_t i = 0; i < n; i++)
+      r += u[i] * v[i];
+    return r;
+  };
+  const Vdouble& sLast = s_[(historyStart_ + k - 1) % historySize_];
+  const Vdouble& yLast = y_[(historyStart_ + k - 1) % historySize_];
+  theta_ = dot(yLast, yLast) / dot(sLast, yLast);
+
+  // K = [-D, L^T; L, theta S^T S], and M = K^-1:
+  RowMatrix<double> mk(2 * k, 2 * k);
+  for (size_t a = 0; a < k; a++)
+  {
+    const Vdouble& sa = s_[(historyStart_ + a) % historySize_];
+    for (size_t b = 0; b < k; b++)
+    {
+      const Vdouble& sb = s_[(historyStart_ + b) % historySize_];
+      const Vdouble& yb = y_[(historyStart_ + b) % historySize_];
+      if (a == b)
+        mk(a, a) = -dot(sa, yb);
+      else if (a > b)
+      {
+        double l = dot(sa, yb);
+        mk(k + a, b) = l;
+        mk(b, k + a) = l;
+      }
+      mk(k + a, k + b) = theta_ * dot(sa, sb);
+    }
+  }
+  if (!inverse_(mk, m_))
+  {
+    // Degenerated history, restart without it:
+    historyLength_ = 0;
+    theta_ = 1.;
+    m_.resize(0, 0);
+  }
+}
+
+/******************************************************************************/
+
+void LbfgsbMultiDimensions::multiplyMiddleMatrix_(const Vdouble& v, Vdouble& out) const
+{
+  size_t k2 = 2 * historyLength_;
+  out.assign(k2, 0.);
+  for (size_t a = 0; a < k2; a++)
+  {
+    for (size_t b = 0; b < k2; b++)
+      out[a] += m_(a, b) * v[b];
+  }
+}
+
+/******************************************************************************/
+
+void LbfgsbMultiDimensions::computeCauchyPoint_()
+{
+  size_t n = x_.size();
+  size_t k2 = 2 * historyLength_;
+
+  // Breakpoints of the projected steepest descent path:
+  Vdouble t(n);
+  vector<size_t> breakpoints;
+  for (size_t i = 0; i < n; i++)
+  {
+    xcp_[i] = x_[i];
+    if (gradient_[i] < 0)
+      t[i] = (x_[i] - Up_[i]) / gradient_[i];
+    else if (gradient_[i] > 0)
+      t[i] = (x_[i] - Lo_[i]) / gradient_[i];
+    else
+      t[i] = NumConstants::PINF();
+    d_[i] = t[i] > 0 ? -gradient_[i] : 0.;
+    if (t[i] > 0 && t[i] < NumConstants::PINF())
+      breakpoints.push_back(i);
+  }
+  sort(breakpoints.begin(), breakpoints.end(), [&t](size_t i, size_t j) { return t[i] < t[j]; });
+
+  // p = W^T d, c = 0:
+  Vdouble p(k2, 0.), mv, wb(k2);
+  c_.assign(k2, 0.);
+  double fp = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    fp -= d_[i] * d_[i];
+    if (d_[i] != 0)
+    {
+      for (size_t j = 0; j < k2; j++)
+        p[j] += getW_(i, j) * d_[i];
+    }
+  }
+  multiplyMiddleMatrix_(p, mv);
+  double fpp = -theta_ * fp - VectorTools::scalar<double, double>(p, mv);
+  fpp = max(fpp, NumConstants::VERY_TINY());
+  double dtMin = -fp / fpp;
+  double tOld = 0;
+
+  // Examine the segments between breakpoints:
+  for (size_t h = 0; h < breakpoints.size(); h++)
+  {
+    size_t b = breakpoints[h];
+    double dt = t[b] - tOld;
+    if (dtMin < dt)
+      break;
+    double gb = gradient_[b];
+    xcp_[b] = d_[b] > 0 ? Up_[b] : Lo_[b];
+    double zb = xcp_[b] - x_[b];
+    for (size_t j = 0; j < k2; j++)
+    {
+      c_[j] += dt * p[j];
+      wb[j] = getW_(b, j);
+    }
+    double wMc = 0, wMp = 0, wMw = 0;
+    if (k2 > 0)
+    {
+      multiplyMiddleMatrix_(wb, mv);
+      wMc = VectorTools::scalar<double, double>(c_, mv);
+      wMp = VectorTools::scalar<double, double>(p, mv);
+      wMw = VectorTools::scalar<double, double>(wb, mv);
+    }
+    fp += dt * fpp + gb * gb + theta_ * gb * zb - gb * wMc;
+    fpp += -theta_ * gb * gb - 2. * gb * wMp - gb * gb * wMw;
+    fpp = max(fpp, NumConstants::VERY_TINY());
+    for (size_t j = 0; j < k2; j++)
+      p[j] += gb * wb[j];
+    d_[b] = 0;
+    dtMin = -fp / fpp;
+    tOld = t[b];
+  }
+
+  dtMin = max(dtMin, 0.);
+  tOld += dtMin;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (d_[i] != 0)
+      xcp_[i] = x_[i] + tOld * d_[i];
+  }
+  for (size_t j = 0; j < k2; j++)
+    c_[j] += dtMin * p[j];
+}
+
+/******************************************************************************/
+
+void LbfgsbMultiDimensions::minimizeSubspace_()
+{
+  size_t n = x_.size();
+  size_t k2 = 2 * historyLength_;
+
+  vector<size_t> free;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (xcp_[i] > Lo_[i] && xcp_[i] < Up_[i])
+      free.push_back(i);
+  }
+
+  if (free.size() > 0)
+  {
+    // Reduced gradient of the model at the Cauchy point:
+    Vdouble mc;
+    multiplyMiddleMatrix_(c_, mc);
+    Vdouble r(free.size()), du(free.size());
+    for (size_t f = 0; f < free.size(); f++)
+    {
+      size_t i = free[f];
+      r[f] = gradient_[i] + theta_ * (xcp_[i] - x_[i]);
+      for (size_t j = 0; j < k2; j++)
+        r[f] -= getW_(i, j) * mc[j];
+      du[f] = -r[f] / theta_;
+    }
+
+    if (k2 > 0)
+    {
+      // Sherman-Morrison-Woodbury: du = -r / theta - W_Z N^-1 M W_Z^T r / theta^2,
+      // with N = I - M W_Z^T W_Z / theta.
+      Vdouble v(k2, 0.), mv;
+      RowMatrix<double> a(k2, k2);
+      for (size_t f = 0; f < free.size(); f++)
+      {
+        size_t i = free[f];
+        for (size_t j = 0; j < k2; j++)
+        {
+          double wij = getW_(i, j);
+          v[j] += wij * r[f];
+          for (size_t l = 0; l < k2; l++)
+            a(j, l) += wij * getW_(i, l);
+        }
+      }
+      multiplyMiddleMatrix_(v, mv);
+      RowMatrix<double> nm(k2, k2), nInv;
+      for (size_t j = 0; j < k2; j++)
+      {
+        for (size_t l = 0; l < k2; l++)
+        {
+          double ma = 0;
+          for (size_t q = 0; q < k2; q++)
+            ma += m_(j, q) * a(q, l);
+          nm(j, l) = (j == l ? 1. : 0.) - ma / theta_;
+        }
+      }
+      // If N is singular, the history is ignored in the subspace (du = -r / theta):
+      if (inverse_(nm, nInv))
+      {
+        Vdouble nv(k2, 0.);
+        for (size_t j = 0; j < k2; j++)
+        {
+          for (size_t l = 0; l < k2; l++)
+            nv[j] += nInv(j, l) * mv[l];
+        }
+        for (size_t f = 0; f < free.size(); f++)
+        {
+          for (size_t j = 0; j < k2; j++)
+            du[f] -= getW_(free[f], j) * nv[j] / (theta_ * theta_);
+        }
+      }
+    }
+
+    // Move toward the minimum of the model, within the bounds:
+    double alpha = 1.;
+    for (size_t f = 0; f < free.size(); f++)
+    {
+      size_t i = free[f];
+      if (du[f] > 0)
+        alpha = min(alpha, (Up_[i] - xcp_[i]) / du[f]);
+      else if (du[f] < 0)
+        alpha = min(alpha, (Lo_[i] - xcp_[i]) / du[f]);
+    }
+    for (size_t f = 0; f < free.size(); f++)
+      xcp_[free[f]] += alpha * du[f];
+  }
+
+  for (size_t i = 0; i < n; i++)
+  {
+    d_[i] = xcp_[i] - x_[i];
+  }
+}
+
+/******************************************************************************/
+
+double LbfgsbMultiDimensions::getMaximumStep_() const
+{
+  double maxStep = OneDimensionOptimizationTools::GLIMIT;
+  for (size_t i = 0; i < d_.size(); i++)
+  {
+    if (d_[i] > 0 && (Up_[i] - x_[i]) < maxStep * d_[i])
+      maxStep = (Up_[i] - x_[i]) / d_[i];
+    else if (d_[i] < 0 && (Lo_[i] - x_[i]) > maxStep * d_[i])
+      maxStep = (Lo_[i] - x_[i]) / d_[i];
+  }
+  return max(maxStep, 0.);
+}
+
+/******************************************************************************/
+
+bool LbfgsbMultiDimensions::inverse_(const RowMatrix<double>& a, RowMatrix<double>& inv)
+{
+  size_t n = a.getNumberOfRows();
+  RowMatrix<double> b(a);
+  inv.resize(n, n);
+  for (size_t i = 0; i < n; i++)
+  {
+    for (size_t j = 0; j < n; j++)
+      inv(i, j) = (i == j ? 1. : 0.);
+  }
+  for (size_t col = 0; col < n; col++)
+  {
+    size_t pivot = col;
+    for (size_t i = col + 1; i < n; i++)
+    {
+      if (abs(b(i, col)) > abs(b(pivot, col)))
+        pivot = i;
+    }
+    double pv = b(pivot, col);
+    if (pv == 0 || std::isnan(pv) || std::isinf(pv))
+      return false;
+    if (pivot != col)
+    {
+      for (size_t j = 0; j < n; j++)
+      {
+        swap(b(pivot, j), b(col, j));
+        swap(inv(pivot, j), inv(col, j));
+      }
+    }
+    for (size_t j = 0; j < n; j++)
+    {
+      b(col, j) /= pv;
+      inv(col, j) /= pv;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+      double factor = b(i, col);
+      if (i == col || factor == 0)
+        continue;
+      for (size_t j = 0; j < n; j++)
+      {
+        b(i, j) -= factor * b(col, j);
+        inv(i, j) -= factor * inv(col, j);
+      }
+    }
+  }
+  return true;
+}
+
+/******************************************************************************/
+
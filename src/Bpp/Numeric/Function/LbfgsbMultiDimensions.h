@@ -0,0 +1,209 @@
+//
+// File: LbfgsbMultiDimensions.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _LBFGSBMULTIDIMENSIONS_H_
+#define _LBFGSBMULTIDIMENSIONS_H_
+
+#include "AbstractOptimizer.h"
+#include "../VectorTools.h"
+#include "../Matrix/Matrix.h"
+
+namespace bpp
+{
+
+  /**
+   * @brief Limited-memory BFGS optimization method for bound constrained problems (L-BFGS-B).
+   *
+   * This optimizer handles the bounds of the parameters directly, instead of relying on a
+   * reparametrization of the function or on an infinite value outside the bounds. It follows:
+   *
+   * <pre>
+   * Byrd R. H., Lu P., Nocedal J. and Zhu C., A limited memory algorithm for bound
+   * constrained optimization (1995). SIAM J. Sci. Comput. 16(5):1190-1208.
+   * </pre>
+   *
+   * Each step:
+   * - computes the generalized Cauchy point, i.e. the first local minimizer of the quadratic
+   *   model along the projected steepest descent path;
+   * - minimizes the quadratic model on the variables which are not at a bound at the Cauchy
+   *   point (direct primal method), keeping the result within the bounds;
+   * - performs a line search fulfilling the strong Wolfe conditions toward this point
+   *   (see OneDimensionOptimizationTools::strongWolfeLineSearch).
+   *
+   * The quadratic model uses the compact representation of the L-BFGS matrix, built from the
+   * last m steps and gradient changes, so that memory and time per step are in O(mn).
+   *
+   * Bounds are taken from the IntervalConstraint objects of the parameters. Finite bounds are
+   * shifted inside by NumConstants::TINY(), as in BfgsMultiDimensions, so that rounding errors
+   * never lead to a value outside the constraint.
+   *
+   * Optimization stops when the stop condition is reached, or when the largest component of
+   * the projected gradient is lower than a given threshold (see setProjectedGradientTolerance()).
+   */
+  class LbfgsbMultiDimensions:
+    public AbstractOptimizer
+  {
+  protected:
+    size_t historySize_;
+    double pgtol_;
+
+    // vectors of the Lower & Upper bounds of the parameters
+    Vdouble Up_, Lo_;
+
+    mutable Vdouble x_, gradient_, xcp_, d_, c_, dg_;
+
+    // Last steps and gradient changes, in a circular buffer:
+    std::vector<Vdouble> s_, y_;
+    size_t historyStart_, historyLength_;
+    double theta_;
+    // Middle matrix of the compact representation:
+    RowMatrix<double> m_;
+
+  public:
+    /**
+     * @param function The function to optimize.
+     * @param historySize The number of steps used to approximate the hessian.
+     */
+    LbfgsbMultiDimensions(DerivableFirstOrder* function, size_t historySize = 5);
+
+    virtual ~LbfgsbMultiDimensions() {}
+
+    LbfgsbMultiDimensions* clone() const { return new LbfgsbMultiDimensions(*this); }
+
+  public:
+
+    /**
+     * @name From AbstractOptimizer.
+     *
+     * @{
+     */
+    const DerivableFirstOrder* getFunction() const
+    {
+      return dynamic_cast<const DerivableFirstOrder*>(AbstractOptimizer::getFunction());
+    }
+    DerivableFirstOrder* getFunction()
+    {
+      return dynamic_cast<DerivableFirstOrder*>(AbstractOptimizer::getFunction());
+    }
+    void doInit(const ParameterList& params);
+
+    double doStep();
+    /** @} */
+
+    void getGradient(std::vector<double>& gradient) const;
+
+    /**
+     * @brief Set the number of steps used to approximate the hessian.
+     *
+     * The change takes effect at the next call to init().
+     */
+    void setHistorySize(size_t historySize)
+    {
+      if (historySize == 0)
+        throw Exception("LbfgsbMultiDimensions::setHistorySize. History size must be positive.");
+      historySize_ = historySize;
+    }
+    size_t getHistorySize() const { return historySize_; }
+
+    /**
+     * @brief Set the threshold on the largest component of the projected gradient to stop the optimization.
+     */
+    void setProjectedGradientTolerance(double pgtol) { pgtol_ = pgtol; }
+    double getProjectedGradientTolerance() const { return pgtol_; }
+
+    /**
+     * @return The largest absolute component of the gradient projected on the bounds, at the current point.
+     */
+    double getProjectedGradientNorm() const;
+
+  protected:
+    DerivableFirstOrder* getFunction_()
+    {
+      return dynamic_cast<DerivableFirstOrder*>(AbstractOptimizer::getFunction_());
+    }
+
+  private:
+    /**
+     * @return The (i, j) element of W = [Y, theta S], the n x 2k matrix of the compact representation.
+     */
+    double getW_(size_t i, size_t j) const
+    {
+      return j < historyLength_ ?
+        y_[(historyStart_ + j) % historySize_][i] :
+        theta_ * s_[(historyStart_ + j - historyLength_) % historySize_][i];
+    }
+
+    /**
+     * @brief Compute m_ and theta_ from the history.
+     */
+    void updateMiddleMatrix_();
+
+    /**
+     * @brief Compute out = M v.
+     */
+    void multiplyMiddleMatrix_(const Vdouble& v, Vdouble& out) const;
+
+    /**
+     * @brief Compute the generalized Cauchy point xcp_, and c_ = W^T (xcp_ - x_).
+     */
+    void computeCauchyPoint_();
+
+    /**
+     * @brief Minimize the model on the free variables, and set d_ to the direction from x_.
+     */
+    void minimizeSubspace_();
+
+    /**
+     * @return The largest step along d_ within the bounds.
+     */
+    double getMaximumStep_() const;
+
+    /**
+     * @brief Inverse a small matrix, by Gauss-Jordan elimination with partial pivoting.
+     *
+     * Contrary to MatrixTools::inv, there is no absolute threshold on pivots, as the
+     * matrices of the compact representation scale with the steps.
+     *
+     * @return False if the matrix is singular.
+     */
+    static bool inverse_(const RowMatrix<double>& a, RowMatrix<double>& inv);
+  };
+
+} //end of namespace bpp.
+
+#endif //_LBFGSBMULTIDIMENSIONS_H_
+
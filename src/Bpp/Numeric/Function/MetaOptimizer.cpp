@@ -142,7 +142,7 @@ void MetaOptimizer::doInit(const ParameterList& parameters)
   }
   
   // Actualize parameters:
-  getParameters_().matchParametersValues(getFunction()->getParameters());
+  matchFunctionParametersValues_();
   
   getFunction()->setParameters(getParameters());
   initialValue_ = getFunction()->getValue();
@@ -40,6 +40,7 @@
 #include "NewtonBacktrackOneDimension.h"
 #include "BrentOneDimension.h"
 #include "OneDimensionOptimizationTools.h"
+#include "FunctionTools.h"
 #include "../NumTools.h"
 #include "../NumConstants.h"
 
@@ -67,11 +68,9 @@ Bracket OneDimensionOptimizationTools::bracketMinimum(
   ParameterList parameters)
 {
   Bracket bracket;
-  // Copy the parameter to use.
   bracket.a.x = a;
-  parameters[0].setValue(bracket.a.x); bracket.a.f = function->f(parameters);
   bracket.b.x = b;
-  parameters[0].setValue(bracket.b.x); bracket.b.f = function->f(parameters);
+  evaluate_(function, parameters, bracket.a, bracket.b);
 
   while (std::isnan(bracket.b.f)|| std::isinf(bracket.b.f))
   {
@@ -166,11 +165,9 @@ Bracket OneDimensionOptimizationTools::inwardBracketMinimum(
   uint intervalsNum)
 {
   Bracket bracket;
-  // Copy the parameter to use.
   bracket.a.x = a;
-  parameters[0].setValue(bracket.a.x); bracket.a.f = function->f(parameters);
   bracket.b.x = b;
-  parameters[0].setValue(bracket.b.x); bracket.b.f = function->f(parameters);
+  evaluate_(function, parameters, bracket.a, bracket.b);
 
   while (std::isnan(bracket.b.f)|| std::isinf(bracket.b.f))
   {
@@ -187,10 +184,18 @@ Bracket OneDimensionOptimizationTools::inwardBracketMinimum(
   bestMiddleX = (bracket.a.f < bracket.b.f ? bracket.a.x : bracket.b.x); // determine the currently optimal point with respect to f out of a and b 
   bestMiddleF = (bracket.a.f < bracket.b.f ? bracket.a.f : bracket.b.f); // determine the currently optimal point with respect to f out of a and b 
   jump = (b - a) / static_cast<double>(intervalsNum); // Determine the spacing appropriate to the mesh.
+  vector<ParameterList> points(intervalsNum, parameters);
   for (size_t i=1; i<=intervalsNum; i++) 
-  { // Loop over all intervals
+  {
     curr += jump;
-    parameters[0].setValue(curr); fcurr = function->f(parameters); 
+    points[i - 1][0].setValue(curr);
+  }
+  Vdouble values;
+  FunctionTools::evaluate(*function, points, values);
+  for (size_t i=1; i<=intervalsNum; i++) 
+  { // Loop over all intervals
+    curr = points[i - 1][0].getValue();
+    fcurr = values[i - 1];
     // If c yields better likelihood than a and b
     if (fcurr < bestMiddleF) 
     {
@@ -309,6 +314,157 @@ unsigned int OneDimensionOptimizationTools::lineSearch(DirectionFunction& f1dim,
 
 /******************************************************************************/
 
+unsigned int OneDimensionOptimizationTools::strongWolfeLineSearch(DerivableFirstOrder* function,
+                                                                  ParameterList& parameters,
+                                                                  std::vector<double>& xi,
+                                                                  std::vector<double>& gradient,
+                                                                  double& value,
+                                                                  double maxStep,
+                                                                  double c1,
+                                                                  double c2,
+                                                                  unsigned int maxEval)
+{
+  size_t size = xi.size();
+  vector<double> x0(size);
+  for (size_t i = 0; i < size; i++)
+    x0[i] = parameters[i].getValue();
+
+  double f0 = value, slope0 = 0;
+  for (size_t i = 0; i < size; i++)
+    slope0 += xi[i] * gradient[i];
+  if (slope0 >= 0)
+    throw Exception("OneDimensionOptimizationTools::strongWolfeLineSearch. Not a descent direction. Slope=" + TextTools::toString(slope0));
+
+  unsigned int nbEval = 0;
+  vector<double> g(size);
+  // Move to x0 + alpha * xi, and return the value and slope there:
+  auto evaluate = [&](double alpha, double& slope) {
+    for (size_t i = 0; i < size; i++)
+      parameters[i].setValue(x0[i] + alpha * xi[i]);
+    double f = function->f(parameters);
+    slope = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+      g[i] = function->getFirstOrderDerivative(parameters[i].getName());
+      slope += xi[i] * g[i];
+    }
+    nbEval++;
+    return f;
+  };
+
+  double alpha = min(1., maxStep), alphaPrev = 0, fPrev = f0, slopePrev = slope0;
+  double alphaLo = 0, alphaHi = 0, fLo = f0, fHi = f0, slopeLo = slope0, slopeHi = slope0;
+  bool zoom = false, found = false;
+  // Best point evaluated so far, in case the conditions are not met:
+  double alphaBest = 0, fBest = f0;
+  vector<double> gBest(gradient);
+
+  while (!found && nbEval < maxEval)
+  {
+    double slope;
+    double f = evaluate(alpha, slope);
+    if (f < fBest)
+    {
+      alphaBest = alpha;
+      fBest = f;
+      gBest = g;
+    }
+    if (!zoom)
+    {
+      if (f > f0 + c1 * alpha * slope0 || (nbEval > 1 && f >= fPrev))
+      {
+        zoom = true;
+        alphaLo = alphaPrev; fLo = fPrev; slopeLo = slopePrev;
+        alphaHi = alpha; fHi = f; slopeHi = slope;
+      }
+      else if (abs(slope) <= -c2 * slope0 || alpha >= maxStep)
+        found = true;
+      else if (slope >= 0)
+      {
+        zoom = true;
+        alphaLo = alpha; fLo = f; slopeLo = slope;
+        alphaHi = alphaPrev; fHi = fPrev; slopeHi = slopePrev;
+      }
+      else
+      {
+        alphaPrev = alpha; fPrev = f; slopePrev = slope;
+        alpha = min(2. * alpha, maxStep);
+        continue;
+      }
+    }
+    else
+    {
+      if (f > f0 + c1 * alpha * slope0 || f >= fLo)
+      {
+        alphaHi = alpha; fHi = f; slopeHi = slope;
+      }
+      else
+      {
+        if (abs(slope) <= -c2 * slope0)
+          found = true;
+        else
+        {
+          if (slope * (alphaHi - alphaLo) >= 0)
+          {
+            alphaHi = alphaLo; fHi = fLo; slopeHi = slopeLo;
+          }
+          alphaLo = alpha; fLo = f; slopeLo = slope;
+        }
+      }
+    }
+    if (found)
+    {
+      value = f;
+      gradient = g;
+      break;
+    }
+    double width = alphaHi - alphaLo;
+    if (abs(width) < NumConstants::TINY())
+      break;
+    // Cubic interpolation between alphaLo and alphaHi, safeguarded by bisection:
+    double d1 = slopeLo + slopeHi - 3. * (fLo - fHi) / (alphaLo - alphaHi);
+    double d2 = d1 * d1 - slopeLo * slopeHi;
+    alpha = alphaLo + width / 2.;
+    if (d2 >= 0)
+    {
+      d2 = (width > 0 ? 1. : -1.) * sqrt(d2);
+      double alphaCubic = alphaHi - width * (slopeHi + d2 - d1) / (slopeHi - slopeLo + 2. * d2);
+      if ((alphaCubic - alphaLo) / width > 0.1 && (alphaHi - alphaCubic) / width > 0.1)
+        alpha = alphaCubic;
+    }
+  }
+
+  if (!found)
+  {
+    // Go back to the best point:
+    alpha = alphaBest;
+    for (size_t i = 0; i < size; i++)
+      parameters[i].setValue(x0[i] + alpha * xi[i]);
+    function->setParameters(parameters);
+    nbEval++;
+    value = fBest;
+    gradient = gBest;
+  }
+  for (size_t i = 0; i < size; i++)
+    xi[i] *= alpha;
+  return nbEval;
+}
+
+/******************************************************************************/
+
+void OneDimensionOptimizationTools::evaluate_(Function* function, const ParameterList& parameters, BracketPoint& a, BracketPoint& b)
+{
+  vector<ParameterList> points(2, parameters);
+  points[0][0].setValue(a.x);
+  points[1][0].setValue(b.x);
+  Vdouble values;
+  FunctionTools::evaluate(*function, points, values);
+  a.f = values[0];
+  b.f = values[1];
+}
+
+/******************************************************************************/
+
 double OneDimensionOptimizationTools::GLIMIT = 100.0;
 
 /******************************************************************************/
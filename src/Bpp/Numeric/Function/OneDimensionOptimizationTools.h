@@ -140,11 +140,49 @@ public:
    */
   static unsigned int lineSearch(DirectionFunction& f1dim, ParameterList& parameters, std::vector<double>& xi, std::vector<double>& gradient, OutputStream* profiler = 0, OutputStream* messenger = 0, unsigned int verbose = 2);
 
+  /**
+   * @brief Search a step in a given direction fulfilling the strong Wolfe conditions.
+   *
+   * This is algorithm 3.5 (with the 'zoom' procedure of algorithm 3.6, using cubic interpolation) in
+   *
+   * <pre>
+   * Nocedal J. and Wright S. J., Numerical Optimization, 2nd edition (2006). Springer.
+   * </pre>
+   *
+   * Contrary to lineSearch(), the gradient is computed at each trial point, so first order
+   * derivatives must be enabled. If no step fulfilling the conditions is found after maxEval
+   * evaluations, the step with the lowest value is taken.
+   *
+   * @param function   The function to minimize.
+   * @param parameters [in,out] The starting point, set to the point found on return.
+   * @param xi         [in,out] The direction of search, set to the step actually performed on return.
+   * @param gradient   [in,out] The gradient at the starting point, set to the gradient at the point found on return.
+   * @param value      [in,out] The value of the function at the starting point, set to the value at the point found on return.
+   * @param maxStep    The maximum step along xi, for instance to stay within the bounds of the parameters.
+   * @param c1, c2     The constants of the sufficient decrease and curvature conditions (0 < c1 < c2 < 1).
+   * @param maxEval    The maximum number of evaluations of the function.
+   * @return The number of evaluations of the function.
+   * @throw Exception If xi is not a descent direction.
+   */
+  static unsigned int strongWolfeLineSearch(DerivableFirstOrder* function, ParameterList& parameters, std::vector<double>& xi, std::vector<double>& gradient, double& value, double maxStep = 1., double c1 = 1e-4, double c2 = 0.9, unsigned int maxEval = 20);
+
 public:
   /**
    * @brief Maximum magnification allowed for a parabolic-fit step.
    */
   static double GLIMIT;
+
+private:
+  /**
+   * @brief Evaluate the function at the two initial points of a bracket, at once.
+   *
+   * The function is left at the second point.
+   *
+   * @param function   The function to evaluate.
+   * @param parameters The parameter to use as a variable.
+   * @param a, b       [in,out] The two points, with their x value set. Their f value is set on return.
+   */
+  static void evaluate_(Function* function, const ParameterList& parameters, BracketPoint& a, BracketPoint& b);
 };
 } // end of namespace bpp.
 
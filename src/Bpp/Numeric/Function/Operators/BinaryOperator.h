@@ -107,7 +107,7 @@ namespace bpp
       case '+':
         return dl + dr;
       case '-':
-        return dl - dl;
+        return dl - dr;
       case '/':
         if (r==0)
           return 0;
@@ -144,7 +144,7 @@ namespace bpp
         if (r==0)
           return 0;
         
-        return (d2l * r - d2r * l ) / r2 - ( 2 * dl * ( dl * r - dr * l) ) / r3;
+        return (d2l * r - d2r * l ) / r2 - ( 2 * dr * ( dl * r - dr * l) ) / r3;
         
       case '*':
         return d2l * r + d2r * l + 2 * dr * dl;
@@ -157,6 +157,70 @@ namespace bpp
     {
       return "(" + left_->output() + " " + symb_ + " " + right_->output() + ")";
     }
+
+    bool isDecomposable() const { return true; }
+
+    std::vector<std::shared_ptr<Operator> > getOperands() const
+    {
+      return {left_, right_};
+    }
+
+    double getValue(const double* operands) const
+    {
+      double l = operands[0];
+      double r = operands[1];
+      switch(symb_)
+      {
+      case '+':
+        return l + r;
+      case '-':
+        return l - r;
+      case '/':
+        if (r==0)
+          return 0;
+        
+        return l / r;
+      case '*':
+        return l * r;
+      default:
+        return 0;
+      }
+    }
+
+    void getPartialDerivatives(const double* operands, double* d1, double* d2) const
+    {
+      double l = operands[0];
+      double r = operands[1];
+      d1[0] = d1[1] = 0;
+      d2[0] = d2[1] = d2[2] = d2[3] = 0;
+      switch(symb_)
+      {
+      case '+':
+        d1[0] = 1;
+        d1[1] = 1;
+        break;
+      case '-':
+        d1[0] = 1;
+        d1[1] = -1;
+        break;
+      case '/':
+        if (r==0)
+          break;
+
+        d1[0] = 1 / r;
+        d1[1] = - l / (r * r);
+        d2[1] = d2[2] = - 1 / (r * r);
+        d2[3] = 2 * l / (r * r * r);
+        break;
+      case '*':
+        d1[0] = r;
+        d1[1] = l;
+        d2[1] = d2[2] = 1;
+        break;
+      default:
+        break;
+      }
+    }
     
 
   };
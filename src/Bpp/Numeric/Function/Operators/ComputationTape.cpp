@@ -0,0 +1,297 @@
+//
+// File: ComputationTape.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "ComputationTape.h"
+
+#include "BinaryOperator.h"
+#include "ConstantOperator.h"
+#include "NegativeOperator.h"
+#include "MathOperator.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace bpp;
+
+ComputationTape::ComputationTape(const ComputationTree& tree):
+  instructions_(), callOperands_(),
+  inputNames_(), inputs_(), inputSlots_(),
+  constants_(), nbSlots_(0), rootSlot_(0)
+{
+  map<string, size_t> inputs;
+  map<double, size_t> constants;
+  map<vector<size_t>, size_t> expressions;
+  map<string, size_t> calls;
+  rootSlot_ = compile_(tree.getRoot(), inputs, constants, expressions, calls);
+}
+
+/******************************************************************************/
+
+size_t ComputationTape::addConstant_(double value, std::map<double, size_t>& constants)
+{
+  //NaN can not be used as a key.
+  if (value == value)
+  {
+    map<double, size_t>::const_iterator it = constants.find(value);
+    if (it != constants.end())
+      return it->second;
+    constants[value] = nbSlots_;
+  }
+  constants_[nbSlots_] = value;
+  return nbSlots_++;
+}
+
+/******************************************************************************/
+
+bool ComputationTape::getConstant_(size_t slot, double& value) const
+{
+  map<size_t, double>::const_iterator it = constants_.find(slot);
+  if (it == constants_.end())
+    return false;
+  value = it->second;
+  return true;
+}
+
+/******************************************************************************/
+
+size_t ComputationTape::compile_(const std::shared_ptr<Operator>& op, std::map<std::string, size_t>& inputs, std::map<double, size_t>& constants, std::map<std::vector<size_t>, size_t>& expressions, std::map<std::string, size_t>& calls)
+{
+  if (!op->isDecomposable())
+    throw Exception("ComputationTape::compile_. Operator " + op->output() + " does not give access to its operands and partial derivatives.");
+  vector<shared_ptr<Operator> > sons = op->getOperands();
+
+  //Leaves:
+  if (sons.empty())
+  {
+    if (dynamic_cast<const ConstantOperator*>(op.get()))
+      return addConstant_(op->getValue(), constants);
+
+    string name = op->output();
+    map<string, size_t>::const_iterator it = inputs.find(name);
+    if (it != inputs.end())
+      return it->second;
+    inputs[name] = nbSlots_;
+    inputNames_.push_back(name);
+    inputs_.push_back(op);
+    inputSlots_.push_back(nbSlots_);
+    return nbSlots_++;
+  }
+
+  vector<size_t> slots(sons.size());
+  vector<double> values(sons.size());
+  bool isConstant = true;
+  for (size_t k = 0; k < sons.size(); ++k)
+  {
+    slots[k] = compile_(sons[k], inputs, constants, expressions, calls);
+    isConstant &= getConstant_(slots[k], values[k]);
+  }
+
+  //Constant folding:
+  if (isConstant)
+    return addConstant_(op->getValue(values.data()), constants);
+
+  Instruction_ instruction = { CALL, 0, 0, 0, shared_ptr<Operator>() };
+  const BinaryOperator* binary = dynamic_cast<const BinaryOperator*>(op.get());
+  const MathOperator* math = dynamic_cast<const MathOperator*>(op.get());
+  if (binary && (binary->getSymbol() == '+' || binary->getSymbol() == '-' || binary->getSymbol() == '*' || binary->getSymbol() == '/'))
+  {
+    switch (binary->getSymbol())
+    {
+    case '+':
+      instruction.code = ADD;
+      break;
+    case '-':
+      instruction.code = SUB;
+      break;
+    case '*':
+      instruction.code = MUL;
+      break;
+    default:
+      instruction.code = DIV;
+    }
+    instruction.a = slots[0];
+    instruction.b = slots[1];
+    //Commutative operators:
+    if ((instruction.code == ADD || instruction.code == MUL) && instruction.a > instruction.b)
+      swap(instruction.a, instruction.b);
+  }
+  else if (dynamic_cast<const NegativeOperator*>(op.get()))
+  {
+    instruction.code = NEG;
+    instruction.a = slots[0];
+  }
+  else if (math && (math->getName() == "exp" || math->getName() == "log"))
+  {
+    instruction.code = (math->getName() == "exp" ? EXP : LOG);
+    instruction.a = slots[0];
+  }
+  else
+  {
+    instruction.op = op;
+    instruction.a = callOperands_.size();
+    instruction.b = slots.size();
+    callOperands_.insert(callOperands_.end(), slots.begin(), slots.end());
+  }
+
+  //Common subexpressions, other operators being called are identified by their formula:
+  if (instruction.code != CALL)
+  {
+    vector<size_t> key = { static_cast<size_t>(instruction.code), instruction.a, instruction.b };
+    map<vector<size_t>, size_t>::const_iterator it = expressions.find(key);
+    if (it != expressions.end())
+      return it->second;
+    expressions[key] = nbSlots_;
+  }
+  else
+  {
+    string key = op->output();
+    map<string, size_t>::const_iterator it = calls.find(key);
+    if (it != calls.end())
+      return it->second;
+    calls[key] = nbSlots_;
+  }
+
+  instruction.result = nbSlots_++;
+  instructions_.push_back(instruction);
+  return instruction.result;
+}
+
+/******************************************************************************/
+
+void ComputationTape::run_(std::vector<double>& buffer, size_t nbPoints) const
+{
+  double* slots = buffer.data();
+  vector<double> operands;
+  for (const Instruction_& instruction : instructions_)
+  {
+    double* r = slots + instruction.result * nbPoints;
+    const double* x = slots + instruction.a * nbPoints;
+    const double* y = slots + instruction.b * nbPoints;
+    switch (instruction.code)
+    {
+    case ADD:
+      for (size_t p = 0; p < nbPoints; ++p)
+        r[p] = x[p] + y[p];
+      break;
+    case SUB:
+      for (size_t p = 0; p < nbPoints; ++p)
+        r[p] = x[p] - y[p];
+      break;
+    case MUL:
+      for (size_t p = 0; p < nbPoints; ++p)
+        r[p] = x[p] * y[p];
+      break;
+    case DIV:
+      //As BinaryOperator, a division by 0 gives 0.
+      for (size_t p = 0; p < nbPoints; ++p)
+        r[p] = (y[p] == 0 ? 0 : x[p] / y[p]);
+      break;
+    case NEG:
+      for (size_t p = 0; p < nbPoints; ++p)
+        r[p] = -x[p];
+      break;
+    case EXP:
+      for (size_t p = 0; p < nbPoints; ++p)
+        r[p] = exp(x[p]);
+      break;
+    case LOG:
+      for (size_t p = 0; p < nbPoints; ++p)
+        r[p] = log(x[p]);
+      break;
+    case CALL:
+      operands.resize(instruction.b);
+      for (size_t p = 0; p < nbPoints; ++p)
+      {
+        for (size_t k = 0; k < instruction.b; ++k)
+          operands[k] = slots[callOperands_[instruction.a + k] * nbPoints + p];
+        r[p] = instruction.op->getValue(operands.data());
+      }
+      break;
+    }
+  }
+}
+
+/******************************************************************************/
+
+double ComputationTape::getValue() const
+{
+  vector<double> buffer(nbSlots_);
+  for (map<size_t, double>::const_iterator it = constants_.begin(); it != constants_.end(); ++it)
+    buffer[it->first] = it->second;
+  for (size_t i = 0; i < inputs_.size(); ++i)
+    buffer[inputSlots_[i]] = inputs_[i]->getValue();
+  run_(buffer, 1);
+  return buffer[rootSlot_];
+}
+
+/******************************************************************************/
+
+double ComputationTape::getValue(const std::vector<double>& inputs) const
+{
+  if (inputs.size() != inputs_.size())
+    throw Exception("ComputationTape::getValue. Wrong number of inputs: " + TextTools::toString(inputs.size()) + " instead of " + TextTools::toString(inputs_.size()) + ".");
+  vector<double> buffer(nbSlots_);
+  for (map<size_t, double>::const_iterator it = constants_.begin(); it != constants_.end(); ++it)
+    buffer[it->first] = it->second;
+  for (size_t i = 0; i < inputs_.size(); ++i)
+    buffer[inputSlots_[i]] = inputs[i];
+  run_(buffer, 1);
+  return buffer[rootSlot_];
+}
+
+/******************************************************************************/
+
+void ComputationTape::getValues(const VVdouble& inputs, Vdouble& values) const
+{
+  size_t nbPoints = inputs.size();
+  values.resize(nbPoints);
+  if (nbPoints == 0)
+    return;
+  vector<double> buffer(nbSlots_ * nbPoints);
+  for (map<size_t, double>::const_iterator it = constants_.begin(); it != constants_.end(); ++it)
+    std::fill_n(buffer.begin() + static_cast<ptrdiff_t>(it->first * nbPoints), nbPoints, it->second);
+  for (size_t p = 0; p < nbPoints; ++p)
+  {
+    if (inputs[p].size() != inputs_.size())
+      throw Exception("ComputationTape::getValues. Wrong number of inputs for point " + TextTools::toString(p) + ": " + TextTools::toString(inputs[p].size()) + " instead of " + TextTools::toString(inputs_.size()) + ".");
+    for (size_t i = 0; i < inputs_.size(); ++i)
+      buffer[inputSlots_[i] * nbPoints + p] = inputs[p][i];
+  }
+  run_(buffer, nbPoints);
+  std::copy(buffer.begin() + static_cast<ptrdiff_t>(rootSlot_ * nbPoints), buffer.begin() + static_cast<ptrdiff_t>((rootSlot_ + 1) * nbPoints), values.begin());
+}
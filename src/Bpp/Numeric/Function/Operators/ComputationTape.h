@@ -0,0 +1,169 @@
+//
+// File: ComputationTape.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _COMPUTATION_TAPE_H_
+#define _COMPUTATION_TAPE_H_
+
+#include "ComputationTree.h"
+#include "../../VectorTools.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief A ComputationTree compiled to a flat list of instructions.
+ *
+ * The operators of the tree are translated once into instructions reading and writing
+ * slots of a contiguous buffer, which are then executed in a single loop, without
+ * virtual calls nor pointer chasing. While compiling:
+ * - operators with constant operands are replaced by their value,
+ * - identical subexpressions are computed only once.
+ * Both assume that the value of an operator only depends on the value of its operands
+ * (see Operator::getValue(const double*)).
+ *
+ * The leaves of the tree which are not constant are the inputs of the tape, one per name.
+ * Their values are either taken from the tree (getValue()), or given for one or several
+ * points (getValue(inputs), getValues()). In the latter case, each instruction is executed
+ * for all points before the next one.
+ *
+ * The tape keeps the leaves of the tree alive, but does not see changes of its structure:
+ * it must be built again after ComputationTree::readFormula.
+ *
+ * Each computation uses its own buffer, so that the const methods can be called from several
+ * threads at once, as long as the leaves of the tree can.
+ */
+  class ComputationTape
+  {
+  private:
+    enum Opcode_ { ADD, SUB, MUL, DIV, NEG, EXP, LOG, CALL };
+
+    /**
+     * @brief Computes slot result from slots a and b.
+     *
+     * For CALL, the operands are the b slots listed in callOperands_ from position a,
+     * and the value is computed by op.
+     */
+    struct Instruction_
+    {
+      Opcode_ code;
+      size_t result;
+      size_t a;
+      size_t b;
+      std::shared_ptr<Operator> op;
+    };
+
+    std::vector<Instruction_> instructions_;
+    std::vector<size_t> callOperands_;
+
+    std::vector<std::string> inputNames_;
+    std::vector<std::shared_ptr<Operator> > inputs_;
+    std::vector<size_t> inputSlots_;
+
+    /**
+     * @brief Value of each constant slot.
+     */
+    std::map<size_t, double> constants_;
+
+    size_t nbSlots_;
+    size_t rootSlot_;
+
+  public:
+    /**
+     * @brief Compile a computation tree.
+     *
+     * @param tree The tree to compile.
+     * @throw Exception If an operator of the tree is not decomposable (see Operator::isDecomposable()).
+     */
+    ComputationTape(const ComputationTree& tree);
+
+    virtual ~ComputationTape() {}
+
+  public:
+    /**
+     * @return The names of the inputs, in the order expected by getValue(inputs) and getValues().
+     */
+    const std::vector<std::string>& getInputNames() const { return inputNames_; }
+
+    size_t getNumberOfInputs() const { return inputNames_.size(); }
+
+    size_t getNumberOfInstructions() const { return instructions_.size(); }
+
+    /**
+     * @return The value of the tree, with the current values of its leaves.
+     */
+    double getValue() const;
+
+    /**
+     * @return The value of the tree for given values of the inputs.
+     *
+     * @param inputs The value of each input.
+     */
+    double getValue(const std::vector<double>& inputs) const;
+
+    /**
+     * @brief Compute the value of the tree for several points at once.
+     *
+     * @param inputs The value of each input, for each point.
+     * @param values [out] The value of the tree for each point.
+     */
+    void getValues(const VVdouble& inputs, Vdouble& values) const;
+
+  private:
+    /**
+     * @return The slot where the value of an operator is stored.
+     */
+    size_t compile_(const std::shared_ptr<Operator>& op, std::map<std::string, size_t>& inputs, std::map<double, size_t>& constants, std::map<std::vector<size_t>, size_t>& expressions, std::map<std::string, size_t>& calls);
+
+    size_t addConstant_(double value, std::map<double, size_t>& constants);
+
+    /**
+     * @return True if a slot holds a constant, which is then copied to value.
+     */
+    bool getConstant_(size_t slot, double& value) const;
+
+    /**
+     * @brief Execute all instructions, for nbPoints points stored contiguously for each slot.
+     */
+    void run_(std::vector<double>& buffer, size_t nbPoints) const;
+  };
+} // end of namespace bpp
+#endif // _COMPUTATION_TAPE_H_
+
@@ -46,12 +46,15 @@
 #include "MathOperator.h"
 
 #include <algorithm>
+#include <map>
+#include <stack>
 
 using namespace std;
 using namespace bpp;
 
 ComputationTree::ComputationTree(const std::string& formula, const std::map<std::string, Function*>& functionNames):
-  AssociationTreeGlobalGraphObserver<Operator,short>(true)
+  AssociationTreeGlobalGraphObserver<Operator,short>(true),
+  nodes_(), operands_()
 {
   getGraph() ;
 
@@ -205,6 +208,210 @@ std::shared_ptr<Operator> ComputationTree::readFormula_(const std::string& formu
   //never
 }
 
+const std::vector<ComputationTree::Node_>& ComputationTree::getNodes_() const
+{
+  if (!nodes_.empty())
+    return nodes_;
+
+  //Post-order depth first search, operands being numbered before their operator.
+  map<const Operator*, size_t> index;
+  stack<pair<shared_ptr<Operator>, bool> > toVisit;
+  toVisit.push(make_pair(getRoot(), false));
+  size_t nbD2 = 0;
+  while (!toVisit.empty())
+  {
+    shared_ptr<Operator> op = toVisit.top().first;
+    if (!op->isDecomposable())
+      throw Exception("ComputationTree::getNodes_. Operator " + op->output() + " does not give access to its operands and partial derivatives.");
+    vector<shared_ptr<Operator> > sons = op->getOperands();
+    if (!toVisit.top().second)
+    {
+      toVisit.top().second = true;
+      for (size_t k = sons.size(); k > 0; --k)
+        toVisit.push(make_pair(sons[k - 1], false));
+      continue;
+    }
+    toVisit.pop();
+
+    Node_ node = { op.get(), operands_.size(), sons.size(), nbD2 };
+    for (size_t k = 0; k < sons.size(); ++k)
+      operands_.push_back(index[sons[k].get()]);
+    nbD2 += sons.size() * sons.size();
+    index[op.get()] = nodes_.size();
+    nodes_.push_back(node);
+  }
+  return nodes_;
+}
+
+/******************************************************************************/
+
+void ComputationTree::forwardSweep_(std::vector<double>& values, std::vector<double>& d1, std::vector<double>& d2) const
+{
+  const vector<Node_>& nodes = getNodes_();
+  values.resize(nodes.size());
+  d1.assign(operands_.size(), 0);
+  d2.assign(nodes.back().firstD2 + nodes.back().nbOperands * nodes.back().nbOperands, 0);
+
+  vector<double> operands;
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    const Node_& node = nodes[i];
+    operands.resize(node.nbOperands);
+    for (size_t k = 0; k < node.nbOperands; ++k)
+      operands[k] = values[operands_[node.firstOperand + k]];
+    values[i] = node.op->getValue(operands.data());
+    node.op->getPartialDerivatives(operands.data(), d1.data() + node.firstOperand, d2.data() + node.firstD2);
+  }
+}
+
+/******************************************************************************/
+
+void ComputationTree::backwardSweep_(const std::vector<double>& d1, std::vector<double>& adjoints) const
+{
+  const vector<Node_>& nodes = getNodes_();
+  adjoints.assign(nodes.size(), 0);
+  adjoints.back() = 1;
+  for (size_t i = nodes.size(); i > 0; --i)
+  {
+    const Node_& node = nodes[i - 1];
+    if (adjoints[i - 1] == 0)
+      continue;
+    for (size_t k = 0; k < node.nbOperands; ++k)
+      adjoints[operands_[node.firstOperand + k]] += adjoints[i - 1] * d1[node.firstOperand + k];
+  }
+}
+
+/******************************************************************************/
+
+void ComputationTree::tangentSweeps_(const std::vector<double>& d1, const std::vector<double>& d2, const std::vector<double>& adjoints, std::vector<double>& tangents, std::vector<double>& adjointTangents) const
+{
+  const vector<Node_>& nodes = getNodes_();
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    const Node_& node = nodes[i];
+    if (node.nbOperands == 0)
+      continue;
+    tangents[i] = 0;
+    for (size_t k = 0; k < node.nbOperands; ++k)
+      tangents[i] += d1[node.firstOperand + k] * tangents[operands_[node.firstOperand + k]];
+  }
+
+  //The adjoint of the root is constant.
+  adjointTangents.assign(nodes.size(), 0);
+  for (size_t i = nodes.size(); i > 0; --i)
+  {
+    const Node_& node = nodes[i - 1];
+    for (size_t k = 0; k < node.nbOperands; ++k)
+    {
+      double s = 0;
+      for (size_t l = 0; l < node.nbOperands; ++l)
+        s += d2[node.firstD2 + k * node.nbOperands + l] * tangents[operands_[node.firstOperand + l]];
+      adjointTangents[operands_[node.firstOperand + k]] += adjointTangents[i - 1] * d1[node.firstOperand + k] + adjoints[i - 1] * s;
+    }
+  }
+}
+
+/******************************************************************************/
+
+double ComputationTree::getValueAndGradient(const std::vector<std::string>& variables, std::vector<double>& gradient) const
+{
+  vector<double> values, d1, d2, adjoints;
+  forwardSweep_(values, d1, d2);
+  backwardSweep_(d1, adjoints);
+
+  const vector<Node_>& nodes = getNodes_();
+  gradient.assign(variables.size(), 0);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    if (nodes[i].nbOperands != 0 || adjoints[i] == 0)
+      continue;
+    for (size_t j = 0; j < variables.size(); ++j)
+      gradient[j] += adjoints[i] * nodes[i].op->getFirstOrderDerivative(variables[j]);
+  }
+  return values.back();
+}
+
+/******************************************************************************/
+
+void ComputationTree::getSecondOrderDerivatives(const std::vector<std::string>& variables, std::vector<double>& d2) const
+{
+  vector<double> values, pd1, pd2, adjoints, tangents, adjointTangents;
+  forwardSweep_(values, pd1, pd2);
+  backwardSweep_(pd1, adjoints);
+
+  const vector<Node_>& nodes = getNodes_();
+  d2.assign(variables.size(), 0);
+  tangents.assign(nodes.size(), 0);
+  for (size_t j = 0; j < variables.size(); ++j)
+  {
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+      if (nodes[i].nbOperands == 0)
+        tangents[i] = nodes[i].op->getFirstOrderDerivative(variables[j]);
+    }
+    tangentSweeps_(pd1, pd2, adjoints, tangents, adjointTangents);
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+      if (nodes[i].nbOperands != 0)
+        continue;
+      d2[j] += adjointTangents[i] * tangents[i];
+      if (adjoints[i] != 0)
+        d2[j] += adjoints[i] * nodes[i].op->getSecondOrderDerivative(variables[j]);
+    }
+  }
+}
+
+/******************************************************************************/
+
+void ComputationTree::getHessianVectorProduct(const std::vector<std::string>& variables, const std::vector<double>& direction, std::vector<double>& product) const
+{
+  if (direction.size() != variables.size())
+    throw Exception("ComputationTree::getHessianVectorProduct. The direction and the variables have different sizes.");
+
+  vector<double> values, d1, d2, adjoints, tangents, adjointTangents;
+  forwardSweep_(values, d1, d2);
+  backwardSweep_(d1, adjoints);
+
+  const vector<Node_>& nodes = getNodes_();
+  //First order derivatives of the leaves, for each variable.
+  vector<double> leafD1(nodes.size() * variables.size(), 0);
+  tangents.assign(nodes.size(), 0);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    if (nodes[i].nbOperands != 0)
+      continue;
+    for (size_t j = 0; j < variables.size(); ++j)
+    {
+      leafD1[i * variables.size() + j] = nodes[i].op->getFirstOrderDerivative(variables[j]);
+      tangents[i] += direction[j] * leafD1[i * variables.size() + j];
+    }
+  }
+  tangentSweeps_(d1, d2, adjoints, tangents, adjointTangents);
+
+  product.assign(variables.size(), 0);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    if (nodes[i].nbOperands != 0)
+      continue;
+    for (size_t j = 0; j < variables.size(); ++j)
+    {
+      product[j] += adjointTangents[i] * leafD1[i * variables.size() + j];
+      if (adjoints[i] == 0)
+        continue;
+      for (size_t u = 0; u < variables.size(); ++u)
+      {
+        if (direction[u] == 0)
+          continue;
+        double d2f = (u == j ? nodes[i].op->getSecondOrderDerivative(variables[j]) : nodes[i].op->getSecondOrderDerivative(variables[j], variables[u]));
+        product[j] += adjoints[i] * direction[u] * d2f;
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+
 bool ComputationTree::isAllSum()
 {
   std::unique_ptr<NodeIterator> it=allNodesIterator();
@@ -45,18 +45,46 @@
 #include "Operator.h"
 #include "../Functions.h"
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace bpp
 {
 /**
  * @brief Defines a Computation Tree based on Operators.
  *
+ * Besides the recursive computation of derivatives for one variable, derivatives
+ * for several variables can be computed in reverse mode: the value of each operator
+ * is computed in a forward sweep over the tree, and the derivative of the root with respect
+ * to each operator in a backward sweep. Derivatives of the leaves are then combined, so that
+ * the full gradient costs two sweeps instead of one recursion per variable.
+ * Second order derivatives are computed by differentiating these sweeps along a direction
+ * (forward-over-reverse mode), at the cost of two more sweeps per direction.
  */  
   
   class ComputationTree:
     public AssociationTreeGlobalGraphObserver<Operator,short>
   {
   private:
+    /**
+     * @brief An operator of the tree, with the positions of its operands.
+     */
+    struct Node_
+    {
+      const Operator* op;
+      size_t firstOperand; //Position of the first operand in operands_.
+      size_t nbOperands;
+      size_t firstD2; //Position of the second order partial derivatives in the sweeps buffers.
+    };
+
+    /**
+     * @brief Operators of the tree, each one after its operands, the root being the last one.
+     *
+     * It is built when first needed.
+     */
+    mutable std::vector<Node_> nodes_;
+    mutable std::vector<size_t> operands_;
+
     std::shared_ptr<Operator> readFormula_(const std::string& formula,const std::map<std::string, Function*>& functionNames);
     
   public:
@@ -68,6 +96,20 @@ namespace bpp
      */
     
     ComputationTree(const std::string& formula, const std::map<std::string, Function*>& functionNames);
+
+    ComputationTree(const ComputationTree& tree):
+      AssociationTreeGlobalGraphObserver<Operator,short>(tree),
+      nodes_(), operands_()
+    {
+    }
+
+    ComputationTree& operator=(const ComputationTree& tree)
+    {
+      AssociationTreeGlobalGraphObserver<Operator,short>::operator=(tree);
+      nodes_.clear();
+      operands_.clear();
+      return *this;
+    }
     
     ComputationTree* clone() const
     {
@@ -89,9 +131,44 @@ namespace bpp
       return getRoot()->getSecondOrderDerivative(variable);
     }
 
+    /**
+     * @brief Compute the value and the first order derivatives for several variables at once, in reverse mode.
+     *
+     * As the other reverse mode computations, this requires all the operators of the tree to be
+     * decomposable (see Operator::isDecomposable()), and throws an Exception otherwise.
+     *
+     * @param variables The names of the variables.
+     * @param gradient [out] The first order derivative for each variable.
+     * @return The value of the tree.
+     */
+    double getValueAndGradient(const std::vector<std::string>& variables, std::vector<double>& gradient) const;
+
+    /**
+     * @brief Compute the second order derivatives for several variables, in forward-over-reverse mode.
+     *
+     * Only second order derivatives of the leaves for each variable are needed.
+     *
+     * @param variables The names of the variables.
+     * @param d2 [out] The second order derivative for each variable.
+     */
+    void getSecondOrderDerivatives(const std::vector<std::string>& variables, std::vector<double>& d2) const;
+
+    /**
+     * @brief Compute the product of the hessian matrix with a vector, in forward-over-reverse mode.
+     *
+     * The leaves must provide cross second order derivatives for the variables with a non-null direction.
+     *
+     * @param variables The names of the variables.
+     * @param direction The coordinate of the vector for each variable.
+     * @param product [out] The product of the hessian matrix with the vector.
+     */
+    void getHessianVectorProduct(const std::vector<std::string>& variables, const std::vector<double>& direction, std::vector<double>& product) const;
+
     void readFormula(const std::string& formula,const std::map<std::string, Function*>& functionNames)
     {
       readFormula_(formula, functionNames);
+      nodes_.clear();
+      operands_.clear();
     }
     
     std::string output() const;
@@ -102,7 +179,35 @@ namespace bpp
      */
     
     bool isAllSum();
-    
+
+  private:
+    /**
+     * @return The operators of the tree, each one after its operands.
+     */
+    const std::vector<Node_>& getNodes_() const;
+
+    /**
+     * @brief Compute the value of all operators, and their partial derivatives with respect to their operands.
+     *
+     * @param values [out] The value of each operator.
+     * @param d1 [out] The first order partial derivatives, in the order of operands_.
+     * @param d2 [out] The second order partial derivatives, at the position given by each node.
+     */
+    void forwardSweep_(std::vector<double>& values, std::vector<double>& d1, std::vector<double>& d2) const;
+
+    /**
+     * @brief Compute the derivative of the root with respect to each operator.
+     */
+    void backwardSweep_(const std::vector<double>& d1, std::vector<double>& adjoints) const;
+
+    /**
+     * @brief Differentiate both sweeps along a direction.
+     *
+     * @param d1, d2, adjoints As computed by forwardSweep_ and backwardSweep_.
+     * @param tangents [in,out] The derivative of each leaf along the direction, set for all operators on return.
+     * @param adjointTangents [out] The derivative of each adjoint along the direction.
+     */
+    void tangentSweeps_(const std::vector<double>& d1, const std::vector<double>& d2, const std::vector<double>& adjoints, std::vector<double>& tangents, std::vector<double>& adjointTangents) const;
   };
     
 }
@@ -82,10 +82,29 @@ namespace bpp
       return 0;
     }
 
+    double getSecondOrderDerivative(const std::string& variable1, const std::string& variable2) const
+    {
+      return 0;
+    }
+
     std::string output() const
     {
       return TextTools::toString(value_);
     }
+
+    bool isDecomposable() const { return true; }
+
+    std::vector<std::shared_ptr<Operator> > getOperands() const
+    {
+      return {};
+    }
+
+    double getValue(const double* operands) const
+    {
+      return value_;
+    }
+
+    void getPartialDerivatives(const double* operands, double* d1, double* d2) const {}
         
   };
   
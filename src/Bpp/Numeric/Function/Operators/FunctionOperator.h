@@ -91,6 +91,18 @@ namespace bpp
       return 0;
     }
 
+    double getSecondOrderDerivative_(const std::string& variable1, const std::string& variable2, std::true_type) const
+    {
+      if (variable1 == variable2)
+        return func_.getSecondOrderDerivative(variable1);
+      return func_.getSecondOrderDerivative(variable1, variable2);
+    }
+
+    double getSecondOrderDerivative_(const std::string& variable1, const std::string& variable2, std::false_type) const
+    {
+      return 0;
+    }
+
 
   public:
 
@@ -119,10 +131,29 @@ namespace bpp
       return getSecondOrderDerivative_(variable, std::integral_constant<bool, std::is_base_of<DerivableSecondOrder, F>::value>{});
     }
 
+    double getSecondOrderDerivative(const std::string& variable1, const std::string& variable2) const
+    {
+      return getSecondOrderDerivative_(variable1, variable2, std::integral_constant<bool, std::is_base_of<DerivableSecondOrder, F>::value>{});
+    }
+
     std::string output() const
     {
       return name_;
     }
+
+    bool isDecomposable() const { return true; }
+
+    std::vector<std::shared_ptr<Operator> > getOperands() const
+    {
+      return {};
+    }
+
+    double getValue(const double* operands) const
+    {
+      return getValue();
+    }
+
+    void getPartialDerivatives(const double* operands, double* d1, double* d2) const {}
     
   };
 
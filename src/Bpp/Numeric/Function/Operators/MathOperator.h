@@ -78,6 +78,14 @@ namespace bpp
     {
       return new MathOperator(*this);
     }
+
+    /**
+     * @return The name of the function.
+     */
+    const std::string& getName() const
+    {
+      return name_;
+    }
     
 
     double getValue() const
@@ -127,6 +135,40 @@ namespace bpp
     {
       return name_ + "(" + son_->output() + ")";
     }
+
+    bool isDecomposable() const { return true; }
+
+    std::vector<std::shared_ptr<Operator> > getOperands() const
+    {
+      return {son_};
+    }
+
+    double getValue(const double* operands) const
+    {
+      if (func_)
+        return (*func_)(operands[0]);
+      else
+        return operands[0];
+    }
+
+    void getPartialDerivatives(const double* operands, double* d1, double* d2) const
+    {
+      double v = operands[0];
+      if (!func_)
+      {
+        d1[0] = 1;
+        d2[0] = 0;
+      }
+      else if (name_=="exp")
+        d1[0] = d2[0] = exp(v);
+      else if (name_=="log")
+      {
+        d1[0] = 1 / v;
+        d2[0] = - 1 / (v * v);
+      }
+      else
+        throw Exception("MathOperator::getPartialDerivatives : unknown function " + name_);
+    }
     
     
   };
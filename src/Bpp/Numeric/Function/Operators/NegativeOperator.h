@@ -87,6 +87,24 @@ namespace bpp
     {
       return "-" + son_->output();
     }
+
+    bool isDecomposable() const { return true; }
+
+    std::vector<std::shared_ptr<Operator> > getOperands() const
+    {
+      return {son_};
+    }
+
+    double getValue(const double* operands) const
+    {
+      return - operands[0];
+    }
+
+    void getPartialDerivatives(const double* operands, double* d1, double* d2) const
+    {
+      d1[0] = -1;
+      d2[0] = 0;
+    }
     
 
   };
@@ -41,6 +41,11 @@ knowledge of the CeCILL license and that you accept its terms.
 #define _OPERATOR_H_
 
 #include "../../../Clonable.h"
+#include "../../../Exceptions.h"
+
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace bpp
 {
@@ -48,6 +53,10 @@ namespace bpp
 /**
  * @brief Interface of operator for numerical computation.
  *
+ * Besides the recursive computation of values and derivatives, an
+ * operator gives access to its operands and to its partial derivatives
+ * with respect to them, so that a tree of operators can be differentiated
+ * in reverse mode (see ComputationTree::getValueAndGradient).
  */
 
   class Operator :
@@ -62,8 +71,61 @@ namespace bpp
 
     virtual double getSecondOrderDerivative(const std::string& variable) const = 0;
 
+    /**
+     * @brief Cross second order derivative.
+     *
+     * Only required for leaves of a computation tree, see ComputationTree::getHessianVectorProduct.
+     */
+    virtual double getSecondOrderDerivative(const std::string& variable1, const std::string& variable2) const
+    {
+      throw Exception("Operator::getSecondOrderDerivative. Cross derivatives are not available for " + output() + ".");
+    }
+
     virtual std::string output() const = 0;
 
+    /**
+     * @brief Tell if the operator implements getOperands(), getValue(const double*) and getPartialDerivatives().
+     *
+     * Only such operators can be part of a tree differentiated in reverse mode
+     * (see ComputationTree::getValueAndGradient), or compiled into a ComputationTape.
+     */
+    virtual bool isDecomposable() const { return false; }
+
+    /**
+     * @return The operands of this operator, none for a leaf.
+     */
+    virtual std::vector<std::shared_ptr<Operator> > getOperands() const
+    {
+      return {};
+    }
+
+    /**
+     * @brief Compute the value of the operator from the value of its operands.
+     *
+     * The value must only depend on the operands, which allows ComputationTape to
+     * replace operators with constant operands by their value and to compute
+     * identical subexpressions once.
+     *
+     * @param operands The value of each operand, in the order of getOperands().
+     */
+    virtual double getValue(const double* operands) const
+    {
+      throw Exception("Operator::getValue. Computation from the operands is not supported by " + output() + ".");
+    }
+
+    /**
+     * @brief Compute the partial derivatives of the operator with respect to its operands.
+     *
+     * @param operands The value of each operand, in the order of getOperands().
+     * @param d1 [out] The first order partial derivative with respect to each operand.
+     * @param d2 [out] The second order partial derivatives, d2[i * n + j] being
+     * the one with respect to operands i and j, with n operands.
+     */
+    virtual void getPartialDerivatives(const double* operands, double* d1, double* d2) const
+    {
+      throw Exception("Operator::getPartialDerivatives. Partial derivatives are not supported by " + output() + ".");
+    }
+
   };
   
 
@@ -168,18 +168,45 @@ void ReparametrizationFunctionWrapper::init_(bool verbose)
       }
     }
   }
+  transforms_.reset(new TransformedParameterArray(getParameters()));
+  functionSchema_.reset(new ParameterSchema(functionParameters_));
+  transformedValues_.resize(getNumberOfParameters());
 }
 
+/******************************************************************************/
+
+double ReparametrizationFunctionWrapper::evaluate(const ParameterSnapshot& snapshot) const
+{
+  vector<double> transformed(getNumberOfParameters());
+  for (size_t i = 0; i < transformed.size(); ++i)
+    transformed[i] = getParameters()[i].getValue();
+  for (size_t k = 0; k < snapshot.size(); ++k)
+  {
+    const string& name = snapshot.getName(k);
+    if (getParameters().hasParameter(name))
+      transformed[getParameters().whichParameterHasName(name)] = snapshot.getValue(k);
+  }
+  vector<double> values;
+  transforms_->getOriginalValues(transformed, values);
+  return function_->evaluate(ParameterSnapshot(functionSchema_, values));
+}
+
+/******************************************************************************/
+
 void ReparametrizationFunctionWrapper::fireParameterChanged(const ParameterList& parameters)
 {
   // Recompute function parameters:
   // We could update only the parameter that actually changed,
   // but that would implied a quick sort on parameter names (nlog(n))
   // whereas using a loop over the set is in o(n). It should hence be
-  // more efficient in most cases.
+  // more efficient in most cases. All values are transformed at once,
+  // with one pass per type of transformation.
+  for (size_t i = 0; i < getNumberOfParameters(); ++i)
+    transformedValues_[i] = getParameter_(i).getValue();
+  transforms_->getOriginalValues(transformedValues_, originalValues_);
   for (size_t i = 0; i < getNumberOfParameters(); ++i)
   {
-    double x = dynamic_cast<TransformedParameter&>(getParameter_(i)).getOriginalValue();
+    double x = originalValues_[i];
     try
     {
       functionParameters_[i].setValue(x);
@@ -43,6 +43,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "Functions.h"
 #include "../AbstractParametrizable.h"
 #include "../TransformedParameter.h"
+#include "../TransformedParameterArray.h"
 
 namespace bpp {
 
@@ -58,7 +59,11 @@ class ReparametrizationFunctionWrapper:
 {
    private:
     Function* function_;
+    std::shared_ptr<Function> ownedFunction_; //Set in copies made with independentClone(), shared by their copies.
     ParameterList functionParameters_;
+    std::shared_ptr<const TransformedParameterArray> transforms_; //Transformations of all parameters, shared by copies.
+    std::shared_ptr<const ParameterSchema> functionSchema_;
+    std::vector<double> transformedValues_, originalValues_;
     
   public:
     /**
@@ -70,7 +75,12 @@ class ReparametrizationFunctionWrapper:
     ReparametrizationFunctionWrapper(Function* function, bool verbose=true) :
       AbstractParametrizable(function->getNamespace()),
       function_(function),
-      functionParameters_(function->getParameters())
+      ownedFunction_(),
+      functionParameters_(function->getParameters()),
+      transforms_(),
+      functionSchema_(),
+      transformedValues_(),
+      originalValues_()
     {
       init_(verbose);
     }
@@ -87,7 +97,12 @@ class ReparametrizationFunctionWrapper:
     ReparametrizationFunctionWrapper(Function* function, const ParameterList& parameters, bool verbose=true) :
       AbstractParametrizable(function->getNamespace()),
       function_(function),
-      functionParameters_(function->getParameters().getCommonParametersWith(parameters))
+      ownedFunction_(),
+      functionParameters_(function->getParameters().getCommonParametersWith(parameters)),
+      transforms_(),
+      functionSchema_(),
+      transformedValues_(),
+      originalValues_()
     {
       init_(verbose);
     }
@@ -95,13 +110,23 @@ class ReparametrizationFunctionWrapper:
     ReparametrizationFunctionWrapper(const ReparametrizationFunctionWrapper& rfw) :
       AbstractParametrizable(rfw),
       function_(rfw.function_),
-      functionParameters_(rfw.functionParameters_) {}
+      ownedFunction_(rfw.ownedFunction_),
+      functionParameters_(rfw.functionParameters_),
+      transforms_(rfw.transforms_),
+      functionSchema_(rfw.functionSchema_),
+      transformedValues_(rfw.transformedValues_),
+      originalValues_(rfw.originalValues_) {}
     
     ReparametrizationFunctionWrapper& operator=(const ReparametrizationFunctionWrapper& rfw)
     {
       AbstractParametrizable::operator=(rfw),
       function_ = rfw.function_;
+      ownedFunction_ = rfw.ownedFunction_;
       functionParameters_ = rfw.functionParameters_;
+      transforms_ = rfw.transforms_;
+      functionSchema_ = rfw.functionSchema_;
+      transformedValues_ = rfw.transformedValues_;
+      originalValues_ = rfw.originalValues_;
       return *this;
     }
 
@@ -131,6 +156,24 @@ class ReparametrizationFunctionWrapper:
       return function_->getValue();
     }
 
+    /**
+     * @brief Evaluate the wrapped function at a point given in transformed coordinates.
+     *
+     * Parameters of the wrapped function which are not in the snapshot keep their current value.
+     */
+    double evaluate(const ParameterSnapshot& snapshot) const;
+
+    /**
+     * @return A copy of the wrapper, wrapping an independent copy of the wrapped function that it owns.
+     */
+    Function* independentClone() const
+    {
+      std::unique_ptr<ReparametrizationFunctionWrapper> rfw(dynamic_cast<ReparametrizationFunctionWrapper*>(clone()));
+      rfw->ownedFunction_.reset(function_->independentClone());
+      rfw->function_ = rfw->ownedFunction_.get();
+      return rfw.release();
+    }
+
     void fireParameterChanged (const ParameterList &parameters);
 
 };
@@ -103,7 +103,7 @@ double SimpleMultiDimensions::doStep()
     // Optimize through this dimension:
     f = optimizer_.optimize();
     if (getVerbose() > 0) cout << endl;
-    getParameters_().matchParametersValues(getFunction()->getParameters());
+    matchFunctionParametersValues_();
     nbEval_ += optimizer_.getNumberOfEvaluations(); 
   }
   tolIsReached_ = nbParams_ <= 1;
@@ -46,10 +46,11 @@ void ThreePointsNumericalDerivative::updateDerivatives(const ParameterList param
 {
   if (computeD1_ && variables_.size() > 0)
   {
+    // In parallel, trial points are evaluated on clones, so that analytical derivatives can be computed at once:
     if (function1_)
-      function1_->enableFirstOrderDerivatives(false);
+      function1_->enableFirstOrderDerivatives(isParallel_());
     if (function2_)
-      function2_->enableSecondOrderDerivatives(false);
+      function2_->enableSecondOrderDerivatives(isParallel_() && computeD2_);
     function_->setParameters(parameters);
     f2_ = function_->getValue();
     if ((abs(f2_) >= NumConstants::VERY_BIG()) || std::isnan(f2_))
@@ -62,117 +63,188 @@ void ThreePointsNumericalDerivative::updateDerivatives(const ParameterList param
       return;
     }
 
-    string lastVar;
-    bool functionChanged = false;
-    ParameterList p;
-    bool start = true;
-    for (size_t i = 0; i < variables_.size(); ++i)
+    const vector<size_t>& positions = getVariablePositions_(parameters);
+    size_t n = variables_.size();
+    vector<bool> done(n, false), crossDone(n * n, false);
+    size_t last = n;
+    if (dynamic_cast<BatchFunction*>(function_))
     {
-      string var = variables_[i];
-      if (!parameters.hasParameter(var))
-        continue;
-      if (!start)
-      {
-        vector<string> vars(2);
-        vars[0] = var;
-        vars[1] = lastVar;
-        p = parameters.createSubList(vars);
-      }
-      else
+      // Evaluate at once the trial points of all variables which are not close to their bounds,
+      // and then the ones of all pairs of variables if cross derivatives are needed:
+      vector<ParameterList> points;
+      vector<size_t> index1, index2;
+      vector<double> steps(n);
+      for (size_t i = 0; i < n; ++i)
       {
-        p = parameters.createSubList(var);
-        start = false;
-      }
-      lastVar = var;
-      functionChanged = true;
-      double value = function_->getParameterValue(var);
-      double h = -(1. + std::abs(value)) * h_;
-      if (abs(h) < p[0].getPrecision())
-        h = h < 0 ? -p[0].getPrecision() : p[0].getPrecision();
-      double hf1(0), hf3(0);
-      unsigned int nbtry = 0;
-
-      // Compute f1_
-      while (hf1 == 0)
-      {
-        try
-        {
-          p[0].setValue(value + h);
-          function_->setParameters(p); // also reset previous parameter...
-
-          p = p.createSubList(0);
-          f1_ = function_->getValue();
-          if ((abs(f1_) >= NumConstants::VERY_BIG()) || std::isnan(f1_))
-            throw ConstraintException("f1_ too large", &p[0], f1_);
-          else
-            hf1 = h;
-        }
-        catch (ConstraintException& ce)
+        if (positions[i] == parameters.size())
+          continue;
+        const Parameter& parameter = parameters[positions[i]];
+        double value = parameter.getValue();
+        double h = -(1. + std::abs(value)) * h_;
+        if (abs(h) < parameter.getPrecision())
+          h = -parameter.getPrecision();
+        steps[i] = h;
+        if (isCorrect_(parameter, value + h) && isCorrect_(parameter, value - h))
         {
-          if (++nbtry == 10) // no possibility to compute derivatives
-            break;
-          else if (h < 0)
-            h = -h;  // try on the right
-          else
-            h /= -2;  // try again on the left with smaller interval
+          points.push_back(getTrialPoint_(parameter, value + h));
+          points.push_back(getTrialPoint_(parameter, value - h));
+          index1.push_back(i);
         }
       }
-
-      if (hf1 != 0)
+      size_t nbVariables = index1.size();
+      for (size_t i = 0; computeCrossD2_ && i < n; ++i)
       {
-        // Compute f3_
-        if (h < 0)
-          h = -h;  // on the right
-        else
-          h /= 2;  //  on the left with smaller interval
-
-        nbtry = 0;
-        while (hf3 == 0)
+        if (positions[i] == parameters.size())
+          continue;
+        for (size_t j = 0; j < n; ++j)
         {
-          try
-          {
-            p[0].setValue(value + h);
-            function_->setParameters(p); // also reset previous parameter...
-
-            p = p.createSubList(0);
-            f3_ = function_->getValue();
-            if ((abs(f3_) >= NumConstants::VERY_BIG()) || std::isnan(f3_))
-              throw ConstraintException("f3_ too large", &p[0], f3_);
-            else
-              hf3 = h;
-          }
-          catch (ConstraintException& ce)
+          if (j == i || positions[j] == parameters.size())
+            continue;
+          const Parameter& parameter1 = parameters[positions[i]];
+          const Parameter& parameter2 = parameters[positions[j]];
+          double value1 = parameter1.getValue();
+          double value2 = parameter2.getValue();
+          double h1 = (1. + std::abs(value1)) * h_;
+          double h2 = (1. + std::abs(value2)) * h_;
+          if (isCorrect_(parameter1, value1 - h1) && isCorrect_(parameter1, value1 + h1)
+              && isCorrect_(parameter2, value2 - h2) && isCorrect_(parameter2, value2 + h2))
           {
-            if (++nbtry == 10) // no possibility to compute derivatives
-              break;
-            else if (h < 0)
-              h = -h;  // try on the right
-            else
-              h /= -2;  // try again on the left with smaller interval
+            points.push_back(getTrialPoint_(parameter1, value1 - h1, parameter2, value2 - h2));
+            points.push_back(getTrialPoint_(parameter1, value1 - h1, parameter2, value2 + h2));
+            points.push_back(getTrialPoint_(parameter1, value1 + h1, parameter2, value2 + h2));
+            points.push_back(getTrialPoint_(parameter1, value1 + h1, parameter2, value2 - h2));
+            index1.push_back(i);
+            index2.push_back(j);
           }
         }
       }
-
-      if (hf3 == 0)
+      Vdouble values;
+      FunctionTools::evaluate(*function_, points, values);
+      bool complete = true;
+      for (size_t k = 0; k < nbVariables; ++k)
       {
-        der1_[i] = log(-1);
-        der2_[i] = log(-1);
+        size_t i = index1[k];
+        double f1 = values[2 * k], f3 = values[2 * k + 1];
+        double hf1 = steps[i], hf3 = -steps[i];
+        if ((abs(f1) >= NumConstants::VERY_BIG()) || std::isnan(f1)
+            || (abs(f3) >= NumConstants::VERY_BIG()) || std::isnan(f3))
+        {
+          // The trial points will be searched for one at a time:
+          complete = false;
+          continue;
+        }
+        der1_[i] = (f1 - f3) / (hf1 - hf3);
+        der2_[i] = ((f1 - f2_) / hf1 - (f3 - f2_) / hf3) * 2 / (hf1 - hf3);
+        done[i] = true;
       }
-      else
+      for (size_t k = 0; k < index2.size(); ++k)
+      {
+        size_t i = index1[nbVariables + k];
+        size_t j = index2[k];
+        const double* f = &values[2 * nbVariables + 4 * k];
+        double h1 = (1. + std::abs(parameters[positions[i]].getValue())) * h_;
+        double h2 = (1. + std::abs(parameters[positions[j]].getValue())) * h_;
+        crossDer2_(i, j) = ((f[2] - f[3]) - (f[1] - f[0])) / (4 * h1 * h2);
+        crossDone[i * n + j] = true;
+      }
+      for (size_t i = 0; i < n; ++i)
+      {
+        if (positions[i] == parameters.size())
+          continue;
+        complete &= done[i];
+        for (size_t j = 0; computeCrossD2_ && j < n; ++j)
+          complete &= j == i || positions[j] == parameters.size() || crossDone[i * n + j];
+      }
+      if (points.size() > 0)
       {
-        der1_[i] = (f1_ - f3_) / (hf1 - hf3);
-        der2_[i] = ((f1_ - f2_) / hf1 - (f3_ - f2_) / hf3) * 2 / (hf1 - hf3);
+        if (!complete)
+        {
+          // Reset the variables of the last trial point before evaluating other ones:
+          ParameterList p;
+          for (size_t k = 0; k < points.back().size(); ++k)
+            p.addParameter(parameters[parameters.whichParameterHasName(points.back()[k].getName())]);
+          function_->setParameters(p);
+        }
+        else if (index2.size() == 0)
+          last = index1.back(); // Reset with the final evaluation.
+        // Otherwise all variables are reset with the final evaluation.
       }
     }
+    else if (isParallel_())
+    {
+      // One task per variable, then one per pair of variables if cross derivatives are needed:
+      vector<size_t> tasks1, tasks2;
+      for (size_t i = 0; i < variables_.size(); ++i)
+        if (positions[i] < parameters.size())
+          tasks1.push_back(i);
+      size_t nbVariables = tasks1.size();
+      if (computeCrossD2_)
+        for (size_t i = 0; i < nbVariables; ++i)
+          for (size_t j = 0; j < nbVariables; ++j)
+            if (j != i)
+            {
+              tasks1.push_back(tasks1[i]);
+              tasks2.push_back(tasks1[j]);
+            }
 
+      parallelFor_(tasks1.size(), [&](size_t t, Function& function, vector<size_t>& modified) {
+        size_t i = tasks1[t];
+        ParameterList p1;
+        p1.addParameter(parameters[positions[i]]);
+        if (t < nbVariables)
+        {
+          ParameterList reset = getResetParameters_(parameters, modified, i, i);
+          const ParameterList* previous = reset.size() > 0 ? &reset : 0;
+          computeDerivatives_(function, i, p1, previous);
+          if (previous)
+            function.setParameters(*previous);
+          modified.assign(1, i);
+        }
+        else
+        {
+          size_t j = tasks2[t - nbVariables];
+          ParameterList p2;
+          p2.addParameter(parameters[positions[j]]);
+          ParameterList reset = getResetParameters_(parameters, modified, i, j);
+          const ParameterList* previous = reset.size() > 0 ? &reset : 0;
+          computeCrossDerivative_(function, i, j, p1, p2, previous);
+          modified.assign(1, i);
+          modified.push_back(j);
+        }
+      });
+      if (computeCrossD2_)
+        for (size_t i = 0; i < nbVariables; ++i)
+          crossDer2_(tasks1[i], tasks1[i]) = der2_[tasks1[i]];
+      return;
+    }
+
+    for (size_t i = 0; i < variables_.size(); ++i)
+    {
+      size_t pos = positions[i];
+      if (pos == parameters.size() || done[i])
+        continue;
+      ParameterList& p = getTrialParameters_(i, parameters[pos]);
+      // Also reset previous parameter with the first trial point:
+      ParameterList reset;
+      if (last < variables_.size())
+        reset.shareParameters(getTrialParameters_(last, parameters[positions[last]]));
+      const ParameterList* previous = reset.size() > 0 ? &reset : 0;
+      computeDerivatives_(*function_, i, p, previous);
+      if (previous)
+        function_->setParameters(*previous);
+      last = i;
+    }
 
     if (computeCrossD2_)
     {
-      string lastVar1, lastVar2;
+      //Variables which may still have a trial value in the function:
+      vector<size_t> modified;
+      if (last < variables_.size())
+        modified.push_back(last);
       for (unsigned int i = 0; i < variables_.size(); i++)
       {
-        string var1 = variables_[i];
-        if (!parameters.hasParameter(var1))
+        size_t pos1 = positions[i];
+        if (pos1 == parameters.size())
           continue;
         for (unsigned int j = 0; j < variables_.size(); j++)
         {
@@ -181,60 +253,21 @@ void ThreePointsNumericalDerivative::updateDerivatives(const ParameterList param
             crossDer2_(i, j) = der2_[i];
             continue;
           }
-          string var2 = variables_[j];
-          if (!parameters.hasParameter(var2))
+          size_t pos2 = positions[j];
+          if (pos2 == parameters.size() || crossDone[i * variables_.size() + j])
             continue;
 
-          vector<string> vars(2);
-          vars[0] = var1;
-          vars[1] = var2;
-          if (i > 0 && j > 0)
-          {
-            if (lastVar1 != var1 && lastVar1 != var2)
-              vars.push_back(lastVar1);
-            if (lastVar2 != var1 && lastVar2 != var2)
-              vars.push_back(lastVar2);
-          }
-          p = parameters.createSubList(vars);
-
-          double value1 = function_->getParameterValue(var1);
-          double value2 = function_->getParameterValue(var2);
-          double h1 = (1. + std::abs(value1)) * h_;
-          double h2 = (1. + std::abs(value2)) * h_;
-
-          // Compute 4 additional points:
-          try
-          {
-            p[0].setValue(value1 - h1);
-            p[1].setValue(value2 - h2);
-            function_->setParameters(p); // also reset previous parameter...
-            vector<size_t> tmp(2);
-            tmp[0] = 0;
-            tmp[1] = 1;
-            p = p.createSubList(tmp); // removed the previous parameters.
-            f11_ = function_->getValue();
-
-            p[1].setValue(value2 + h2);
-            function_->setParameters(p.createSubList(1));
-            f12_ = function_->getValue();
-
-            p[0].setValue(value1 + h1);
-            function_->setParameters(p.createSubList(0));
-            f22_ = function_->getValue();
-
-            p[1].setValue(value2 - h2);
-            function_->setParameters(p.createSubList(1));
-            f21_ = function_->getValue();
-
-            crossDer2_(i, j) = ((f22_ - f21_) - (f12_ - f11_)) / (4 * h1 * h2);
-          }
-          catch (ConstraintException& ce)
-          {
-            throw Exception("ThreePointsNumericalDerivative::setParameters. Could not compute cross derivatives at limit.");
-          }
-
-          lastVar1 = var1;
-          lastVar2 = var2;
+          ParameterList& p1 = getTrialParameters_(i, parameters[pos1]);
+          ParameterList& p2 = getTrialParameters_(j, parameters[pos2]);
+          // Also reset previous parameters:
+          ParameterList reset;
+          for (size_t k = 0; k < modified.size(); k++)
+            if (modified[k] != i && modified[k] != j)
+              reset.shareParameters(getTrialParameters_(modified[k], parameters[positions[modified[k]]]));
+          const ParameterList* previous = reset.size() > 0 ? &reset : 0;
+          computeCrossDerivative_(*function_, i, j, p1, p2, previous);
+          modified.assign(1, i);
+          modified.push_back(j);
         }
       }
     }
@@ -244,8 +277,17 @@ void ThreePointsNumericalDerivative::updateDerivatives(const ParameterList param
       function1_->enableFirstOrderDerivatives(computeD1_);
     if (function2_)
       function2_->enableSecondOrderDerivatives(computeD2_);
-    if (functionChanged)
-      function_->setParameters(parameters.createSubList(lastVar));
+    if (computeCrossD2_)
+    {
+      //Reset all variables which may have been modified:
+      ParameterList p;
+      for (size_t i = 0; i < variables_.size(); i++)
+        if (positions[i] < parameters.size())
+          p.shareParameters(getTrialParameters_(i, parameters[positions[i]]));
+      function_->setParameters(p);
+    }
+    else if (last < variables_.size())
+      function_->setParameters(getTrialParameters_(last, parameters[positions[last]]));
   }
   else
   {
@@ -260,3 +302,125 @@ void ThreePointsNumericalDerivative::updateDerivatives(const ParameterList param
   }
 }
 
+/******************************************************************************/
+
+void ThreePointsNumericalDerivative::computeDerivatives_(Function& function, size_t i, ParameterList& p, const ParameterList*& previous)
+{
+  double value = p[0].getValue();
+  double h = -(1. + std::abs(value)) * h_;
+  if (abs(h) < p[0].getPrecision())
+    h = h < 0 ? -p[0].getPrecision() : p[0].getPrecision();
+  double f1(0), f3(0), hf1(0), hf3(0);
+  unsigned int nbtry = 0;
+
+  // Compute f1
+  while (hf1 == 0)
+  {
+    try
+    {
+      p[0].setValue(value + h);
+      setTrialParameters_(function, p, previous);
+      f1 = function.getValue();
+      if ((abs(f1) >= NumConstants::VERY_BIG()) || std::isnan(f1))
+        throw ConstraintException("f1 too large", &p[0], f1);
+      else
+        hf1 = h;
+    }
+    catch (ConstraintException& ce)
+    {
+      if (++nbtry == 10) // no possibility to compute derivatives
+        break;
+      else if (h < 0)
+        h = -h;  // try on the right
+      else
+        h /= -2;  // try again on the left with smaller interval
+    }
+  }
+
+  if (hf1 != 0)
+  {
+    // Compute f3
+    if (h < 0)
+      h = -h;  // on the right
+    else
+      h /= 2;  //  on the left with smaller interval
+
+    nbtry = 0;
+    while (hf3 == 0)
+    {
+      try
+      {
+        p[0].setValue(value + h);
+        function.setParameters(p);
+        f3 = function.getValue();
+        if ((abs(f3) >= NumConstants::VERY_BIG()) || std::isnan(f3))
+          throw ConstraintException("f3 too large", &p[0], f3);
+        else
+          hf3 = h;
+      }
+      catch (ConstraintException& ce)
+      {
+        if (++nbtry == 10) // no possibility to compute derivatives
+          break;
+        else if (h < 0)
+          h = -h;  // try on the right
+        else
+          h /= -2;  // try again on the left with smaller interval
+      }
+    }
+  }
+
+  if (hf3 == 0)
+  {
+    der1_[i] = log(-1);
+    der2_[i] = log(-1);
+  }
+  else
+  {
+    der1_[i] = (f1 - f3) / (hf1 - hf3);
+    der2_[i] = ((f1 - f2_) / hf1 - (f3 - f2_) / hf3) * 2 / (hf1 - hf3);
+  }
+}
+
+/******************************************************************************/
+
+void ThreePointsNumericalDerivative::computeCrossDerivative_(Function& function, size_t i, size_t j, ParameterList& p1, ParameterList& p2, const ParameterList*& previous)
+{
+  double value1 = p1[0].getValue();
+  double value2 = p2[0].getValue();
+  double h1 = (1. + std::abs(value1)) * h_;
+  double h2 = (1. + std::abs(value2)) * h_;
+
+  // Compute 4 additional points:
+  try
+  {
+    p1[0].setValue(value1 - h1);
+    p2[0].setValue(value2 - h2);
+    ParameterList p;
+    p.shareParameters(p1);
+    p.shareParameters(p2);
+    setTrialParameters_(function, p, previous);
+    double f11 = function.getValue();
+
+    p2[0].setValue(value2 + h2);
+    function.setParameters(p2);
+    double f12 = function.getValue();
+
+    p1[0].setValue(value1 + h1);
+    function.setParameters(p1);
+    double f22 = function.getValue();
+
+    p2[0].setValue(value2 - h2);
+    function.setParameters(p2);
+    double f21 = function.getValue();
+
+    crossDer2_(i, j) = ((f22 - f21) - (f12 - f11)) / (4 * h1 * h2);
+  }
+  catch (ConstraintException& ce)
+  {
+    throw Exception("ThreePointsNumericalDerivative::setParameters. Could not compute cross derivatives at limit.");
+  }
+}
+
+/******************************************************************************/
+
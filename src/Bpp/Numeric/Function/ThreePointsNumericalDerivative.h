@@ -85,36 +85,18 @@ class ThreePointsNumericalDerivative :
   public AbstractNumericalDerivative
 {
 private:
-  double f1_, f2_, f3_, f11_, f22_, f12_, f21_;
+  double f2_;
 
 public:
   ThreePointsNumericalDerivative (Function* function) :
     AbstractNumericalDerivative(function),
-    f1_(),
-    f2_(),
-    f3_(),
-    f11_(),
-    f22_(),
-    f12_(),
-    f21_() {}
+    f2_() {}
   ThreePointsNumericalDerivative (DerivableFirstOrder* function) :
     AbstractNumericalDerivative(function),
-    f1_(),
-    f2_(),
-    f3_(),
-    f11_(),
-    f22_(),
-    f12_(),
-    f21_() {}
+    f2_() {}
   ThreePointsNumericalDerivative (DerivableSecondOrder* function) :
     AbstractNumericalDerivative(function),
-    f1_(),
-    f2_(),
-    f3_(),
-    f11_(),
-    f22_(),
-    f12_(),
-    f21_() {}
+    f2_() {}
   virtual ~ThreePointsNumericalDerivative() {}
 
   ThreePointsNumericalDerivative* clone() const { return new ThreePointsNumericalDerivative(*this); }
@@ -127,6 +109,27 @@ public:
 
 protected:
   void updateDerivatives(const ParameterList parameters);
+
+private:
+  /**
+   * @brief Compute the first and second order derivatives for one variable.
+   *
+   * @param function The function to evaluate.
+   * @param i The index of the variable.
+   * @param p A list with a copy of the variable, used to set trial values.
+   * @param previous Parameters to reset together with the first trial point, or 0 (see setTrialParameters_).
+   */
+  void computeDerivatives_(Function& function, size_t i, ParameterList& p, const ParameterList*& previous);
+
+  /**
+   * @brief Compute the cross second order derivative for two variables.
+   *
+   * @param function The function to evaluate.
+   * @param i, j The indices of the variables.
+   * @param p1, p2 Lists with a copy of each variable, used to set trial values.
+   * @param previous Parameters to reset together with the first trial point, or 0 (see setTrialParameters_).
+   */
+  void computeCrossDerivative_(Function& function, size_t i, size_t j, ParameterList& p1, ParameterList& p2, const ParameterList*& previous);
 };
 } // end of namespace bpp.
 
@@ -46,70 +46,86 @@ void TwoPointsNumericalDerivative::updateDerivatives(const ParameterList paramet
 {
   if (computeD1_ && variables_.size() > 0)
   {
+    // In parallel, trial points are evaluated on clones, so that analytical derivatives can be computed at once:
     if (function1_)
-      function1_->enableFirstOrderDerivatives(false);
+      function1_->enableFirstOrderDerivatives(isParallel_());
     if (function2_)
       function2_->enableSecondOrderDerivatives(false);
     function_->setParameters(parameters);
     f1_ = function_->getValue();
-    string lastVar;
-    bool functionChanged = false;
-    bool start = true;
-    for (unsigned int i = 0; i < variables_.size(); i++)
+    const vector<size_t>& positions = getVariablePositions_(parameters);
+    vector<bool> done(variables_.size(), false);
+    size_t last = variables_.size();
+    if (dynamic_cast<BatchFunction*>(function_))
     {
-      string var = variables_[i];
-      if (!parameters.hasParameter(var))
-        continue;
-      ParameterList p;
-      if (!start)
-      {
-        vector<string> vars(2);
-        vars[0] = var;
-        vars[1] = lastVar;
-        lastVar = var;
-        functionChanged = true;
-        p = parameters.createSubList(vars);
-      }
-      else
-      {
-        p = parameters.createSubList(var);
-        lastVar = var;
-        functionChanged = true;
-        start = false;
-      }
-      double value = function_->getParameterValue(var);
-      double h = (1 + std::abs(value)) * h_;
-      // Compute one other point:
-      try
-      {
-        p[0].setValue(value + h);
-        function_->setParameters(p);
-        f2_ = function_->getValue();
-      }
-      catch (ConstraintException& ce1)
+      // Evaluate all trial points within the constraints at once:
+      vector<ParameterList> points;
+      vector<size_t> index;
+      for (size_t i = 0; i < variables_.size(); ++i)
       {
-        // Right limit raised, use backward approximation:
-        try
+        if (positions[i] == parameters.size())
+          continue;
+        const Parameter& parameter = parameters[positions[i]];
+        double value = parameter.getValue();
+        double h = (1 + std::abs(value)) * h_;
+        if (isCorrect_(parameter, value + h))
         {
-          p[0].setValue(value - h);
-          function_->setParameters(p);
-          f2_ = function_->getValue();
-          der1_[i] = (f1_ - f2_) / h;
-        }
-        catch (ConstraintException& ce2)
-        {
-          // PB: can't compute derivative, because of a two narrow interval (lower than h)
-          throw ce2;
+          points.push_back(getTrialPoint_(parameter, value + h));
+          index.push_back(i);
         }
       }
-      // No limit raised, use forward approximation:
-      der1_[i] = (f2_ - f1_) / h;
+      Vdouble values;
+      FunctionTools::evaluate(*function_, points, values);
+      for (size_t k = 0; k < index.size(); ++k)
+      {
+        size_t i = index[k];
+        double h = (1 + std::abs(parameters[positions[i]].getValue())) * h_;
+        der1_[i] = (values[k] - f1_) / h;
+        done[i] = true;
+        last = i;
+      }
+    }
+    else if (isParallel_())
+    {
+      vector<size_t> tasks;
+      for (size_t i = 0; i < variables_.size(); ++i)
+        if (positions[i] < parameters.size())
+          tasks.push_back(i);
+      parallelFor_(tasks.size(), [&](size_t t, Function& function, vector<size_t>& modified) {
+        size_t i = tasks[t];
+        ParameterList p;
+        p.addParameter(parameters[positions[i]]);
+        ParameterList reset = getResetParameters_(parameters, modified, i, i);
+        const ParameterList* previous = reset.size() > 0 ? &reset : 0;
+        computeDerivatives_(function, i, p, previous);
+        if (previous)
+          function.setParameters(*previous);
+        modified.assign(1, i);
+      });
+      return;
+    }
+
+    for (size_t i = 0; i < variables_.size(); ++i)
+    {
+      size_t pos = positions[i];
+      if (pos == parameters.size() || done[i])
+        continue;
+      ParameterList& p = getTrialParameters_(i, parameters[pos]);
+      // Also reset previous parameter with the first trial point:
+      ParameterList reset;
+      if (last < variables_.size())
+        reset.shareParameters(getTrialParameters_(last, parameters[positions[last]]));
+      const ParameterList* previous = reset.size() > 0 ? &reset : 0;
+      computeDerivatives_(*function_, i, p, previous);
+      if (previous)
+        function_->setParameters(*previous);
+      last = i;
     }
     // Reset last parameter and compute analytical derivatives if any:
     if (function1_)
       function1_->enableFirstOrderDerivatives(computeD1_);
-    if (functionChanged)
-      function_->setParameters(parameters.createSubList(lastVar));
+    if (last < variables_.size())
+      function_->setParameters(getTrialParameters_(last, parameters[positions[last]]));
   }
   else
   {
@@ -124,3 +140,31 @@ void TwoPointsNumericalDerivative::updateDerivatives(const ParameterList paramet
   }
 }
 
+/******************************************************************************/
+
+void TwoPointsNumericalDerivative::computeDerivatives_(Function& function, size_t i, ParameterList& p, const ParameterList*& previous)
+{
+  double value = p[0].getValue();
+  double h = (1 + std::abs(value)) * h_;
+  // Compute one other point:
+  try
+  {
+    p[0].setValue(value + h);
+    setTrialParameters_(function, p, previous);
+    double f2 = function.getValue();
+    // No limit raised, use forward approximation:
+    der1_[i] = (f2 - f1_) / h;
+  }
+  catch (ConstraintException& ce)
+  {
+    // Right limit raised, use backward approximation.
+    // If this fails too, derivatives can't be computed, because of a too narrow interval (lower than h).
+    p[0].setValue(value - h);
+    setTrialParameters_(function, p, previous);
+    double f2 = function.getValue();
+    der1_[i] = (f1_ - f2) / h;
+  }
+}
+
+/******************************************************************************/
+
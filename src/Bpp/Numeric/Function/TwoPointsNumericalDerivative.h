@@ -75,17 +75,15 @@ class TwoPointsNumericalDerivative :
   public AbstractNumericalDerivative
 {
 private:
-  double f1_, f2_;
+  double f1_;
 
 public:
   TwoPointsNumericalDerivative(Function* function) :
     AbstractNumericalDerivative(function),
-    f1_(),
-    f2_() {}
+    f1_() {}
   TwoPointsNumericalDerivative(DerivableFirstOrder* function) :
     AbstractNumericalDerivative(function),
-    f1_(),
-    f2_() {}
+    f1_() {}
   virtual ~TwoPointsNumericalDerivative() {}
 
   TwoPointsNumericalDerivative* clone() const { return new TwoPointsNumericalDerivative(*this); }
@@ -111,6 +109,17 @@ public:
 
 protected:
   void updateDerivatives(const ParameterList parameters);
+
+private:
+  /**
+   * @brief Compute the derivatives for one variable.
+   *
+   * @param function The function to evaluate.
+   * @param i The index of the variable.
+   * @param p A list with a copy of the variable, used to set trial values.
+   * @param previous Parameters to reset together with the first trial point, or 0 (see setTrialParameters_).
+   */
+  void computeDerivatives_(Function& function, size_t i, ParameterList& p, const ParameterList*& previous);
 };
 } // end of namespace bpp.
 
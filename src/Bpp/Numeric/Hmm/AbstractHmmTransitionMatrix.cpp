@@ -42,6 +42,9 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "../Matrix/MatrixTools.h"
 #include "../VectorTools.h"
 #include "../Random/RandomTools.h"
+#include "../NumConstants.h"
+
+#include <memory>
 
 using namespace bpp;
 using namespace std;
@@ -127,3 +130,56 @@ vector<size_t> AbstractHmmTransitionMatrix::sample(size_t size) const
 }
 
   
+
+void AbstractHmmTransitionMatrix::getDPij(const string& variable, RowMatrix<double>& dPij, vector<double>& dEqFreqs) const
+{
+  size_t nbStates = getNumberOfStates();
+  dPij.resize(nbStates, nbStates);
+  dEqFreqs.assign(nbStates, 0.);
+  for (size_t i = 0; i < nbStates; ++i)
+    for (size_t j = 0; j < nbStates; ++j)
+      dPij(i, j) = 0.;
+
+  if (!getParameters().hasParameter(variable))
+    return;
+
+  const Parameter& param = getParameters().getParameter(variable);
+  double x = param.getValue();
+  double h = NumConstants::SMALL() * (1. + std::abs(x));
+  double xm = x - h, xp = x + h;
+  if (param.hasConstraint())
+  {
+    if (!param.getConstraint()->isCorrect(xm))
+      xm = x;
+    if (!param.getConstraint()->isCorrect(xp))
+      xp = x;
+    if (xm == xp)
+      throw Exception("AbstractHmmTransitionMatrix::getDPij. No valid step around value of parameter " + variable + ".");
+  }
+
+  unique_ptr<HmmTransitionMatrix> copy(dynamic_cast<HmmTransitionMatrix*>(clone()));
+  ParameterList pl;
+  pl.addParameter(param);
+
+  vector<double> eqm, eqp;
+  RowMatrix<double> pm, pp;
+
+  pl[0].setValue(xm);
+  copy->matchParametersValues(pl);
+  eqm = copy->getEquilibriumFrequencies();
+  pm = copy->getPij();
+
+  pl[0].setValue(xp);
+  copy->matchParametersValues(pl);
+  eqp = copy->getEquilibriumFrequencies();
+  pp = copy->getPij();
+
+  double dx = xp - xm;
+  for (size_t i = 0; i < nbStates; ++i)
+  {
+    dEqFreqs[i] = (eqp[i] - eqm[i]) / dx;
+    for (size_t j = 0; j < nbStates; ++j)
+      dPij(i, j) = (pp(i, j) - pm(i, j)) / dx;
+  }
+}
+
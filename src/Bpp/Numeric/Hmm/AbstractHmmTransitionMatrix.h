@@ -111,6 +111,15 @@ public:
    */
 
   std::vector<size_t> sample(size_t size) const;
+
+  /**
+   * @brief Derivatives of the transition probabilities and equilibrium frequencies,
+   * approximated by central finite differences on a copy of the matrix.
+   *
+   * A one-sided difference is used when the parameter is close to a bound of its constraint.
+   * Implementations should override this method with analytical derivatives when available.
+   */
+  void getDPij(const std::string& variable, RowMatrix<double>& dPij, std::vector<double>& dEqFreqs) const;
   
 };
 
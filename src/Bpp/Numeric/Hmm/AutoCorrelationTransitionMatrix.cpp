@@ -100,6 +100,32 @@ const std::vector<double>& AutoCorrelationTransitionMatrix::getEquilibriumFreque
   return eqFreq_;
 }
 
+void AutoCorrelationTransitionMatrix::getDiagonalPlusRankOne(std::vector<double>& d, std::vector<double>& u, std::vector<double>& v) const
+{
+  size_t n = vAutocorrel_.size();
+  d.resize(n);
+  u.resize(n);
+  v.assign(n, 1.);
+  for (size_t i = 0; i < n; ++i)
+  {
+    u[i] = (n > 1) ? (1 - vAutocorrel_[i]) / static_cast<double>(n - 1) : 0.;
+    d[i] = vAutocorrel_[i] - u[i];
+  }
+}
+
+void AutoCorrelationTransitionMatrix::getDPij(const std::string& variable, RowMatrix<double>& dPij, std::vector<double>& dEqFreqs) const
+{
+  size_t n = vAutocorrel_.size();
+  dPij.resize(n, n);
+  dEqFreqs.assign(n, 0.);
+  for (size_t i = 0; i < n; ++i)
+  {
+    bool isVariable = (variable == getNamespace() + "lambda" + TextTools::toString(i + 1));
+    for (size_t j = 0; j < n; ++j)
+      dPij(i, j) = !isVariable ? 0. : (i == j ? 1. : -1. / static_cast<double>(n - 1));
+  }
+}
+
 void AutoCorrelationTransitionMatrix::fireParameterChanged(const ParameterList& parameters)
 {
   size_t salph=getNumberOfStates();
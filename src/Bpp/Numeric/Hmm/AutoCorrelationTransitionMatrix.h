@@ -102,6 +102,21 @@ public:
 
   const std::vector<double>& getEquilibriumFrequencies() const;
 
+  /**
+   * @brief The matrix is diagonal plus rank one.
+   *
+   * With @f$u_i = (1 - \lambda_i) / (n - 1)@f$, @f$p_{i,j} = (\lambda_i - u_i)\delta_{i,j} + u_i@f$.
+   */
+  Structure getStructure() const { return DIAGONAL_PLUS_RANK_ONE; }
+
+  void getDiagonalPlusRankOne(std::vector<double>& d, std::vector<double>& u, std::vector<double>& v) const;
+
+  /**
+   * @brief Analytical derivatives: only row i depends on @f$\lambda_i@f$,
+   * and the equilibrium frequencies are constant.
+   */
+  void getDPij(const std::string& variable, RowMatrix<double>& dPij, std::vector<double>& dEqFreqs) const;
+
 
   /*
    * @brief From AbstractParametrizable interface
@@ -129,6 +129,53 @@ const std::vector<double>& FullHmmTransitionMatrix::getEquilibriumFrequencies()
   return eqFreq_;
 }
 
+void FullHmmTransitionMatrix::getDPij(const string& variable, RowMatrix<double>& dPij, vector<double>& dEqFreqs) const
+{
+  size_t n = getNumberOfStates();
+  dPij.resize(n, n);
+  dEqFreqs.assign(n, 0.);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      dPij(i, j) = 0.;
+
+  size_t row = 0;
+  while (row < n && !vSimplex_[row].getParameters().hasParameter(variable))
+    row++;
+  if (row == n)
+    return;
+
+  // Derivative of p_j = theta_j.(1 - theta_1)...(1 - theta_{j-1}) with respect to theta_k:
+  const ParameterList& thetas = vSimplex_[row].getParameters();
+  size_t k = thetas.whichParameterHasName(variable);
+  double x = 1.;
+  for (size_t j = 0; j < n; ++j)
+  {
+    double th = (j + 1 < n) ? thetas[j].getValue() : 1.;
+    if (j == k)
+      dPij(row, j) = x;
+    else if (j > k)
+      dPij(row, j) = -x * th;
+    if (j != k)
+      x *= 1. - th;
+  }
+
+  // Equilibrium frequencies: pi.(I - P) = 0 and sum(pi) = 1, the last equation being replaced by the sum:
+  const Matrix<double>& pij = getPij();
+  RowMatrix<double> a(n, n), ainv;
+  for (size_t r = 0; r < n; ++r)
+    for (size_t c = 0; c < n; ++c)
+      a(r, c) = (r + 1 < n) ? (r == c ? 1. : 0.) - pij(c, r) : 1.;
+  MatrixTools::inv(a, ainv);
+
+  // d(pi).(I - P) = pi.dP, with sum(d(pi)) = 0:
+  vector<double> b(n, 0.);
+  for (size_t c = 0; c + 1 < n; ++c)
+    b[c] = ainv(row, n - 1) * dPij(row, c);
+  for (size_t r = 0; r < n; ++r)
+    for (size_t c = 0; c < n; ++c)
+      dEqFreqs[r] += ainv(r, c) * b[c];
+}
+
 void FullHmmTransitionMatrix::fireParameterChanged(const ParameterList& parameters)
 {
   size_t salph=getNumberOfStates();
@@ -114,6 +114,16 @@ public:
 
   const std::vector<double>& getEquilibriumFrequencies() const;
 
+  /**
+   * @brief Analytical derivatives.
+   *
+   * Only row i depends on the parameters of the ith Simplex. With the global ratio
+   * parametrization, @f$p_{i,j} = \theta_j \prod_{m<j}(1-\theta_m)@f$. The derivatives of the
+   * equilibrium frequencies @f$\pi@f$ are obtained by solving
+   * @f$d\pi (I - P) = \pi dP@f$ with @f$\sum d\pi = 0@f$.
+   */
+  void getDPij(const std::string& variable, RowMatrix<double>& dPij, std::vector<double>& dEqFreqs) const;
+
 
   /*
    * @brief From AbstractParametrizable interface
@@ -0,0 +1,205 @@
+//
+// File: HmmEmissionBuffer.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _HMMEMISSIONBUFFER_H_
+#define _HMMEMISSIONBUFFER_H_
+
+#include "HmmEmissionProbabilities.h"
+
+//From the STL:
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+namespace bpp
+{
+
+/**
+ * @brief Sequential access to emission probabilities, fetched by contiguous blocks.
+ *
+ * Recursions over a range of positions use this class instead of per-position vectors:
+ * emissions are returned as pointers to the probabilities of all hidden states at a position.
+ * When the emission probabilities are stored contiguously (see
+ * HmmEmissionProbabilities::getEmissionProbabilitiesData), pointers into this storage are
+ * returned directly. Otherwise, emissions are copied by blocks of positions into a single buffer
+ * aligned on cache lines, with HmmEmissionProbabilities::getEmissionProbabilities.
+ * Blocks are fetched in the direction of the traversal, forward or reverse.
+ *
+ * Instances are not thread-safe, but several instances can share the same emission probabilities.
+ */
+class HmmEmissionBuffer
+{
+public:
+  /**
+   * @brief Alignment of the buffer, in bytes.
+   */
+  static const size_t ALIGNMENT = 64;
+
+private:
+  const HmmEmissionProbabilities* emissions_;
+  size_t nbStates_;
+  size_t begin_, end_;
+  bool reverse_;
+  size_t blockSize_;
+  size_t blockBegin_, blockEnd_;
+
+  /**
+   * @brief Contiguous emission probabilities, if available.
+   */
+  const double* data_;
+
+  /**
+   * @brief Storage of the buffer, with ALIGNMENT extra bytes so that an aligned block fits in.
+   */
+  std::vector<double> storage_;
+  double* buffer_;
+
+public:
+  /**
+   * @param emissions The emission probabilities.
+   * @param nbStates The number of hidden states.
+   * @param begin The first position which can be accessed.
+   * @param end The position after the last one which can be accessed.
+   * @param reverse Whether positions are accessed in decreasing order.
+   * @param blockSize The number of positions fetched at once.
+   */
+  HmmEmissionBuffer(const HmmEmissionProbabilities& emissions, size_t nbStates, size_t begin, size_t end, bool reverse = false, size_t blockSize = 256) :
+    emissions_(&emissions),
+    nbStates_(nbStates),
+    begin_(begin),
+    end_(end),
+    reverse_(reverse),
+    blockSize_(std::max(blockSize, static_cast<size_t>(1))),
+    blockBegin_(0),
+    blockEnd_(0),
+    data_(emissions.getEmissionProbabilitiesData()),
+    storage_(),
+    buffer_(0)
+  {
+    if (!data_)
+      allocate_();
+  }
+
+  HmmEmissionBuffer(const HmmEmissionBuffer& buffer) :
+    emissions_(buffer.emissions_),
+    nbStates_(buffer.nbStates_),
+    begin_(buffer.begin_),
+    end_(buffer.end_),
+    reverse_(buffer.reverse_),
+    blockSize_(buffer.blockSize_),
+    blockBegin_(buffer.blockBegin_),
+    blockEnd_(buffer.blockEnd_),
+    data_(buffer.data_),
+    storage_(),
+    buffer_(0)
+  {
+    if (!data_)
+    {
+      allocate_();
+      std::copy(buffer.buffer_, buffer.buffer_ + getBufferSize_(), buffer_);
+    }
+  }
+
+  HmmEmissionBuffer& operator=(const HmmEmissionBuffer& buffer)
+  {
+    emissions_  = buffer.emissions_;
+    nbStates_   = buffer.nbStates_;
+    begin_      = buffer.begin_;
+    end_        = buffer.end_;
+    reverse_    = buffer.reverse_;
+    blockSize_  = buffer.blockSize_;
+    blockBegin_ = buffer.blockBegin_;
+    blockEnd_   = buffer.blockEnd_;
+    data_       = buffer.data_;
+    storage_.clear();
+    buffer_     = 0;
+    if (!data_)
+    {
+      allocate_();
+      std::copy(buffer.buffer_, buffer.buffer_ + getBufferSize_(), buffer_);
+    }
+    return *this;
+  }
+
+public:
+  /**
+   * @param pos A position in the accessible range.
+   * @return A pointer to the emission probabilities of all hidden states at this position.
+   */
+  const double* operator()(size_t pos)
+  {
+    if (data_)
+      return data_ + pos * nbStates_;
+    if (pos < blockBegin_ || pos >= blockEnd_)
+      fetch_(pos);
+    return buffer_ + (pos - blockBegin_) * nbStates_;
+  }
+
+private:
+  size_t getBufferSize_() const
+  {
+    return std::min(blockSize_, end_ - begin_) * nbStates_;
+  }
+
+  void allocate_()
+  {
+    storage_.resize(getBufferSize_() + ALIGNMENT / sizeof(double));
+    void* ptr = &storage_[0];
+    size_t space = storage_.size() * sizeof(double);
+    buffer_ = static_cast<double*>(std::align(ALIGNMENT, getBufferSize_() * sizeof(double), ptr, space));
+  }
+
+  void fetch_(size_t pos)
+  {
+    if (reverse_)
+    {
+      blockEnd_ = pos + 1;
+      blockBegin_ = (blockEnd_ - begin_ > blockSize_) ? blockEnd_ - blockSize_ : begin_;
+    }
+    else
+    {
+      blockBegin_ = pos;
+      blockEnd_ = std::min(pos + blockSize_, end_);
+    }
+    emissions_->getEmissionProbabilities(blockBegin_, blockEnd_, buffer_);
+  }
+};
+
+} //end of namespace bpp
+
+#endif //_HMMEMISSIONBUFFER_H_
+
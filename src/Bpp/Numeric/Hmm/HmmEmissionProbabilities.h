@@ -46,6 +46,8 @@
 
 //From the STL:
 #include <vector>
+#include <utility>
+#include <algorithm>
 
 namespace bpp
 {
@@ -118,11 +120,59 @@ namespace bpp
      * @return A vector of probabilities, whose size is the number of hidden states.
      */
     virtual const std::vector<double>& operator()(size_t pos) const = 0;
+
+    /**
+     * @brief Copy the emission probabilities of a range of positions into a contiguous buffer.
+     *
+     * Element (i - begin) * n + k of the buffer is the probability of the data at position i
+     * conditioned on hidden state k, n being the number of hidden states. The default
+     * implementation copies the vectors returned by operator(); implementations which store
+     * or compute emissions by blocks should override it, and implementations which store
+     * them contiguously should rather override getEmissionProbabilitiesData.
+     *
+     * @param begin The first position.
+     * @param end The position after the last one.
+     * @param buffer [out] A buffer of size at least (end - begin) * n.
+     */
+    virtual void getEmissionProbabilities(size_t begin, size_t end, double* buffer) const
+    {
+      for (size_t i = begin; i < end; i++)
+      {
+        const std::vector<double>& emissions = (*this)(i);
+        buffer = std::copy(emissions.begin(), emissions.end(), buffer);
+      }
+    }
+
+    /**
+     * @brief Direct access to emission probabilities stored contiguously.
+     *
+     * @return A pointer to the emission probabilities of all positions, with the same layout as
+     * getEmissionProbabilities, or a null pointer if they are not stored this way (the default).
+     * The pointer is valid until the next parameter change.
+     */
+    virtual const double* getEmissionProbabilitiesData() const
+    {
+      return 0;
+    }
     
     /**
      * @return The number of positions in the data.
      */
     virtual size_t getNumberOfPositions() const = 0;
+
+    /**
+     * @brief Get the positions whose emission probabilities were modified by the last parameter change.
+     *
+     * Likelihood computations use this information to only update the affected positions.
+     * The default implementation does not locate the changes.
+     *
+     * @param ranges [out] A list of ranges [begin, end[ of modified positions.
+     * @return false if the modified positions are not known, in which case all positions should be considered as modified.
+     */
+    virtual bool getChangedPositions(std::vector< std::pair<size_t, size_t> >& ranges) const
+    {
+      return false;
+    }
   };
 
 } //end of namespace bpp.
@@ -39,6 +39,9 @@
 
 #include "HmmLikelihood.h"
 
+// From the STL:
+#include <algorithm>
+
 using namespace bpp;
 using namespace std;
 
@@ -46,13 +49,25 @@ AbstractHmmLikelihood::AbstractHmmLikelihood() :
   dLogLik_(0),
   dVariable_(""),
   d2LogLik_(0),
-  d2Variable_("") {}
+  d2Variable_(""),
+  singleSweepGradient_(false),
+  gradient_(),
+  gradientUpToDate_(false),
+  nbThreads_(1),
+  segmentBounds_(),
+  segmentOrder_() {}
 
 AbstractHmmLikelihood::AbstractHmmLikelihood(const AbstractHmmLikelihood& adhlik) :
   dLogLik_(adhlik.dLogLik_),
   dVariable_(adhlik.dVariable_),
   d2LogLik_(adhlik.d2LogLik_),
-  d2Variable_(adhlik.d2Variable_)
+  d2Variable_(adhlik.d2Variable_),
+  singleSweepGradient_(adhlik.singleSweepGradient_),
+  gradient_(adhlik.gradient_),
+  gradientUpToDate_(adhlik.gradientUpToDate_),
+  nbThreads_(adhlik.nbThreads_),
+  segmentBounds_(adhlik.segmentBounds_),
+  segmentOrder_(adhlik.segmentOrder_)
 {}
 
 AbstractHmmLikelihood& AbstractHmmLikelihood::operator=(const AbstractHmmLikelihood& adhlik)
@@ -61,12 +76,36 @@ AbstractHmmLikelihood& AbstractHmmLikelihood::operator=(const AbstractHmmLikelih
   dVariable_=adhlik.dVariable_;
   d2LogLik_=adhlik.d2LogLik_;
   d2Variable_=adhlik.d2Variable_;
+  singleSweepGradient_=adhlik.singleSweepGradient_;
+  gradient_=adhlik.gradient_;
+  gradientUpToDate_=adhlik.gradientUpToDate_;
+  nbThreads_=adhlik.nbThreads_;
+  segmentBounds_=adhlik.segmentBounds_;
+  segmentOrder_=adhlik.segmentOrder_;
 
   return *this;
 }
 
 double AbstractHmmLikelihood::getFirstOrderDerivative(const std::string& variable) const
 {
+  if (singleSweepGradient_)
+  {
+    if (!gradientUpToDate_)
+    {
+      vector<string> variables = getParameters().getParameterNames();
+      vector<double> gradient;
+      getGradient(variables, gradient);
+      gradient_.clear();
+      for (size_t v = 0; v < variables.size(); v++)
+        gradient_[variables[v]] = gradient[v];
+      gradientUpToDate_ = true;
+    }
+    map<string, double>::const_iterator it = gradient_.find(variable);
+    if (it == gradient_.end())
+      throw ParameterNotFoundException("AbstractHmmLikelihood::getFirstOrderDerivative.", variable);
+    return it->second;
+  }
+
   if (variable!=dVariable_){
     dVariable_=variable;
     
@@ -88,3 +127,136 @@ double AbstractHmmLikelihood::getSecondOrderDerivative(const std::string& variab
   return -d2LogLik_;
 }
 
+void AbstractHmmLikelihood::getGradient(const std::vector<std::string>& variables, std::vector<double>& gradient) const
+{
+  const HmmTransitionMatrix& transitions = getHmmTransitionMatrix();
+  const HmmEmissionProbabilities& emissions = getHmmEmissionProbabilities();
+  size_t nbStates = transitions.getNumberOfStates();
+  size_t nbSegments = getNumberOfSegments();
+
+  bool hasTransitionParameter = false;
+  bool hasEmissionParameter = false;
+  for (size_t v = 0; v < variables.size(); v++)
+  {
+    hasTransitionParameter |= transitions.getParameters().hasParameter(variables[v]);
+    hasEmissionParameter |= emissions.getParameters().hasParameter(variables[v]);
+  }
+
+  //Derivatives with respect to transition probabilities and initial frequencies:
+  vector<double> dTransitions, dInit;
+  if (hasTransitionParameter)
+    computeDLogLikelihoodDTransitions_(dTransitions, dInit);
+
+  //Posterior probabilities of hidden states, for the emission parameters:
+  vector< vector<double> > posteriors;
+  if (hasEmissionParameter)
+    getHiddenStatesPosteriorProbabilities(posteriors, false);
+
+  gradient.assign(variables.size(), 0.);
+  RowMatrix<double> dPij;
+  vector<double> dEqFreqs;
+  vector<double> segD(nbSegments);
+  for (size_t v = 0; v < variables.size(); v++)
+  {
+    double d = 0;
+    if (transitions.getParameters().hasParameter(variables[v]))
+    {
+      transitions.getDPij(variables[v], dPij, dEqFreqs);
+      for (size_t j = 0; j < nbStates; j++)
+      {
+        for (size_t k = 0; k < nbStates; k++)
+          d += dTransitions[j * nbStates + k] * dPij(j, k);
+        d += dInit[j] * dEqFreqs[j];
+      }
+    }
+    if (emissions.getParameters().hasParameter(variables[v]))
+    {
+      string variable = variables[v];
+      emissions.computeDEmissionProbabilities(variable);
+      forEachSegment_([&](size_t s) {
+          double sd = 0;
+          for (size_t i = segmentBounds_[s]; i < segmentBounds_[s + 1]; i++)
+          {
+            const vector<double>& e = emissions(i);
+            const vector<double>& de = emissions.getDEmissionProbabilities(i);
+            for (size_t k = 0; k < nbStates; k++)
+            {
+              if (e[k] > 0)
+                sd += posteriors[i][k] * de[k] / e[k];
+            }
+          }
+          segD[s] = sd;
+        });
+      for (size_t s = 0; s < nbSegments; s++)
+        d += segD[s];
+    }
+    gradient[v] = -d;
+  }
+
+  //Emission derivatives have been overwritten:
+  dVariable_ = "";
+  d2Variable_ = "";
+}
+
+void AbstractHmmLikelihood::setNumberOfThreads(size_t nbThreads)
+{
+  if (nbThreads == 0)
+    throw Exception("AbstractHmmLikelihood::setNumberOfThreads. At least one thread is required.");
+  nbThreads_ = nbThreads;
+}
+
+void AbstractHmmLikelihood::updateSegments_(const std::vector<size_t>& breakPoints, size_t nbSites)
+{
+  segmentBounds_.clear();
+  segmentBounds_.push_back(0);
+  for (size_t i = 0; i < breakPoints.size(); i++)
+  {
+    if (breakPoints[i] > segmentBounds_.back() && breakPoints[i] < nbSites)
+      segmentBounds_.push_back(breakPoints[i]);
+  }
+  segmentBounds_.push_back(nbSites);
+
+  vector<size_t> lengths(segmentBounds_.size() - 1);
+  for (size_t s = 0; s < lengths.size(); s++)
+  {
+    lengths[s] = segmentBounds_[s + 1] - segmentBounds_[s];
+  }
+  segmentOrder_ = ThreadTools::getDispatchOrder(lengths);
+}
+
+bool AbstractHmmLikelihood::getDirtyRanges_(std::vector<size_t>& firstDirty, std::vector<size_t>& lastDirty) const
+{
+  vector< pair<size_t, size_t> > ranges;
+  if (!getHmmEmissionProbabilities().getChangedPositions(ranges))
+    return false;
+
+  size_t nbSegments = getNumberOfSegments();
+  firstDirty.assign(segmentBounds_.begin() + 1, segmentBounds_.end());
+  lastDirty.assign(segmentBounds_.begin(), segmentBounds_.end() - 1);
+  for (size_t r = 0; r < ranges.size(); r++)
+  {
+    size_t begin = ranges[r].first;
+    size_t end = min(ranges[r].second, segmentBounds_.back());
+    //A range can span several segments:
+    while (begin < end)
+    {
+      size_t s = getSegmentIndex_(begin);
+      size_t segEnd = min(end, segmentBounds_[s + 1]);
+      firstDirty[s] = min(firstDirty[s], begin);
+      lastDirty[s] = max(lastDirty[s], segEnd);
+      begin = segEnd;
+    }
+  }
+  for (size_t s = 0; s < nbSegments; s++)
+  {
+    if (firstDirty[s] == segmentBounds_[s + 1])
+      lastDirty[s] = firstDirty[s];
+  }
+  return true;
+}
+
+size_t AbstractHmmLikelihood::getSegmentIndex_(size_t site) const
+{
+  vector<size_t>::const_iterator it = upper_bound(segmentBounds_.begin(), segmentBounds_.end(), site);
+  return static_cast<size_t>(it - segmentBounds_.begin()) - 1;
+}
@@ -44,11 +44,15 @@
 // From NumCalc:
 #include "../Function/Functions.h"
 #include "../VectorTools.h"
+#include "../../Utils/ThreadTools.h"
 
 #include "HmmStateAlphabet.h"
 #include "HmmTransitionMatrix.h"
 #include "HmmEmissionProbabilities.h"
 
+//From the STL:
+#include <map>
+
 namespace bpp
 {
 
@@ -72,6 +76,9 @@ namespace bpp
    * The HmmLikelihood interface provides essentially two major methods:
    * - A method to retrieve the likelihood value (parameter estimation)
    * - Two methods to retrieve the posterio probabilities of each state using the forward and backward conditionnal likelihoods (posterior decoding).
+   *
+   * Break points split the data into independent segments, as the chain is reset to the equilibrium
+   * frequencies at each of them. Segments can therefore be processed in parallel, see setNumberOfThreads.
    */
   
   class HmmLikelihood:
@@ -123,6 +130,32 @@ namespace bpp
 
     virtual void setBreakPoints(const std::vector<size_t>& breakPoints) = 0;
 
+    /**
+     * @brief Set the number of threads used to process independent segments.
+     *
+     * Segments delimited by break points are dispatched to the threads, the longest ones first.
+     * Per-segment results are combined in a fixed order, so that the results do not depend on
+     * the number of threads. With more than one thread, the emission probabilities must be
+     * accessible concurrently.
+     *
+     * @param nbThreads The number of threads to use (1 for sequential computations).
+     */
+    virtual void setNumberOfThreads(size_t nbThreads) = 0;
+
+    virtual size_t getNumberOfThreads() const = 0;
+
+    /**
+     * @brief Get the derivatives of the function (minus the log likelihood) with respect to several parameters.
+     *
+     * All derivatives are obtained from a single forward-backward sweep: the expected numbers of
+     * transitions between hidden states are accumulated once, and combined with the derivatives
+     * of the transition matrix (see HmmTransitionMatrix::getDPij) and of the emission probabilities.
+     *
+     * @param variables The full names of the parameters.
+     * @param gradient [out] The derivatives, in the same order as the parameters.
+     */
+    virtual void getGradient(const std::vector<std::string>& variables, std::vector<double>& gradient) const = 0;
+
   protected:
 
     virtual void computeDLikelihood_() const = 0;
@@ -148,6 +181,25 @@ namespace bpp
     mutable double d2LogLik_;
     mutable std::string d2Variable_;
 
+    bool singleSweepGradient_;
+    mutable std::map<std::string, double> gradient_;
+    mutable bool gradientUpToDate_;
+
+    size_t nbThreads_;
+
+    /**
+     * @brief Bounds of the independent segments.
+     *
+     * Segment s spans sites [segmentBounds_[s], segmentBounds_[s + 1][,
+     * the last element being the total number of sites.
+     */
+    std::vector<size_t> segmentBounds_;
+
+    /**
+     * @brief Segment indices sorted by decreasing length, for dispatching.
+     */
+    std::vector<size_t> segmentOrder_;
+
   public:
     AbstractHmmLikelihood();
     
@@ -155,6 +207,15 @@ namespace bpp
 
     AbstractHmmLikelihood& operator=(const AbstractHmmLikelihood& adhlik);
 
+    void setNumberOfThreads(size_t nbThreads);
+
+    size_t getNumberOfThreads() const { return nbThreads_; }
+
+    /**
+     * @return The number of independent segments, as delimited by break points.
+     */
+    size_t getNumberOfSegments() const { return segmentBounds_.size() == 0 ? 0 : segmentBounds_.size() - 1; }
+
     /* @{
      *
      * @brief From FirstOrder:
@@ -167,6 +228,19 @@ namespace bpp
 
     double getFirstOrderDerivative(const std::string& variable) const;
 
+    /**
+     * @brief Compute first order derivatives with respect to all parameters at once.
+     *
+     * When enabled, the first call to getFirstOrderDerivative after a parameter change computes
+     * the derivatives for all parameters with getGradient, and the following calls return cached values.
+     * This is much faster than one recursion per parameter when many parameters are optimized.
+     */
+    void enableSingleSweepGradient(bool yn) { singleSweepGradient_ = yn; gradientUpToDate_ = false; }
+
+    bool enableSingleSweepGradient() const { return singleSweepGradient_; }
+
+    void getGradient(const std::vector<std::string>& variables, std::vector<double>& gradient) const;
+
     double getDLogLikelihood() const
     {
       return dLogLik_;
@@ -203,6 +277,64 @@ namespace bpp
      *
      */
 
+  protected:
+    /**
+     * @brief Invalidate all cached derivatives, to be called when parameters or break points change.
+     */
+    void resetDerivatives_()
+    {
+      dVariable_ = "";
+      d2Variable_ = "";
+      gradientUpToDate_ = false;
+    }
+
+    /**
+     * @brief Compute the derivatives of the log likelihood with respect to the transition probabilities
+     * and to the frequencies of hidden states before the first site of each segment.
+     *
+     * @param dTransitions [out] A vector of size n*n, with element j*n+k being the derivative with
+     * respect to the probability of transition from state j to state k, that is the expected number
+     * of such transitions divided by their probability.
+     * @param dInitFreqs [out] A vector of size n, with the derivatives with respect to the initial frequencies.
+     * @throw NotImplementedException if the class does not store the forward and backward likelihoods.
+     */
+    virtual void computeDLogLikelihoodDTransitions_(std::vector<double>& dTransitions, std::vector<double>& dInitFreqs) const
+    {
+      throw NotImplementedException("AbstractHmmLikelihood::computeDLogLikelihoodDTransitions_.");
+    }
+
+    /**
+     * @brief Compute segment bounds from break points.
+     *
+     * Break points which are out of range or not in increasing order are ignored.
+     *
+     * @param breakPoints The positions where the chain is reset.
+     * @param nbSites The total number of sites.
+     */
+    void updateSegments_(const std::vector<size_t>& breakPoints, size_t nbSites);
+
+    /**
+     * @brief Locate the sites whose emission probabilities changed, in each segment.
+     *
+     * @param firstDirty [out] For each segment, the first site with modified emission probabilities,
+     * or the end of the segment if there is none.
+     * @param lastDirty [out] For each segment, the site after the last one with modified emission probabilities.
+     * @return false if the emission probabilities do not locate their changes.
+     */
+    bool getDirtyRanges_(std::vector<size_t>& firstDirty, std::vector<size_t>& lastDirty) const;
+
+    /**
+     * @return The index of the segment containing the given site.
+     */
+    size_t getSegmentIndex_(size_t site) const;
+
+    /**
+     * @brief Apply a function to each segment index, possibly in parallel.
+     */
+    void forEachSegment_(const std::function<void (size_t)>& f) const
+    {
+      ThreadTools::parallelFor(segmentOrder_, nbThreads_, f);
+    }
   
   };
 
@@ -0,0 +1,301 @@
+//
+// File: HmmPathSampler.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "HmmPathSampler.h"
+#include "HmmEmissionBuffer.h"
+#include "../../Text/TextTools.h"
+
+// From the STL:
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+HmmPathSampler::HmmPathSampler(const RescaledHmmLikelihood& likelihood) :
+  kernel_(likelihood.getHmmTransitionMatrix()),
+  eqFreqs_(),
+  transitionsByColumn_(),
+  emissions_(&likelihood.getHmmEmissionProbabilities()),
+  nbStates_(likelihood.getHmmTransitionMatrix().getNumberOfStates()),
+  nbSites_(likelihood.getHmmEmissionProbabilities().getNumberOfPositions()),
+  segmentBounds_(),
+  likelihood_(&likelihood),
+  checkpointInterval_(0),
+  checkpoints_(),
+  firstBlock_()
+{
+  init_(likelihood.getHmmTransitionMatrix(), likelihood.getBreakPoints());
+}
+
+HmmPathSampler::HmmPathSampler(const HmmTransitionMatrix& transitionMatrix, const HmmEmissionProbabilities& emissions,
+    const std::vector<size_t>& breakPoints, size_t checkpointInterval) :
+  kernel_(transitionMatrix),
+  eqFreqs_(),
+  transitionsByColumn_(),
+  emissions_(&emissions),
+  nbStates_(transitionMatrix.getNumberOfStates()),
+  nbSites_(emissions.getNumberOfPositions()),
+  segmentBounds_(),
+  likelihood_(0),
+  checkpointInterval_(checkpointInterval),
+  checkpoints_(),
+  firstBlock_()
+{
+  if (checkpointInterval == 0)
+    throw Exception("HmmPathSampler. The checkpoint interval must be positive.");
+  init_(transitionMatrix, breakPoints);
+  computeCheckpoints_();
+}
+
+HmmPathSampler::HmmPathSampler(const HmmPathSampler& sampler) :
+  kernel_(sampler.kernel_),
+  eqFreqs_(sampler.eqFreqs_),
+  transitionsByColumn_(sampler.transitionsByColumn_),
+  emissions_(sampler.emissions_),
+  nbStates_(sampler.nbStates_),
+  nbSites_(sampler.nbSites_),
+  segmentBounds_(sampler.segmentBounds_),
+  likelihood_(sampler.likelihood_),
+  checkpointInterval_(sampler.checkpointInterval_),
+  checkpoints_(sampler.checkpoints_),
+  firstBlock_(sampler.firstBlock_)
+{}
+
+HmmPathSampler& HmmPathSampler::operator=(const HmmPathSampler& sampler)
+{
+  kernel_              = sampler.kernel_;
+  eqFreqs_             = sampler.eqFreqs_;
+  transitionsByColumn_ = sampler.transitionsByColumn_;
+  emissions_           = sampler.emissions_;
+  nbStates_            = sampler.nbStates_;
+  nbSites_             = sampler.nbSites_;
+  segmentBounds_       = sampler.segmentBounds_;
+  likelihood_          = sampler.likelihood_;
+  checkpointInterval_  = sampler.checkpointInterval_;
+  checkpoints_         = sampler.checkpoints_;
+  firstBlock_          = sampler.firstBlock_;
+  return *this;
+}
+
+/***************************************************************************************************************************/
+
+void HmmPathSampler::init_(const HmmTransitionMatrix& transitionMatrix, const std::vector<size_t>& breakPoints)
+{
+  eqFreqs_ = transitionMatrix.getEquilibriumFrequencies();
+  getTransitionsByColumn_(transitionMatrix, transitionsByColumn_);
+  getSegmentBounds_(breakPoints, nbSites_, segmentBounds_);
+}
+
+void HmmPathSampler::getTransitionsByColumn_(const HmmTransitionMatrix& transitionMatrix, std::vector<double>& transitions)
+{
+  size_t n = transitionMatrix.getNumberOfStates();
+  const Matrix<double>& pij = transitionMatrix.getPij();
+  transitions.resize(n * n);
+  for (size_t k = 0; k < n; k++)
+  {
+    for (size_t j = 0; j < n; j++)
+    {
+      transitions[k * n + j] = pij(j, k);
+    }
+  }
+}
+
+void HmmPathSampler::getSegmentBounds_(const std::vector<size_t>& breakPoints, size_t nbSites, std::vector<size_t>& bounds)
+{
+  //Same segments as in AbstractHmmLikelihood:
+  bounds.assign(1, 0);
+  for (size_t i = 0; i < breakPoints.size(); i++)
+  {
+    if (breakPoints[i] > bounds.back() && breakPoints[i] < nbSites)
+      bounds.push_back(breakPoints[i]);
+  }
+  bounds.push_back(nbSites);
+}
+
+void HmmPathSampler::computeCheckpoints_()
+{
+  size_t nbSegments = segmentBounds_.size() - 1;
+  firstBlock_.resize(nbSegments);
+  size_t nbBlocks = 0;
+  for (size_t s = 0; s < nbSegments; s++)
+  {
+    firstBlock_[s] = nbBlocks;
+    nbBlocks += (segmentBounds_[s + 1] - segmentBounds_[s] + checkpointInterval_ - 1) / checkpointInterval_;
+  }
+  checkpoints_.resize(nbBlocks * nbStates_);
+
+  vector<double> previous(nbStates_), current(nbStates_);
+  for (size_t s = 0; s < nbSegments; s++)
+  {
+    size_t begin = segmentBounds_[s], end = segmentBounds_[s + 1];
+    HmmEmissionBuffer emissionBuffer(*emissions_, nbStates_, begin, end);
+    previous = eqFreqs_;
+    for (size_t i = begin; i < end; i++)
+    {
+      if ((i - begin) % checkpointInterval_ == 0)
+        copy(previous.begin(), previous.end(), checkpoints_.begin() + static_cast<ptrdiff_t>((firstBlock_[s] + (i - begin) / checkpointInterval_) * nbStates_));
+      forwardStep_(&previous[0], emissionBuffer(i), &current[0]);
+      previous.swap(current);
+    }
+  }
+}
+
+void HmmPathSampler::forwardStep_(const double* previous, const double* emissions, double* current) const
+{
+  //Same operations as in RescaledHmmLikelihood, so that results are identical:
+  kernel_.forward(previous, current);
+  double scale = 0;
+  for (size_t j = 0; j < nbStates_; j++)
+  {
+    current[j] = emissions[j] * current[j];
+    if (current[j] < 0)
+      current[j] = 0;
+    scale += current[j];
+  }
+  for (size_t j = 0; j < nbStates_; j++)
+  {
+    current[j] = (scale > 0) ? current[j] / scale : 0;
+  }
+}
+
+/***************************************************************************************************************************/
+
+void HmmPathSampler::samplePaths(size_t nbPaths, std::vector< std::vector<size_t> >& paths, const RandomFactory& generator) const
+{
+  vector<size_t> states(nbPaths);
+  vector<double> cdf(nbStates_ * nbStates_);
+  vector<double> rows;
+
+  if (likelihood_)
+  {
+    //Everything is read from the likelihood object, whose parameters may have changed:
+    vector<double> transitions;
+    vector<size_t> bounds;
+    size_t nbSites = likelihood_->getHmmEmissionProbabilities().getNumberOfPositions();
+    getTransitionsByColumn_(likelihood_->getHmmTransitionMatrix(), transitions);
+    getSegmentBounds_(likelihood_->getBreakPoints(), nbSites, bounds);
+    const vector<double>& forward = likelihood_->getForwardLikelihoods();
+    paths.assign(nbPaths, vector<size_t>(nbSites));
+    for (size_t s = bounds.size() - 1; s > 0; s--)
+    {
+      size_t begin = bounds[s - 1], end = bounds[s];
+      sampleBackward_(&forward[begin * nbStates_], transitions, begin, end, end - 1, states, paths, cdf, generator);
+    }
+    return;
+  }
+
+  paths.assign(nbPaths, vector<size_t>(nbSites_));
+  for (size_t s = segmentBounds_.size() - 1; s > 0; s--)
+  {
+    size_t begin = segmentBounds_[s - 1], end = segmentBounds_[s];
+
+    //Recompute forward likelihoods block by block, from the last one:
+    size_t nbBlocks = (end - begin + checkpointInterval_ - 1) / checkpointInterval_;
+    rows.resize(min(checkpointInterval_, end - begin) * nbStates_);
+    for (size_t b = nbBlocks; b > 0; b--)
+    {
+      size_t blockBegin = begin + (b - 1) * checkpointInterval_;
+      size_t blockEnd = min(blockBegin + checkpointInterval_, end);
+      HmmEmissionBuffer emissionBuffer(*emissions_, nbStates_, blockBegin, blockEnd);
+      const double* previous = &checkpoints_[(firstBlock_[s - 1] + b - 1) * nbStates_];
+      for (size_t i = blockBegin; i < blockEnd; i++)
+      {
+        double* current = &rows[(i - blockBegin) * nbStates_];
+        forwardStep_(previous, emissionBuffer(i), current);
+        previous = current;
+      }
+      sampleBackward_(&rows[0], transitionsByColumn_, blockBegin, blockEnd, end - 1, states, paths, cdf, generator);
+    }
+  }
+}
+
+void HmmPathSampler::sampleBackward_(const double* rows, const std::vector<double>& transitions, size_t begin, size_t end, size_t last,
+    std::vector<size_t>& states, std::vector< std::vector<size_t> >& paths,
+    std::vector<double>& cdf, const RandomFactory& generator) const
+{
+  size_t nbPaths = states.size();
+  vector<bool> needed(nbStates_);
+  for (size_t i = end; i > begin; i--)
+  {
+    size_t site = i - 1;
+    const double* f = rows + (site - begin) * nbStates_;
+
+    //Cumulative distributions, for each state at the next site:
+    if (site == last)
+    {
+      needed.assign(nbStates_, false);
+      needed[0] = true;
+    }
+    else
+    {
+      needed.assign(nbStates_, false);
+      for (size_t p = 0; p < nbPaths; p++)
+        needed[states[p]] = true;
+    }
+    for (size_t k = 0; k < nbStates_; k++)
+    {
+      if (!needed[k])
+        continue;
+      double* c = &cdf[k * nbStates_];
+      const double* pk = &transitions[k * nbStates_];
+      double x = 0;
+      for (size_t j = 0; j < nbStates_; j++)
+      {
+        x += (site == last) ? f[j] : f[j] * pk[j];
+        c[j] = x;
+      }
+      if (!(x > 0))
+        throw Exception("HmmPathSampler::samplePaths. Null posterior probability at position " + TextTools::toString(site) + ".");
+    }
+
+    //Draw all paths:
+    for (size_t p = 0; p < nbPaths; p++)
+    {
+      size_t k = (site == last) ? 0 : states[p];
+      size_t j = drawCategory_(&cdf[k * nbStates_], nbStates_, generator.drawNumber());
+      states[p] = j;
+      paths[p][site] = j;
+    }
+  }
+}
+
+size_t HmmPathSampler::drawCategory_(const double* cdf, size_t n, double u)
+{
+  size_t j = static_cast<size_t>(upper_bound(cdf, cdf + n, u * cdf[n - 1]) - cdf);
+  return min(j, n - 1);
+}
+
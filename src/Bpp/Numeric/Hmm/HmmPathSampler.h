@@ -0,0 +1,183 @@
+//
+// File: HmmPathSampler.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _HMMPATHSAMPLER_H_
+#define _HMMPATHSAMPLER_H_
+
+#include "RescaledHmmLikelihood.h"
+#include "HmmTransitionKernel.h"
+#include "HmmEmissionProbabilities.h"
+#include "../Random/RandomFactory.h"
+
+// From the STL:
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief Sample hidden state paths from their posterior distribution (forward filtering, backward sampling).
+ *
+ * Given the normalized forward likelihoods @f$\hat{f}_i@f$, the hidden state at the last site of a segment
+ * is drawn from @f$\hat{f}_l@f$, and the state at site i given the state k at site i + 1 from the
+ * distribution proportional to @f$\hat{f}_i(j) p_{j,k}@f$. All paths are drawn in a single backward pass:
+ * at each site, one cumulative distribution is computed for each state present at the next site, and
+ * each path then costs one uniform number and a binary search.
+ *
+ * The forward likelihoods are either those stored by a RescaledHmmLikelihood object, or recomputed
+ * by blocks from checkpoints, which only requires O(l / c + c) memory for a sequence of length l and
+ * checkpoints every c sites, at the cost of one additional forward pass.
+ *
+ * In the first case, the sampler keeps a reference to the likelihood object, which must outlive it.
+ * The forward likelihoods, transition probabilities and break points are read from the likelihood
+ * object each time paths are sampled, so that parameters can change between two samplings.
+ * In the second case, the transition probabilities are read and the checkpoints computed when the
+ * sampler is built: the sampler keeps a reference to the emission probabilities, which must outlive
+ * it and not be modified while it is used.
+ *
+ * This class is part of the HMM framework.
+ */
+  class HmmPathSampler
+  {
+  private:
+    HmmTransitionKernel kernel_;
+    std::vector<double> eqFreqs_;
+
+    /**
+     * @brief Transition probabilities by column: element k * n + j is @f$p_{j,k}@f$.
+     */
+    std::vector<double> transitionsByColumn_;
+
+    const HmmEmissionProbabilities* emissions_;
+    size_t nbStates_, nbSites_;
+    std::vector<size_t> segmentBounds_;
+
+    /**
+     * @brief The likelihood object storing the forward likelihoods, or NULL if they are recomputed from checkpoints.
+     */
+    const RescaledHmmLikelihood* likelihood_;
+
+    size_t checkpointInterval_;
+
+    /**
+     * @brief Forward vectors before the first site of each block, block after block.
+     */
+    std::vector<double> checkpoints_;
+
+    /**
+     * @brief Index of the first block of each segment.
+     */
+    std::vector<size_t> firstBlock_;
+
+  public:
+    /**
+     * @brief Build a sampler using the forward likelihoods stored by a likelihood object.
+     *
+     * @param likelihood The likelihood object, which must outlive the sampler.
+     */
+    HmmPathSampler(const RescaledHmmLikelihood& likelihood);
+
+    /**
+     * @brief Build a sampler storing forward likelihoods at checkpoints only.
+     *
+     * @param transitionMatrix The transition matrix.
+     * @param emissions The emission probabilities, which must not be modified while the sampler is used.
+     * @param breakPoints The positions where the chain is reset, as in HmmLikelihood::setBreakPoints.
+     * @param checkpointInterval The number of sites between two checkpoints.
+     * @throw Exception If the checkpoint interval is null.
+     */
+    HmmPathSampler(const HmmTransitionMatrix& transitionMatrix, const HmmEmissionProbabilities& emissions,
+        const std::vector<size_t>& breakPoints, size_t checkpointInterval);
+
+    HmmPathSampler(const HmmPathSampler& sampler);
+
+    HmmPathSampler& operator=(const HmmPathSampler& sampler);
+
+  public:
+    /**
+     * @brief Draw hidden state paths from their posterior distribution.
+     *
+     * @param nbPaths The number of paths to draw.
+     * @param paths [out] The sampled paths: paths[p][i] is the hidden state of path p at site i.
+     * @param generator The random number generator to use.
+     * @throw Exception If the data have a null likelihood.
+     */
+    void samplePaths(size_t nbPaths, std::vector< std::vector<size_t> >& paths, const RandomFactory& generator) const;
+
+    size_t getCheckpointInterval() const { return checkpointInterval_; }
+
+  private:
+    void init_(const HmmTransitionMatrix& transitionMatrix, const std::vector<size_t>& breakPoints);
+
+    /**
+     * @brief Get the transition probabilities by column: element k * n + j is @f$p_{j,k}@f$.
+     */
+    static void getTransitionsByColumn_(const HmmTransitionMatrix& transitionMatrix, std::vector<double>& transitions);
+
+    /**
+     * @brief Get the bounds of the segments, as in AbstractHmmLikelihood.
+     */
+    static void getSegmentBounds_(const std::vector<size_t>& breakPoints, size_t nbSites, std::vector<size_t>& bounds);
+
+    void computeCheckpoints_();
+
+    /**
+     * @brief One step of the normalized forward recursion.
+     */
+    void forwardStep_(const double* previous, const double* emissions, double* current) const;
+
+    /**
+     * @brief Sample the states of all paths on sites [begin, end[, in decreasing order.
+     *
+     * @param rows The forward likelihoods of sites begin to end - 1.
+     * @param transitions The transition probabilities by column.
+     * @param last The last site of the segment.
+     * @param states [in,out] The states of all paths at site end, replaced by their states at site begin.
+     */
+    void sampleBackward_(const double* rows, const std::vector<double>& transitions, size_t begin, size_t end, size_t last,
+        std::vector<size_t>& states, std::vector< std::vector<size_t> >& paths,
+        std::vector<double>& cdf, const RandomFactory& generator) const;
+
+    /**
+     * @return The index drawn from a cumulative distribution, given a uniform number in [0, 1[.
+     */
+    static size_t drawCategory_(const double* cdf, size_t n, double u);
+  };
+
+} //end of namespace bpp
+
+#endif //_HMMPATHSAMPLER_H_
+
@@ -0,0 +1,318 @@
+//
+// File: HmmTransitionKernel.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "HmmTransitionKernel.h"
+#include "../../Text/TextTools.h"
+#include "../NumTools.h"
+
+// From the STL:
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+HmmTransitionKernel::HmmTransitionKernel(const HmmTransitionMatrix& transitionMatrix) :
+  structure_(transitionMatrix.getStructure()),
+  nbStates_(transitionMatrix.getNumberOfStates()),
+  dense_(), denseT_(), logDense_(), logDenseT_(),
+  diag_(), u_(), v_(), logU_(), logV_(),
+  colStart_(), colIndex_(), rowStart_(), rowIndex_(),
+  colValue_(), logColValue_(), rowValue_(), logRowValue_()
+{
+  switch (structure_)
+  {
+  case HmmTransitionMatrix::DIAGONAL_PLUS_RANK_ONE:
+    transitionMatrix.getDiagonalPlusRankOne(diag_, u_, v_);
+    if (diag_.size() != nbStates_ || u_.size() != nbStates_ || v_.size() != nbStates_)
+      throw Exception("HmmTransitionKernel. Diagonal plus rank one decomposition has wrong dimensions.");
+    logU_.resize(nbStates_);
+    logV_.resize(nbStates_);
+    for (size_t i = 0; i < nbStates_; i++)
+    {
+      if (std::isnan(diag_[i]))
+        throw Exception("HmmTransitionKernel. NaN transition probability");
+      checkProbability_(u_[i]);
+      checkProbability_(v_[i]);
+      checkProbability_(diag_[i] + u_[i] * v_[i]);
+      logU_[i] = log(u_[i]);
+      logV_[i] = log(v_[i]);
+    }
+    break;
+  case HmmTransitionMatrix::BANDED:
+    initCompressed_(transitionMatrix, transitionMatrix.getLowerBandwidth(), transitionMatrix.getUpperBandwidth(), false);
+    break;
+  case HmmTransitionMatrix::SPARSE:
+    initCompressed_(transitionMatrix, nbStates_ - 1, nbStates_ - 1, true);
+    break;
+  default:
+    structure_ = HmmTransitionMatrix::DENSE;
+    initDense_(transitionMatrix);
+  }
+}
+
+/***************************************************************************************************************************/
+
+void HmmTransitionKernel::checkProbability_(double p)
+{
+  if (std::isnan(p))
+    throw Exception("HmmTransitionKernel. NaN transition probability");
+  if (p < 0)
+    throw Exception("HmmTransitionKernel. Negative transition probability: " + TextTools::toString(p));
+}
+
+void HmmTransitionKernel::initDense_(const HmmTransitionMatrix& transitionMatrix)
+{
+  size_t n2 = nbStates_ * nbStates_;
+  dense_.resize(n2);
+  denseT_.resize(n2);
+  logDense_.resize(n2);
+  logDenseT_.resize(n2);
+  for (size_t j = 0; j < nbStates_; j++)
+  {
+    size_t jj = j * nbStates_;
+    for (size_t k = 0; k < nbStates_; k++)
+    {
+      dense_[jj + k] = transitionMatrix.Pij(k, j);
+      denseT_[jj + k] = transitionMatrix.Pij(j, k);
+      checkProbability_(dense_[jj + k]);
+      logDense_[jj + k] = log(dense_[jj + k]);
+      logDenseT_[jj + k] = log(denseT_[jj + k]);
+    }
+  }
+}
+
+void HmmTransitionKernel::initCompressed_(const HmmTransitionMatrix& transitionMatrix, size_t lowerBandwidth, size_t upperBandwidth, bool skipZeros)
+{
+  colStart_.assign(1, 0);
+  rowStart_.assign(1, 0);
+  for (size_t j = 0; j < nbStates_; j++)
+  {
+    //Column j: p_{k,j} is null if k > j + lower or k < j - upper.
+    size_t kmin = j > upperBandwidth ? j - upperBandwidth : 0;
+    size_t kmax = min(nbStates_ - 1, j + lowerBandwidth);
+    for (size_t k = kmin; k <= kmax; k++)
+    {
+      double p = transitionMatrix.Pij(k, j);
+      checkProbability_(p);
+      if (!skipZeros || p > 0)
+      {
+        colIndex_.push_back(k);
+        colValue_.push_back(p);
+        logColValue_.push_back(log(p));
+      }
+    }
+    colStart_.push_back(colIndex_.size());
+
+    //Row j: p_{j,k} is null if k < j - lower or k > j + upper.
+    kmin = j > lowerBandwidth ? j - lowerBandwidth : 0;
+    kmax = min(nbStates_ - 1, j + upperBandwidth);
+    for (size_t k = kmin; k <= kmax; k++)
+    {
+      double p = transitionMatrix.Pij(j, k);
+      if (!skipZeros || p > 0)
+      {
+        rowIndex_.push_back(k);
+        rowValue_.push_back(p);
+        logRowValue_.push_back(log(p));
+      }
+    }
+    rowStart_.push_back(rowIndex_.size());
+  }
+}
+
+/***************************************************************************************************************************/
+
+void HmmTransitionKernel::forward(const double* f, double* x) const
+{
+  switch (structure_)
+  {
+  case HmmTransitionMatrix::DIAGONAL_PLUS_RANK_ONE:
+    rankOneProduct_(diag_, u_, v_, f, x, nbStates_);
+    break;
+  case HmmTransitionMatrix::BANDED:
+  case HmmTransitionMatrix::SPARSE:
+    compressedProduct_(colStart_, colIndex_, colValue_, f, x, nbStates_);
+    break;
+  default:
+    denseProduct_(dense_, f, x, nbStates_);
+  }
+}
+
+void HmmTransitionKernel::backward(const double* b, double* x) const
+{
+  switch (structure_)
+  {
+  case HmmTransitionMatrix::DIAGONAL_PLUS_RANK_ONE:
+    rankOneProduct_(diag_, v_, u_, b, x, nbStates_);
+    break;
+  case HmmTransitionMatrix::BANDED:
+  case HmmTransitionMatrix::SPARSE:
+    compressedProduct_(rowStart_, rowIndex_, rowValue_, b, x, nbStates_);
+    break;
+  default:
+    denseProduct_(denseT_, b, x, nbStates_);
+  }
+}
+
+void HmmTransitionKernel::logForward(const double* lf, double* lx) const
+{
+  switch (structure_)
+  {
+  case HmmTransitionMatrix::DIAGONAL_PLUS_RANK_ONE:
+    logRankOneProduct_(diag_, logU_, logV_, lf, lx, nbStates_);
+    break;
+  case HmmTransitionMatrix::BANDED:
+  case HmmTransitionMatrix::SPARSE:
+    logCompressedProduct_(colStart_, colIndex_, logColValue_, lf, lx, nbStates_);
+    break;
+  default:
+    logDenseProduct_(logDense_, lf, lx, nbStates_);
+  }
+}
+
+void HmmTransitionKernel::logBackward(const double* lb, double* lx) const
+{
+  switch (structure_)
+  {
+  case HmmTransitionMatrix::DIAGONAL_PLUS_RANK_ONE:
+    logRankOneProduct_(diag_, logV_, logU_, lb, lx, nbStates_);
+    break;
+  case HmmTransitionMatrix::BANDED:
+  case HmmTransitionMatrix::SPARSE:
+    logCompressedProduct_(rowStart_, rowIndex_, logRowValue_, lb, lx, nbStates_);
+    break;
+  default:
+    logDenseProduct_(logDenseT_, lb, lx, nbStates_);
+  }
+}
+
+/***************************************************************************************************************************/
+
+void HmmTransitionKernel::denseProduct_(const vector<double>& m, const double* f, double* x, size_t n)
+{
+  for (size_t j = 0; j < n; j++)
+  {
+    size_t jj = j * n;
+    double y = 0;
+    for (size_t k = 0; k < n; k++)
+    {
+      y += m[jj + k] * f[k];
+    }
+    x[j] = y;
+  }
+}
+
+void HmmTransitionKernel::logDenseProduct_(const vector<double>& logM, const double* lf, double* lx, size_t n)
+{
+  for (size_t j = 0; j < n; j++)
+  {
+    lx[j] = NumTools::logSumExpOfSum(&logM[j * n], lf, n);
+  }
+}
+
+void HmmTransitionKernel::compressedProduct_(const vector<size_t>& start, const vector<size_t>& index, const vector<double>& value, const double* f, double* x, size_t n)
+{
+  for (size_t j = 0; j < n; j++)
+  {
+    double y = 0;
+    for (size_t e = start[j]; e < start[j + 1]; e++)
+    {
+      y += value[e] * f[index[e]];
+    }
+    x[j] = y;
+  }
+}
+
+void HmmTransitionKernel::logCompressedProduct_(const vector<size_t>& start, const vector<size_t>& index, const vector<double>& logValue, const double* lf, double* lx, size_t n)
+{
+  for (size_t j = 0; j < n; j++)
+  {
+    double m = -numeric_limits<double>::infinity();
+    for (size_t e = start[j]; e < start[j + 1]; e++)
+    {
+      m = max(m, logValue[e] + lf[index[e]]);
+    }
+    if (std::isinf(m))
+    {
+      lx[j] = m;
+      continue;
+    }
+    double y = 0;
+    for (size_t e = start[j]; e < start[j + 1]; e++)
+    {
+      y += exp(logValue[e] + lf[index[e]] - m);
+    }
+    lx[j] = m + log(y);
+  }
+}
+
+void HmmTransitionKernel::rankOneProduct_(const vector<double>& d, const vector<double>& a, const vector<double>& b, const double* f, double* x, size_t n)
+{
+  //x_j = d_j f_j + b_j sum_k a_k f_k
+  double s = 0;
+  for (size_t k = 0; k < n; k++)
+  {
+    s += a[k] * f[k];
+  }
+  for (size_t j = 0; j < n; j++)
+  {
+    x[j] = d[j] * f[j] + b[j] * s;
+  }
+}
+
+void HmmTransitionKernel::logRankOneProduct_(const vector<double>& d, const vector<double>& logA, const vector<double>& logB, const double* lf, double* lx, size_t n)
+{
+  //log(sum_k a_k f_k):
+  double ls = NumTools::logSumExpOfSum(&logA[0], lf, n);
+
+  //lx_j = log(d_j f_j + b_j s), where d_j may be negative:
+  for (size_t j = 0; j < n; j++)
+  {
+    double r = logB[j] + ls;
+    double mj = (d[j] == 0) ? r : max(lf[j], r);
+    if (std::isinf(mj))
+    {
+      lx[j] = -numeric_limits<double>::infinity();
+      continue;
+    }
+    double y = d[j] * exp(lf[j] - mj) + exp(r - mj);
+    lx[j] = (y > 0) ? mj + log(y) : -numeric_limits<double>::infinity();
+  }
+}
+
@@ -0,0 +1,138 @@
+//
+// File: HmmTransitionKernel.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _HMMTRANSITIONKERNEL_H_
+#define _HMMTRANSITIONKERNEL_H_
+
+#include "HmmTransitionMatrix.h"
+
+// From the STL:
+#include <vector>
+
+namespace bpp
+{
+
+/**
+ * @brief Products of vectors with a transition matrix, for the forward and backward recursions.
+ *
+ * The kernel takes a snapshot of a HmmTransitionMatrix and stores it in a form suited
+ * to its structure (see HmmTransitionMatrix::getStructure):
+ * - DENSE matrices are stored row-wise and column-wise, and each product costs O(n^2),
+ * - DIAGONAL_PLUS_RANK_ONE matrices are stored as their decomposition, and each product costs O(n),
+ * - BANDED and SPARSE matrices are stored in compressed rows and columns, and each product
+ *   costs O(number of non-null entries).
+ *
+ * All transition probabilities are checked when the kernel is built. The kernel is not updated
+ * when the transition matrix changes: it has to be rebuilt.
+ *
+ * All methods are const and can be called concurrently.
+ *
+ * This class is part of the HMM framework.
+ */
+  class HmmTransitionKernel
+  {
+  private:
+    HmmTransitionMatrix::Structure structure_;
+    size_t nbStates_;
+
+    // Dense storage: dense_[j * n + k] = p_{k,j}, denseT_[j * n + k] = p_{j,k}
+    std::vector<double> dense_, denseT_, logDense_, logDenseT_;
+
+    // Diagonal plus rank one storage: p_{i,j} = d_i delta_{i,j} + u_i v_j
+    std::vector<double> diag_, u_, v_, logU_, logV_;
+
+    // Compressed storage, by column and by row:
+    std::vector<size_t> colStart_, colIndex_, rowStart_, rowIndex_;
+    std::vector<double> colValue_, logColValue_, rowValue_, logRowValue_;
+
+  public:
+    /**
+     * @brief Build the kernel of a transition matrix.
+     *
+     * @param transitionMatrix The transition matrix.
+     * @throw Exception If a transition probability is negative or NaN.
+     */
+    HmmTransitionKernel(const HmmTransitionMatrix& transitionMatrix);
+
+  public:
+    HmmTransitionMatrix::Structure getStructure() const { return structure_; }
+
+    size_t getNumberOfStates() const { return nbStates_; }
+
+    /**
+     * @brief Propagate a vector forward: @f$x_j = \sum_k p_{k,j} f_k@f$.
+     *
+     * @param f Input vector, of size n.
+     * @param x Output vector, of size n. Must not overlap with f.
+     */
+    void forward(const double* f, double* x) const;
+
+    /**
+     * @brief Propagate a vector backward: @f$x_j = \sum_k p_{j,k} b_k@f$.
+     *
+     * @param b Input vector, of size n.
+     * @param x Output vector, of size n. Must not overlap with b.
+     */
+    void backward(const double* b, double* x) const;
+
+    /**
+     * @brief Same as forward, with all vectors in log scale.
+     */
+    void logForward(const double* lf, double* lx) const;
+
+    /**
+     * @brief Same as backward, with all vectors in log scale.
+     */
+    void logBackward(const double* lb, double* lx) const;
+
+  private:
+    void initDense_(const HmmTransitionMatrix& transitionMatrix);
+    void initCompressed_(const HmmTransitionMatrix& transitionMatrix, size_t lowerBandwidth, size_t upperBandwidth, bool skipZeros);
+
+    static void compressedProduct_(const std::vector<size_t>& start, const std::vector<size_t>& index, const std::vector<double>& value, const double* f, double* x, size_t n);
+    static void logCompressedProduct_(const std::vector<size_t>& start, const std::vector<size_t>& index, const std::vector<double>& logValue, const double* lf, double* lx, size_t n);
+    static void denseProduct_(const std::vector<double>& m, const double* f, double* x, size_t n);
+    static void logDenseProduct_(const std::vector<double>& logM, const double* lf, double* lx, size_t n);
+    static void rankOneProduct_(const std::vector<double>& d, const std::vector<double>& a, const std::vector<double>& b, const double* f, double* x, size_t n);
+    static void logRankOneProduct_(const std::vector<double>& d, const std::vector<double>& logA, const std::vector<double>& logB, const double* lf, double* lx, size_t n);
+    static void checkProbability_(double p);
+  };
+
+} //end of namespace bpp
+
+#endif //_HMMTRANSITIONKERNEL_H_
+
@@ -55,10 +55,31 @@ namespace bpp
  * @brief Describe the transition probabilities between hidden states of a Hidden Markov Model.
  *
  * This class is part of the HMM framework.
+ *
+ * Implementations can declare a particular structure of the matrix (see getStructure), which
+ * likelihood computations use to perform each step of the recursions in less than O(n^2)
+ * operations, n being the number of hidden states.
  */
   class HmmTransitionMatrix:
     public virtual Parametrizable
   {
+  public:
+    /**
+     * @brief Structure of the transition matrix.
+     *
+     * - DENSE: no particular structure.
+     * - DIAGONAL_PLUS_RANK_ONE: @f$p_{i,j} = d_i \delta_{i,j} + u_i v_j@f$, see getDiagonalPlusRankOne.
+     * - BANDED: @f$p_{i,j} = 0@f$ if @f$j < i - l@f$ or @f$j > i + u@f$, see getLowerBandwidth and getUpperBandwidth.
+     * - SPARSE: most entries are zero.
+     */
+    enum Structure
+    {
+      DENSE = 0,
+      DIAGONAL_PLUS_RANK_ONE = 1,
+      BANDED = 2,
+      SPARSE = 3
+    };
+
   public:
 
     /**
@@ -100,6 +121,44 @@ namespace bpp
      */
     virtual const std::vector<double>& getEquilibriumFrequencies() const = 0;
 
+    /**
+     * @return The structure of the matrix. Default is DENSE.
+     */
+    virtual Structure getStructure() const { return DENSE; }
+
+    /**
+     * @brief Get the decomposition of a DIAGONAL_PLUS_RANK_ONE matrix.
+     *
+     * @param d [out] The diagonal part.
+     * @param u [out] The row factor of the rank one part.
+     * @param v [out] The column factor of the rank one part.
+     */
+    virtual void getDiagonalPlusRankOne(std::vector<double>& d, std::vector<double>& u, std::vector<double>& v) const
+    {
+      throw NotImplementedException("HmmTransitionMatrix::getDiagonalPlusRankOne. Matrix is not diagonal plus rank one.");
+    }
+
+    /**
+     * @return The number of non-null diagonals below the main one, for BANDED matrices.
+     */
+    virtual size_t getLowerBandwidth() const { return getNumberOfStates() - 1; }
+
+    /**
+     * @return The number of non-null diagonals above the main one, for BANDED matrices.
+     */
+    virtual size_t getUpperBandwidth() const { return getNumberOfStates() - 1; }
+
+    /**
+     * @brief Get the derivatives of all transition probabilities and
+     * equilibrium frequencies with respect to a parameter.
+     *
+     * @param variable The full name of the parameter.
+     * @param dPij [out] A n*n matrix with the derivatives of the transition probabilities.
+     * @param dEqFreqs [out] The derivatives of the equilibrium frequencies.
+     * Both are null if the matrix does not depend on the parameter.
+     */
+    virtual void getDPij(const std::string& variable, RowMatrix<double>& dPij, std::vector<double>& dEqFreqs) const = 0;
+
   };
 
 } //end of namespace bpp
@@ -42,6 +42,9 @@ knowledge of the CeCILL license and that you accept its terms.
 // from the STL:
 #include <iostream>
 #include <algorithm>
+
+#include "../NumConstants.h"
+
 using namespace bpp;
 using namespace std;
 
@@ -66,6 +69,7 @@ LogsumHmmLikelihood::LogsumHmmLikelihood(
   partialD2LogLikelihoods_(),
   backLogLikelihood_(),
   backLogLikelihoodUpToDate_(false),
+  backValidFrom_(),
   breakPoints_(),
   nbStates_(),
   nbSites_()
@@ -89,6 +93,8 @@ LogsumHmmLikelihood::LogsumHmmLikelihood(
   //Init arrays:
   logLikelihood_.resize(nbSites_ * nbStates_);
 
+  updateSegments_(breakPoints_, nbSites_);
+
   //Compute:
   computeForward_();
 }
@@ -104,8 +110,7 @@ void LogsumHmmLikelihood::setNamespace(const std::string& nameSpace)
 
 void LogsumHmmLikelihood::fireParameterChanged(const ParameterList& pl)
 {
-  dVariable_="";
-  d2Variable_="";
+  resetDerivatives_();
 
   bool alphabetChanged    = hiddenAlphabet_->matchParametersValues(pl);
   bool transitionsChanged = transitionMatrix_->matchParametersValues(pl);
@@ -117,7 +122,11 @@ void LogsumHmmLikelihood::fireParameterChanged(const ParameterList& pl)
   if (alphabetChanged && !emissionChanged) emissionProbabilities_->setParametersValues(emissionProbabilities_->getParameters());
 
   backLogLikelihoodUpToDate_=false;
-  computeLikelihood();
+  vector<size_t> firstDirty, lastDirty;
+  if (emissionChanged && !alphabetChanged && !transitionsChanged && getDirtyRanges_(firstDirty, lastDirty))
+    updateForward_(firstDirty, lastDirty);
+  else
+    computeLikelihood();
 }
 
 void LogsumHmmLikelihood::computeLikelihood()
@@ -129,96 +138,105 @@ void LogsumHmmLikelihood::computeLikelihood()
 
 void LogsumHmmLikelihood::computeForward_()
 {
-  double x, a;
-  vector<double> logTrans(nbStates_ * nbStates_);
-
   //Transition probabilities:
-  for (size_t i = 0; i < nbStates_; i++)
+  HmmTransitionKernel kernel(*transitionMatrix_);
+  vector<double> logEqFreqs = VectorTools::log(transitionMatrix_->getEquilibriumFrequencies());
+
+  //Segments are independent:
+  partialLogLikelihoods_.resize(getNumberOfSegments());
+  forEachSegment_([&](size_t s) {
+      partialLogLikelihoods_[s] = computeForward_(kernel, logEqFreqs, segmentBounds_[s], segmentBounds_[s + 1]);
+    });
+  //Transitions may have changed, and so did all backward log likelihoods:
+  backValidFrom_.clear();
+
+  //Compute likelihood:
+  logLik_ = 0;
+  vector<double> copy = partialLogLikelihoods_; //We need to keep the original order for posterior decoding.
+  sort(copy.begin(), copy.end());
+  for (size_t i = copy.size(); i > 0; --i)
+    logLik_ += copy[i - 1];
+}
+
+double LogsumHmmLikelihood::computeForward_(const HmmTransitionKernel& kernel, const vector<double>& logEqFreqs, size_t begin, size_t end)
+{
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin, end);
+  for (size_t i = begin; i < end; i++)
   {
     size_t ii = i * nbStates_;
+    //The markov chain starts from the equilibrium frequencies:
+    const double* previous = (i == begin) ? &logEqFreqs[0] : &logLikelihood_[ii - nbStates_];
+    const double* emissions = emissionBuffer(i);
+    kernel.logForward(previous, &logLikelihood_[ii]);
     for (size_t j = 0; j < nbStates_; j++)
-      logTrans[ii + j] = log(transitionMatrix_->Pij(j, i));
+    {
+      logLikelihood_[ii + j] += log(emissions[j]);
+    }
   }
 
-  //Initialisation:
-  const vector<double>* emissions = &(* emissionProbabilities_)(0);
+  //Termination:
+  return NumTools::logSumExp(&logLikelihood_[(end - 1) * nbStates_], nbStates_);
+}
 
-  for (size_t j = 0; j < nbStates_; j++)
-  {
-    size_t jj = j * nbStates_;
-    x = logTrans[jj] + log(transitionMatrix_->getEquilibriumFrequencies()[0]);
+/***************************************************************************************************************************/
 
-    for (size_t k = 1; k < nbStates_; k++)
-    {
-      a = logTrans[k + jj] + log(transitionMatrix_->getEquilibriumFrequencies()[k]);
-      x = NumTools::logsum(x, a);
-    }
+void LogsumHmmLikelihood::updateForward_(const vector<size_t>& firstDirty, const vector<size_t>& lastDirty)
+{
+  HmmTransitionKernel kernel(*transitionMatrix_);
+  vector<double> logEqFreqs = VectorTools::log(transitionMatrix_->getEquilibriumFrequencies());
+
+  forEachSegment_([&](size_t s) {
+      if (firstDirty[s] < segmentBounds_[s + 1])
+        partialLogLikelihoods_[s] = updateForward_(kernel, logEqFreqs, segmentBounds_[s], firstDirty[s], lastDirty[s], segmentBounds_[s + 1]);
+    });
 
-    logLikelihood_[j] = log((*emissions)[j]) + x;
+  //Backward log likelihoods only depend on the emissions after each site:
+  for (size_t s = 0; s < backValidFrom_.size(); s++)
+  {
+    if (firstDirty[s] < segmentBounds_[s + 1])
+      backValidFrom_[s] = max(backValidFrom_[s], lastDirty[s] - 1);
   }
- 
-  //Recursion:
-  size_t nextBrkPt = nbSites_; //next break point
-  vector<size_t>::const_iterator bpIt = breakPoints_.begin();
-  if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-  partialLogLikelihoods_.clear();
- 
-  for (size_t i = 1; i < nbSites_; i++)
+
+  logLik_ = 0;
+  vector<double> copy = partialLogLikelihoods_;
+  sort(copy.begin(), copy.end());
+  for (size_t i = copy.size(); i > 0; --i)
+    logLik_ += copy[i - 1];
+}
+
+double LogsumHmmLikelihood::updateForward_(const HmmTransitionKernel& kernel, const vector<double>& logEqFreqs, size_t begin, size_t first, size_t last, size_t end)
+{
+  vector<double> tmp(nbStates_);
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, first, end);
+
+  for (size_t i = first; i < end; i++)
   {
     size_t ii = i * nbStates_;
-    size_t iip = (i - 1) * nbStates_;
-    emissions = &(*emissionProbabilities_)(i);
-    if (i < nextBrkPt)
+    const double* previous = (i == begin) ? &logEqFreqs[0] : &logLikelihood_[ii - nbStates_];
+    const double* emissions = emissionBuffer(i);
+    kernel.logForward(previous, &tmp[0]);
+    double minShift = 0, maxShift = 0;
+    for (size_t j = 0; j < nbStates_; j++)
     {
-      for (size_t j = 0; j < nbStates_; j++)
-      {
-        size_t jj = j * nbStates_;
-        x = logTrans[jj] + logLikelihood_[iip];
-        for (size_t k = 1; k < nbStates_; k++)
-        {
-          a = logTrans[jj + k] + logLikelihood_[iip + k];
-          x = NumTools::logsum(x, a);
-        }
-        logLikelihood_[ii + j] = log((*emissions)[j]) + x;
-      }
+      tmp[j] += log(emissions[j]);
+      double shift = tmp[j] - logLikelihood_[ii + j];
+      minShift = (j == 0) ? shift : min(minShift, shift);
+      maxShift = (j == 0) ? shift : max(maxShift, shift);
+      logLikelihood_[ii + j] = tmp[j];
     }
-    else //Reset markov chain:
-    {
-      //Termination of previous segment:
-      double tmpLog = logLikelihood_[(i - 1) * nbStates_];
-      for (size_t k = 1; k < nbStates_; k++)
-        tmpLog = NumTools::logsum(tmpLog, logLikelihood_[(i - 1) * nbStates_ + k]);
-      partialLogLikelihoods_.push_back(tmpLog);
 
-      for (size_t j = 0; j < nbStates_; j++)
-      {
-        size_t jj = j * nbStates_;
-        x = logTrans[jj] + log(transitionMatrix_->getEquilibriumFrequencies()[0]);
-        for (size_t k = 1; k < nbStates_; k++)
-        {
-          a = logTrans[jj + k] + log(transitionMatrix_->getEquilibriumFrequencies()[k]);
-          x = NumTools::logsum(x, a);
-        }
-        logLikelihood_[ii + j] = log((*emissions)[j]) + x;
-      }
-      bpIt++;
-      if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-      else nextBrkPt = nbSites_;
+    //The following sites are only shifted:
+    if (i >= last && maxShift - minShift <= NumConstants::TINY())
+    {
+      double shift = (minShift + maxShift) / 2.;
+      for (size_t k = ii + nbStates_; k < end * nbStates_; k++)
+        logLikelihood_[k] += shift;
+      break;
     }
   }
 
   //Termination:
-  double tmpLog = logLikelihood_[(nbSites_ - 1) * nbStates_];
-  for (size_t k = 1; k < nbStates_; k++)
-    tmpLog = NumTools::logsum(tmpLog, logLikelihood_[(nbSites_ - 1) * nbStates_ + k]);
-  partialLogLikelihoods_.push_back(tmpLog);
-  
-  //Compute likelihood:
-  logLik_ = 0;
-  vector<double> copy = partialLogLikelihoods_; //We need to keep the original order for posterior decoding.
-  sort(copy.begin(), copy.end());
-  for (size_t i = copy.size(); i > 0; --i)
-    logLik_ += copy[i - 1];
+  return NumTools::logSumExp(&logLikelihood_[(end - 1) * nbStates_], nbStates_);
 }
 
 /***************************************************************************************************************************/
@@ -232,59 +250,44 @@ void LogsumHmmLikelihood::computeBackward_() const
       backLogLikelihood_[i].resize(nbStates_);
   }
   
-  double x;
-
   //Transition probabilities:
-  vector<double> logTrans(nbStates_ * nbStates_);
-  for (size_t i = 0; i < nbStates_; i++)
-  {
-    size_t ii = i * nbStates_;
-    for (size_t j = 0; j < nbStates_; j++)
-      logTrans[ii + j] = log(transitionMatrix_->Pij(i, j));
-  }
+  HmmTransitionKernel kernel(*transitionMatrix_);
+
+  forEachSegment_([&](size_t s) {
+      size_t validFrom = backValidFrom_.empty() ? segmentBounds_[s + 1] : backValidFrom_[s];
+      computeBackward_(kernel, segmentBounds_[s], validFrom, segmentBounds_[s + 1]);
+    });
 
+  backValidFrom_.assign(segmentBounds_.begin(), segmentBounds_.end() - 1);
+
+  backLogLikelihoodUpToDate_=true;
+}
+
+void LogsumHmmLikelihood::computeBackward_(const HmmTransitionKernel& kernel, size_t begin, size_t validFrom, size_t end) const
+{
+  vector<double> next(nbStates_);
 
   //Initialisation:
-  const vector<double>* emissions = 0;
-  size_t nextBrkPt = 0; //next break point
-  vector<size_t>::const_reverse_iterator bpIt = breakPoints_.rbegin();
-  if (bpIt != breakPoints_.rend()) nextBrkPt = *bpIt;
-  
-  for (size_t k = 0; k < nbStates_; k++)
+  if (validFrom == end)
   {
-    backLogLikelihood_[nbSites_ - 1][k] = 0.;
+    validFrom = end - 1;
+    for (size_t k = 0; k < nbStates_; k++)
+    {
+      backLogLikelihood_[end - 1][k] = 0.;
+    }
   }
 
   //Recursion:
-  for (size_t i = nbSites_ - 1; i > 0; i--)
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin + 1, validFrom + 1, true);
+  for (size_t i = validFrom; i > begin; i--)
   {
-    emissions = &(*emissionProbabilities_)(i);
-    if (i > nextBrkPt)
+    const double* emissions = emissionBuffer(i);
+    for (size_t k = 0; k < nbStates_; k++)
     {
-      for (size_t j = 0; j < nbStates_; j++)
-      {
-        size_t jj = j * nbStates_;
-        x = log((*emissions)[0]) + logTrans[jj] + backLogLikelihood_[i][0];
-        for (size_t k = 1; k < nbStates_; k++)
-        {
-          x = NumTools::logsum(x, log((*emissions)[k]) + logTrans[jj + k] + backLogLikelihood_[i][k]);
-        }
-        backLogLikelihood_[i - 1][j] = x;
-      }    
-    }
-    else //Reset markov chain
-    {
-      for (unsigned int j = 0; j < nbStates_; j++)
-      {
-        backLogLikelihood_[i - 1][j] = 0.;
-      }    
-      bpIt++;
-      if (bpIt != breakPoints_.rend()) nextBrkPt = *bpIt;
-      else nextBrkPt = 0;
+      next[k] = log(emissions[k]) + backLogLikelihood_[i][k];
     }
+    kernel.logBackward(&next[0], &backLogLikelihood_[i - 1][0]);
   }
-
-  backLogLikelihoodUpToDate_=true;
 }
 
 
@@ -326,20 +329,10 @@ Vdouble LogsumHmmLikelihood::getHiddenStatesPosteriorProbabilitiesForASite(size_
 
   Vdouble probs(nbStates_);
   
-  vector<size_t>::const_iterator bpIt = breakPoints_.begin();
-  vector<double>::const_iterator logLikIt = partialLogLikelihoods_.begin();
-  while (bpIt != breakPoints_.end())
-  {
-    if (site>=(*bpIt))
-      logLikIt++;
-    else
-      break;
-    bpIt++;
-  }
-
+  double segLogLik = partialLogLikelihoods_[getSegmentIndex_(site)];
   for (size_t j = 0; j < nbStates_; j++)
   {
-    probs[j] = exp(logLikelihood_[site * nbStates_ + j] + backLogLikelihood_[site][j] - *logLikIt);
+    probs[j] = exp(logLikelihood_[site * nbStates_ + j] + backLogLikelihood_[site][j] - segLogLik);
   }
 
   return probs;
@@ -357,25 +350,73 @@ void LogsumHmmLikelihood::getHiddenStatesPosteriorProbabilities(std::vector< std
   if (!backLogLikelihoodUpToDate_)
     computeBackward_();
  
-  size_t nextBrkPt = nbSites_; //next break point
-  vector<size_t>::const_iterator bpIt = breakPoints_.begin();
-  if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
- 
-  vector<double>::const_iterator logLikIt = partialLogLikelihoods_.begin();
-  for (size_t i = 0; i < nbSites_; i++)
+  forEachSegment_([&](size_t s) {
+      double segLogLik = partialLogLikelihoods_[s];
+      for (size_t i = segmentBounds_[s]; i < segmentBounds_[s + 1]; i++)
+      {
+        size_t ii = i * nbStates_;
+        for (size_t j = 0; j < nbStates_; j++)
+        {
+          probs[offset + i][j] = exp(logLikelihood_[ii + j] + backLogLikelihood_[i][j] - segLogLik);
+        }
+      }
+    });
+}
+
+void LogsumHmmLikelihood::computeDLogLikelihoodDTransitions_(std::vector<double>& dTransitions, std::vector<double>& dInitFreqs) const
+{
+  if (!backLogLikelihoodUpToDate_)
+    computeBackward_();
+
+  HmmTransitionKernel kernel(*transitionMatrix_);
+  const vector<double>& eqFreqs = transitionMatrix_->getEquilibriumFrequencies();
+  vector<double> logEqFreqs(nbStates_);
+  for (size_t k = 0; k < nbStates_; k++)
   {
-    if (i == nextBrkPt) {
-      logLikIt++;
-      bpIt++;
-      if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-      else nextBrkPt = nbSites_;
-    }
+    logEqFreqs[k] = log(eqFreqs[k]);
+  }
+  size_t nbSegments = getNumberOfSegments();
+  vector< vector<double> > segDTransitions(nbSegments), segDInitFreqs(nbSegments);
+
+  forEachSegment_([&](size_t s) {
+      vector<double>& d = segDTransitions[s];
+      d.assign(nbStates_ * nbStates_, 0.);
+      segDInitFreqs[s].assign(nbStates_, 0.);
+      vector<double> next(nbStates_);
+      double segLogLik = partialLogLikelihoods_[s];
+      HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, segmentBounds_[s], segmentBounds_[s + 1]);
+      for (size_t i = segmentBounds_[s]; i < segmentBounds_[s + 1]; i++)
+      {
+        const double* emissions = emissionBuffer(i);
+        for (size_t k = 0; k < nbStates_; k++)
+        {
+          next[k] = log(emissions[k]) + backLogLikelihood_[i][k] - segLogLik;
+        }
+        //The first site of a segment is reached by a transition from the initial frequencies:
+        const double* previous = (i == segmentBounds_[s]) ? &logEqFreqs[0] : &logLikelihood_[(i - 1) * nbStates_];
+        for (size_t j = 0; j < nbStates_; j++)
+        {
+          for (size_t k = 0; k < nbStates_; k++)
+            d[j * nbStates_ + k] += exp(previous[j] + next[k]);
+        }
+        if (i == segmentBounds_[s])
+        {
+          kernel.logBackward(&next[0], &segDInitFreqs[s][0]);
+          for (size_t k = 0; k < nbStates_; k++)
+            segDInitFreqs[s][k] = exp(segDInitFreqs[s][k]);
+        }
+      }
+    });
 
-    size_t ii = i * nbStates_;
-    for (size_t j = 0; j < nbStates_; j++)
-    {
-      probs[offset + i][j] = exp(logLikelihood_[ii + j] + backLogLikelihood_[i][j] - *logLikIt);
-    }
+  //Sum over segments in a fixed order:
+  dTransitions.assign(nbStates_ * nbStates_, 0.);
+  dInitFreqs.assign(nbStates_, 0.);
+  for (size_t s = 0; s < nbSegments; s++)
+  {
+    for (size_t x = 0; x < dTransitions.size(); x++)
+      dTransitions[x] += segDTransitions[s][x];
+    for (size_t k = 0; k < nbStates_; k++)
+      dInitFreqs[k] += segDInitFreqs[s][k];
   }
 }
 
@@ -390,79 +431,70 @@ void LogsumHmmLikelihood::computeDForward_() const
       dLogLikelihood_[i].resize(nbStates_);
   }
 
-  partialDLogLikelihoods_.clear();
+  //Transition probabilities:
+  HmmTransitionKernel kernel(*transitionMatrix_);
 
-  vector<double> num(nbStates_), num2(nbStates_);
+  partialDLogLikelihoods_.resize(getNumberOfSegments());
+  forEachSegment_([&](size_t s) {
+      partialDLogLikelihoods_[s] = computeDForward_(kernel, segmentBounds_[s], segmentBounds_[s + 1]);
+    });
 
-  //Transition probabilities:
-  const ColMatrix<double> trans(transitionMatrix_->getPij());
+  //Compute dLogLikelihood
+  
+  dLogLik_ = 0;
+  vector<double> copy = partialDLogLikelihoods_; //We need to keep the original order for posterior decoding.
+  sort(copy.begin(), copy.end());
+  for (size_t i = copy.size(); i > 0; --i)
+    dLogLik_ += copy[i - 1];
+}
+
+double LogsumHmmLikelihood::computeDForward_(const HmmTransitionKernel& kernel, size_t begin, size_t end) const
+{
+  vector<double> num(nbStates_);
+  vector<double> a(nbStates_), b(nbStates_), propA(nbStates_), propB(nbStates_);
 
   //Initialisation:
-  const vector<double>* emissions = &(*emissionProbabilities_)(0);
-  const vector<double>* dEmissions = &emissionProbabilities_->getDEmissionProbabilities(0);
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin, end);
+  const double* emissions = emissionBuffer(begin);
+  const vector<double>* dEmissions = &emissionProbabilities_->getDEmissionProbabilities(begin);
 
   for (size_t j = 0; j < nbStates_; j++)
-    dLogLikelihood_[0][j] = (*dEmissions)[j] / (*emissions)[j];
+    dLogLikelihood_[begin][j] = (*dEmissions)[j] / emissions[j];
 
   //Recursion:
-  size_t nextBrkPt = nbSites_; //next break point
-  vector<size_t>::const_iterator bpIt = breakPoints_.begin();
-  if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-  partialDLogLikelihoods_.clear();
- 
-  for (size_t i = 1; i < nbSites_; i++)
+  for (size_t i = begin + 1; i < end; i++)
   {
     size_t iip = (i - 1) * nbStates_;
 
-    emissions = &(*emissionProbabilities_)(i);
+    emissions = emissionBuffer(i);
     dEmissions = &emissionProbabilities_->getDEmissionProbabilities(i);
 
     for (size_t kp = 0; kp < nbStates_; kp++)
       num[kp]=logLikelihood_[iip+kp];
 
-    num-=num[VectorTools::whichMax(num)];
+    num-=VectorTools::max(num);
 
-    if (i < nextBrkPt)
+    for (size_t k = 0; k < nbStates_; k++)
     {
-      for (size_t j = 0; j < nbStates_; j++)
-      {
-        num2=dLogLikelihood_[i-1]*trans.getCol(j);
+      b[k] = exp(num[k]);
+      a[k] = b[k] * dLogLikelihood_[i-1][k];
+    }
+    kernel.forward(&a[0], &propA[0]);
+    kernel.forward(&b[0], &propB[0]);
 
-        dLogLikelihood_[i][j] = (*dEmissions)[j]/(*emissions)[j] + VectorTools::sumExp(num,num2)/VectorTools::sumExp(num,trans.getCol(j));
-      }
-    }      
-    else //Reset markov chain:
+    for (size_t j = 0; j < nbStates_; j++)
     {
-      //Termination of previous segment
-
-      partialDLogLikelihoods_.push_back(VectorTools::sumExp(num,dLogLikelihood_[i-1])/VectorTools::sumExp(num));
-
-      for (size_t j = 0; j < nbStates_; j++)
-        dLogLikelihood_[i][j] = (*dEmissions)[j] / (*emissions)[j];
-      
-      bpIt++;
-      if (bpIt != breakPoints_.end())
-        nextBrkPt = *bpIt;
-      else
-        nextBrkPt = nbSites_;
+      dLogLikelihood_[i][j] = (*dEmissions)[j]/emissions[j] + propA[j]/propB[j];
     }
   }
   
   //Termination:
   for (size_t kp = 0; kp < nbStates_; kp++)
-    num[kp]=logLikelihood_[nbStates_*(nbSites_-1)+kp];
+    num[kp]=logLikelihood_[nbStates_*(end-1)+kp];
 
-  num-=num[VectorTools::whichMax(num)];
+  num-=VectorTools::max(num);
             
-  partialDLogLikelihoods_.push_back(VectorTools::sumExp(num,dLogLikelihood_[nbSites_-1])/VectorTools::sumExp(num));
-
-  //Compute dLogLikelihood
-  
-  dLogLik_ = 0;
-  vector<double> copy = partialDLogLikelihoods_; //We need to keep the original order for posterior decoding.
-  sort(copy.begin(), copy.end());
-  for (size_t i = copy.size(); i > 0; --i)
-    dLogLik_ += copy[i - 1];
+  return VectorTools::sumExp(num,dLogLikelihood_[end-1])/VectorTools::sumExp(num);
 }
 
 double LogsumHmmLikelihood::getDLogLikelihoodForASite(size_t site) const
@@ -484,93 +516,81 @@ void LogsumHmmLikelihood::computeD2Forward_() const
       d2LogLikelihood_[i].resize(nbStates_);
   }
 
-  partialD2LogLikelihoods_.clear();
-  
-  vector<double> num(nbStates_),num2(nbStates_),num3(nbStates_);
-  
   //Transition probabilities:
-  const ColMatrix<double> trans(transitionMatrix_->getPij());
+  HmmTransitionKernel kernel(*transitionMatrix_);
+
+  partialD2LogLikelihoods_.resize(getNumberOfSegments());
+  forEachSegment_([&](size_t s) {
+      partialD2LogLikelihoods_[s] = computeD2Forward_(kernel, segmentBounds_[s], segmentBounds_[s + 1]);
+    });
+
+  //Compute d2LogLikelihood
+  
+  d2LogLik_ = 0;
+  vector<double> copy = partialD2LogLikelihoods_; //We need to keep the original order for posterior decoding.
+  sort(copy.begin(), copy.end());
+  for (size_t i = copy.size(); i > 0; --i)
+    d2LogLik_ += copy[i - 1];
+}
+
+double LogsumHmmLikelihood::computeD2Forward_(const HmmTransitionKernel& kernel, size_t begin, size_t end) const
+{
+  vector<double> num(nbStates_),num2(nbStates_);
+  vector<double> a(nbStates_), b(nbStates_), c(nbStates_), propA(nbStates_), propB(nbStates_), propC(nbStates_);
   
   //Initialisation:
-  const vector<double>* emissions = &(*emissionProbabilities_)(0);
-  const vector<double>* dEmissions = &emissionProbabilities_->getDEmissionProbabilities(0);
-  const vector<double>* d2Emissions = &emissionProbabilities_->getD2EmissionProbabilities(0);
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin, end);
+  const double* emissions = emissionBuffer(begin);
+  const vector<double>* dEmissions = &emissionProbabilities_->getDEmissionProbabilities(begin);
+  const vector<double>* d2Emissions = &emissionProbabilities_->getD2EmissionProbabilities(begin);
   
   for (size_t j = 0; j < nbStates_; j++)
-    d2LogLikelihood_[0][j] = (*d2Emissions)[j] / (*emissions)[j] - pow((*dEmissions)[j] / (*emissions)[j],2);
+    d2LogLikelihood_[begin][j] = (*d2Emissions)[j] / emissions[j] - pow((*dEmissions)[j] / emissions[j],2);
 
   //Recursion:
-  size_t nextBrkPt = nbSites_; //next break point
-  vector<size_t>::const_iterator bpIt = breakPoints_.begin();
-  if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-  partialDLogLikelihoods_.clear();
- 
-  for (size_t i = 1; i < nbSites_; i++)
+  for (size_t i = begin + 1; i < end; i++)
   {
     size_t iip = (i - 1) * nbStates_;
 
-    emissions = &(*emissionProbabilities_)(i);
+    emissions = emissionBuffer(i);
     dEmissions = &emissionProbabilities_->getDEmissionProbabilities(i);
     d2Emissions = &emissionProbabilities_->getD2EmissionProbabilities(i);
 
     for (size_t kp = 0; kp < nbStates_; kp++)
       num[kp]=logLikelihood_[iip+kp];
 
-    num-=num[VectorTools::whichMax(num)];
+    num-=VectorTools::max(num);
 
-    if (i < nextBrkPt)
+    for (size_t k = 0; k < nbStates_; k++)
     {
-      for (size_t j = 0; j < nbStates_; j++)
-      {
-        double den=VectorTools::sumExp(num,trans.getCol(j));
-
-        num2=dLogLikelihood_[i-1]*trans.getCol(j);
-
-        num3=(dLogLikelihood_[i-1]*dLogLikelihood_[i-1]+d2LogLikelihood_[i-1])*trans.getCol(j);
-
-        d2LogLikelihood_[i][j] =  VectorTools::sumExp(num,num3)/den - pow(VectorTools::sumExp(num,num2)/den,2);
-      }
+      b[k] = exp(num[k]);
+      a[k] = b[k] * dLogLikelihood_[i-1][k];
+      c[k] = b[k] * (dLogLikelihood_[i-1][k] * dLogLikelihood_[i-1][k] + d2LogLikelihood_[i-1][k]);
     }
-    else //Reset markov chain:
-    {
-      //Termination of previous segment:
-
-      double den=VectorTools::sumExp(num);
+    kernel.forward(&a[0], &propA[0]);
+    kernel.forward(&b[0], &propB[0]);
+    kernel.forward(&c[0], &propC[0]);
 
-      num2=dLogLikelihood_[i-1]*dLogLikelihood_[i-1]+d2LogLikelihood_[i-1];
-
-      partialD2LogLikelihoods_.push_back(VectorTools::sumExp(num,num2)/den-pow(VectorTools::sumExp(num,dLogLikelihood_[i-1])/den,2));
-      
-      for (size_t j = 0; j < nbStates_; j++)
-        d2LogLikelihood_[i][j] = (*d2Emissions)[j] / (*emissions)[j] - pow((*dEmissions)[j] / (*emissions)[j],2);
+    for (size_t j = 0; j < nbStates_; j++)
+    {
+      double den = propB[j];
 
-      
-      bpIt++;
-      if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-      else nextBrkPt = nbSites_;
+      d2LogLikelihood_[i][j] = (*d2Emissions)[j] / emissions[j] - pow((*dEmissions)[j] / emissions[j],2)
+        + propC[j]/den - pow(propA[j]/den,2);
     }
   }  
 
   //Termination:
   for (size_t kp = 0; kp < nbStates_; kp++)
-    num[kp]=logLikelihood_[nbStates_*(nbSites_-1)+kp];
+    num[kp]=logLikelihood_[nbStates_*(end-1)+kp];
 
-  num-=num[VectorTools::whichMax(num)];
+  num-=VectorTools::max(num);
 
   double den=VectorTools::sumExp(num);
 
-  num2=dLogLikelihood_[nbSites_-1]*dLogLikelihood_[nbSites_-1]+d2LogLikelihood_[nbSites_-1];
-
-  partialD2LogLikelihoods_.push_back(VectorTools::sumExp(num,num2)/den-pow(VectorTools::sumExp(num,dLogLikelihood_[nbSites_-1])/den,2));
+  num2=dLogLikelihood_[end-1]*dLogLikelihood_[end-1]+d2LogLikelihood_[end-1];
 
-  
-  //Compute d2LogLikelihood
-  
-  d2LogLik_ = 0;
-  vector<double> copy = partialD2LogLikelihoods_; //We need to keep the original order for posterior decoding.
-  sort(copy.begin(), copy.end());
-  for (size_t i = copy.size(); i > 0; --i)
-    d2LogLik_ += copy[i - 1];
+  return VectorTools::sumExp(num,num2)/den-pow(VectorTools::sumExp(num,dLogLikelihood_[end-1])/den,2);
 }
 
 double LogsumHmmLikelihood::getD2LogLikelihoodForASite(size_t site) const
@@ -41,6 +41,8 @@
 #define _LOGSUMHMMLIKELIHOOD_H_
 
 #include "HmmLikelihood.h"
+#include "HmmTransitionKernel.h"
+#include "HmmEmissionBuffer.h"
 #include "../AbstractParametrizable.h"
 #include "../NumTools.h"
 #include "../Matrix/Matrix.h"
@@ -57,9 +59,16 @@ namespace bpp {
    * This implementation uses the logsum method described in Durbin et al "Biological sequence analysis", Cambridge University Press,
    * and further developped in Tobias P. Mann "Numerically Stable Hidden Markov Model Implementation" (2006) http://bozeman.genome.washington.edu/compbio/mbt599_2006/hmm_scaling_revised.pdf .
    * It also offer the possibility to specify "breakpoints", where the chain will be reset to the equilibrium frequencies.
+   * The segments delimited by break points are independent, and can be computed in parallel (see setNumberOfThreads).
    *
    * Although probably more numerically accurate, this method is slower than the rescaling, as it involves one exponentiation per site and per hidden state!
    *
+   * When only emission probabilities change, and the HmmEmissionProbabilities object locates the modified
+   * positions (see HmmEmissionProbabilities::getChangedPositions), the forward recursion of each segment
+   * is restarted at the first modified site. After the last modified site, it stops as soon as the
+   * forward log likelihoods differ from the stored ones by the same amount for all hidden states, the
+   * remaining ones being shifted. Backward log likelihoods after the last modified site are kept.
+   *
    * @see RescaledHmmLikelihood
    */
   class LogsumHmmLikelihood:
@@ -119,6 +128,13 @@ namespace bpp {
     mutable std::vector<std::vector<double> > backLogLikelihood_;
     mutable bool backLogLikelihoodUpToDate_;
 
+    /**
+     * @brief For each segment, the first site from which backward log likelihoods are still valid.
+     *
+     * Empty if the backward log likelihoods have to be fully recomputed.
+     */
+    mutable std::vector<size_t> backValidFrom_;
+
     std::vector<size_t> breakPoints_;
 
     size_t nbStates_, nbSites_;
@@ -160,6 +176,7 @@ namespace bpp {
       partialD2LogLikelihoods_(lik.partialD2LogLikelihoods_),
       backLogLikelihood_(lik.backLogLikelihood_),
       backLogLikelihoodUpToDate_(lik.backLogLikelihoodUpToDate_),
+      backValidFrom_(lik.backValidFrom_),
       breakPoints_(lik.breakPoints_),
       nbStates_(lik.nbStates_),
       nbSites_(lik.nbSites_)
@@ -210,6 +227,7 @@ namespace bpp {
       partialD2LogLikelihoods_  = lik.partialD2LogLikelihoods_;
       backLogLikelihood_     = lik.backLogLikelihood_;
       backLogLikelihoodUpToDate_= lik.backLogLikelihoodUpToDate_;
+      backValidFrom_         = lik.backValidFrom_;
       logLik_                = lik.logLik_;
       breakPoints_           = lik.breakPoints_;
       nbStates_              = lik.nbStates_;
@@ -245,6 +263,8 @@ namespace bpp {
 
     void setBreakPoints(const std::vector<size_t>& breakPoints) {
       breakPoints_ = breakPoints;
+      updateSegments_(breakPoints_, nbSites_);
+      resetDerivatives_();
       computeForward_();
       backLogLikelihoodUpToDate_=false;
     }
@@ -283,6 +303,14 @@ namespace bpp {
     
     void computeBackward_() const;
 
+    /**
+     * @brief Update the forward recursion after a change of emission probabilities.
+     *
+     * @param firstDirty For each segment, the first site with modified emission probabilities.
+     * @param lastDirty For each segment, the site after the last one with modified emission probabilities.
+     */
+    void updateForward_(const std::vector<size_t>& firstDirty, const std::vector<size_t>& lastDirty);
+
     void computeDLikelihood_() const
     {
       computeDForward_();
@@ -296,7 +324,33 @@ namespace bpp {
     void computeDForward_() const;
     
     void computeD2Forward_() const;
-    
+
+    void computeDLogLikelihoodDTransitions_(std::vector<double>& dTransitions, std::vector<double>& dInitFreqs) const;
+
+  private:
+    /**
+     * @brief Forward recursion on the segment [begin, end[.
+     *
+     * @return The log likelihood of the segment.
+     */
+    double computeForward_(const HmmTransitionKernel& kernel, const std::vector<double>& logEqFreqs, size_t begin, size_t end);
+
+    /**
+     * @brief Update the forward recursion of the segment [begin, end[, after a change of the emission
+     * probabilities of sites [first, last[.
+     *
+     * @return The log likelihood of the segment.
+     */
+    double updateForward_(const HmmTransitionKernel& kernel, const std::vector<double>& logEqFreqs, size_t begin, size_t first, size_t last, size_t end);
+
+    /**
+     * @brief Backward recursion on the segment [begin, end[, backward log likelihoods being valid from site validFrom.
+     */
+    void computeBackward_(const HmmTransitionKernel& kernel, size_t begin, size_t validFrom, size_t end) const;
+
+    double computeDForward_(const HmmTransitionKernel& kernel, size_t begin, size_t end) const;
+
+    double computeD2Forward_(const HmmTransitionKernel& kernel, size_t begin, size_t end) const;
 
   };
 
@@ -56,9 +56,8 @@ LowMemoryRescaledHmmLikelihood::LowMemoryRescaledHmmLikelihood(
   hiddenAlphabet_(hiddenAlphabet),
   transitionMatrix_(transitionMatrix),
   emissionProbabilities_(emissionProbabilities),
-  likelihood1_(),
-  likelihood2_(),
   logLik_(),
+  segLogLik_(),
   maxSize_(maxSize),
   breakPoints_(),
   nbStates_(),
@@ -79,9 +78,7 @@ LowMemoryRescaledHmmLikelihood::LowMemoryRescaledHmmLikelihood(
   addParameters_(transitionMatrix_->getParameters());
   addParameters_(emissionProbabilities_->getParameters());
 
-  // Init arrays:
-  likelihood1_.resize(nbStates_);
-  likelihood2_.resize(nbStates_);
+  updateSegments_(breakPoints_, nbSites_);
 
   // Compute:
   computeForward_();
@@ -98,6 +95,8 @@ void LowMemoryRescaledHmmLikelihood::setNamespace(const std::string& nameSpace)
 
 void LowMemoryRescaledHmmLikelihood::fireParameterChanged(const ParameterList& pl)
 {
+  resetDerivatives_();
+
    bool alphabetChanged    = hiddenAlphabet_->matchParametersValues(pl);
    bool transitionsChanged = transitionMatrix_->matchParametersValues(pl);
    bool emissionChanged    = emissionProbabilities_->matchParametersValues(pl);
@@ -107,120 +106,75 @@ void LowMemoryRescaledHmmLikelihood::fireParameterChanged(const ParameterList& p
   if (alphabetChanged && !transitionsChanged) transitionMatrix_->setParametersValues(transitionMatrix_->getParameters());
   if (alphabetChanged && !emissionChanged) emissionProbabilities_->setParametersValues(emissionProbabilities_->getParameters());
 
-  computeForward_();
+  vector<size_t> firstDirty, lastDirty;
+  if (emissionChanged && !alphabetChanged && !transitionsChanged && getDirtyRanges_(firstDirty, lastDirty))
+    updateForward_(firstDirty);
+  else
+    computeForward_();
 }
 
 /***************************************************************************************************************************/
 
 void LowMemoryRescaledHmmLikelihood::computeForward_()
 {
-  double x;
-  vector<double> tmp(nbStates_);
-  vector<double> lScales(min(maxSize_, nbSites_));
-  vector<double> trans(nbStates_ * nbStates_);
+  vector<size_t> firstDirty(segmentBounds_.begin(), segmentBounds_.end() - 1);
+  segLogLik_.resize(getNumberOfSegments());
+  updateForward_(firstDirty);
+}
 
+void LowMemoryRescaledHmmLikelihood::updateForward_(const vector<size_t>& firstDirty)
+{
   // Transition probabilities:
-  for (size_t i = 0; i < nbStates_; i++)
-  {
-   size_t ii = i * nbStates_;
-    for (size_t j = 0; j < nbStates_; j++)
-    {
-      trans[ii + j] = transitionMatrix_->Pij(j, i);
-    }
-  }
+  HmmTransitionKernel kernel(*transitionMatrix_);
+  const vector<double>& eqFreqs = transitionMatrix_->getEquilibriumFrequencies();
 
-  // Initialisation:
-  double scale = 0;
-  const vector<double>* emissions = &(*emissionProbabilities_)(0);
-  for (size_t j = 0; j < nbStates_; j++)
-  {
-    size_t jj = j * nbStates_;
-    x = 0;
-    for (size_t k = 0; k < nbStates_; k++)
-    {
-      x += trans[k + jj] * transitionMatrix_->getEquilibriumFrequencies()[k];
-    }
-    tmp[j] = (*emissions)[j] * x;
-    scale += tmp[j];
-  }
-  for (size_t j = 0; j < nbStates_; j++)
+  // Segments are independent:
+  forEachSegment_([&](size_t s) {
+      if (firstDirty[s] < segmentBounds_[s + 1])
+        segLogLik_[s] = computeForward_(kernel, eqFreqs, segmentBounds_[s], segmentBounds_[s + 1]);
+    });
+
+  vector<double> copy = segLogLik_;
+  greater<double> cmp;
+  sort(copy.begin(), copy.end(), cmp);
+  logLik_ = 0;
+  for (size_t s = 0; s < copy.size(); ++s)
   {
-    likelihood1_[j] = tmp[j] / scale;
+    logLik_ += copy[s];
   }
-  lScales[0] = log(scale);
+}
 
-  vector<double>* previousLikelihood = &likelihood2_, * currentLikelihood = &likelihood1_, * tmpLikelihood;
+double LowMemoryRescaledHmmLikelihood::computeForward_(const HmmTransitionKernel& kernel, const vector<double>& eqFreqs, size_t begin, size_t end) const
+{
+  double x, scale;
+  vector<double> tmp(nbStates_), prop(nbStates_);
+  vector<double> lScales(min(maxSize_, end - begin));
+  vector<double> likelihood1(nbStates_), likelihood2(nbStates_);
 
-  // Recursion:
-  size_t nextBrkPt = nbSites_; // next break point
-  vector<size_t>::const_iterator bpIt = breakPoints_.begin();
-  if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
+  // The markov chain starts from the equilibrium frequencies:
+  const vector<double>* previousLikelihood = &eqFreqs;
+  vector<double>* currentLikelihood = &likelihood1;
 
-  double a;
-  logLik_ = 0;
-  size_t offset = 0;
+  double logLik = 0;
+  size_t nbScales = 0;
   greater<double> cmp;
-  for (size_t i = 1; i < nbSites_; i++)
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin, end);
+  for (size_t i = begin; i < end; i++)
   {
-    //Swap pointers:
-    tmpLikelihood = previousLikelihood;
-    previousLikelihood = currentLikelihood;
-    currentLikelihood = tmpLikelihood;
-
     scale = 0;
-    emissions = &(*emissionProbabilities_)(i);
-    if (i < nextBrkPt)
-    {
-      for (size_t j = 0; j < nbStates_; j++)
-      {
-        size_t jj = j * nbStates_;
-        x = 0;
-        for (size_t k = 0; k < nbStates_; k++)
-        {
-          a = trans[jj + k] * (*previousLikelihood)[k];
-          if (a < 0)
-          {
-            // *ApplicationTools::warning << "Negative value for likelihood at " << i << ", state " << j << ": " << _likelihood[i-1][k] << ", Pij = " << _hiddenModel->Pij(k, j) << endl;
-            a = 0;
-          }
-          x += a;
-        }
-        tmp[j] = (*emissions)[j] * x;
-        if (tmp[j] < 0)
-        {
-          // *ApplicationTools::warning << "Negative emission probability at " << i << ", state " << j << ": " << _emissions[i][j] << endl;
-          tmp[j] = 0;
-        }
-        scale += tmp[j];
-      }
-    }
-    else // Reset markov chain:
+    const double* emissions = emissionBuffer(i);
+    // Transition probabilities and likelihoods are non-negative:
+    kernel.forward(&(*previousLikelihood)[0], &prop[0]);
+    for (size_t j = 0; j < nbStates_; j++)
     {
-      for (size_t j = 0; j < nbStates_; j++)
+      x = prop[j];
+      tmp[j] = emissions[j] * x;
+      if (tmp[j] < 0)
       {
-        size_t jj = j * nbStates_;
-        x = 0;
-        for (size_t k = 0; k < nbStates_; k++)
-        {
-          a = trans[jj + k] * transitionMatrix_->getEquilibriumFrequencies()[k];
-          if (a < 0)
-          {
-            // *ApplicationTools::warning << "Negative value for likelihood at " << i << ", state " << j << ": " << _likelihood[i-1][k] << ", Pij = " << _hiddenModel->Pij(k, j) << endl;
-            a = 0;
-          }
-          x += a;
-        }
-        tmp[j] = (*emissions)[j] * x;
-        if (tmp[j] < 0)
-        {
-          // *ApplicationTools::warning << "Negative emission probability at " << i << ", state " << j << ": " << _emissions[i][j] << endl;
-          tmp[j] = 0;
-        }
-        scale += tmp[j];
+        // *ApplicationTools::warning << "Negative emission probability at " << i << ", state " << j << ": " << _emissions[i][j] << endl;
+        tmp[j] = 0;
       }
-      bpIt++;
-      if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-      else nextBrkPt = nbSites_;
+      scale += tmp[j];
     }
 
     for (size_t j = 0; j < nbStates_; j++)
@@ -228,28 +182,26 @@ void LowMemoryRescaledHmmLikelihood::computeForward_()
       if (scale > 0) (*currentLikelihood)[j] = tmp[j] / scale;
       else (*currentLikelihood)[j] = 0;
     }
-    lScales[i - offset] = log(scale);
-  
-    if (i - offset == maxSize_ - 1)
+    lScales[nbScales++] = log(scale);
+
+    if (nbScales == lScales.size() || i == end - 1)
     {
-      //We make partial calculations and reset the arrays:
+      //We make partial calculations and reset the array:
       double partialLogLik = 0;
-      sort(lScales.begin(), lScales.end(), cmp);
-      for (size_t j = 0; j < maxSize_; ++j)
+      sort(lScales.begin(), lScales.begin() + static_cast<ptrdiff_t>(nbScales), cmp);
+      for (size_t j = 0; j < nbScales; ++j)
       {
         partialLogLik += lScales[j];
       }
-      logLik_ += partialLogLik;
-      offset += maxSize_;
+      logLik += partialLogLik;
+      nbScales = 0;
     }
+
+    //Swap pointers:
+    previousLikelihood = currentLikelihood;
+    currentLikelihood = (currentLikelihood == &likelihood1) ? &likelihood2 : &likelihood1;
   }
-  sort(lScales.begin(), lScales.begin() + static_cast<ptrdiff_t>(nbSites_ - offset), cmp);
-  double partialLogLik = 0;
-  for (size_t i = 0; i < nbSites_ - offset; ++i)
-  {
-    partialLogLik += lScales[i];
-  }
-  logLik_ += partialLogLik;
+  return logLik;
 }
 
 /***************************************************************************************************************************/
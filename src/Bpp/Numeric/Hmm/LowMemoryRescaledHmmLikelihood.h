@@ -41,6 +41,8 @@
 #define _LOWMEMORYRESCALEDHMMLIKELIHOOD_H_
 
 #include "HmmLikelihood.h"
+#include "HmmTransitionKernel.h"
+#include "HmmEmissionBuffer.h"
 #include "../AbstractParametrizable.h"
 #include "../Matrix/Matrix.h"
 
@@ -61,6 +63,12 @@ namespace bpp
  * probabilities, neither derivatives of the likelihoods, and can
  * hence only be used to compute likelihoods.
  *
+ * Only the likelihood arrays for positions i and i-1 are kept. The segments delimited by break points
+ * are independent, and can be computed in parallel (see setNumberOfThreads), each thread then using
+ * its own pair of arrays. When only emission probabilities change, and the HmmEmissionProbabilities
+ * object locates the modified positions (see HmmEmissionProbabilities::getChangedPositions), only the
+ * segments containing modified positions are recomputed.
+ *
  */
   
 class LowMemoryRescaledHmmLikelihood :
@@ -75,14 +83,12 @@ private:
   std::unique_ptr<HmmTransitionMatrix> transitionMatrix_;
   std::unique_ptr<HmmEmissionProbabilities> emissionProbabilities_;
 
+  double logLik_;
+
   /**
-   * @brief The likelihood array.
-   *
-   * Here we use two arrays for the i and i-1 positions
+   * @brief Log likelihood of each segment.
    */
-  std::vector<double> likelihood1_;
-  std::vector<double> likelihood2_;
-  double logLik_;
+  std::vector<double> segLogLik_;
   size_t maxSize_;
 
   std::vector<size_t> breakPoints_;
@@ -118,9 +124,8 @@ public:
     hiddenAlphabet_(dynamic_cast<HmmStateAlphabet*>(lik.hiddenAlphabet_->clone())),
     transitionMatrix_(dynamic_cast<HmmTransitionMatrix*>(lik.transitionMatrix_->clone())),
     emissionProbabilities_(dynamic_cast<HmmEmissionProbabilities*>(lik.emissionProbabilities_->clone())),
-    likelihood1_(lik.likelihood1_),
-    likelihood2_(lik.likelihood2_),
     logLik_(lik.logLik_),
+    segLogLik_(lik.segLogLik_),
     maxSize_(lik.maxSize_),
     breakPoints_(lik.breakPoints_),
     nbStates_(lik.nbStates_),
@@ -138,9 +143,8 @@ public:
     hiddenAlphabet_        = std::unique_ptr<HmmStateAlphabet>(dynamic_cast<HmmStateAlphabet*>(lik.hiddenAlphabet_->clone()));
     transitionMatrix_      = std::unique_ptr<HmmTransitionMatrix>(dynamic_cast<HmmTransitionMatrix*>(lik.transitionMatrix_->clone()));
     emissionProbabilities_ = std::unique_ptr<HmmEmissionProbabilities>(dynamic_cast<HmmEmissionProbabilities*>(lik.emissionProbabilities_->clone()));
-    likelihood1_           = lik.likelihood1_;
-    likelihood2_           = lik.likelihood2_;
     logLik_                = lik.logLik_;
+    segLogLik_             = lik.segLogLik_;
     maxSize_               = lik.maxSize_;
     breakPoints_           = lik.breakPoints_;
     nbStates_              = lik.nbStates_;
@@ -168,6 +172,8 @@ public:
 
   void setBreakPoints(const std::vector<size_t>& breakPoints) {
     breakPoints_ = breakPoints;
+    updateSegments_(breakPoints_, nbSites_);
+    resetDerivatives_();
     computeForward_();
   }
 
@@ -210,6 +216,20 @@ public:
 protected:
   void computeForward_();
 
+  /**
+   * @brief Recompute the segments containing sites with modified emission probabilities.
+   *
+   * @param firstDirty For each segment, the first site with modified emission probabilities.
+   */
+  void updateForward_(const std::vector<size_t>& firstDirty);
+
+  /**
+   * @brief Forward recursion on the segment [begin, end[.
+   *
+   * @return The log likelihood of the segment.
+   */
+  double computeForward_(const HmmTransitionKernel& kernel, const std::vector<double>& eqFreqs, size_t begin, size_t end) const;
+
   void computeDLikelihood_() const
   {
     throw (NotImplementedException("LowMemoryRescaledHmmLikelihood::computeDLikelihood_. Use RescaledHmmLikelihood instead."));
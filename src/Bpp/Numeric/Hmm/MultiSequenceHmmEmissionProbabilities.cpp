@@ -0,0 +1,250 @@
+//
+// File: MultiSequenceHmmEmissionProbabilities.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "MultiSequenceHmmEmissionProbabilities.h"
+#include "../../Text/TextTools.h"
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+MultiSequenceHmmEmissionProbabilities::MultiSequenceHmmEmissionProbabilities(const std::vector<HmmEmissionProbabilities*>& sequences):
+  AbstractParametrizable(""),
+  sequences_(),
+  nbStates_(0),
+  offsets_(1, 0),
+  packed_(),
+  changed_(),
+  parameterSequences_(),
+  hasD_(),
+  hasD2_(),
+  zeros_()
+{
+  for (size_t s = 0; s < sequences.size(); s++)
+    sequences_.push_back(unique_ptr<HmmEmissionProbabilities>(sequences[s]));
+  if (sequences_.size() == 0)
+    throw Exception("MultiSequenceHmmEmissionProbabilities: at least one sequence is required.");
+  for (size_t s = 0; s < sequences_.size(); s++)
+  {
+    if (!sequences_[s])
+      throw Exception("MultiSequenceHmmEmissionProbabilities: null pointer passed for sequence " + TextTools::toString(s) + ".");
+    if (sequences_[s]->getNumberOfPositions() == 0)
+      throw Exception("MultiSequenceHmmEmissionProbabilities: sequence " + TextTools::toString(s) + " is empty.");
+    if (!sequences_[0]->getHmmStateAlphabet()->worksWith(sequences_[s]->getHmmStateAlphabet()))
+      throw Exception("MultiSequenceHmmEmissionProbabilities: all sequences should point toward the same HmmStateAlphabet object.");
+    offsets_.push_back(offsets_.back() + sequences_[s]->getNumberOfPositions());
+  }
+  nbStates_ = getHmmStateAlphabet()->getNumberOfStates();
+  zeros_.resize(nbStates_);
+
+  //Parameters with the same name are shared, the first value seen being used:
+  for (size_t s = 0; s < sequences_.size(); s++)
+  {
+    const ParameterList& pl = sequences_[s]->getParameters();
+    for (size_t i = 0; i < pl.size(); i++)
+      if (!getParameters().hasParameter(pl[i].getName()))
+        addParameter_(pl[i].clone());
+  }
+  parameterSequences_.resize(getNumberOfParameters());
+  for (size_t s = 0; s < sequences_.size(); s++)
+  {
+    const ParameterList& pl = sequences_[s]->getParameters();
+    for (size_t i = 0; i < pl.size(); i++)
+      parameterSequences_[getParameters().whichParameterHasName(pl[i].getName())].push_back(s);
+  }
+  for (size_t s = 0; s < sequences_.size(); s++)
+    sequences_[s]->matchParametersValues(getParameters());
+
+  packed_.resize(offsets_.back() * nbStates_);
+  for (size_t s = 0; s < sequences_.size(); s++)
+    pack_(s, 0, sequences_[s]->getNumberOfPositions());
+}
+
+/******************************************************************************/
+
+MultiSequenceHmmEmissionProbabilities::MultiSequenceHmmEmissionProbabilities(const MultiSequenceHmmEmissionProbabilities& mshep):
+  AbstractParametrizable(mshep),
+  sequences_(),
+  nbStates_(mshep.nbStates_),
+  offsets_(mshep.offsets_),
+  packed_(mshep.packed_),
+  changed_(mshep.changed_),
+  parameterSequences_(mshep.parameterSequences_),
+  hasD_(mshep.hasD_),
+  hasD2_(mshep.hasD2_),
+  zeros_(mshep.zeros_)
+{
+  for (size_t s = 0; s < mshep.sequences_.size(); s++)
+    sequences_.push_back(unique_ptr<HmmEmissionProbabilities>(mshep.sequences_[s]->clone()));
+}
+
+/******************************************************************************/
+
+MultiSequenceHmmEmissionProbabilities& MultiSequenceHmmEmissionProbabilities::operator=(const MultiSequenceHmmEmissionProbabilities& mshep)
+{
+  AbstractParametrizable::operator=(mshep);
+  sequences_.clear();
+  for (size_t s = 0; s < mshep.sequences_.size(); s++)
+    sequences_.push_back(unique_ptr<HmmEmissionProbabilities>(mshep.sequences_[s]->clone()));
+  nbStates_ = mshep.nbStates_;
+  offsets_  = mshep.offsets_;
+  packed_   = mshep.packed_;
+  changed_  = mshep.changed_;
+  parameterSequences_ = mshep.parameterSequences_;
+  hasD_     = mshep.hasD_;
+  hasD2_    = mshep.hasD2_;
+  zeros_    = mshep.zeros_;
+  return *this;
+}
+
+/******************************************************************************/
+
+void MultiSequenceHmmEmissionProbabilities::setHmmStateAlphabet(const HmmStateAlphabet* stateAlphabet)
+{
+  for (size_t s = 0; s < sequences_.size(); s++)
+    sequences_[s]->setHmmStateAlphabet(stateAlphabet);
+  nbStates_ = stateAlphabet->getNumberOfStates();
+  zeros_.assign(nbStates_, 0.);
+  packed_.resize(offsets_.back() * nbStates_);
+  for (size_t s = 0; s < sequences_.size(); s++)
+    pack_(s, 0, sequences_[s]->getNumberOfPositions());
+}
+
+/******************************************************************************/
+
+size_t MultiSequenceHmmEmissionProbabilities::getSequenceIndex(size_t pos) const
+{
+  return static_cast<size_t>(upper_bound(offsets_.begin(), offsets_.end(), pos) - offsets_.begin()) - 1;
+}
+
+/******************************************************************************/
+
+void MultiSequenceHmmEmissionProbabilities::computeDEmissionProbabilities(std::string& variable) const
+{
+  hasD_.resize(sequences_.size());
+  for (size_t s = 0; s < sequences_.size(); s++)
+  {
+    hasD_[s] = sequences_[s]->getParameters().hasParameter(variable);
+    if (hasD_[s])
+      sequences_[s]->computeDEmissionProbabilities(variable);
+  }
+}
+
+void MultiSequenceHmmEmissionProbabilities::computeD2EmissionProbabilities(std::string& variable) const
+{
+  hasD2_.resize(sequences_.size());
+  for (size_t s = 0; s < sequences_.size(); s++)
+  {
+    hasD2_[s] = sequences_[s]->getParameters().hasParameter(variable);
+    if (hasD2_[s])
+      sequences_[s]->computeD2EmissionProbabilities(variable);
+  }
+}
+
+const std::vector<double>& MultiSequenceHmmEmissionProbabilities::getDEmissionProbabilities(size_t pos) const
+{
+  size_t s = getSequenceIndex(pos);
+  return hasD_[s] ? sequences_[s]->getDEmissionProbabilities(pos - offsets_[s]) : zeros_;
+}
+
+const std::vector<double>& MultiSequenceHmmEmissionProbabilities::getD2EmissionProbabilities(size_t pos) const
+{
+  size_t s = getSequenceIndex(pos);
+  return hasD2_[s] ? sequences_[s]->getD2EmissionProbabilities(pos - offsets_[s]) : zeros_;
+}
+
+/******************************************************************************/
+
+void MultiSequenceHmmEmissionProbabilities::setNamespace(const std::string& prefix)
+{
+  AbstractParametrizable::setNamespace(prefix);
+  for (size_t s = 0; s < sequences_.size(); s++)
+    sequences_[s]->setNamespace(prefix);
+}
+
+/******************************************************************************/
+
+void MultiSequenceHmmEmissionProbabilities::fireParameterChanged(const ParameterList& parameters)
+{
+  update_(parameters, vector<bool>(sequences_.size(), true));
+}
+
+void MultiSequenceHmmEmissionProbabilities::fireParameterIndicesChanged(const ParameterList& parameters, const ParameterChangeSet& changed)
+{
+  vector<bool> selected(sequences_.size(), false);
+  for (size_t i : changed.getIndices())
+  {
+    for (size_t s : parameterSequences_[i])
+      selected[s] = true;
+  }
+  update_(parameters, selected);
+}
+
+/******************************************************************************/
+
+void MultiSequenceHmmEmissionProbabilities::update_(const ParameterList& parameters, const std::vector<bool>& selected)
+{
+  changed_.clear();
+  vector< pair<size_t, size_t> > ranges;
+  for (size_t s = 0; s < sequences_.size(); s++)
+  {
+    if (!selected[s] || !sequences_[s]->matchParametersValues(parameters))
+      continue;
+    if (!sequences_[s]->getChangedPositions(ranges))
+    {
+      ranges.clear();
+      ranges.push_back(pair<size_t, size_t>(0, sequences_[s]->getNumberOfPositions()));
+    }
+    for (size_t r = 0; r < ranges.size(); r++)
+    {
+      pack_(s, ranges[r].first, ranges[r].second);
+      changed_.push_back(pair<size_t, size_t>(offsets_[s] + ranges[r].first, offsets_[s] + ranges[r].second));
+    }
+  }
+}
+
+/******************************************************************************/
+
+void MultiSequenceHmmEmissionProbabilities::pack_(size_t s, size_t begin, size_t end)
+{
+  if (end > begin)
+    sequences_[s]->getEmissionProbabilities(begin, end, &packed_[(offsets_[s] + begin) * nbStates_]);
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,188 @@
+//
+// File: MultiSequenceHmmEmissionProbabilities.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _MULTISEQUENCEHMMEMISSIONPROBABILITIES_H_
+#define _MULTISEQUENCEHMMEMISSIONPROBABILITIES_H_
+
+#include "HmmEmissionProbabilities.h"
+#include "../AbstractParametrizable.h"
+
+//From the STL:
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+namespace bpp
+{
+/**
+ * @brief Emission probabilities of several independent sequences, seen as one concatenated sequence.
+ *
+ * Each sequence has its own HmmEmissionProbabilities object, and all of them share their parameters:
+ * parameters with the same name are merged into one. The emission probabilities of all sequences are
+ * stored in one packed buffer, which is served to the likelihood recursions by getEmissionProbabilities.
+ *
+ * When parameters change, only the sequences depending on them are repacked, and the modified
+ * positions are always reported by getChangedPositions.
+ *
+ * This class is part of the HMM framework.
+ */
+  class MultiSequenceHmmEmissionProbabilities:
+    public virtual HmmEmissionProbabilities,
+    public AbstractParametrizable
+  {
+  private:
+    std::vector< std::unique_ptr<HmmEmissionProbabilities> > sequences_;
+
+    size_t nbStates_;
+
+    /**
+     * @brief Position of the first site of each sequence, the last element being the total number of positions.
+     */
+    std::vector<size_t> offsets_;
+
+    /**
+     * @brief Packed emission probabilities: element i * n + k is the probability of position i given state k.
+     */
+    std::vector<double> packed_;
+
+    std::vector< std::pair<size_t, size_t> > changed_;
+
+    /**
+     * @brief For each parameter of this object, the indices of the sequences depending on it.
+     */
+    std::vector< std::vector<size_t> > parameterSequences_;
+
+    mutable std::vector<bool> hasD_, hasD2_;
+    std::vector<double> zeros_;
+
+  public:
+    /**
+     * @brief Build a new MultiSequenceHmmEmissionProbabilities object.
+     *
+     * @param sequences The emission probabilities of each sequence, which will be owned by this object.
+     * They must all be non-null, non-empty and share the same hidden state alphabet.
+     * @throw Exception If one of these conditions is not fulfilled.
+     */
+    MultiSequenceHmmEmissionProbabilities(const std::vector<HmmEmissionProbabilities*>& sequences);
+
+    MultiSequenceHmmEmissionProbabilities(const MultiSequenceHmmEmissionProbabilities& mshep);
+
+    MultiSequenceHmmEmissionProbabilities& operator=(const MultiSequenceHmmEmissionProbabilities& mshep);
+
+    MultiSequenceHmmEmissionProbabilities* clone() const { return new MultiSequenceHmmEmissionProbabilities(*this); }
+
+  public:
+    const HmmStateAlphabet* getHmmStateAlphabet() const { return sequences_[0]->getHmmStateAlphabet(); }
+
+    void setHmmStateAlphabet(const HmmStateAlphabet* stateAlphabet);
+
+    size_t getNumberOfSequences() const { return sequences_.size(); }
+
+    const HmmEmissionProbabilities& getSequence(size_t i) const { return *sequences_[i]; }
+
+    /**
+     * @return The position of the first site of each sequence, followed by the total number of positions.
+     */
+    const std::vector<size_t>& getSequenceOffsets() const { return offsets_; }
+
+    /**
+     * @return The index of the sequence containing a given position.
+     */
+    size_t getSequenceIndex(size_t pos) const;
+
+    double operator()(size_t pos, size_t state) const { return packed_[pos * nbStates_ + state]; }
+
+    const std::vector<double>& operator()(size_t pos) const
+    {
+      size_t s = getSequenceIndex(pos);
+      return (*sequences_[s])(pos - offsets_[s]);
+    }
+
+    void getEmissionProbabilities(size_t begin, size_t end, double* buffer) const
+    {
+      std::copy(&packed_[0] + begin * nbStates_, &packed_[0] + end * nbStates_, buffer);
+    }
+
+    const double* getEmissionProbabilitiesData() const { return &packed_[0]; }
+
+    size_t getNumberOfPositions() const { return offsets_.back(); }
+
+    bool getChangedPositions(std::vector< std::pair<size_t, size_t> >& ranges) const
+    {
+      ranges = changed_;
+      return true;
+    }
+
+    /**
+     * @brief Derivatives are computed for the sequences which depend on the parameter, and are null for the others.
+     */
+    void computeDEmissionProbabilities(std::string& variable) const;
+
+    void computeD2EmissionProbabilities(std::string& variable) const;
+
+    const std::vector<double>& getDEmissionProbabilities(size_t pos) const;
+
+    const std::vector<double>& getD2EmissionProbabilities(size_t pos) const;
+
+    void setNamespace(const std::string& prefix);
+
+    void fireParameterChanged(const ParameterList& parameters);
+
+    /**
+     * @brief Only the sequences depending on one of the changed parameters are updated.
+     */
+    void fireParameterIndicesChanged(const ParameterList& parameters, const ParameterChangeSet& changed);
+
+  private:
+    /**
+     * @brief Update the selected sequences and repack their modified positions.
+     *
+     * @param parameters The changed parameters.
+     * @param selected For each sequence, whether it may depend on the changed parameters.
+     */
+    void update_(const ParameterList& parameters, const std::vector<bool>& selected);
+
+    /**
+     * @brief Copy the emission probabilities of positions [begin, end[ of a sequence into the packed buffer.
+     */
+    void pack_(size_t s, size_t begin, size_t end);
+  };
+
+} //end of namespace bpp
+
+#endif //_MULTISEQUENCEHMMEMISSIONPROBABILITIES_H_
+
@@ -0,0 +1,116 @@
+//
+// File: MultiSequenceHmmLikelihood.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _MULTISEQUENCEHMMLIKELIHOOD_H_
+#define _MULTISEQUENCEHMMLIKELIHOOD_H_
+
+#include "RescaledHmmLikelihood.h"
+#include "MultiSequenceHmmEmissionProbabilities.h"
+
+//From the STL:
+#include <vector>
+#include <string>
+
+namespace bpp
+{
+  /**
+   * @brief Likelihood of several independent sequences under a shared hidden Markov model.
+   *
+   * The emission probabilities of all sequences are gathered in a MultiSequenceHmmEmissionProbabilities
+   * object, and the sequences are treated as the segments of one concatenated sequence, with break
+   * points at the start of each sequence. Sequences are therefore processed in parallel (see
+   * setNumberOfThreads), and the log-likelihood is the sum of the per-sequence values, reduced in
+   * a fixed order so that results do not depend on the number of threads.
+   *
+   * The object is a single DerivableFirstOrder function of all model parameters, whose gradient is
+   * computed in one sweep by default (see enableSingleSweepGradient).
+   */
+  class MultiSequenceHmmLikelihood:
+    public RescaledHmmLikelihood
+  {
+  private:
+    MultiSequenceHmmLikelihood(
+        HmmStateAlphabet* hiddenAlphabet,
+        HmmTransitionMatrix* transitionMatrix,
+        MultiSequenceHmmEmissionProbabilities* emissionProbabilities,
+        const std::string& prefix);
+
+  public:
+    /**
+     * @brief Build a new MultiSequenceHmmLikelihood object.
+     *
+     * @warning the HmmStateAlphabet, HmmTransitionMatrix and HmmEmissionProbabilities objects are owned
+     * by this class and will be destroyed together with it.
+     *
+     * @param hiddenAlphabet The hidden states alphabet to use.
+     * @param transitionMatrix The transition matrix to use.
+     * @param emissionProbabilities The emission probabilities of each sequence.
+     * @param prefix A namespace for parameter names.
+     */
+    MultiSequenceHmmLikelihood(
+        HmmStateAlphabet* hiddenAlphabet,
+        HmmTransitionMatrix* transitionMatrix,
+        const std::vector<HmmEmissionProbabilities*>& emissionProbabilities,
+        const std::string& prefix = "");
+
+    virtual ~MultiSequenceHmmLikelihood() {}
+
+    MultiSequenceHmmLikelihood* clone() const { return new MultiSequenceHmmLikelihood(*this); }
+
+  public:
+    const MultiSequenceHmmEmissionProbabilities& getMultiSequenceEmissionProbabilities() const
+    {
+      return dynamic_cast<const MultiSequenceHmmEmissionProbabilities&>(getHmmEmissionProbabilities());
+    }
+
+    size_t getNumberOfSequences() const { return getMultiSequenceEmissionProbabilities().getNumberOfSequences(); }
+
+    /**
+     * @brief Break points are set at the start of each sequence and cannot be changed.
+     *
+     * @throw Exception Always.
+     */
+    void setBreakPoints(const std::vector<size_t>& breakPoints)
+    {
+      throw Exception("MultiSequenceHmmLikelihood::setBreakPoints. Break points are defined by the sequences.");
+    }
+  };
+
+} //end of namespace bpp
+
+#endif //_MULTISEQUENCEHMMLIKELIHOOD_H_
+
@@ -40,10 +40,12 @@ knowledge of the CeCILL license and that you accept its terms.
 #include "RescaledHmmLikelihood.h"
 
 #include "../../App/ApplicationTools.h"
+#include "../NumConstants.h"
 
 // from the STL:
 #include <iostream>
 #include <algorithm>
+#include <limits>
 using namespace bpp;
 using namespace std;
 
@@ -52,6 +54,16 @@ RescaledHmmLikelihood::RescaledHmmLikelihood(
     HmmTransitionMatrix* transitionMatrix,
     HmmEmissionProbabilities* emissionProbabilities,
     const std::string& prefix):
+  RescaledHmmLikelihood(hiddenAlphabet, transitionMatrix, emissionProbabilities, vector<size_t>(), prefix)
+{
+}
+
+RescaledHmmLikelihood::RescaledHmmLikelihood(
+    HmmStateAlphabet* hiddenAlphabet,
+    HmmTransitionMatrix* transitionMatrix,
+    HmmEmissionProbabilities* emissionProbabilities,
+    const std::vector<size_t>& breakPoints,
+    const std::string& prefix):
   AbstractHmmLikelihood(),
   AbstractParametrizable(prefix),
   hiddenAlphabet_(hiddenAlphabet),
@@ -62,13 +74,17 @@ RescaledHmmLikelihood::RescaledHmmLikelihood(
   d2Likelihood_(),
   backLikelihood_(),
   backLikelihoodUpToDate_(false),
+  backValidFrom_(),
   scales_(),
   dScales_(),
   d2Scales_(),
   logLik_(),
-  breakPoints_(),
+  segLogLik_(),
+  breakPoints_(breakPoints),
   nbStates_(),
-  nbSites_()
+  nbSites_(),
+  scanChunkSize_(0),
+  componentBounds_()
 {
   if (!hiddenAlphabet)        throw Exception("RescaledHmmLikelihood: null pointer passed for HmmStateAlphabet.");
   if (!transitionMatrix)      throw Exception("RescaledHmmLikelihood: null pointer passed for HmmTransitionMatrix.");
@@ -84,11 +100,19 @@ RescaledHmmLikelihood::RescaledHmmLikelihood(
   addParameters_(hiddenAlphabet_->getParameters());
   addParameters_(transitionMatrix_->getParameters());
   addParameters_(emissionProbabilities_->getParameters());
+  componentBounds_.push_back(0);
+  componentBounds_.push_back(componentBounds_.back() + hiddenAlphabet_->getNumberOfParameters());
+  componentBounds_.push_back(componentBounds_.back() + transitionMatrix_->getNumberOfParameters());
+  componentBounds_.push_back(componentBounds_.back() + emissionProbabilities_->getNumberOfParameters());
+  if (getNumberOfParameters() != componentBounds_.back())
+    throw Exception("RescaledHmmLikelihood: the parameters of the alphabet, transitions and emissions should be distinct.");
 
   //Init arrays:
   likelihood_.resize(nbSites_ * nbStates_);
   
   scales_.resize(nbSites_);
+
+  updateSegments_(breakPoints_, nbSites_);
   
   //Compute:
   computeForward_();
@@ -105,16 +129,46 @@ void RescaledHmmLikelihood::setNamespace(const std::string& nameSpace)
 
 void RescaledHmmLikelihood::fireParameterChanged(const ParameterList& pl)
 {
-  bool alphabetChanged    = hiddenAlphabet_->matchParametersValues(pl);
-  bool transitionsChanged = transitionMatrix_->matchParametersValues(pl);
-  bool emissionChanged    = emissionProbabilities_->matchParametersValues(pl);
+  updateParameters_(pl, pl, pl);
+}
+
+void RescaledHmmLikelihood::fireParameterIndicesChanged(const ParameterList& pl, const ParameterChangeSet& changed)
+{
+  if (changed.getNumberOfParameters() != componentBounds_.back())
+    throw Exception("RescaledHmmLikelihood::fireParameterIndicesChanged. The list of parameters does not match the components.");
+  //Split the changed positions between components:
+  vector< vector<size_t> > positions(3);
+  for (size_t i : changed.getIndices())
+  {
+    size_t k = 0;
+    while (i >= componentBounds_[k + 1]) k++;
+    positions[k].push_back(i);
+  }
+  const ParameterList& parameters = getParameters();
+  updateParameters_(
+      parameters.shareSubList(positions[0]),
+      parameters.shareSubList(positions[1]),
+      parameters.shareSubList(positions[2]));
+}
+
+void RescaledHmmLikelihood::updateParameters_(const ParameterList& alphabet, const ParameterList& transitions, const ParameterList& emissions)
+{
+  resetDerivatives_();
+
+  bool alphabetChanged    = alphabet.size() > 0 && hiddenAlphabet_->matchParametersValues(alphabet);
+  bool transitionsChanged = transitions.size() > 0 && transitionMatrix_->matchParametersValues(transitions);
+  bool emissionChanged    = emissions.size() > 0 && emissionProbabilities_->matchParametersValues(emissions);
   // these lines are necessary because the transitions and emissions can depend on the alphabet.
   // we could use a StateChangeEvent, but this would result in computing some calculations twice in some cases
   // (when both the alphabet and other parameter changed).
   if (alphabetChanged && !transitionsChanged) transitionMatrix_->setParametersValues(transitionMatrix_->getParameters());
   if (alphabetChanged && !emissionChanged) emissionProbabilities_->setParametersValues(emissionProbabilities_->getParameters());
-  
-  computeForward_();
+
+  vector<size_t> firstDirty, lastDirty;
+  if (emissionChanged && !alphabetChanged && !transitionsChanged && getDirtyRanges_(firstDirty, lastDirty))
+    updateForward_(firstDirty, lastDirty);
+  else
+    computeForward_();
   backLikelihoodUpToDate_=false;
 }
 
@@ -122,110 +176,171 @@ void RescaledHmmLikelihood::fireParameterChanged(const ParameterList& pl)
 
 void RescaledHmmLikelihood::computeForward_()
 {
-  double x;
-  vector<double> tmp(nbStates_);
-  vector<double> lScales(nbSites_);
-  vector<double> trans(nbStates_ * nbStates_);
-
   //Transition probabilities:
-  for (size_t i = 0; i < nbStates_; i++)
+  HmmTransitionKernel kernel(*transitionMatrix_);
+  const vector<double>& eqFreqs = transitionMatrix_->getEquilibriumFrequencies();
+
+  //Segments are independent:
+  vector<double>& segLogLik = segLogLik_;
+  segLogLik.resize(getNumberOfSegments());
+  vector<size_t> longSegments;
+  for (size_t s = 0; s < segLogLik.size(); s++)
   {
-    size_t ii = i * nbStates_;
-    for (size_t j = 0; j < nbStates_; j++) {
-      trans[ii + j] = transitionMatrix_->Pij(j, i);
-      if (std::isnan(trans[ii + j]))
-        throw Exception("RescaledHmmLikelihood::computeForward_. NaN transition probability");
-      if (trans[ii + j] < 0)
-        throw Exception("RescaledHmmLikelihood::computeForward_. Negative transition probability: " + TextTools::toString(trans[ii + j]));
+    if (scanChunkSize_ > 0 && segmentBounds_[s + 1] - segmentBounds_[s] > scanChunkSize_)
+      longSegments.push_back(s);
+  }
+  vector< vector<size_t> > negativeSites(segLogLik.size());
+  forEachSegment_([&](size_t s) {
+      if (scanChunkSize_ == 0 || segmentBounds_[s + 1] - segmentBounds_[s] <= scanChunkSize_)
+        segLogLik[s] = computeForward_(kernel, eqFreqs, segmentBounds_[s], segmentBounds_[s + 1], negativeSites[s]);
+    });
+  //Long segments are split, and use all threads:
+  for (size_t s : longSegments)
+  {
+    segLogLik[s] = computeForwardScan_(kernel, eqFreqs, segmentBounds_[s], segmentBounds_[s + 1], negativeSites[s]);
+  }
+  //Output streams are not thread safe, warnings are reported once all threads are done:
+  for (size_t s = 0; s < negativeSites.size(); s++)
+  {
+    for (size_t i : negativeSites[s])
+    {
+      (*ApplicationTools::warning << "Negative probability at " << i << ", set to 0.").endLine();
     }
   }
+  //Scales changed, and so did all backward likelihoods:
+  backValidFrom_.clear();
 
-  //Initialisation:
-  scales_[0] = 0;
-  const vector<double>* emissions = &(*emissionProbabilities_)(0);
-  for (size_t j = 0; j < nbStates_; j++)
+  vector<double> copy = segLogLik_; //We need to keep the original order for incremental updates.
+  greater<double> cmp;
+  sort(copy.begin(), copy.end(), cmp);
+  logLik_ = 0;
+  for (size_t s = 0; s < copy.size(); ++s)
   {
-    size_t jj = j * nbStates_;
-    x = 0;
-    for (size_t k = 0; k < nbStates_; k++)
+    logLik_ += copy[s];
+  }
+}
+
+/***************************************************************************************************************************/
+
+void RescaledHmmLikelihood::updateForward_(const vector<size_t>& firstDirty, const vector<size_t>& lastDirty)
+{
+  HmmTransitionKernel kernel(*transitionMatrix_);
+  const vector<double>& eqFreqs = transitionMatrix_->getEquilibriumFrequencies();
+
+  vector<size_t> stop(segmentBounds_.begin() + 1, segmentBounds_.end());
+  vector< vector<size_t> > negativeSites(segLogLik_.size());
+  forEachSegment_([&](size_t s) {
+      if (firstDirty[s] < segmentBounds_[s + 1])
+        segLogLik_[s] += updateForward_(kernel, eqFreqs, segmentBounds_[s], firstDirty[s], lastDirty[s], segmentBounds_[s + 1], stop[s], negativeSites[s]);
+    });
+  //Output streams are not thread safe, warnings are reported once all threads are done:
+  for (size_t s = 0; s < negativeSites.size(); s++)
+  {
+    for (size_t i : negativeSites[s])
     {
-      x += trans[k + jj] * transitionMatrix_->getEquilibriumFrequencies()[k];
-      //cerr << j << "\t" << k << "\t" << trans[k + jj] << "\t" << transitionMatrix_->getEquilibriumFrequencies()[k] << "\t" << trans[k + jj] * transitionMatrix_->getEquilibriumFrequencies()[k] << "\t" << x << endl;  
+      (*ApplicationTools::warning << "Negative probability at " << i << ", set to 0.").endLine();
     }
-    tmp[j] = (*emissions)[j] * x;
-    //cerr << "e[j]=" << (*emissions)[j] << "\t" << tmp[j] << endl;
-    scales_[0] += tmp[j];
   }
-  for (size_t j = 0; j < nbStates_; j++)
+
+  //Backward likelihoods are still valid after the last updated site:
+  for (size_t s = 0; s < backValidFrom_.size(); s++)
   {
-    likelihood_[j] = tmp[j] / scales_[0];
+    if (firstDirty[s] < segmentBounds_[s + 1])
+      backValidFrom_[s] = max(backValidFrom_[s], stop[s] - 1);
   }
-  lScales[0] = log(scales_[0]);
- 
-  //Recursion:
-  size_t nextBrkPt = nbSites_; //next break point
-  vector<size_t>::const_iterator bpIt = breakPoints_.begin();
-  if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-  
-  double a;
-  for (size_t i = 1; i < nbSites_; i++)
+
+  vector<double> copy = segLogLik_;
+  greater<double> cmp;
+  sort(copy.begin(), copy.end(), cmp);
+  logLik_ = 0;
+  for (size_t s = 0; s < copy.size(); ++s)
+  {
+    logLik_ += copy[s];
+  }
+}
+
+double RescaledHmmLikelihood::updateForward_(const HmmTransitionKernel& kernel, const vector<double>& eqFreqs, size_t begin, size_t first, size_t last, size_t end, size_t& stop, vector<size_t>& negativeSites)
+{
+  double scale;
+  bool converged;
+  vector<double> tmp(nbStates_);
+  vector<double> dLScales;
+
+  stop = end;
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, first, end);
+  for (size_t i = first; i < end; i++)
   {
     size_t ii = i * nbStates_;
-    size_t iip = (i - 1) * nbStates_;
-    scales_[i] = 0 ;
-    emissions = &(*emissionProbabilities_)(i);
-    if (i < nextBrkPt)
+    const double* previous = (i == begin) ? &eqFreqs[0] : &likelihood_[ii - nbStates_];
+    const double* emissions = emissionBuffer(i);
+    kernel.forward(previous, &tmp[0]);
+    scale = 0;
+    for (size_t j = 0; j < nbStates_; j++)
     {
-      for (size_t j = 0; j < nbStates_; j++)
+      tmp[j] *= emissions[j];
+      if (tmp[j] < 0)
       {
-        size_t jj = j * nbStates_;
-        x = 0;
-        for (size_t k = 0; k < nbStates_; k++)
-        {
-          a = trans[jj + k] * likelihood_[iip + k];
-          //if (a < 0)
-          //{
-          //  (*ApplicationTools::warning << "Negative value for likelihood at " << i << ", state " << j << ": " << likelihood_[iip + k] << ", Pij = " << trans[jj + k]).endLine();
-          //  a = 0;
-          //}
-          x += a;
-        }
-        tmp[j] = (*emissions)[j] * x;
-        if (tmp[j] < 0)
-        {
-          (*ApplicationTools::warning << "Negative probability at " << i << ", state " << j << ": " << (*emissions)[j] << "\t" << x).endLine();
-          tmp[j] = 0;
-        }
-        scales_[i] += tmp[j];
+        if (negativeSites.empty() || negativeSites.back() != i)
+          negativeSites.push_back(i);
+        tmp[j] = 0;
       }
+      scale += tmp[j];
     }
-    else //Reset markov chain:
+
+    converged = (i >= last);
+    for (size_t j = 0; j < nbStates_; j++)
     {
-      for (size_t j = 0; j < nbStates_; j++)
+      double x = (scale > 0) ? tmp[j] / scale : 0;
+      converged &= (std::abs(x - likelihood_[ii + j]) <= NumConstants::TINY() * likelihood_[ii + j]);
+      likelihood_[ii + j] = x;
+    }
+    dLScales.push_back(log(scale) - log(scales_[i]));
+    scales_[i] = scale;
+
+    //The following sites are not affected anymore:
+    if (converged)
+    {
+      stop = i + 1;
+      break;
+    }
+  }
+
+  greater<double> cmp;
+  sort(dLScales.begin(), dLScales.end(), cmp);
+  double dLogLik = 0;
+  for (size_t i = 0; i < dLScales.size(); ++i)
+  {
+    dLogLik += dLScales[i];
+  }
+  return dLogLik;
+}
+
+double RescaledHmmLikelihood::computeForward_(const HmmTransitionKernel& kernel, const vector<double>& initFreqs, size_t begin, size_t end, vector<size_t>& negativeSites)
+{
+  double x;
+  vector<double> tmp(nbStates_), prop(nbStates_);
+  vector<double> lScales(end - begin);
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin, end);
+
+  for (size_t i = begin; i < end; i++)
+  {
+    size_t ii = i * nbStates_;
+    //initFreqs are the probabilities of hidden states before the first site:
+    const double* previous = (i == begin) ? &initFreqs[0] : &likelihood_[ii - nbStates_];
+    const double* emissions = emissionBuffer(i);
+    scales_[i] = 0;
+    kernel.forward(previous, &prop[0]);
+    for (size_t j = 0; j < nbStates_; j++)
+    {
+      x = prop[j];
+      tmp[j] = emissions[j] * x;
+      if (tmp[j] < 0)
       {
-        size_t jj = j * nbStates_;
-        x = 0;
-        for (size_t k = 0; k < nbStates_; k++)
-        {
-          a = trans[jj + k] * transitionMatrix_->getEquilibriumFrequencies()[k];
-          //if (a < 0)
-          //{
-          //  (*ApplicationTools::warning << "Negative value for likelihood at " << i << ", state " << j << ": ,Pij = " << trans[jj + k]).endLine();
-          //  a = 0;
-          //}
-          x += a;
-        }
-        tmp[j] = (*emissions)[j] * x;
-        //if (tmp[j] < 0)
-        //{
-        //  (*ApplicationTools::warning << "Negative emission probability at " << i << ", state " << j << ": " << (*emissions)[j]).endLine();
-        //  tmp[j] = 0;
-        //}
-        scales_[i] += tmp[j];
+        if (negativeSites.empty() || negativeSites.back() != i)
+          negativeSites.push_back(i);
+        tmp[j] = 0;
       }
-      bpIt++;
-      if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-      else nextBrkPt = nbSites_;
+      scales_[i] += tmp[j];
     }
 
     for (size_t j = 0; j < nbStates_; j++)
@@ -233,84 +348,208 @@ void RescaledHmmLikelihood::computeForward_()
       if (scales_[i] > 0) likelihood_[ii + j] = tmp[j] / scales_[i];
       else                likelihood_[ii + j] = 0;
     }
-    lScales[i] = log(scales_[i]);
+    lScales[i - begin] = log(scales_[i]);
   }
+
   greater<double> cmp;
   sort(lScales.begin(), lScales.end(), cmp);
-  logLik_ = 0;
-  for (size_t i = 0; i < nbSites_; ++i)
+  double logLik = 0;
+  for (size_t i = 0; i < lScales.size(); ++i)
   {
-    logLik_ += lScales[i];
+    logLik += lScales[i];
   }
+  return logLik;
 }
 
 /***************************************************************************************************************************/
 
-void RescaledHmmLikelihood::computeBackward_() const
+double RescaledHmmLikelihood::computeForwardScan_(const HmmTransitionKernel& kernel, const vector<double>& eqFreqs, size_t begin, size_t end, vector<size_t>& negativeSites)
 {
-  if (backLikelihood_.size() == 0)
+  size_t nbChunks = (end - begin + scanChunkSize_ - 1) / scanChunkSize_;
+  vector<size_t> bounds(nbChunks + 1);
+  vector<size_t> costs(nbChunks);
+  for (size_t c = 0; c < nbChunks; c++)
   {
-    backLikelihood_.resize(nbSites_);
-    for (size_t i = 0; i < nbSites_; i++)
-      backLikelihood_[i].resize(nbStates_);
+    bounds[c] = begin + c * scanChunkSize_;
+  }
+  bounds[nbChunks] = end;
+  for (size_t c = 0; c < nbChunks; c++)
+  {
+    costs[c] = (bounds[c + 1] - bounds[c]) * (c == 0 ? 1 : nbStates_);
   }
 
-  double x;
+  //Step 1: forward recursion on the first chunk, transfer matrices for the others:
+  vector<double> chunkLogLik(nbChunks);
+  vector< vector<size_t> > chunkNegativeSites(nbChunks);
+  vector< vector<double> > transfer(nbChunks), transferLogScales(nbChunks);
+  ThreadTools::parallelFor(ThreadTools::getDispatchOrder(costs), nbThreads_, [&](size_t c) {
+      if (c == 0)
+        chunkLogLik[0] = computeForward_(kernel, eqFreqs, bounds[0], bounds[1], chunkNegativeSites[0]);
+      else
+        computeTransferMatrix_(kernel, bounds[c], bounds[c + 1], transfer[c], transferLogScales[c]);
+    });
+
+  //Step 2: combine transfer matrices to get the forward vectors before each chunk:
+  vector< vector<double> > initFreqs(nbChunks, vector<double>(nbStates_));
+  vector<double> w(nbStates_);
+  size_t last = (bounds[1] - 1) * nbStates_;
+  for (size_t j = 0; j < nbStates_; j++)
+  {
+    initFreqs[1][j] = likelihood_[last + j];
+  }
+  for (size_t c = 1; c + 1 < nbChunks; c++)
+  {
+    for (size_t x = 0; x < nbStates_; x++)
+    {
+      w[x] = (initFreqs[c][x] > 0) ? log(initFreqs[c][x]) + transferLogScales[c][x] : -numeric_limits<double>::infinity();
+    }
+    double m = VectorTools::max(w);
+    if (std::isinf(m))
+      throw Exception("RescaledHmmLikelihood::computeForwardScan_. Null likelihood at site " + TextTools::toString(bounds[c + 1] - 1));
+    double sum = 0;
+    for (size_t y = 0; y < nbStates_; y++)
+    {
+      double x = 0;
+      for (size_t k = 0; k < nbStates_; k++)
+      {
+        if (!std::isinf(w[k]))
+          x += exp(w[k] - m) * transfer[c][k * nbStates_ + y];
+      }
+      initFreqs[c + 1][y] = x;
+      sum += x;
+    }
+    for (size_t y = 0; y < nbStates_; y++)
+    {
+      initFreqs[c + 1][y] /= sum;
+    }
+  }
 
-  //Transition probabilities:
-  vector<double> trans(nbStates_ * nbStates_);
-  for (size_t i = 0; i < nbStates_; i++)
+  //Step 3: forward recursion on each remaining chunk:
+  vector<size_t> order = ThreadTools::getDispatchOrder(costs);
+  order.erase(find(order.begin(), order.end(), 0));
+  ThreadTools::parallelFor(order, nbThreads_, [&](size_t c) {
+      chunkLogLik[c] = computeForward_(kernel, initFreqs[c], bounds[c], bounds[c + 1], chunkNegativeSites[c]);
+    });
+  for (size_t c = 0; c < nbChunks; c++)
   {
-    size_t ii = i * nbStates_;
-    for (size_t j = 0; j < nbStates_; j++)
-      trans[ii + j] = transitionMatrix_->Pij(i, j);
+    negativeSites.insert(negativeSites.end(), chunkNegativeSites[c].begin(), chunkNegativeSites[c].end());
   }
 
+  greater<double> cmp;
+  sort(chunkLogLik.begin(), chunkLogLik.end(), cmp);
+  double logLik = 0;
+  for (size_t c = 0; c < nbChunks; ++c)
+  {
+    logLik += chunkLogLik[c];
+  }
+  return logLik;
+}
 
-  //Initialisation:
-  const vector<double>* emissions = 0;
-  size_t nextBrkPt = 0; //next break point
-  vector<size_t>::const_reverse_iterator bpIt = breakPoints_.rbegin();
-  if (bpIt != breakPoints_.rend()) nextBrkPt = *bpIt;
-  
-  for (size_t j = 0; j < nbStates_; j++)
+void RescaledHmmLikelihood::computeTransferMatrix_(const HmmTransitionKernel& kernel, size_t begin, size_t end, vector<double>& transfer, vector<double>& logScales) const
+{
+  double scale;
+  vector<double> tmp(nbStates_), prop(nbStates_);
+
+  //Row x starts from hidden state x:
+  transfer.assign(nbStates_ * nbStates_, 0.);
+  logScales.assign(nbStates_, 0.);
+  for (size_t k = 0; k < nbStates_; k++)
   {
-    x = 0;
-    backLikelihood_[nbSites_ - 1][j] = 1.;
+    transfer[k * nbStates_ + k] = 1.;
   }
 
-  //Recursion:
-  for (size_t i = nbSites_ - 1; i > 0; i--)
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin, end);
+  for (size_t i = begin; i < end; i++)
   {
-    emissions = &(*emissionProbabilities_)(i);
-    if (i > nextBrkPt)
+    const double* emissions = emissionBuffer(i);
+    for (size_t r = 0; r < nbStates_; r++)
     {
+      if (std::isinf(logScales[r]))
+        continue;
+      size_t rr = r * nbStates_;
+      scale = 0;
+      kernel.forward(&transfer[rr], &prop[0]);
       for (size_t j = 0; j < nbStates_; j++)
       {
-        x = 0;
-        size_t jj = j * nbStates_;
-        for (size_t k = 0; k < nbStates_; k++)
+        tmp[j] = emissions[j] * prop[j];
+        if (tmp[j] < 0) tmp[j] = 0;
+        scale += tmp[j];
+      }
+      if (scale > 0)
+      {
+        for (size_t j = 0; j < nbStates_; j++)
         {
-          x += (*emissions)[k] * trans[jj + k] * backLikelihood_[i][k];
+          transfer[rr + j] = tmp[j] / scale;
         }
-        backLikelihood_[i-1][j] = x / scales_[i];
-      }    
-    }
-    else //Reset markov chain
-    {
-      for (size_t j = 0; j < nbStates_; j++)
+        logScales[r] += log(scale);
+      }
+      else
       {
-        backLikelihood_[i-1][j] = 1.;
-      }    
-      bpIt++;
-      if (bpIt != breakPoints_.rend()) nextBrkPt = *bpIt;
-      else nextBrkPt = 0;
+        //This starting state is incompatible with the data:
+        for (size_t j = 0; j < nbStates_; j++)
+        {
+          transfer[rr + j] = 0;
+        }
+        logScales[r] = -numeric_limits<double>::infinity();
+      }
     }
   }
+}
+
+/***************************************************************************************************************************/
+
+void RescaledHmmLikelihood::computeBackward_() const
+{
+  if (backLikelihood_.size() == 0)
+  {
+    backLikelihood_.resize(nbSites_);
+    for (size_t i = 0; i < nbSites_; i++)
+      backLikelihood_[i].resize(nbStates_);
+  }
+
+  //Transition probabilities:
+  HmmTransitionKernel kernel(*transitionMatrix_);
 
+  forEachSegment_([&](size_t s) {
+      size_t validFrom = backValidFrom_.empty() ? segmentBounds_[s + 1] : backValidFrom_[s];
+      computeBackward_(kernel, segmentBounds_[s], validFrom, segmentBounds_[s + 1]);
+    });
+
+  backValidFrom_.assign(segmentBounds_.begin(), segmentBounds_.end() - 1);
   backLikelihoodUpToDate_ = true;
 }
 
+void RescaledHmmLikelihood::computeBackward_(const HmmTransitionKernel& kernel, size_t begin, size_t validFrom, size_t end) const
+{
+  vector<double> next(nbStates_);
+
+  //Initialisation:
+  if (validFrom == end)
+  {
+    validFrom = end - 1;
+    for (size_t j = 0; j < nbStates_; j++)
+    {
+      backLikelihood_[end - 1][j] = 1.;
+    }
+  }
+
+  //Recursion:
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin + 1, validFrom + 1, true);
+  for (size_t i = validFrom; i > begin; i--)
+  {
+    const double* emissions = emissionBuffer(i);
+    for (size_t k = 0; k < nbStates_; k++)
+    {
+      next[k] = emissions[k] * backLikelihood_[i][k];
+    }
+    kernel.backward(&next[0], &backLikelihood_[i - 1][0]);
+    for (size_t j = 0; j < nbStates_; j++)
+    {
+      backLikelihood_[i - 1][j] /= scales_[i];
+    }
+  }
+}
+
 /***************************************************************************************************************************/
 
 double RescaledHmmLikelihood::getLikelihoodForASite(size_t site) const
@@ -369,13 +608,64 @@ void RescaledHmmLikelihood::getHiddenStatesPosteriorProbabilities(std::vector< s
   if (!backLikelihoodUpToDate_)
     computeBackward_();
   
-  for (size_t i = 0; i < nbSites_; i++)
+  forEachSegment_([&](size_t s) {
+      for (size_t i = segmentBounds_[s]; i < segmentBounds_[s + 1]; i++)
+      {
+        size_t ii = i * nbStates_;
+        for (size_t j = 0; j < nbStates_; j++)
+        {
+          probs[offset + i][j] = likelihood_[ii + j] * backLikelihood_[i][j];
+        }
+      }
+    });
+}
+
+void RescaledHmmLikelihood::computeDLogLikelihoodDTransitions_(std::vector<double>& dTransitions, std::vector<double>& dInitFreqs) const
+{
+  if (!backLikelihoodUpToDate_)
+    computeBackward_();
+
+  HmmTransitionKernel kernel(*transitionMatrix_);
+  const vector<double>& eqFreqs = transitionMatrix_->getEquilibriumFrequencies();
+  size_t nbSegments = getNumberOfSegments();
+  vector< vector<double> > segDTransitions(nbSegments), segDInitFreqs(nbSegments);
+
+  forEachSegment_([&](size_t s) {
+      vector<double>& d = segDTransitions[s];
+      d.assign(nbStates_ * nbStates_, 0.);
+      segDInitFreqs[s].assign(nbStates_, 0.);
+      vector<double> next(nbStates_);
+      HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, segmentBounds_[s], segmentBounds_[s + 1]);
+      for (size_t i = segmentBounds_[s]; i < segmentBounds_[s + 1]; i++)
+      {
+        if (scales_[i] <= 0)
+          continue;
+        const double* emissions = emissionBuffer(i);
+        for (size_t k = 0; k < nbStates_; k++)
+        {
+          next[k] = emissions[k] * backLikelihood_[i][k] / scales_[i];
+        }
+        //The first site of a segment is reached by a transition from the initial frequencies:
+        const double* previous = (i == segmentBounds_[s]) ? &eqFreqs[0] : &likelihood_[(i - 1) * nbStates_];
+        for (size_t j = 0; j < nbStates_; j++)
+        {
+          for (size_t k = 0; k < nbStates_; k++)
+            d[j * nbStates_ + k] += previous[j] * next[k];
+        }
+        if (i == segmentBounds_[s])
+          kernel.backward(&next[0], &segDInitFreqs[s][0]);
+      }
+    });
+
+  //Sum over segments in a fixed order:
+  dTransitions.assign(nbStates_ * nbStates_, 0.);
+  dInitFreqs.assign(nbStates_, 0.);
+  for (size_t s = 0; s < nbSegments; s++)
   {
-    size_t ii = i * nbStates_;
-    for (size_t j = 0; j < nbStates_; j++)
-    {
-      probs[offset + i][j] = likelihood_[ii + j] * backLikelihood_[i][j];
-    }
+    for (size_t x = 0; x < dTransitions.size(); x++)
+      dTransitions[x] += segDTransitions[s][x];
+    for (size_t k = 0; k < nbStates_; k++)
+      dInitFreqs[k] += segDInitFreqs[s][k];
   }
 }
 
@@ -392,77 +682,67 @@ void RescaledHmmLikelihood::computeDForward_() const
   if (dScales_.size()==0)
     dScales_.resize(nbSites_);
   
-  double x;
-  vector<double> tmp(nbStates_), dTmp(nbStates_);
-  vector<double> dLScales(nbSites_);
-  
   //Transition probabilities:
-  const ColMatrix<double> trans(transitionMatrix_->getPij());
+  HmmTransitionKernel kernel(*transitionMatrix_);
+  const vector<double>& eqFreqs = transitionMatrix_->getEquilibriumFrequencies();
 
-  //Initialisation:
-  dScales_[0] = 0;
-  const vector<double>* emissions = &(*emissionProbabilities_)(0);
-  const vector<double>* dEmissions = &emissionProbabilities_->getDEmissionProbabilities(0);
+  vector<double> segDLogLik(getNumberOfSegments());
+  forEachSegment_([&](size_t s) {
+      segDLogLik[s] = computeDForward_(kernel, eqFreqs, segmentBounds_[s], segmentBounds_[s + 1]);
+    });
 
-  for (size_t j = 0; j < nbStates_; j++)
+  greater<double> cmp;
+  sort(segDLogLik.begin(), segDLogLik.end(), cmp);
+  dLogLik_ = 0;
+  for (size_t s = 0; s < segDLogLik.size(); ++s)
   {
-    dTmp[j] = (*dEmissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
-    tmp[j] = (*emissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
-
-    dScales_[0] += dTmp[j];
+    dLogLik_ += segDLogLik[s];
   }
+}
 
-  dLScales[0]=dScales_[0]/scales_[0];
-
-  
-  for (size_t j = 0; j < nbStates_; j++)
-    dLikelihood_[0][j] = (dTmp[j] * scales_[0] - tmp[j] * dScales_[0]) / pow(scales_[0],2);
- 
-  //Recursion:
-
-  size_t nextBrkPt = nbSites_; //next break point
-  vector<size_t>::const_iterator bpIt = breakPoints_.begin();
-  if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
+double RescaledHmmLikelihood::computeDForward_(const HmmTransitionKernel& kernel, const vector<double>& eqFreqs, size_t begin, size_t end) const
+{
+  double x, dx;
+  vector<double> tmp(nbStates_), dTmp(nbStates_);
+  vector<double> prop(nbStates_), dProp(nbStates_);
+  vector<double> dLScales(end - begin);
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin, end);
   
-  for (size_t i = 1; i < nbSites_; i++)
+  for (size_t i = begin; i < end; i++)
   {
-    size_t iip = (i - 1) * nbStates_;
-
     dScales_[i] = 0 ;
 
-    emissions = &(*emissionProbabilities_)(i);
-    dEmissions = &emissionProbabilities_->getDEmissionProbabilities(i);
+    const double* emissions = emissionBuffer(i);
+    const vector<double>& dEmissions = emissionProbabilities_->getDEmissionProbabilities(i);
     
-    if (i < nextBrkPt)
+    if (i > begin)
     {
+      size_t iip = (i - 1) * nbStates_;
+      kernel.forward(&likelihood_[iip], &prop[0]);
+      kernel.forward(&dLikelihood_[i - 1][0], &dProp[0]);
       for (size_t j = 0; j < nbStates_; j++)
       {
-        x = 0;
-        for (size_t k = 0; k < nbStates_; k++)
-          x += trans(k,j) * likelihood_[iip + k];
+        x = prop[j];
+        dx = dProp[j];
 
-        tmp[j] = (*emissions)[j] * x;
-        dTmp[j] = (*dEmissions)[j] * x + (*emissions)[j] * VectorTools::sum(trans.getCol(j) * dLikelihood_[i-1]);
+        tmp[j] = emissions[j] * x;
+        dTmp[j] = dEmissions[j] * x + emissions[j] * dx;
           
         dScales_[i] += dTmp[j];
       }
     }
-    else //Reset markov chain:
+    else //Start of the markov chain:
     {
       for (size_t j = 0; j < nbStates_; j++)
       {
-        dTmp[j] = (*dEmissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
-        tmp[j] = (*emissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
+        dTmp[j] = dEmissions[j] * eqFreqs[j];
+        tmp[j] = emissions[j] * eqFreqs[j];
         
         dScales_[i] += dTmp[j];
       }
-      
-      bpIt++;
-      if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-      else nextBrkPt = nbSites_;
     }
 
-    dLScales[i]=dScales_[i]/scales_[i];
+    dLScales[i - begin] = dScales_[i] / scales_[i];
 
     for (size_t j = 0; j < nbStates_; j++)
       dLikelihood_[i][j] = (dTmp[j] * scales_[i] - tmp[j] * dScales_[i]) / pow(scales_[i],2);
@@ -470,11 +750,12 @@ void RescaledHmmLikelihood::computeDForward_() const
   
   greater<double> cmp;
   sort(dLScales.begin(), dLScales.end(), cmp);
-  dLogLik_ = 0;
-  for (size_t i = 0; i < nbSites_; ++i)
+  double dLogLik = 0;
+  for (size_t i = 0; i < dLScales.size(); ++i)
   {
-    dLogLik_ += dLScales[i];
+    dLogLik += dLScales[i];
   }
+  return dLogLik;
 }
 
 double RescaledHmmLikelihood::getDLogLikelihoodForASite(size_t site) const
@@ -487,6 +768,9 @@ double RescaledHmmLikelihood::getDLogLikelihoodForASite(size_t site) const
 
 void RescaledHmmLikelihood::computeD2Forward_() const
 {
+  // Make sure that Dlikelihoods are correctly computed
+  getFirstOrderDerivative(d2Variable_);
+
   //Init arrays:
   if (d2Likelihood_.size()==0){
     d2Likelihood_.resize(nbSites_);
@@ -496,83 +780,73 @@ void RescaledHmmLikelihood::computeD2Forward_() const
   if (d2Scales_.size()==0)
     d2Scales_.resize(nbSites_);
   
-  double x;
-  vector<double> tmp(nbStates_), dTmp(nbStates_), d2Tmp(nbStates_);
-  vector<double> d2LScales(nbSites_);
-  
   //Transition probabilities:
-  const ColMatrix<double> trans(transitionMatrix_->getPij());
+  HmmTransitionKernel kernel(*transitionMatrix_);
+  const vector<double>& eqFreqs = transitionMatrix_->getEquilibriumFrequencies();
 
-  //Initialisation:
-  d2Scales_[0] = 0;
-  const vector<double>* emissions = &(*emissionProbabilities_)(0);
-  const vector<double>* dEmissions = &emissionProbabilities_->getDEmissionProbabilities(0);
-  const vector<double>* d2Emissions = &emissionProbabilities_->getD2EmissionProbabilities(0);
+  vector<double> segD2LogLik(getNumberOfSegments());
+  forEachSegment_([&](size_t s) {
+      segD2LogLik[s] = computeD2Forward_(kernel, eqFreqs, segmentBounds_[s], segmentBounds_[s + 1]);
+    });
 
-  for (size_t j = 0; j < nbStates_; j++)
+  greater<double> cmp;
+  sort(segD2LogLik.begin(), segD2LogLik.end(), cmp);
+  d2LogLik_ = 0;
+  for (size_t s = 0; s < segD2LogLik.size(); ++s)
   {
-    tmp[j] = (*emissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
-    dTmp[j] = (*dEmissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
-    d2Tmp[j] = (*d2Emissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
-
-    d2Scales_[0] += d2Tmp[j];
+    d2LogLik_ += segD2LogLik[s];
   }
+}
 
-  d2LScales[0]=d2Scales_[0]/scales_[0]-pow(dScales_[0]/scales_[0],2);
-  
-  for (size_t j = 0; j < nbStates_; j++)
-    d2Likelihood_[0][j] = d2Tmp[j] / scales_[0] - (d2Scales_[0] * tmp[j] + 2 * dScales_[0] * dTmp[j]) / pow(scales_[0],2)
-      +  2 * pow(dScales_[0],2) * tmp[j] / pow(scales_[0],3);
-   
-  //Recursion:
-
-  size_t nextBrkPt = nbSites_; //next break point
-  vector<size_t>::const_iterator bpIt = breakPoints_.begin();
-  if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
+double RescaledHmmLikelihood::computeD2Forward_(const HmmTransitionKernel& kernel, const vector<double>& eqFreqs, size_t begin, size_t end) const
+{
+  double x, dx;
+  vector<double> tmp(nbStates_), dTmp(nbStates_), d2Tmp(nbStates_);
+  vector<double> prop(nbStates_), dProp(nbStates_), d2Prop(nbStates_);
+  vector<double> d2LScales(end - begin);
+  HmmEmissionBuffer emissionBuffer(*emissionProbabilities_, nbStates_, begin, end);
   
-  for (size_t i = 1; i < nbSites_; i++)
+  for (size_t i = begin; i < end; i++)
   {
-    dScales_[i] = 0 ;
+    d2Scales_[i] = 0 ;
 
-    emissions = &(*emissionProbabilities_)(i);
-    dEmissions = &emissionProbabilities_->getDEmissionProbabilities(i);
-    d2Emissions = &emissionProbabilities_->getD2EmissionProbabilities(i);
+    const double* emissions = emissionBuffer(i);
+    const vector<double>& dEmissions = emissionProbabilities_->getDEmissionProbabilities(i);
+    const vector<double>& d2Emissions = emissionProbabilities_->getD2EmissionProbabilities(i);
     
-    if (i < nextBrkPt)
+    if (i > begin)
     {
       size_t iip = (i - 1) * nbStates_;
+      kernel.forward(&likelihood_[iip], &prop[0]);
+      kernel.forward(&dLikelihood_[i - 1][0], &dProp[0]);
+      kernel.forward(&d2Likelihood_[i - 1][0], &d2Prop[0]);
 
       for (size_t j = 0; j < nbStates_; j++)
       {
-        x = 0;
-        for (size_t k = 0; k < nbStates_; k++)
-          x += trans(k,j) * likelihood_[iip + k];
+        x = prop[j];
+        dx = dProp[j];
 
-        tmp[j] = (*emissions)[j] * x;
-        dTmp[j] = (*dEmissions)[j] * x + (*emissions)[j] * VectorTools::sum(trans.getCol(j) * dLikelihood_[i-1]);
-        d2Tmp[j] = (*d2Emissions)[j] * x + 2 * (*dEmissions)[j] * VectorTools::sum(trans.getCol(j) * dLikelihood_[i-1])
-          + (*emissions)[j] * VectorTools::sum(trans.getCol(j) * d2Likelihood_[i-1]);
+        tmp[j] = emissions[j] * x;
+        dTmp[j] = dEmissions[j] * x + emissions[j] * dx;
+        d2Tmp[j] = d2Emissions[j] * x + 2 * dEmissions[j] * dx
+          + emissions[j] * d2Prop[j];
           
         d2Scales_[i] += d2Tmp[j];
       }
     }
-    else //Reset markov chain:
+    else //Start of the markov chain:
     {
       for (size_t j = 0; j < nbStates_; j++)
       {
-        tmp[j] = (*emissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
-        dTmp[j] = (*dEmissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
-        d2Tmp[j] = (*d2Emissions)[j] * transitionMatrix_->getEquilibriumFrequencies()[j];
+        tmp[j] = emissions[j] * eqFreqs[j];
+        dTmp[j] = dEmissions[j] * eqFreqs[j];
+        d2Tmp[j] = d2Emissions[j] * eqFreqs[j];
         
         d2Scales_[i] += d2Tmp[j];
       }
-      
-      bpIt++;
-      if (bpIt != breakPoints_.end()) nextBrkPt = *bpIt;
-      else nextBrkPt = nbSites_;
     }
 
-    d2LScales[i]=d2Scales_[i]/scales_[i]-pow(dScales_[i]/scales_[i],2);
+    d2LScales[i - begin] = d2Scales_[i] / scales_[i] - pow(dScales_[i] / scales_[i], 2);
   
     for (size_t j = 0; j < nbStates_; j++)
       d2Likelihood_[i][j] = d2Tmp[j] / scales_[i] - (d2Scales_[i] * tmp[j] + 2 * dScales_[i] * dTmp[j]) / pow(scales_[i],2)
@@ -581,11 +855,12 @@ void RescaledHmmLikelihood::computeD2Forward_() const
   
   greater<double> cmp;
   sort(d2LScales.begin(), d2LScales.end(), cmp);
-  dLogLik_ = 0;
-  for (size_t i = 0; i < nbSites_; ++i)
+  double d2LogLik = 0;
+  for (size_t i = 0; i < d2LScales.size(); ++i)
   {
-    d2LogLik_ += d2LScales[i];
+    d2LogLik += d2LScales[i];
   }
+  return d2LogLik;
 }
 
 /***************************************************************************************************************************/
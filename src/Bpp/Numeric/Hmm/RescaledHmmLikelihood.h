@@ -41,6 +41,8 @@
 #define _RESCALEDHMMLIKELIHOOD_H_
 
 #include "HmmLikelihood.h"
+#include "HmmTransitionKernel.h"
+#include "HmmEmissionBuffer.h"
 #include "../AbstractParametrizable.h"
 #include "../Matrix/Matrix.h"
 
@@ -55,6 +57,20 @@ namespace bpp {
    *
    * This implementation uses the rescaling method described in Durbin et al "Biological sequence analysis", Cambridge University Press.
    * It also offer the possibility to specify "breakpoints", where the chain will be reset to the equilibrium frequencies.
+   * The segments delimited by break points are independent, and can be computed in parallel (see setNumberOfThreads).
+   *
+   * Long segments can further be split into chunks for the forward recursion (see setScanChunkSize).
+   * As the recursion is a product of matrices, which is associative, each chunk can be summarized
+   * by its transfer matrix, computed independently. Transfer matrices are then combined sequentially
+   * to get the forward vector at the begining of each chunk, and the forward recursion is finally
+   * completed on each chunk independently. This performs about (n+1) times more operations than the
+   * sequential recursion, n being the number of hidden states, and is therefore only beneficial for
+   * models with few states and more threads.
+   *
+   * When only emission probabilities change, and the HmmEmissionProbabilities object locates the modified
+   * positions (see HmmEmissionProbabilities::getChangedPositions), the forward recursion of each segment
+   * is restarted at the first modified site, and stops as soon as the forward vector after the last modified
+   * site is back to its stored value. Backward likelihoods after this point are kept.
    */
   class RescaledHmmLikelihood:
     public virtual AbstractHmmLikelihood,
@@ -101,6 +117,13 @@ namespace bpp {
 
     mutable std::vector<std::vector<double> > backLikelihood_;
     mutable bool backLikelihoodUpToDate_;
+
+    /**
+     * @brief For each segment, the first site from which backward likelihoods are still valid.
+     *
+     * Empty if the backward likelihoods have to be fully recomputed.
+     */
+    mutable std::vector<size_t> backValidFrom_;
     
     /**
      * @brief scales for likelihood computing
@@ -115,10 +138,29 @@ namespace bpp {
     mutable std::vector<double> d2Scales_;
     double logLik_;
 
+    /**
+     * @brief Log likelihood of each segment.
+     */
+    std::vector<double> segLogLik_;
+
     std::vector<size_t> breakPoints_;
 
     size_t nbStates_, nbSites_;
 
+    /**
+     * @brief Length of chunks for the parallel forward recursion, 0 if disabled.
+     */
+    size_t scanChunkSize_;
+
+    /**
+     * @brief Positions of the parameters of each component in the list of parameters.
+     *
+     * The parameters of the alphabet, transitions and emissions are in
+     * [componentBounds_[0], componentBounds_[1][, [componentBounds_[1], componentBounds_[2][ and
+     * [componentBounds_[2], componentBounds_[3][ respectively. Set at construction.
+     */
+    std::vector<size_t> componentBounds_;
+
   public:
     /**
      * @brief Build a new RescaledHmmLikelihood object.
@@ -133,7 +175,21 @@ namespace bpp {
                           HmmTransitionMatrix* transitionMatrix,
                           HmmEmissionProbabilities* emissionProbabilities,
                           const std::string& prefix);
-    
+
+  protected:
+    /**
+     * @brief Build a new RescaledHmmLikelihood object with break points.
+     *
+     * The forward recursion is computed once, with the given break points (see setBreakPoints).
+     */
+    RescaledHmmLikelihood(
+                          HmmStateAlphabet* hiddenAlphabet,
+                          HmmTransitionMatrix* transitionMatrix,
+                          HmmEmissionProbabilities* emissionProbabilities,
+                          const std::vector<size_t>& breakPoints,
+                          const std::string& prefix);
+
+  public:
     RescaledHmmLikelihood(const RescaledHmmLikelihood& lik):
     AbstractHmmLikelihood(lik),
     AbstractParametrizable(lik),
@@ -145,13 +201,17 @@ namespace bpp {
     d2Likelihood_(lik.d2Likelihood_),
     backLikelihood_(lik.backLikelihood_),
     backLikelihoodUpToDate_(lik.backLikelihoodUpToDate_),
+    backValidFrom_(lik.backValidFrom_),
     scales_(lik.scales_),
     dScales_(lik.dScales_),
     d2Scales_(lik.d2Scales_),
     logLik_(lik.logLik_),
+    segLogLik_(lik.segLogLik_),
     breakPoints_(lik.breakPoints_),
     nbStates_(lik.nbStates_),
-    nbSites_(lik.nbSites_)
+    nbSites_(lik.nbSites_),
+    scanChunkSize_(lik.scanChunkSize_),
+    componentBounds_(lik.componentBounds_)
     {
       // Now adjust pointers:
       transitionMatrix_->setHmmStateAlphabet(hiddenAlphabet_.get());
@@ -170,13 +230,17 @@ namespace bpp {
       d2Likelihood_          = lik.d2Likelihood_;
       backLikelihood_        = lik.backLikelihood_;
       backLikelihoodUpToDate_= lik.backLikelihoodUpToDate_;
+      backValidFrom_         = lik.backValidFrom_;
       scales_                = lik.scales_;
       dScales_               = lik.dScales_;
       d2Scales_              = lik.d2Scales_;
       logLik_                = lik.logLik_;
+      segLogLik_             = lik.segLogLik_;
       breakPoints_           = lik.breakPoints_;
       nbStates_              = lik.nbStates_;
       nbSites_               = lik.nbSites_;
+      scanChunkSize_         = lik.scanChunkSize_;
+      componentBounds_       = lik.componentBounds_;
 
       // Now adjust pointers:
       transitionMatrix_->setHmmStateAlphabet(hiddenAlphabet_.get());
@@ -200,12 +264,30 @@ namespace bpp {
 
     void setBreakPoints(const std::vector<size_t>& breakPoints) {
       breakPoints_ = breakPoints;
+      updateSegments_(breakPoints_, nbSites_);
+      resetDerivatives_();
       computeForward_();
       backLikelihoodUpToDate_=false;
     }
 
     const std::vector<size_t>& getBreakPoints() const { return breakPoints_; }
 
+    /**
+     * @brief Split segments into chunks for the forward recursion.
+     *
+     * Segments longer than the chunk size are split and their chunks processed in parallel.
+     * The chunk decomposition does not depend on the number of threads, and neither do the results.
+     *
+     * @param chunkSize The number of sites per chunk, or 0 to use the sequential recursion.
+     */
+    void setScanChunkSize(size_t chunkSize) {
+      scanChunkSize_ = chunkSize;
+      computeForward_();
+      backLikelihoodUpToDate_=false;
+    }
+
+    size_t getScanChunkSize() const { return scanChunkSize_; }
+
     void setParameters(const ParameterList& pl)
     {
       setParametersValues(pl);
@@ -227,15 +309,36 @@ namespace bpp {
 
     void fireParameterChanged(const ParameterList& pl);
 
+    /**
+     * @brief Only the components owning one of the changed parameters are updated.
+     *
+     * Each component is passed the changed parameters at its own positions only.
+     */
+    void fireParameterIndicesChanged(const ParameterList& pl, const ParameterChangeSet& changed);
+
     Vdouble getHiddenStatesPosteriorProbabilitiesForASite(size_t site) const;
 
     void getHiddenStatesPosteriorProbabilities(std::vector< std::vector<double> >& probs, bool append = false) const;
 
+    /**
+     * @return The normalized forward likelihoods: element i * n + j is the probability of hidden
+     * state j at site i, given the data of the segment up to site i (n being the number of hidden states).
+     */
+    const std::vector<double>& getForwardLikelihoods() const { return likelihood_; }
+
     
   protected:
     void computeForward_();
     void computeBackward_() const;
 
+    /**
+     * @brief Update the forward recursion after a change of emission probabilities.
+     *
+     * @param firstDirty For each segment, the first site with modified emission probabilities.
+     * @param lastDirty For each segment, the site after the last one with modified emission probabilities.
+     */
+    void updateForward_(const std::vector<size_t>& firstDirty, const std::vector<size_t>& lastDirty);
+
     
     void computeDLikelihood_() const
     {
@@ -250,6 +353,62 @@ namespace bpp {
     void computeDForward_() const;
     
     void computeD2Forward_() const;
+
+    void computeDLogLikelihoodDTransitions_(std::vector<double>& dTransitions, std::vector<double>& dInitFreqs) const;
+
+  private:
+    /**
+     * @brief Update the components after a change of parameters, and recompute the likelihood.
+     *
+     * @param alphabet, transitions, emissions The changed parameters to pass to the corresponding component.
+     */
+    void updateParameters_(const ParameterList& alphabet, const ParameterList& transitions, const ParameterList& emissions);
+
+    /**
+     * @brief Forward recursion on the segment [begin, end[.
+     *
+     * Negative probabilities are set to 0. As this may run in several threads,
+     * they are not reported here but stored in negativeSites.
+     *
+     * @param negativeSites [out] Sites with a negative probability are appended to this vector.
+     * @return The log likelihood of the segment.
+     */
+    double computeForward_(const HmmTransitionKernel& kernel, const std::vector<double>& initFreqs, size_t begin, size_t end, std::vector<size_t>& negativeSites);
+
+    /**
+     * @brief Forward recursion on the segment [begin, end[, split into chunks of size scanChunkSize_.
+     *
+     * @param negativeSites [out] Sites with a negative probability are appended to this vector.
+     * @return The log likelihood of the segment.
+     */
+    double computeForwardScan_(const HmmTransitionKernel& kernel, const std::vector<double>& eqFreqs, size_t begin, size_t end, std::vector<size_t>& negativeSites);
+
+    /**
+     * @brief Compute the normalized transfer matrix of the forward recursion on [begin, end[.
+     *
+     * Row x contains the normalized forward vector at the last site, when starting from hidden state x
+     * before site begin. Rows are rescaled independently, and their log scales are stored separately.
+     */
+    void computeTransferMatrix_(const HmmTransitionKernel& kernel, size_t begin, size_t end, std::vector<double>& transfer, std::vector<double>& logScales) const;
+
+    /**
+     * @brief Update the forward recursion of the segment [begin, end[, after a change of the emission
+     * probabilities of sites [first, last[.
+     *
+     * @param stop [out] The first site whose forward likelihoods were not recomputed.
+     * @param negativeSites [out] Sites with a negative probability are appended to this vector.
+     * @return The change of the log likelihood of the segment.
+     */
+    double updateForward_(const HmmTransitionKernel& kernel, const std::vector<double>& eqFreqs, size_t begin, size_t first, size_t last, size_t end, size_t& stop, std::vector<size_t>& negativeSites);
+
+    /**
+     * @brief Backward recursion on the segment [begin, end[, backward likelihoods being valid from site validFrom.
+     */
+    void computeBackward_(const HmmTransitionKernel& kernel, size_t begin, size_t validFrom, size_t end) const;
+
+    double computeDForward_(const HmmTransitionKernel& kernel, const std::vector<double>& eqFreqs, size_t begin, size_t end) const;
+
+    double computeD2Forward_(const HmmTransitionKernel& kernel, const std::vector<double>& eqFreqs, size_t begin, size_t end) const;
     
   };
 
@@ -0,0 +1,196 @@
+//
+// File: StreamingHmmLikelihood.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "StreamingHmmLikelihood.h"
+#include "../VectorExceptions.h"
+
+// From the STL:
+#include <cmath>
+#include <algorithm>
+
+using namespace bpp;
+using namespace std;
+
+StreamingHmmLikelihood::StreamingHmmLikelihood(const HmmTransitionMatrix& transitionMatrix, size_t lag) :
+  kernel_(transitionMatrix),
+  eqFreqs_(transitionMatrix.getEquilibriumFrequencies()),
+  nbStates_(transitionMatrix.getNumberOfStates()),
+  lag_(lag),
+  blockSize_(max<size_t>(lag, 1)),
+  forward_(lag + max<size_t>(lag, 1), vector<double>(transitionMatrix.getNumberOfStates())),
+  emissions_(lag + max<size_t>(lag, 1), vector<double>(transitionMatrix.getNumberOfStates())),
+  posteriors_(),
+  nbPositions_(0),
+  nbSmoothed_(0),
+  logLik_(0),
+  flushed_(false)
+{
+}
+
+void StreamingHmmLikelihood::reset()
+{
+  posteriors_.clear();
+  nbPositions_ = 0;
+  nbSmoothed_ = 0;
+  logLik_ = 0;
+  flushed_ = false;
+}
+
+/***************************************************************************************************************************/
+
+void StreamingHmmLikelihood::addEmissions(const vector< vector<double> >& emissions)
+{
+  if (flushed_)
+    throw Exception("StreamingHmmLikelihood::addEmissions. The sequence was flushed, call reset to start a new one.");
+
+  size_t cap = lag_ + blockSize_;
+  double scale;
+  vector<double> tmp(nbStates_);
+  vector<double> lScales(emissions.size());
+
+  for (size_t c = 0; c < emissions.size(); c++)
+  {
+    const vector<double>& e = emissions[c];
+    if (e.size() != nbStates_)
+      throw DimensionException("StreamingHmmLikelihood::addEmissions. Bad number of emission probabilities.", e.size(), nbStates_);
+
+    size_t i = nbPositions_;
+    //The markov chain starts from the equilibrium frequencies:
+    const vector<double>& previous = (i == 0) ? eqFreqs_ : forward_[(i - 1) % cap];
+    vector<double>& current = forward_[i % cap];
+    kernel_.forward(&previous[0], &tmp[0]);
+    scale = 0;
+    for (size_t j = 0; j < nbStates_; j++)
+    {
+      tmp[j] *= e[j];
+      if (tmp[j] < 0)
+        tmp[j] = 0;
+      scale += tmp[j];
+    }
+    for (size_t j = 0; j < nbStates_; j++)
+    {
+      if (scale > 0) current[j] = tmp[j] / scale;
+      else current[j] = 0;
+    }
+    emissions_[i % cap] = e;
+    lScales[c] = log(scale);
+    nbPositions_++;
+
+    //Fixed-lag smoothing, one block at a time:
+    if (i + 1 == nbSmoothed_ + blockSize_ + lag_)
+      computeBackward_(nbSmoothed_, i, blockSize_);
+  }
+
+  //Partial sum of the chunk:
+  greater<double> cmp;
+  sort(lScales.begin(), lScales.end(), cmp);
+  double partialLogLik = 0;
+  for (size_t c = 0; c < lScales.size(); ++c)
+  {
+    partialLogLik += lScales[c];
+  }
+  logLik_ += partialLogLik;
+}
+
+void StreamingHmmLikelihood::flush()
+{
+  if (!flushed_ && nbPositions_ > nbSmoothed_)
+    computeBackward_(nbSmoothed_, nbPositions_ - 1, nbPositions_ - nbSmoothed_);
+  flushed_ = true;
+}
+
+/***************************************************************************************************************************/
+
+void StreamingHmmLikelihood::computeBackward_(size_t first, size_t last, size_t nbKept)
+{
+  size_t cap = lag_ + blockSize_;
+  double sum;
+  vector<double> back(nbStates_, 1.), next(nbStates_);
+  vector< vector<double> > kept(nbKept, vector<double>(nbStates_));
+
+  for (size_t i = last; ; i--)
+  {
+    if (i < first + nbKept)
+    {
+      const vector<double>& forward = forward_[i % cap];
+      vector<double>& probs = kept[i - first];
+      sum = 0;
+      for (size_t j = 0; j < nbStates_; j++)
+      {
+        probs[j] = forward[j] * back[j];
+        sum += probs[j];
+      }
+      if (sum > 0)
+      {
+        for (size_t j = 0; j < nbStates_; j++)
+          probs[j] /= sum;
+      }
+    }
+    if (i == first)
+      break;
+
+    //Backward vectors are rescaled to sum to 1, as only their relative values matter:
+    const vector<double>& emissions = emissions_[i % cap];
+    for (size_t k = 0; k < nbStates_; k++)
+    {
+      next[k] = emissions[k] * back[k];
+    }
+    kernel_.backward(&next[0], &back[0]);
+    sum = 0;
+    for (size_t j = 0; j < nbStates_; j++)
+      sum += back[j];
+    if (sum > 0)
+    {
+      for (size_t j = 0; j < nbStates_; j++)
+        back[j] /= sum;
+    }
+  }
+
+  posteriors_.insert(posteriors_.end(), kept.begin(), kept.end());
+  nbSmoothed_ += nbKept;
+}
+
+/***************************************************************************************************************************/
+
+void StreamingHmmLikelihood::getHiddenStatesPosteriorProbabilities(vector< vector<double> >& probs, bool append)
+{
+  if (!append)
+    probs.clear();
+  probs.insert(probs.end(), posteriors_.begin(), posteriors_.end());
+  posteriors_.clear();
+}
+
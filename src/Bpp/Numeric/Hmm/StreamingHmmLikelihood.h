@@ -0,0 +1,171 @@
+//
+// File: StreamingHmmLikelihood.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _STREAMINGHMMLIKELIHOOD_H_
+#define _STREAMINGHMMLIKELIHOOD_H_
+
+#include "HmmTransitionMatrix.h"
+#include "HmmTransitionKernel.h"
+
+// From the STL:
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief Likelihood of a Hidden Markov Model, computed while emission probabilities are streamed.
+ *
+ * Contrary to the HmmLikelihood implementations, this class does not need all emission probabilities
+ * to be available at once: they are pushed chunk after chunk with addEmissions, and the forward
+ * recursion is carried from one chunk to the next. Sequences generated on the fly or read from disk
+ * can hence be scored in constant memory.
+ *
+ * The forward recursion uses the same rescaling scheme as LowMemoryRescaledHmmLikelihood. Only the
+ * last 2 * lag forward vectors and emission probabilities are kept, which allows to compute fixed-lag
+ * smoothed posterior probabilities of hidden states. Positions are smoothed by blocks of lag positions:
+ * once the emissions up to lag positions after the end of a block are available, a single backward
+ * recursion computes the posterior probabilities of the whole block. The posterior probabilities at
+ * position i are hence computed conditionally on the emissions up to position b + 2 * lag - 1, where
+ * b is the first position of the block of i, that is with at least lag positions after i. This costs
+ * two backward steps per position, whatever the lag.
+ * Call flush at the end of the sequence to get the posterior probabilities of the last positions,
+ * conditioned on all emissions.
+ *
+ * Transition probabilities are read when the object is built: parameters changed afterwards are
+ * not taken into account. Break points are not supported: the emissions form a single sequence
+ * until reset is called.
+ *
+ * This class is part of the HMM framework.
+ */
+  class StreamingHmmLikelihood
+  {
+  private:
+    HmmTransitionKernel kernel_;
+    std::vector<double> eqFreqs_;
+    size_t nbStates_;
+    size_t lag_;
+
+    /**
+     * @brief The number of positions smoothed at once, lag or 1 if lag is 0.
+     */
+    size_t blockSize_;
+
+    /**
+     * @brief Ring buffers with the last lag + blockSize_ normalized forward vectors and emission probabilities.
+     *
+     * Position i is stored at index i % (lag + blockSize_).
+     */
+    std::vector< std::vector<double> > forward_, emissions_;
+
+    std::vector< std::vector<double> > posteriors_;
+
+    size_t nbPositions_, nbSmoothed_;
+    double logLik_;
+    bool flushed_;
+
+  public:
+    /**
+     * @brief Build a new StreamingHmmLikelihood object.
+     *
+     * @param transitionMatrix The transition matrix to use.
+     * @param lag The minimum number of positions after a given position used to compute its posterior probabilities.
+     */
+    StreamingHmmLikelihood(const HmmTransitionMatrix& transitionMatrix, size_t lag);
+
+  public:
+    /**
+     * @brief Push a new chunk of emission probabilities.
+     *
+     * @param emissions One vector of emission probabilities for each hidden state, for each new position.
+     * @throw DimensionException If a vector does not have one probability per hidden state.
+     * @throw Exception If flush was called before.
+     */
+    void addEmissions(const std::vector< std::vector<double> >& emissions);
+
+    /**
+     * @brief End the sequence, and compute the posterior probabilities of the remaining positions.
+     *
+     * No more emissions can be added after this method is called, unless reset is called.
+     */
+    void flush();
+
+    /**
+     * @brief Start a new sequence.
+     */
+    void reset();
+
+    /**
+     * @return The log likelihood of the emissions pushed so far.
+     */
+    double getLogLikelihood() const { return logLik_; }
+
+    /**
+     * @return The number of positions pushed so far.
+     */
+    size_t getNumberOfPositions() const { return nbPositions_; }
+
+    /**
+     * @return The number of positions for which the posterior probabilities were computed so far.
+     */
+    size_t getNumberOfSmoothedPositions() const { return nbSmoothed_; }
+
+    size_t getLag() const { return lag_; }
+
+    /**
+     * @brief Get the posterior probabilities computed since the last call of this method.
+     *
+     * Posterior probabilities are returned in the order of positions, and are removed from this object.
+     *
+     * @param probs [out] A vector with one vector of posterior probabilities for each position.
+     * @param append Tell if the probabilities should be appended to probs, or replace its content.
+     */
+    void getHiddenStatesPosteriorProbabilities(std::vector< std::vector<double> >& probs, bool append = false);
+
+  private:
+    /**
+     * @brief Backward recursion from position last down to position first, with backward vectors
+     * initialized to 1 at position last.
+     *
+     * The posterior probabilities of positions first to first + nbKept - 1 are stored.
+     */
+    void computeBackward_(size_t first, size_t last, size_t nbKept);
+  };
+
+} //end of namespace bpp
+
+#endif //_STREAMINGHMMLIKELIHOOD_H_
+
@@ -42,6 +42,10 @@
 
 #include "Function/Functions.h"
 
+//From the STL:
+#include <cmath>
+#include <limits>
+
 namespace bpp
 {
 //Forward declaration:
@@ -133,6 +137,105 @@ namespace bpp
         lny + log(1. + exp(lnx - lny));
     }
 
+    /**
+     * @name Batched sums of exponentials.
+     *
+     * These kernels work on contiguous arrays. All terms are shifted by their maximum, which is found
+     * in a first pass, and exponentials are then accumulated in a second, branch-free pass with four
+     * independent partial sums, which the compiler can pipeline or vectorize. Compared to successive
+     * calls to logsum, only one logarithm is computed per reduction.
+     *
+     * @{
+     */
+
+    /**
+     * @return The maximum of the n values in x, or -infinity if n is 0.
+     */
+    template<class T> static T max(const T* x, size_t n)
+    {
+      T m = -std::numeric_limits<T>::infinity();
+      for (size_t i = 0; i < n; i++)
+        m = (x[i] > m) ? x[i] : m;
+      return m;
+    }
+
+    /**
+     * @return @f$\sum_i \exp(x_i - s)@f$.
+     */
+    template<class T> static T sumExp(const T* x, size_t n, T s)
+    {
+      T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        s0 += std::exp(x[i] - s);
+        s1 += std::exp(x[i + 1] - s);
+        s2 += std::exp(x[i + 2] - s);
+        s3 += std::exp(x[i + 3] - s);
+      }
+      for (; i < n; i++)
+        s0 += std::exp(x[i] - s);
+      return (s0 + s1) + (s2 + s3);
+    }
+
+    /**
+     * @return @f$\sum_i w_i \exp(x_i - s)@f$.
+     */
+    template<class T> static T weightedSumExp(const T* x, const T* w, size_t n, T s)
+    {
+      T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        s0 += w[i] * std::exp(x[i] - s);
+        s1 += w[i + 1] * std::exp(x[i + 1] - s);
+        s2 += w[i + 2] * std::exp(x[i + 2] - s);
+        s3 += w[i + 3] * std::exp(x[i + 3] - s);
+      }
+      for (; i < n; i++)
+        s0 += w[i] * std::exp(x[i] - s);
+      return (s0 + s1) + (s2 + s3);
+    }
+
+    /**
+     * @return @f$\log(\sum_i \exp(x_i))@f$, or -infinity if n is 0.
+     */
+    template<class T> static T logSumExp(const T* x, size_t n)
+    {
+      T m = max(x, n);
+      if (std::isinf(m))
+        return m;
+      return m + std::log(sumExp(x, n, m));
+    }
+
+    /**
+     * @return @f$\log(\sum_i \exp(x_i + y_i))@f$, or -infinity if n is 0.
+     *
+     * This is the log-space equivalent of a dot product.
+     */
+    template<class T> static T logSumExpOfSum(const T* x, const T* y, size_t n)
+    {
+      T m = -std::numeric_limits<T>::infinity();
+      for (size_t i = 0; i < n; i++)
+        m = (x[i] + y[i] > m) ? x[i] + y[i] : m;
+      if (std::isinf(m))
+        return m;
+      T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        s0 += std::exp(x[i] + y[i] - m);
+        s1 += std::exp(x[i + 1] + y[i + 1] - m);
+        s2 += std::exp(x[i + 2] + y[i + 2] - m);
+        s3 += std::exp(x[i + 3] + y[i + 3] - m);
+      }
+      for (; i < n; i++)
+        s0 += std::exp(x[i] + y[i] - m);
+      return m + std::log((s0 + s1) + (s2 + s3));
+    }
+
+    /** @} */
+
     /**************************************************************************/
 
     template<class T> static void swap(T & a, T & b)
@@ -76,6 +76,8 @@ Parameter::Parameter(const Parameter& p) :
 
 Parameter& Parameter::operator=(const Parameter& p)
 {
+  if (name_ != p.name_)
+    nameChanges_++;
   name_           = p.name_;
   value_          = p.value_;
   precision_      = p.precision_;
@@ -162,6 +164,8 @@ bool Parameter::hasParameterListener(const std::string& listenerId)
 
 /******************************************************************************/
 
+std::atomic<unsigned long> Parameter::nameChanges_(0);
+
 const std::shared_ptr<IntervalConstraint> Parameter::R_PLUS(new IntervalConstraint(true, 0, true));
 const std::shared_ptr<IntervalConstraint> Parameter::R_PLUS_STAR(new IntervalConstraint(true, 0, false));
 const std::shared_ptr<IntervalConstraint> Parameter::R_MINUS(new IntervalConstraint(false, 0, true));
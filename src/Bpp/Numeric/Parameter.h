@@ -49,6 +49,7 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <atomic>
 
 namespace bpp
 {
@@ -185,6 +186,7 @@ namespace bpp
     virtual void setName(const std::string & name)
     {
       name_ = name;
+      nameChanges_++;
       ParameterEvent event(this);
       fireParameterNameChanged(event);
     }
@@ -317,7 +319,17 @@ namespace bpp
         (*it)->parameterConstraintChanged(event);
     }
 
+  private:
+    static std::atomic<unsigned long> nameChanges_;
+
   public:
+    /**
+     * @return The number of times a parameter, any parameter, has been renamed.
+     *
+     * Containers indexing parameters by name use this counter to detect renamings.
+     */
+    static unsigned long getNumberOfNameChanges() { return nameChanges_.load(); }
+
     static const std::shared_ptr<IntervalConstraint> R_PLUS;
     static const std::shared_ptr<IntervalConstraint> R_PLUS_STAR;
     static const std::shared_ptr<IntervalConstraint> R_MINUS;
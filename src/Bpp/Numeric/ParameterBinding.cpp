@@ -0,0 +1,184 @@
+//
+// File: ParameterBinding.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "ParameterBinding.h"
+#include "VectorExceptions.h"
+
+// From the STL:
+#include <unordered_map>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+void ParameterBinding::bind(const ParameterList& source, const ParameterList& target)
+{
+  bind(source, target.getParameterNames());
+  targetVersion_ = target.getStructureVersion();
+}
+
+/******************************************************************************/
+
+void ParameterBinding::bind(const ParameterList& source, const std::vector<std::string>& targetNames)
+{
+  sourceNames_ = source.getParameterNames();
+  targetNames_ = targetNames;
+  sourceVersion_ = source.getStructureVersion();
+  targetVersion_ = 0;
+  nameVersion_ = Parameter::getNumberOfNameChanges();
+  sourcePositions_.clear();
+  targetPositions_.clear();
+  unordered_map<string, size_t> index;
+  for (size_t j = 0; j < targetNames_.size(); j++)
+    index.emplace(targetNames_[j], j);
+  for (size_t i = 0; i < sourceNames_.size(); i++)
+  {
+    unordered_map<string, size_t>::const_iterator it = index.find(sourceNames_[i]);
+    if (it != index.end())
+    {
+      sourcePositions_.push_back(i);
+      targetPositions_.push_back(it->second);
+    }
+  }
+}
+
+/******************************************************************************/
+
+bool ParameterBinding::isValidForSource(const ParameterList& source) const
+{
+  unsigned long names = Parameter::getNumberOfNameChanges();
+  if (source.getStructureVersion() == sourceVersion_ && names == nameVersion_)
+    return true;
+  if (source.size() != sourceNames_.size())
+    return false;
+  for (size_t i = 0; i < sourceNames_.size(); i++)
+  {
+    if (source[i].getName() != sourceNames_[i])
+      return false;
+  }
+  // The target was not checked with the current renamings:
+  sourceVersion_ = source.getStructureVersion();
+  targetVersion_ = 0;
+  nameVersion_ = names;
+  return true;
+}
+
+/******************************************************************************/
+
+bool ParameterBinding::isValidFor(const ParameterList& source, const ParameterList& target) const
+{
+  unsigned long names = Parameter::getNumberOfNameChanges();
+  if (source.getStructureVersion() == sourceVersion_ && target.getStructureVersion() == targetVersion_ && names == nameVersion_)
+    return true;
+  if (target.size() != targetNames_.size() || !isValidForSource(source))
+    return false;
+  for (size_t i = 0; i < targetNames_.size(); i++)
+  {
+    if (target[i].getName() != targetNames_[i])
+      return false;
+  }
+  sourceVersion_ = source.getStructureVersion();
+  targetVersion_ = target.getStructureVersion();
+  nameVersion_ = names;
+  return true;
+}
+
+/******************************************************************************/
+
+bool ParameterBinding::apply(const ParameterList& source, ParameterList& target, std::vector<size_t>* changed) const
+{
+  // First we check if all values are correct:
+  for (size_t i = 0; i < sourcePositions_.size(); i++)
+  {
+    const Parameter& p = target[targetPositions_[i]];
+    double value = source[sourcePositions_[i]].getValue();
+    if (p.hasConstraint() && !p.getConstraint()->isCorrect(value))
+      throw ConstraintException("ParameterBinding::apply()", &p, value);
+  }
+
+  // If all values are ok, we set them:
+  bool ch = false;
+  for (size_t i = 0; i < sourcePositions_.size(); i++)
+  {
+    Parameter& p = target[targetPositions_[i]];
+    double value = source[sourcePositions_[i]].getValue();
+    if (p.getValue() != value)
+    {
+      ch = true;
+      p.setValue(value);
+      if (changed)
+        changed->push_back(sourcePositions_[i]);
+    }
+  }
+  return ch;
+}
+
+/******************************************************************************/
+
+bool ParameterBinding::apply(const std::vector<double>& values, ParameterList& target, std::vector<size_t>* changed) const
+{
+  if (values.size() != sourceNames_.size())
+    throw DimensionException("ParameterBinding::apply(). Wrong number of values.", values.size(), sourceNames_.size());
+  // First we check if all values are correct:
+  for (size_t i = 0; i < sourcePositions_.size(); i++)
+  {
+    const Parameter& p = target[targetPositions_[i]];
+    double value = values[sourcePositions_[i]];
+    if (p.hasConstraint() && !p.getConstraint()->isCorrect(value))
+      throw ConstraintException("ParameterBinding::apply()", &p, value);
+  }
+
+  // If all values are ok, we set them:
+  bool ch = false;
+  for (size_t i = 0; i < sourcePositions_.size(); i++)
+  {
+    Parameter& p = target[targetPositions_[i]];
+    double value = values[sourcePositions_[i]];
+    if (p.getValue() != value)
+    {
+      ch = true;
+      p.setValue(value);
+      if (changed)
+        changed->push_back(sourcePositions_[i]);
+    }
+  }
+  return ch;
+}
+
+/******************************************************************************/
+
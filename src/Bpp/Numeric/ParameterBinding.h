@@ -0,0 +1,173 @@
+//
+// File: ParameterBinding.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _PARAMETERBINDING_H_
+#define _PARAMETERBINDING_H_
+
+#include "ParameterList.h"
+
+// From the STL:
+#include <vector>
+#include <string>
+
+namespace bpp
+{
+/**
+ * @brief Correspondence between the positions of parameters with the same name in two lists.
+ *
+ * Optimizers repeatedly transfer values between lists whose names and order do not change.
+ * A binding resolves the names once, and then transfers values in a single pass over the
+ * parameters found in both lists, without any name lookup.
+ *
+ * A binding remains usable as long as the bound lists keep their names and order, which can
+ * be checked with isValidFor. The structure stamps of the lists (see ParameterList::getStructureVersion)
+ * and the number of parameter renamings are recorded when the check succeeds: as long as they do not
+ * change, the check is done in constant time. Otherwise, names are compared one by one.
+ */
+  class ParameterBinding
+  {
+  private:
+    std::vector<std::string> sourceNames_;
+    std::vector<std::string> targetNames_;
+    std::vector<size_t> sourcePositions_;
+    std::vector<size_t> targetPositions_;
+
+    /**
+     * @brief Structure stamps of the lists and number of renamings when names were last checked, 0 if unknown.
+     */
+    mutable unsigned long sourceVersion_, targetVersion_, nameVersion_;
+
+  public:
+    ParameterBinding() :
+      sourceNames_(), targetNames_(), sourcePositions_(), targetPositions_(),
+      sourceVersion_(0), targetVersion_(0), nameVersion_(0) {}
+
+    /**
+     * @brief Build a binding between two lists.
+     *
+     * @param source The list values will be read from.
+     * @param target The list values will be written to.
+     */
+    ParameterBinding(const ParameterList& source, const ParameterList& target) :
+      sourceNames_(), targetNames_(), sourcePositions_(), targetPositions_(),
+      sourceVersion_(0), targetVersion_(0), nameVersion_(0)
+    {
+      bind(source, target);
+    }
+
+    /**
+     * @brief Build a binding between a list and a vector of names.
+     *
+     * Target positions are then indices in the vector of names.
+     *
+     * @param source The list values will be read from.
+     * @param targetNames The names of the target parameters.
+     */
+    ParameterBinding(const ParameterList& source, const std::vector<std::string>& targetNames) :
+      sourceNames_(), targetNames_(), sourcePositions_(), targetPositions_(),
+      sourceVersion_(0), targetVersion_(0), nameVersion_(0)
+    {
+      bind(source, targetNames);
+    }
+
+  public:
+    /**
+     * @brief (Re)compute the binding between two lists.
+     */
+    void bind(const ParameterList& source, const ParameterList& target);
+
+    /**
+     * @brief (Re)compute the binding between a list and a vector of names.
+     */
+    void bind(const ParameterList& source, const std::vector<std::string>& targetNames);
+
+    /**
+     * @return The number of parameters found in both lists.
+     */
+    size_t size() const { return sourcePositions_.size(); }
+
+    const std::string& getName(size_t i) const { return sourceNames_[sourcePositions_[i]]; }
+
+    size_t getSourcePosition(size_t i) const { return sourcePositions_[i]; }
+
+    size_t getTargetPosition(size_t i) const { return targetPositions_[i]; }
+
+    const std::vector<size_t>& getSourcePositions() const { return sourcePositions_; }
+
+    const std::vector<size_t>& getTargetPositions() const { return targetPositions_; }
+
+    /**
+     * @return True if the source list has the names the binding was computed with, in the same order.
+     */
+    bool isValidForSource(const ParameterList& source) const;
+
+    /**
+     * @return True if both lists have the names the binding was computed with, in the same order.
+     */
+    bool isValidFor(const ParameterList& source, const ParameterList& target) const;
+
+    /**
+     * @brief Transfer values from a source list to a target list.
+     *
+     * This is equivalent to target.matchParametersValues(source, changed), provided the binding is valid for both lists:
+     * all values are checked against the constraints of the target parameters before any of them is set,
+     * and only the values which differ are set.
+     *
+     * @param source The list to read values from.
+     * @param target The list to write values to.
+     * @param changed [out] If non-null, the positions in the source list of the parameters whose value changed are appended to this vector.
+     * @return True if at least one value changed.
+     * @throw ConstraintException If a value does not match the constraint of the corresponding target parameter.
+     */
+    bool apply(const ParameterList& source, ParameterList& target, std::vector<size_t>* changed = 0) const;
+
+    /**
+     * @brief Transfer values to a target list.
+     *
+     * @param values A vector of values, ordered as the parameters of the source list.
+     * @param target The list to write values to.
+     * @param changed [out] If non-null, the positions in the source list of the parameters whose value changed are appended to this vector.
+     * @return True if at least one value changed.
+     * @throw ConstraintException If a value does not match the constraint of the corresponding target parameter.
+     */
+    bool apply(const std::vector<double>& values, ParameterList& target, std::vector<size_t>* changed = 0) const;
+  };
+
+} // end of namespace bpp.
+
+#endif  // _PARAMETERBINDING_H_
+
@@ -0,0 +1,157 @@
+//
+// File: ParameterChangeSet.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _PARAMETERCHANGESET_H_
+#define _PARAMETERCHANGESET_H_
+
+#include "../Exceptions.h"
+
+// From the STL:
+#include <vector>
+#include <cstddef>
+
+namespace bpp
+{
+/**
+ * @brief The set of parameters of an object whose values changed, given by position.
+ *
+ * Positions refer to the list of parameters of the notified object, as returned by
+ * getParameters(). The set is stored both as a dense bitset, for constant-time membership
+ * tests, and as the list of changed positions in the order they were added.
+ *
+ * @see AbstractParametrizable::fireParameterIndicesChanged
+ */
+  class ParameterChangeSet
+  {
+  private:
+    std::vector<bool> changed_;
+    std::vector<size_t> indices_;
+
+  public:
+    /**
+     * @brief Build an empty change set.
+     *
+     * @param nbParameters The number of parameters of the notified object.
+     */
+    ParameterChangeSet(size_t nbParameters) :
+      changed_(nbParameters, false), indices_() {}
+
+    /**
+     * @brief Build a change set from a list of positions.
+     *
+     * @param nbParameters The number of parameters of the notified object.
+     * @param indices The positions of the changed parameters. Duplicates are ignored.
+     * @throw IndexOutOfBoundsException If a position is not lower than nbParameters.
+     */
+    ParameterChangeSet(size_t nbParameters, const std::vector<size_t>& indices) :
+      changed_(nbParameters, false), indices_()
+    {
+      indices_.reserve(indices.size());
+      for (size_t i = 0; i < indices.size(); i++)
+        add(indices[i]);
+    }
+
+  public:
+    /**
+     * @brief Mark a parameter as changed.
+     *
+     * @param index The position of the parameter.
+     * @throw IndexOutOfBoundsException If the position is not lower than the number of parameters.
+     */
+    void add(size_t index)
+    {
+      if (index >= changed_.size())
+        throw IndexOutOfBoundsException("ParameterChangeSet::add.", index, 0, changed_.size() - 1);
+      if (!changed_[index])
+      {
+        changed_[index] = true;
+        indices_.push_back(index);
+      }
+    }
+
+    /**
+     * @brief Mark all parameters as changed.
+     */
+    void addAll()
+    {
+      for (size_t i = 0; i < changed_.size(); i++)
+        add(i);
+    }
+
+    /**
+     * @return The number of parameters of the notified object.
+     */
+    size_t getNumberOfParameters() const { return changed_.size(); }
+
+    /**
+     * @return The number of changed parameters.
+     */
+    size_t size() const { return indices_.size(); }
+
+    bool isEmpty() const { return indices_.empty(); }
+
+    /**
+     * @return True if the parameter at the given position changed.
+     * @warning No check is performed on the validity of the index given as input!
+     */
+    bool isChanged(size_t index) const { return changed_[index]; }
+
+    /**
+     * @return True if at least one parameter with position in [begin, end[ changed.
+     */
+    bool isChanged(size_t begin, size_t end) const
+    {
+      if (end > changed_.size()) end = changed_.size();
+      for (size_t i = begin; i < end; i++)
+        if (changed_[i]) return true;
+      return false;
+    }
+
+    /**
+     * @return The positions of the changed parameters.
+     */
+    const std::vector<size_t>& getIndices() const { return indices_; }
+
+    /**
+     * @return The changed state of all parameters, as a dense bitset.
+     */
+    const std::vector<bool>& getBitset() const { return changed_; }
+  };
+
+} // end of namespace bpp.
+
+#endif // _PARAMETERCHANGESET_H_
@@ -46,10 +46,16 @@ using namespace bpp;
 #include <algorithm>
 using namespace std;
 
+std::atomic<unsigned long> ParameterList::structureChanges_(0);
+
 /** Copy constructor: *********************************************************/
 
 ParameterList::ParameterList(const ParameterList& pl) :
-  parameters_(pl.size())
+  parameters_(pl.size()),
+  index_(pl.index_),
+  indexed_(pl.indexed_),
+  indexVersion_(pl.indexVersion_),
+  structureVersion_(pl.structureVersion_)
 {
   // Now copy all parameters:
   for (size_t i = 0; i < size(); i++)
@@ -70,6 +76,10 @@ ParameterList& ParameterList::operator=(const ParameterList& pl)
   {
     parameters_[i] = shared_ptr<Parameter>(pl.parameters_[i]->clone());
   }
+  index_        = pl.index_;
+  indexed_      = pl.indexed_;
+  indexVersion_ = pl.indexVersion_;
+  structureVersion_ = pl.structureVersion_;
 
   return *this;
 }
@@ -86,11 +96,9 @@ ParameterList::~ParameterList()
 
 const Parameter& ParameterList::getParameter(const std::string& name) const
 {
-  for (size_t i = 0; i < size(); i++)
-  {
-    const Parameter* p = parameters_[i].get();
-    if (p->getName() == name) return *p;
-  }
+  size_t i = findParameter_(name);
+  if (i < size())
+    return *parameters_[i];
   throw ParameterNotFoundException("ParameterList::getParameter('name').", name);
 }
 
@@ -98,12 +106,9 @@ const Parameter& ParameterList::getParameter(const std::string& name) const
 
 const shared_ptr<Parameter>& ParameterList::getSharedParameter(const std::string& name) const
 {
-  for (size_t i = 0; i < size(); i++)
-  {
-    const shared_ptr<Parameter>& p = parameters_[i];
-    if (p->getName() == name)
-      return p;
-  }
+  size_t i = findParameter_(name);
+  if (i < size())
+    return parameters_[i];
   throw ParameterNotFoundException("ParameterList::getSharedParameter('name').", name);
 }
 
@@ -112,11 +117,9 @@ const shared_ptr<Parameter>& ParameterList::getSharedParameter(const std::string
 
 double ParameterList::getParameterValue(const std::string& name) const
 {
-  for (size_t i = 0; i < size(); i++)
-  {
-    const Parameter* p = parameters_[i].get();
-    if (p->getName() == name) return p->getValue();
-  }
+  size_t i = findParameter_(name);
+  if (i < size())
+    return parameters_[i]->getValue();
   throw ParameterNotFoundException("ParameterList::getParameterValue('name').", name);
 }
 
@@ -124,24 +127,21 @@ double ParameterList::getParameterValue(const std::string& name) const
 
 Parameter& ParameterList::getParameter(const std::string& name)
 {
-  for (size_t i = 0; i < size(); i++)
-  {
-    Parameter* p = parameters_[i].get();
-    if (p->getName() == name) return *p;
-  }
+  updateIndex_();
+  size_t i = findParameter_(name);
+  if (i < size())
+    return *parameters_[i];
   throw ParameterNotFoundException("ParameterList::getParameter('name').", name);
 }
 
 /******************************************************************************/
 
-shared_ptr<Parameter>& ParameterList::getSharedParameter(const std::string& name)
+const shared_ptr<Parameter>& ParameterList::getSharedParameter(const std::string& name)
 {
-  for (size_t i = 0; i < size(); i++)
-  {
-    shared_ptr<Parameter>& p = parameters_[i];
-    if (p->getName() == name)
-      return p;
-  }
+  updateIndex_();
+  size_t i = findParameter_(name);
+  if (i < size())
+    return parameters_[i];
   throw ParameterNotFoundException("ParameterList::getSharedParameter('name').", name);
 }
 
@@ -153,8 +153,7 @@ ParameterList ParameterList::createSubList(const std::vector<std::string>& names
   ParameterList pl;
   for (size_t i = 0; i < names.size(); i++)
   {
-    Parameter param = getParameter(names[i]);
-    pl.addParameter(param);
+    pl.addParameter(getParameter(names[i]));
   }
   return pl;
 }
@@ -188,7 +187,7 @@ ParameterList ParameterList::createSubList(const std::vector<size_t>& parameters
   for (auto iparam : parameters)
   {
     if (iparam < size())
-      pl.parameters_.push_back(shared_ptr<Parameter>(parameters_[iparam]->clone()));
+      pl.pushParameter_(shared_ptr<Parameter>(parameters_[iparam]->clone()));
   }
   return pl;
 }
@@ -213,7 +212,7 @@ ParameterList ParameterList::createSubList(size_t parameter) const
 {
   ParameterList pl;
   if (parameter < size())
-    pl.parameters_.push_back(shared_ptr<Parameter>(parameters_[parameter]->clone()));
+    pl.pushParameter_(shared_ptr<Parameter>(parameters_[parameter]->clone()));
   return pl;
 }
 
@@ -226,8 +225,8 @@ ParameterList ParameterList::getCommonParametersWith(const ParameterList& params
   {
     const Parameter& p = params[i];
     if (hasParameter(p.getName()))
-      pl.parameters_.push_back(shared_ptr<Parameter>(p.clone()));
-    // We use push_back instead of addParameter because we are sure the name is not duplicated.
+      pl.pushParameter_(shared_ptr<Parameter>(p.clone()));
+    // We use pushParameter_ instead of addParameter because we are sure the name is not duplicated.
   }
 
   return pl;
@@ -283,29 +282,32 @@ vector<string> ParameterList::getMatchingParameterNames(const string& pattern) c
 
 void ParameterList::addParameter(const Parameter& param)
 {
-  if (hasParameter(param.getName()))
+  updateIndex_();
+  if (findParameter_(param.getName()) < size())
     throw ParameterException("ParameterList::addParameter. Parameter with name '" + param.getName() + "' already exists.", &param);
-  parameters_.push_back(shared_ptr<Parameter>(param.clone()));
-  
+  pushParameter_(shared_ptr<Parameter>(param.clone()));
 }
 
 /******************************************************************************/
 
 void ParameterList::addParameter(Parameter* param)
 {
-  if (hasParameter(param->getName()))
+  updateIndex_();
+  if (findParameter_(param->getName()) < size())
     throw ParameterException("ParameterList::addParameter. Parameter with name '" + param->getName() + "' already exists.", param);
-  parameters_.push_back(shared_ptr<Parameter>(param));
+  pushParameter_(shared_ptr<Parameter>(param));
 }
 
 /******************************************************************************/
 
 void ParameterList::shareParameter(const std::shared_ptr<Parameter>& param)
 {
-  if (hasParameter(param->getName()))
-    setParameterValue(param->getName(), param->getValue());
+  updateIndex_();
+  size_t i = findParameter_(param->getName());
+  if (i < size())
+    parameters_[i]->setValue(param->getValue());
   else
-    parameters_.push_back(param);
+    pushParameter_(param);
 }
 
 
@@ -315,6 +317,7 @@ void ParameterList::setParameter(size_t index, const Parameter& param)
 {
   if (index >= size()) throw IndexOutOfBoundsException("ParameterList::setParameter.", index, 0, size());
   parameters_[index] = shared_ptr<Parameter>(param.clone());
+  structureChanged_();
 }
 
 
@@ -322,12 +325,14 @@ void ParameterList::setParameter(size_t index, const Parameter& param)
 
 void ParameterList::includeParameters(const ParameterList& params)
 {
+  updateIndex_();
   for (size_t i = 0; i < params.size(); i++)
   {
-    if (hasParameter(params[i].getName()))
-      setParameterValue(params[i].getName(), params[i].getValue());
+    size_t j = findParameter_(params[i].getName());
+    if (j < size())
+      parameters_[j]->setValue(params[i].getValue());
     else
-      parameters_.push_back(shared_ptr<Parameter>(params[i].clone()));
+      pushParameter_(shared_ptr<Parameter>(params[i].clone()));
   }
 }
 
@@ -381,28 +386,30 @@ void ParameterList::setAllParametersValues(const ParameterList& params)
 
 /******************************************************************************/
 
-void ParameterList::setParametersValues(const ParameterList& params)
+void ParameterList::setParametersValues_(const ParameterList& params, vector<size_t>* updatedPositions)
 {
+  updateIndex_();
+  vector<size_t> positions(params.size());
   // First we check if all values are correct:
-  for (vector<shared_ptr<Parameter> >::const_iterator it = params.parameters_.begin(); it < params.parameters_.end(); it++)
+  for (size_t j = 0; j < params.size(); j++)
   {
-    if (hasParameter((*it)->getName()))
+    positions[j] = findParameter_(params[j].getName());
+    if (positions[j] < size())
     {
-      Parameter* p = &getParameter((*it)->getName());
-      if (p->hasConstraint() && !p->getConstraint()->isCorrect((*it)->getValue()))
-        throw ConstraintException("ParameterList::setParametersValues()", p, (*it)->getValue());
+      Parameter* p = parameters_[positions[j]].get();
+      if (p->hasConstraint() && !p->getConstraint()->isCorrect(params[j].getValue()))
+        throw ConstraintException("ParameterList::setParametersValues()", p, params[j].getValue());
     }
   }
 
   // If all values are ok, we set them:
+  for (size_t j = 0; j < params.size(); j++)
   {
-    for (vector<shared_ptr<Parameter> >::const_iterator it = params.parameters_.begin(); it < params.parameters_.end(); it++)
+    if (positions[j] < size())
     {
-      if (hasParameter((*it)->getName()))
-      {
-        Parameter* p = &getParameter((*it)->getName());
-        p->setValue((*it)->getValue());
-      }
+      parameters_[positions[j]]->setValue(params[j].getValue());
+      if (updatedPositions)
+        updatedPositions->push_back(positions[j]);
     }
   }
 }
@@ -411,64 +418,65 @@ void ParameterList::setParametersValues(const ParameterList& params)
 
 bool ParameterList::testParametersValues(const ParameterList& params) const
 {
+  vector<size_t> positions(params.size());
   // First we check if all values are correct:
-  for (vector<shared_ptr<Parameter> >::const_iterator it = params.parameters_.begin(); it < params.parameters_.end(); it++)
+  for (size_t j = 0; j < params.size(); j++)
   {
-    if (hasParameter((*it)->getName()))
+    positions[j] = findParameter_(params[j].getName());
+    if (positions[j] < size())
     {
-      const Parameter* p = &getParameter((*it)->getName());
-      if (p->hasConstraint() && !p->getConstraint()->isCorrect((*it)->getValue()))
-        throw ConstraintException("ParameterList::testParametersValues()", p, (*it)->getValue());
+      const Parameter* p = parameters_[positions[j]].get();
+      if (p->hasConstraint() && !p->getConstraint()->isCorrect(params[j].getValue()))
+        throw ConstraintException("ParameterList::testParametersValues()", p, params[j].getValue());
     }
   }
 
   // If all values are ok, we test them:
   bool ch = 0;
 
-  for (vector<shared_ptr<Parameter> >::const_iterator it = params.parameters_.begin(); it < params.parameters_.end(); it++)
+  for (size_t j = 0; j < params.size(); j++)
   {
-    if (hasParameter((*it)->getName()))
-    {
-      const Parameter* p = &getParameter((*it)->getName());
-      if (p->getValue() != (*it)->getValue())
-        ch |= 1;
-    }
+    if (positions[j] < size() && parameters_[positions[j]]->getValue() != params[j].getValue())
+      ch |= 1;
   }
   return ch;
 }
 
 /******************************************************************************/
 
-bool ParameterList::matchParametersValues(const ParameterList& params, vector<size_t>* updatedParameters)
+bool ParameterList::matchParametersValues_(const ParameterList& params, vector<size_t>* updatedParameters, vector<size_t>* updatedPositions)
 {
+  updateIndex_();
+  vector<size_t> positions(params.size());
   // First we check if all values are correct:
-  for (vector<shared_ptr<Parameter> >::const_iterator it = params.parameters_.begin(); it < params.parameters_.end(); it++)
+  for (size_t j = 0; j < params.size(); j++)
   {
-    if (hasParameter((*it)->getName()))
+    positions[j] = findParameter_(params[j].getName());
+    if (positions[j] < size())
     {
-      Parameter* p = &getParameter((*it)->getName());
-      if (p->hasConstraint() && !p->getConstraint()->isCorrect((*it)->getValue()))
-        throw ConstraintException("ParameterList::matchParametersValues()", p, (*it)->getValue());
+      Parameter* p = parameters_[positions[j]].get();
+      if (p->hasConstraint() && !p->getConstraint()->isCorrect(params[j].getValue()))
+        throw ConstraintException("ParameterList::matchParametersValues()", p, params[j].getValue());
     }
   }
 
   // If all values are ok, we set them:
   bool ch = 0;
 
-  size_t pos = 0;
-  for (vector<shared_ptr<Parameter> >::const_iterator it = params.parameters_.begin(); it < params.parameters_.end(); it++)
+  for (size_t j = 0; j < params.size(); j++)
   {
-    if (hasParameter((*it)->getName()))
+    if (positions[j] < size())
     {
-      Parameter* p = &getParameter((*it)->getName());
-      if (p->getValue() != (*it)->getValue()) {
+      Parameter* p = parameters_[positions[j]].get();
+      if (p->getValue() != params[j].getValue()) {
         ch |= 1;
-        p->setValue((*it)->getValue());
+        p->setValue(params[j].getValue());
         if (updatedParameters)
-          updatedParameters->push_back(pos);
+          updatedParameters->push_back(j);
+        if (updatedPositions)
+          updatedPositions->push_back(positions[j]);
       }
     }
-    pos++;
   }
   return ch;
 }
@@ -496,38 +504,30 @@ void ParameterList::setParameters(const ParameterList& params)
 /******************************************************************************/
 bool ParameterList::hasParameter(const std::string& name) const
 {
-  for (unsigned int i = 0; i < size(); i++)
-  {
-    const Parameter* p = parameters_[i].get();
-    if (p->getName() == name)
-      return true;
-  }
-  return false;
+  return findParameter_(name) < size();
 }
 
 /******************************************************************************/
 void ParameterList::matchParameters(const ParameterList& params)
 {
+  updateIndex_();
   for (vector<shared_ptr<Parameter> >::const_iterator it = params.parameters_.begin(); it < params.parameters_.end(); it++)
   {
-    if (hasParameter((*it)->getName()))
-    {
-      Parameter* p = &getParameter((*it)->getName());
-      *p = **it;
-    }
+    size_t i = findParameter_((*it)->getName());
+    if (i < size())
+      *parameters_[i] = **it;
   }
 }
 
 /******************************************************************************/
 void ParameterList::deleteParameter(const std::string& name)
 {
-  for (auto it = parameters_.begin(); it != parameters_.end(); ++it)
+  updateIndex_();
+  size_t i = findParameter_(name);
+  if (i < size())
   {
-    if ((*it)->getName() == name)
-    {
-      it = parameters_.erase(it);
-      return;
-    }
+    deleteParameter(i);
+    return;
   }
   throw ParameterNotFoundException("ParameterList::deleteParameter", name);
 }
@@ -556,6 +556,8 @@ void ParameterList::deleteParameter(size_t index)
 {
   if (index >= size()) throw IndexOutOfBoundsException("ParameterList::deleteParameter.", index, 0, size());
   parameters_.erase(parameters_.begin() + static_cast<ptrdiff_t>(index));
+  //Following parameters are shifted:
+  structureChanged_();
 }
 
 /******************************************************************************/
@@ -571,15 +573,15 @@ void ParameterList::deleteParameters(const std::vector<size_t>& indices)
 //    delete p;
     parameters_.erase(parameters_.begin() + static_cast<ptrdiff_t>(index));
   }
+  structureChanged_();
 }
 
 /******************************************************************************/
 size_t ParameterList::whichParameterHasName(const std::string& name) const
 {
-  for (size_t i = 0; i < size(); i++)
-  {
-    if (parameters_[i]->getName() == name) return i;
-  }
+  size_t i = findParameter_(name);
+  if (i < size())
+    return i;
   throw ParameterNotFoundException("ParameterList::whichParameterHasName.", name);
 }
 
@@ -601,6 +603,49 @@ void ParameterList::printParameters(OutputStream& out) const
 void ParameterList::reset()
 {
   parameters_.resize(0);
+  index_.clear();
+  indexed_ = true;
+  indexVersion_ = Parameter::getNumberOfNameChanges();
+  structureVersion_ = ++structureChanges_;
+}
+
+/******************************************************************************/
+size_t ParameterList::findParameter_(const std::string& name) const
+{
+  if (indexed_ && indexVersion_ == Parameter::getNumberOfNameChanges())
+  {
+    auto it = index_.find(name);
+    return it == index_.end() ? size() : it->second;
+  }
+  for (size_t i = 0; i < size(); i++)
+  {
+    if (parameters_[i]->getName() == name)
+      return i;
+  }
+  return size();
+}
+
+/******************************************************************************/
+void ParameterList::updateIndex_()
+{
+  unsigned long version = Parameter::getNumberOfNameChanges();
+  if (indexed_ && indexVersion_ == version)
+    return;
+  index_.clear();
+  // In case of duplicated names, the first parameter is found, as with a linear search:
+  for (size_t i = 0; i < size(); i++)
+    index_.emplace(parameters_[i]->getName(), i);
+  indexed_ = true;
+  indexVersion_ = version;
+}
+
+/******************************************************************************/
+void ParameterList::pushParameter_(const std::shared_ptr<Parameter>& param)
+{
+  parameters_.push_back(param);
+  if (indexed_)
+    index_.emplace(param->getName(), parameters_.size() - 1);
+  structureVersion_ = ++structureChanges_;
 }
 
 /******************************************************************************/
@@ -48,6 +48,8 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <unordered_map>
+#include <atomic>
 
 namespace bpp
 {
@@ -57,6 +59,11 @@ namespace bpp
  * @author Julien Dutheil, Laurent Gueguen
  * This is a vector of Parameter with a few additional methods, mainly for giving
  * name access.
+ *
+ * Name access uses a hash index of parameter positions, kept up to date by all methods of the list.
+ * As parameters may be renamed outside of the list, the index is rebuilt by the first non-const access
+ * following a renaming (see Parameter::getNumberOfNameChanges). Until then, const accesses fall back
+ * to a linear search.
  */
   class ParameterList :
     public Clonable
@@ -64,11 +71,37 @@ namespace bpp
   private:
     std::vector<std::shared_ptr<Parameter> > parameters_;
 
+    /**
+     * @brief Position of each parameter, by name.
+     */
+    std::unordered_map<std::string, size_t> index_;
+
+    /**
+     * @brief Tell if the index matches the positions of the parameters.
+     */
+    bool indexed_;
+
+    /**
+     * @brief The number of renamings when the index was built.
+     */
+    unsigned long indexVersion_;
+
+    /**
+     * @brief A stamp identifying the parameters of the list and their order.
+     *
+     * A new unique stamp is drawn each time parameters are added, removed or replaced.
+     */
+    unsigned long structureVersion_;
+
+    static std::atomic<unsigned long> structureChanges_;
+
   public:
     /**
      * @brief Build a new ParameterList object.
      */
-    ParameterList() : parameters_() {}
+    ParameterList() :
+      parameters_(), index_(), indexed_(true), indexVersion_(Parameter::getNumberOfNameChanges()),
+      structureVersion_(++structureChanges_) {}
 
     /**
      * @brief Copy constructor
@@ -101,7 +134,31 @@ namespace bpp
      * @warning No check is performed on the validity of the index given as input!
      */
     virtual const std::shared_ptr<Parameter>& getSharedParameter(size_t i) const { return parameters_[i]; }
-    virtual std::shared_ptr<Parameter>& getSharedParameter(size_t i) { return parameters_[i]; }
+    virtual const std::shared_ptr<Parameter>& getSharedParameter(size_t i) { return parameters_[i]; }
+
+    /**
+     * @brief Replace the parameter at a given position by a shared one.
+     *
+     * @param i The position of the parameter to replace.
+     * @param param The parameter to share.
+     * @warning No check is performed on the validity of the index given as input!
+     */
+    virtual void setSharedParameter(size_t i, const std::shared_ptr<Parameter>& param)
+    {
+      parameters_[i] = param;
+      structureChanged_();
+    }
+
+    /**
+     * @brief Get a stamp identifying the parameters of the list and their order.
+     *
+     * Two lists with the same stamp hold parameters with the same names in the same order,
+     * provided no parameter was renamed since (see Parameter::getNumberOfNameChanges).
+     * This allows to check in constant time that a list did not change.
+     *
+     * @return The stamp of the list.
+     */
+    unsigned long getStructureVersion() const { return structureVersion_; }
 
     /**
      * @brief Get the parameter with name <i>name</i>.
@@ -147,7 +204,7 @@ namespace bpp
      * @return A shared parameter toward the parameter with name <i>name</i>.
      * @throw ParameterNotFoundException If no parameter with the given name is found.
      */
-    virtual std::shared_ptr<Parameter>& getSharedParameter(const std::string& name);
+    virtual const std::shared_ptr<Parameter>& getSharedParameter(const std::string& name);
 
     /**
      * @brief Get given parameters as a sublist.
@@ -374,7 +431,24 @@ namespace bpp
      * @see setAllParameters(), matchParameters()
      * @throw ConstraintException If one value is incorrect (and the two parameter list do not have the same constraints).
      */
-    virtual void setParametersValues(const ParameterList& params);
+    virtual void setParametersValues(const ParameterList& params)
+    {
+      setParametersValues_(params, 0);
+    }
+
+    /**
+     * @brief Update the parameters from the ones in <i>params</i>
+     * that have matching names, and get their positions.
+     *
+     * @param params A list containing all parameters to update.
+     * @param updatedPositions A vector where the positions in this list of the parameters that were set are appended.
+     * @see setParametersValues(const ParameterList&)
+     * @throw ConstraintException If one value is incorrect (and the two parameter list do not have the same constraints).
+     */
+    void setParametersValues(const ParameterList& params, std::vector<size_t>& updatedPositions)
+    {
+      setParametersValues_(params, &updatedPositions);
+    }
 
     /**
      * @brief Returns true if the Parameter of the given name exists.
@@ -406,7 +480,27 @@ namespace bpp
      * @see setParameters(), setAllParameters()
      */
 
-    virtual bool matchParametersValues(const ParameterList& params, std::vector<size_t>* updatedParameters = 0);
+    virtual bool matchParametersValues(const ParameterList& params, std::vector<size_t>* updatedParameters = 0)
+    {
+      return matchParametersValues_(params, updatedParameters, 0);
+    }
+
+    /**
+     * @brief Update the parameters from <i>params</i>, and get the positions of the updated ones.
+     *
+     * @param params A list of parameters.
+     * @param updatedParameters An optional pointer toward a vector which will
+     * store the indices of parameters for which a value has changed.
+     * Indices are relative on the input parameter list "params".
+     * @param updatedPositions A vector where the positions in this list of the parameters for which
+     * a value has changed are appended, in the same order as updatedParameters.
+     * @return true iff a least one parameter value has been changed.
+     * @see matchParametersValues(const ParameterList&, std::vector<size_t>*)
+     */
+    bool matchParametersValues(const ParameterList& params, std::vector<size_t>* updatedParameters, std::vector<size_t>& updatedPositions)
+    {
+      return matchParametersValues_(params, updatedParameters, &updatedPositions);
+    }
 
     /**
      * @brief Set the parameters to be equals to <i>params</i>.
@@ -496,6 +590,35 @@ namespace bpp
      * @brief Reset the list: delete all parameters.
      */
     virtual void reset();
+
+  private:
+    /**
+     * @return The position of the parameter with a given name, or the size of the list if there is none.
+     */
+    size_t findParameter_(const std::string& name) const;
+
+    /**
+     * @brief Rebuild the index if needed.
+     */
+    void updateIndex_();
+
+    void setParametersValues_(const ParameterList& params, std::vector<size_t>* updatedPositions);
+
+    bool matchParametersValues_(const ParameterList& params, std::vector<size_t>* updatedParameters, std::vector<size_t>* updatedPositions);
+
+    /**
+     * @brief Append a parameter, without checking its name.
+     */
+    void pushParameter_(const std::shared_ptr<Parameter>& param);
+
+    /**
+     * @brief Invalidate the index and draw a new structure stamp, after parameters were removed or replaced.
+     */
+    void structureChanged_()
+    {
+      indexed_ = false;
+      structureVersion_ = ++structureChanges_;
+    }
   };
 } // end of namespace bpp.
 
@@ -0,0 +1,168 @@
+//
+// File: ParameterListView.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _PARAMETERLISTVIEW_H_
+#define _PARAMETERLISTVIEW_H_
+
+#include "ParameterList.h"
+
+// From the STL:
+#include <vector>
+#include <string>
+
+namespace bpp
+{
+/**
+ * @brief A read-only subset of a ParameterList, given by positions.
+ *
+ * Contrary to ParameterList::createSubList, building a view does not copy any parameter:
+ * the parameters are accessed through the parent list, and their current values are
+ * always seen. The parent list must outlive the view, and its parameters must not be
+ * added, deleted or reordered while the view is used.
+ *
+ * A ParameterList object can be created from the view if needed, with createList() (copying
+ * the parameters) or shareList() (sharing them).
+ */
+  class ParameterListView
+  {
+  private:
+    const ParameterList* parent_;
+    std::vector<size_t> positions_;
+
+  public:
+    /**
+     * @brief Build a view of all the parameters of a list.
+     */
+    ParameterListView(const ParameterList& parent) :
+      parent_(&parent), positions_(parent.size())
+    {
+      for (size_t i = 0; i < positions_.size(); i++)
+        positions_[i] = i;
+    }
+
+    /**
+     * @brief Build a view of the parameters at given positions.
+     *
+     * @throw IndexOutOfBoundsException If one of the positions is not valid.
+     */
+    ParameterListView(const ParameterList& parent, const std::vector<size_t>& positions) :
+      parent_(&parent), positions_(positions)
+    {
+      for (size_t i = 0; i < positions_.size(); i++)
+        if (positions_[i] >= parent.size())
+          throw IndexOutOfBoundsException("ParameterListView::ParameterListView.", positions_[i], 0, parent.size() - 1);
+    }
+
+    /**
+     * @brief Build a view of the parameters with given names.
+     *
+     * @throw ParameterNotFoundException If one of the names is not in the list.
+     */
+    ParameterListView(const ParameterList& parent, const std::vector<std::string>& names) :
+      parent_(&parent), positions_(names.size())
+    {
+      for (size_t i = 0; i < names.size(); i++)
+        positions_[i] = parent.whichParameterHasName(names[i]);
+    }
+
+    ParameterListView(const ParameterListView& plv) :
+      parent_(plv.parent_), positions_(plv.positions_) {}
+
+    ParameterListView& operator=(const ParameterListView& plv)
+    {
+      parent_    = plv.parent_;
+      positions_ = plv.positions_;
+      return *this;
+    }
+
+    virtual ~ParameterListView() {}
+
+  public:
+    size_t size() const { return positions_.size(); }
+
+    const Parameter& operator[](size_t i) const { return (*parent_)[positions_[i]]; }
+
+    /**
+     * @return The position in the parent list of the i-th parameter of the view.
+     */
+    size_t getPosition(size_t i) const { return positions_[i]; }
+
+    const std::vector<size_t>& getPositions() const { return positions_; }
+
+    const ParameterList& getParentList() const { return *parent_; }
+
+    /**
+     * @return True if a parameter with the given name is in the view.
+     */
+    bool hasParameter(const std::string& name) const
+    {
+      for (size_t i = 0; i < positions_.size(); i++)
+        if ((*parent_)[positions_[i]].getName() == name)
+          return true;
+      return false;
+    }
+
+    std::vector<std::string> getParameterNames() const
+    {
+      std::vector<std::string> names(positions_.size());
+      for (size_t i = 0; i < positions_.size(); i++)
+        names[i] = (*parent_)[positions_[i]].getName();
+      return names;
+    }
+
+    std::vector<double> getParameterValues() const
+    {
+      std::vector<double> values(positions_.size());
+      for (size_t i = 0; i < positions_.size(); i++)
+        values[i] = (*parent_)[positions_[i]].getValue();
+      return values;
+    }
+
+    /**
+     * @return A list with copies of the parameters of the view.
+     */
+    ParameterList createList() const { return parent_->createSubList(positions_); }
+
+    /**
+     * @return A list sharing the parameters of the view with the parent list.
+     */
+    ParameterList shareList() const { return parent_->shareSubList(positions_); }
+  };
+
+} // end of namespace bpp.
+
+#endif // _PARAMETERLISTVIEW_H_
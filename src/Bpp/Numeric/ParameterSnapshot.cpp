@@ -0,0 +1,134 @@
+//
+// File: ParameterSnapshot.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "ParameterSnapshot.h"
+#include "VectorExceptions.h"
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+ParameterSchema::ParameterSchema(const ParameterList& pl) :
+  names_(pl.size()),
+  constraints_(pl.size()),
+  precisions_(pl.size()),
+  index_(),
+  constraintArray_()
+{
+  for (size_t i = 0; i < pl.size(); i++)
+  {
+    names_[i] = pl[i].getName();
+    constraints_[i] = pl[i].getConstraint();
+    precisions_[i] = pl[i].getPrecision();
+    // In case of duplicated names, the first parameter is found, as with a ParameterList:
+    index_.emplace(names_[i], i);
+    constraintArray_.addConstraint(constraints_[i]);
+  }
+}
+
+/******************************************************************************/
+
+size_t ParameterSchema::getPosition(const std::string& name) const
+{
+  auto it = index_.find(name);
+  if (it == index_.end())
+    throw ParameterNotFoundException("ParameterSchema::getPosition.", name);
+  return it->second;
+}
+
+/******************************************************************************/
+
+bool ParameterSchema::matches(const ParameterList& pl) const
+{
+  if (pl.size() != names_.size())
+    return false;
+  for (size_t i = 0; i < names_.size(); i++)
+  {
+    if (pl[i].getName() != names_[i])
+      return false;
+  }
+  return true;
+}
+
+/******************************************************************************/
+
+ParameterSnapshot::ParameterSnapshot(const ParameterList& pl) :
+  schema_(make_shared<ParameterSchema>(pl)),
+  values_(pl.size())
+{
+  for (size_t i = 0; i < pl.size(); i++)
+    values_[i] = pl[i].getValue();
+}
+
+/******************************************************************************/
+
+ParameterSnapshot::ParameterSnapshot(const std::shared_ptr<const ParameterSchema>& schema, const std::vector<double>& values) :
+  schema_(schema),
+  values_(values)
+{
+  if (values_.size() != schema_->size())
+    throw DimensionException("ParameterSnapshot::ParameterSnapshot(). Wrong number of values.", values_.size(), schema_->size());
+}
+
+/******************************************************************************/
+
+bool ParameterSnapshot::isCorrect() const
+{
+  return schema_->getConstraintArray().areCorrect(values_);
+}
+
+/******************************************************************************/
+
+ParameterSnapshot ParameterSnapshot::withValue(size_t i, double value) const
+{
+  if (i >= values_.size())
+    throw IndexOutOfBoundsException("ParameterSnapshot::withValue.", i, 0, values_.size() - 1);
+  vector<double> values(values_);
+  values[i] = value;
+  return ParameterSnapshot(schema_, values);
+}
+
+/******************************************************************************/
+
+ParameterList ParameterSnapshot::createParameterList() const
+{
+  ParameterList pl;
+  for (size_t i = 0; i < values_.size(); i++)
+    pl.addParameter(new Parameter(schema_->getName(i), values_[i], schema_->getConstraint(i), schema_->getPrecision(i)));
+  return pl;
+}
@@ -0,0 +1,191 @@
+//
+// File: ParameterSnapshot.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _PARAMETERSNAPSHOT_H_
+#define _PARAMETERSNAPSHOT_H_
+
+#include "ParameterList.h"
+#include "Constraints.h"
+
+// From the STL:
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+namespace bpp
+{
+/**
+ * @brief The names, constraints and precisions of a list of parameters, without their values.
+ *
+ * A schema cannot be modified once built, and can therefore be shared by several
+ * ParameterSnapshot objects and used from several threads.
+ */
+  class ParameterSchema
+  {
+  private:
+    std::vector<std::string> names_;
+    std::vector< std::shared_ptr<Constraint> > constraints_;
+    std::vector<double> precisions_;
+    std::unordered_map<std::string, size_t> index_;
+    ConstraintArray constraintArray_;
+
+  public:
+    /**
+     * @brief Build the schema of a list of parameters.
+     */
+    ParameterSchema(const ParameterList& pl);
+
+    virtual ~ParameterSchema() {}
+
+  public:
+    size_t size() const { return names_.size(); }
+
+    const std::string& getName(size_t i) const { return names_[i]; }
+
+    const std::vector<std::string>& getParameterNames() const { return names_; }
+
+    /**
+     * @return The constraint of the i-th parameter, or a null pointer if the parameter is not constrained.
+     */
+    const std::shared_ptr<Constraint>& getConstraint(size_t i) const { return constraints_[i]; }
+
+    /**
+     * @return All constraints, for checking a whole vector of values at once.
+     * Bounds of interval constraints are copied when the schema is built.
+     */
+    const ConstraintArray& getConstraintArray() const { return constraintArray_; }
+
+    double getPrecision(size_t i) const { return precisions_[i]; }
+
+    bool hasParameter(const std::string& name) const { return index_.find(name) != index_.end(); }
+
+    /**
+     * @return The position of the parameter with the given name.
+     * @throw ParameterNotFoundException If no parameter has this name.
+     */
+    size_t getPosition(const std::string& name) const;
+
+    /**
+     * @return True if the list has the same parameter names, in the same order.
+     */
+    bool matches(const ParameterList& pl) const;
+  };
+
+/**
+ * @brief An immutable set of parameter values.
+ *
+ * A snapshot stores the values of a list of parameters in a flat vector, together with
+ * a pointer toward their (shared) schema. Contrary to Parameter objects, snapshots have
+ * no listener and cannot be modified, so that they can be passed to several threads
+ * evaluating the same function at different points (see Function::evaluate).
+ *
+ * New points are obtained from an existing snapshot with withValue() and withValues(),
+ * which share the schema of the original snapshot.
+ */
+  class ParameterSnapshot
+  {
+  private:
+    std::shared_ptr<const ParameterSchema> schema_;
+    std::vector<double> values_;
+
+  public:
+    /**
+     * @brief Take a snapshot of the current values of a list of parameters.
+     */
+    ParameterSnapshot(const ParameterList& pl);
+
+    /**
+     * @brief Build a snapshot from a schema and values.
+     *
+     * @param schema The schema of the parameters.
+     * @param values The values of the parameters, in the order of the schema.
+     * @throw DimensionException If the number of values does not match the schema.
+     */
+    ParameterSnapshot(const std::shared_ptr<const ParameterSchema>& schema, const std::vector<double>& values);
+
+    virtual ~ParameterSnapshot() {}
+
+  public:
+    const std::shared_ptr<const ParameterSchema>& getSchema() const { return schema_; }
+
+    size_t size() const { return values_.size(); }
+
+    const std::string& getName(size_t i) const { return schema_->getName(i); }
+
+    double getValue(size_t i) const { return values_[i]; }
+
+    const std::vector<double>& getValues() const { return values_; }
+
+    bool hasParameter(const std::string& name) const { return schema_->hasParameter(name); }
+
+    /**
+     * @return The value of the parameter with the given name.
+     * @throw ParameterNotFoundException If no parameter has this name.
+     */
+    double getParameterValue(const std::string& name) const { return values_[schema_->getPosition(name)]; }
+
+    /**
+     * @return True if all values fulfill the constraints of the parameters.
+     */
+    bool isCorrect() const;
+
+    /**
+     * @return A new snapshot with the same schema, where the i-th value is replaced.
+     * @throw IndexOutOfBoundsException If i is not a valid position.
+     */
+    ParameterSnapshot withValue(size_t i, double value) const;
+
+    /**
+     * @return A new snapshot with the same schema and the given values.
+     * @throw DimensionException If the number of values does not match the schema.
+     */
+    ParameterSnapshot withValues(const std::vector<double>& values) const
+    {
+      return ParameterSnapshot(schema_, values);
+    }
+
+    /**
+     * @return A new list of parameters with the names, constraints, precisions and values of the snapshot.
+     * @throw ConstraintException If a value does not match the constraint of its parameter.
+     */
+    ParameterList createParameterList() const;
+  };
+
+} // end of namespace bpp.
+
+#endif // _PARAMETERSNAPSHOT_H_
@@ -144,6 +144,10 @@ namespace bpp
     RTransformedParameter* clone() const { return new RTransformedParameter(*this); }
 
   public:
+    double getScale() const { return scale_; }
+    double getBound() const { return bound_; }
+    bool isPositive() const { return positive_; }
+
     void setOriginalValue(double value) 
     {
       if (positive_ ? value <= bound_ : value >= bound_) throw ConstraintException("RTransformedParameter::setValue", this, value);
@@ -237,6 +241,11 @@ namespace bpp
     IntervalTransformedParameter* clone() const { return new IntervalTransformedParameter(*this); }
 
   public:
+    double getScale() const { return scale_; }
+    double getLowerBound() const { return lowerBound_; }
+    double getUpperBound() const { return upperBound_; }
+    bool isHyperbolic() const { return hyper_; }
+
     void setOriginalValue(double value) 
     {
       if (value <= lowerBound_ || value >= upperBound_) throw ConstraintException("IntervalTransformedParameter::setValue", this, value);
@@ -0,0 +1,260 @@
+//
+// File: TransformedParameterArray.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "TransformedParameterArray.h"
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+TransformedParameterArray::TransformedParameterArray(const ParameterList& pl) :
+  size_(pl.size()),
+  identity_(),
+  rPositive_(),
+  rNegative_(),
+  intervalHyper_(),
+  intervalTan_(),
+  others_()
+{
+  for (size_t i = 0; i < pl.size(); i++)
+  {
+    const Parameter& p = pl[i];
+    if (typeid(p) == typeid(PlaceboTransformedParameter))
+      identity_.push_back(i);
+    else if (typeid(p) == typeid(RTransformedParameter))
+    {
+      const RTransformedParameter& rp = dynamic_cast<const RTransformedParameter&>(p);
+      (rp.isPositive() ? rPositive_ : rNegative_).add(i, rp.getBound(), 0., rp.getScale());
+    }
+    else if (typeid(p) == typeid(IntervalTransformedParameter))
+    {
+      const IntervalTransformedParameter& ip = dynamic_cast<const IntervalTransformedParameter&>(p);
+      (ip.isHyperbolic() ? intervalHyper_ : intervalTan_).add(i, ip.getLowerBound(), ip.getUpperBound(), ip.getScale());
+    }
+    else
+    {
+      const TransformedParameter* tp = dynamic_cast<const TransformedParameter*>(&p);
+      if (!tp)
+        throw Exception("TransformedParameterArray. Parameter " + p.getName() + " is not a transformed parameter.");
+      others_.push_back(make_pair(i, shared_ptr<TransformedParameter>(tp->clone())));
+    }
+  }
+}
+
+/******************************************************************************/
+
+void TransformedParameterArray::getOriginalValues(const vector<double>& transformed, vector<double>& original) const
+{
+  checkSize_("getOriginalValues", transformed);
+  original.resize(size_);
+  const double* x = transformed.data();
+  double* y = original.data();
+  for (size_t k = 0; k < identity_.size(); ++k)
+    y[identity_[k]] = x[identity_[k]];
+  for (size_t k = 0; k < rPositive_.positions.size(); ++k)
+  {
+    size_t i = rPositive_.positions[k];
+    double s = rPositive_.scale[k], b = rPositive_.a[k];
+    y[i] = x[i] < 0 ? exp(x[i]) / s + b : x[i] / s + 1. + b;
+  }
+  for (size_t k = 0; k < rNegative_.positions.size(); ++k)
+  {
+    size_t i = rNegative_.positions[k];
+    double s = rNegative_.scale[k], b = rNegative_.a[k];
+    y[i] = x[i] < 0 ? - exp(-x[i]) / s + b : - x[i] / s - 1. + b;
+  }
+  for (size_t k = 0; k < intervalHyper_.positions.size(); ++k)
+  {
+    size_t i = intervalHyper_.positions[k];
+    double s = intervalHyper_.scale[k], l = intervalHyper_.a[k], u = intervalHyper_.b[k];
+    y[i] = (tanh(x[i] / s) + 1.) * (u - l) / 2. + l;
+  }
+  for (size_t k = 0; k < intervalTan_.positions.size(); ++k)
+  {
+    size_t i = intervalTan_.positions[k];
+    double s = intervalTan_.scale[k], l = intervalTan_.a[k], u = intervalTan_.b[k];
+    y[i] = (atan(x[i] / s) + NumConstants::PI() / 2.) * (u - l) / NumConstants::PI() + l;
+  }
+  for (size_t k = 0; k < others_.size(); ++k)
+  {
+    size_t i = others_[k].first;
+    unique_ptr<TransformedParameter> tp(others_[k].second->clone());
+    tp->setValue(x[i]);
+    y[i] = tp->getOriginalValue();
+  }
+}
+
+/******************************************************************************/
+
+void TransformedParameterArray::getTransformedValues(const vector<double>& original, vector<double>& transformed) const
+{
+  checkSize_("getTransformedValues", original);
+  transformed.resize(size_);
+  const double* x = original.data();
+  double* y = transformed.data();
+  for (size_t k = 0; k < identity_.size(); ++k)
+    y[identity_[k]] = x[identity_[k]];
+  for (size_t k = 0; k < rPositive_.positions.size(); ++k)
+  {
+    size_t i = rPositive_.positions[k];
+    double s = rPositive_.scale[k], b = rPositive_.a[k];
+    if (x[i] <= b)
+      throw OutOfRangeException("TransformedParameterArray::getTransformedValues.", x[i], b, NumConstants::PINF());
+    y[i] = x[i] < 1 + b ? log(s * (x[i] - b)) : s * (x[i] - 1. - b);
+  }
+  for (size_t k = 0; k < rNegative_.positions.size(); ++k)
+  {
+    size_t i = rNegative_.positions[k];
+    double s = rNegative_.scale[k], b = rNegative_.a[k];
+    if (x[i] >= b)
+      throw OutOfRangeException("TransformedParameterArray::getTransformedValues.", x[i], NumConstants::MINF(), b);
+    y[i] = x[i] > -1 + b ? log(-s * (x[i] - b)) : -s * (x[i] - 1. - b);
+  }
+  for (size_t k = 0; k < intervalHyper_.positions.size(); ++k)
+  {
+    size_t i = intervalHyper_.positions[k];
+    double s = intervalHyper_.scale[k], l = intervalHyper_.a[k], u = intervalHyper_.b[k];
+    if (x[i] <= l || x[i] >= u)
+      throw OutOfRangeException("TransformedParameterArray::getTransformedValues.", x[i], l, u);
+    y[i] = s * atanh(2. * (x[i] - l) / (u - l) - 1.);
+  }
+  for (size_t k = 0; k < intervalTan_.positions.size(); ++k)
+  {
+    size_t i = intervalTan_.positions[k];
+    double s = intervalTan_.scale[k], l = intervalTan_.a[k], u = intervalTan_.b[k];
+    if (x[i] <= l || x[i] >= u)
+      throw OutOfRangeException("TransformedParameterArray::getTransformedValues.", x[i], l, u);
+    y[i] = s * std::tan(NumConstants::PI() * (x[i] - l) / (u - l) - NumConstants::PI() / 2.);
+  }
+  for (size_t k = 0; k < others_.size(); ++k)
+  {
+    size_t i = others_[k].first;
+    unique_ptr<TransformedParameter> tp(others_[k].second->clone());
+    tp->setOriginalValue(x[i]);
+    y[i] = tp->getValue();
+  }
+}
+
+/******************************************************************************/
+
+void TransformedParameterArray::getFirstOrderDerivatives(const vector<double>& transformed, vector<double>& derivatives) const
+{
+  checkSize_("getFirstOrderDerivatives", transformed);
+  derivatives.resize(size_);
+  const double* x = transformed.data();
+  double* y = derivatives.data();
+  for (size_t k = 0; k < identity_.size(); ++k)
+    y[identity_[k]] = 1.;
+  for (size_t k = 0; k < rPositive_.positions.size(); ++k)
+  {
+    size_t i = rPositive_.positions[k];
+    double s = rPositive_.scale[k];
+    y[i] = x[i] < 0 ? exp(x[i]) / s : 1. / s;
+  }
+  for (size_t k = 0; k < rNegative_.positions.size(); ++k)
+  {
+    size_t i = rNegative_.positions[k];
+    double s = rNegative_.scale[k];
+    y[i] = x[i] < 0 ? exp(-x[i]) / s : - 1. / s;
+  }
+  for (size_t k = 0; k < intervalHyper_.positions.size(); ++k)
+  {
+    size_t i = intervalHyper_.positions[k];
+    double s = intervalHyper_.scale[k], l = intervalHyper_.a[k], u = intervalHyper_.b[k];
+    y[i] = 1. / (std::pow(cosh(x[i] / s), 2)) * (u - l) / (2. * s);
+  }
+  for (size_t k = 0; k < intervalTan_.positions.size(); ++k)
+  {
+    size_t i = intervalTan_.positions[k];
+    double s = intervalTan_.scale[k], l = intervalTan_.a[k], u = intervalTan_.b[k];
+    y[i] = (u - l) / (NumConstants::PI() * s * (std::pow(x[i] / s, 2) + 1.));
+  }
+  for (size_t k = 0; k < others_.size(); ++k)
+  {
+    size_t i = others_[k].first;
+    unique_ptr<TransformedParameter> tp(others_[k].second->clone());
+    tp->setValue(x[i]);
+    y[i] = tp->getFirstOrderDerivative();
+  }
+}
+
+/******************************************************************************/
+
+void TransformedParameterArray::getSecondOrderDerivatives(const vector<double>& transformed, vector<double>& derivatives) const
+{
+  checkSize_("getSecondOrderDerivatives", transformed);
+  derivatives.resize(size_);
+  const double* x = transformed.data();
+  double* y = derivatives.data();
+  for (size_t k = 0; k < identity_.size(); ++k)
+    y[identity_[k]] = 0.;
+  for (size_t k = 0; k < rPositive_.positions.size(); ++k)
+  {
+    size_t i = rPositive_.positions[k];
+    double s = rPositive_.scale[k];
+    y[i] = x[i] < 0 ? exp(x[i]) / s : 0.;
+  }
+  for (size_t k = 0; k < rNegative_.positions.size(); ++k)
+  {
+    size_t i = rNegative_.positions[k];
+    double s = rNegative_.scale[k];
+    y[i] = x[i] < 0 ? - exp(-x[i]) / s : 0.;
+  }
+  for (size_t k = 0; k < intervalHyper_.positions.size(); ++k)
+  {
+    size_t i = intervalHyper_.positions[k];
+    double s = intervalHyper_.scale[k], l = intervalHyper_.a[k], u = intervalHyper_.b[k];
+    y[i] = - 1. / (std::pow(cosh(x[i] / s), 2)) * tanh(x[i] / s) * (u - l) / (s * s);
+  }
+  for (size_t k = 0; k < intervalTan_.positions.size(); ++k)
+  {
+    size_t i = intervalTan_.positions[k];
+    double s = intervalTan_.scale[k], l = intervalTan_.a[k], u = intervalTan_.b[k];
+    y[i] = -2. * x[i] * (u - l) / (NumConstants::PI() * std::pow(s, 3) * std::pow((std::pow(x[i] / s, 2) + 1.), 2));
+  }
+  for (size_t k = 0; k < others_.size(); ++k)
+  {
+    size_t i = others_[k].first;
+    unique_ptr<TransformedParameter> tp(others_[k].second->clone());
+    tp->setValue(x[i]);
+    y[i] = tp->getSecondOrderDerivative();
+  }
+}
+
+/******************************************************************************/
+
@@ -0,0 +1,154 @@
+//
+// File: TransformedParameterArray.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _TRANSFORMEDPARAMETERARRAY_H_
+#define _TRANSFORMEDPARAMETERARRAY_H_
+
+#include "TransformedParameter.h"
+#include "ParameterList.h"
+
+// From the STL:
+#include <vector>
+#include <memory>
+
+namespace bpp
+{
+
+/**
+ * @brief Transformations of a list of TransformedParameter objects, applied to whole vectors of values.
+ *
+ * The transformations of the list are grouped by type, and the parameters of each group
+ * (bounds and scales) are stored as arrays, so that a vector of values is transformed
+ * with one loop per group, without virtual call.
+ * The i-th value of the vectors corresponds to the i-th parameter of the list used to build the array.
+ * Transformations are computed as with TransformedParameter::getOriginalValue(),
+ * TransformedParameter::setOriginalValue() and derivative methods.
+ * Parameters of unknown types are transformed one by one, using a copy of the parameter.
+ *
+ * The values of the parameters are not stored, and all methods are const and thread-safe.
+ */
+  class TransformedParameterArray
+  {
+  private:
+    /**
+     * @brief Parameters of a group of transformations of the same type.
+     *
+     * For RTransformedParameter, 'a' is the bound. For IntervalTransformedParameter,
+     * 'a' and 'b' are the lower and upper bounds.
+     */
+    struct Group_
+    {
+      std::vector<size_t> positions;
+      std::vector<double> a, b, scale;
+      Group_() : positions(), a(), b(), scale() {}
+      void add(size_t position, double av, double bv, double s)
+      {
+        positions.push_back(position);
+        a.push_back(av);
+        b.push_back(bv);
+        scale.push_back(s);
+      }
+    };
+
+    size_t size_;
+    std::vector<size_t> identity_;
+    Group_ rPositive_, rNegative_, intervalHyper_, intervalTan_;
+    std::vector< std::pair<size_t, std::shared_ptr<TransformedParameter> > > others_;
+
+  public:
+    /**
+     * @brief Build the transformations of a list of parameters.
+     *
+     * @param pl A list of TransformedParameter objects.
+     * @throw Exception If a parameter in the list is not a TransformedParameter.
+     */
+    TransformedParameterArray(const ParameterList& pl);
+
+    virtual ~TransformedParameterArray() {}
+
+  public:
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Get the values in original coordinates.
+     *
+     * @param transformed Values in transformed coordinates.
+     * @param original    [out] Values in original coordinates.
+     * @throw BadSizeException If the number of values does not match.
+     */
+    void getOriginalValues(const std::vector<double>& transformed, std::vector<double>& original) const;
+
+    /**
+     * @brief Get the values in transformed coordinates.
+     *
+     * @param original    Values in original coordinates.
+     * @param transformed [out] Values in transformed coordinates.
+     * @throw BadSizeException If the number of values does not match.
+     * @throw OutOfRangeException If a value is out of the interval of its transformation.
+     */
+    void getTransformedValues(const std::vector<double>& original, std::vector<double>& transformed) const;
+
+    /**
+     * @brief Get the first order derivatives of the transformations.
+     *
+     * @param transformed Values in transformed coordinates.
+     * @param derivatives [out] First order derivatives of the original values with respect to the transformed ones.
+     * @throw BadSizeException If the number of values does not match.
+     */
+    void getFirstOrderDerivatives(const std::vector<double>& transformed, std::vector<double>& derivatives) const;
+
+    /**
+     * @brief Get the second order derivatives of the transformations.
+     *
+     * @param transformed Values in transformed coordinates.
+     * @param derivatives [out] Second order derivatives of the original values with respect to the transformed ones.
+     * @throw BadSizeException If the number of values does not match.
+     */
+    void getSecondOrderDerivatives(const std::vector<double>& transformed, std::vector<double>& derivatives) const;
+
+  private:
+    void checkSize_(const std::string& method, const std::vector<double>& values) const
+    {
+      if (values.size() != size_)
+        throw BadSizeException("TransformedParameterArray::" + method + ".", values.size(), size_);
+    }
+  };
+
+} //end of namespace bpp.
+
+#endif //_TRANSFORMEDPARAMETERARRAY_H_
+
@@ -687,12 +687,8 @@ namespace bpp
       T M = max(v1);
       if (std::isinf(M))
         return M;
-    
-      T x = std::accumulate(std::next(v1.begin()), v1.end(), std::exp(v1[0]-M),
-                            [&M](T y, T z){
-                              return y + std::exp(z-M);});
-      
-      return std::log(x) + M;
+
+      return std::log(NumTools::sumExp(&v1[0], v1.size(), M)) + M;
     }
 
     /**
@@ -712,13 +708,8 @@ namespace bpp
       T M = max(v1);
       if (std::isinf(M))
         throw BadNumberException("VectorTools::logSumExp", M);
-    
-      T x = v2[0] * std::exp(v1[0] - M);
-      for (size_t i = 1; i < size; i++)
-      {
-        x += v2[i] * std::exp(v1[i] - M);
-      }
-      return std::log(x) + M;
+
+      return std::log(NumTools::weightedSumExp(&v1[0], &v2[0], size, M)) + M;
     }
 
     /**
@@ -735,23 +726,22 @@ namespace bpp
 
     /**
      * @author Laurent Gueguen
-     * @return From std::vector v1, return @f$\sum_i(\exp(v1_i))@f$.
+     * @return From std::vector v1, return @f$\sum_i(\exp(v1_i))@f$, 0 if v1 is empty.
      * @param v1 a std::vector.
      */
     template<class T>
     static T sumExp(const std::vector<T>& v1)
     {
       if (v1.size()==0)
+        return 0;
+      if (v1.size()==1)
         return std::exp(v1[0]);
       
       T M = max(v1);
       if (std::isinf(M))
         return (M<0?0:M);
 
-      T x = std::accumulate(std::next(v1.begin()), v1.end(), std::exp(v1[0]-M),
-                            [&M](T y, T z){
-                              return y + std::exp(z-M);});
-      return x * std::exp(M);
+      return NumTools::sumExp(&v1[0], v1.size(), M) * std::exp(M);
     }
 
     /**
@@ -775,12 +765,7 @@ namespace bpp
       if (std::isinf(M))
         throw BadNumberException("VectorTools::sumExp", M);
 
-      T x = v2[0] * std::exp(v1[0] - M);
-      for (size_t i = 1; i < size; i++)
-      {
-        x += v2[i] * std::exp(v1[i] - M);
-      }
-      return x * std::exp(M);
+      return NumTools::weightedSumExp(&v1[0], &v2[0], size, M) * std::exp(M);
     }
 
     /**
@@ -0,0 +1,139 @@
+//
+// File: ThreadTools.cpp
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#include "ThreadTools.h"
+
+// From the STL:
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+using namespace bpp;
+using namespace std;
+
+/******************************************************************************/
+
+size_t ThreadTools::getNumberOfAvailableThreads()
+{
+  unsigned int n = thread::hardware_concurrency();
+  return n > 0 ? static_cast<size_t>(n) : 1;
+}
+
+/******************************************************************************/
+
+void ThreadTools::parallelFor(size_t nbTasks, size_t nbThreads, const function<void (size_t)>& task)
+{
+  vector<size_t> tasks(nbTasks);
+  for (size_t i = 0; i < nbTasks; ++i)
+  {
+    tasks[i] = i;
+  }
+  parallelFor(tasks, nbThreads, task);
+}
+
+/******************************************************************************/
+
+void ThreadTools::parallelFor(const vector<size_t>& tasks, size_t nbThreads, const function<void (size_t)>& task)
+{
+  nbThreads = min(nbThreads, tasks.size());
+  if (nbThreads <= 1)
+  {
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+      task(tasks[i]);
+    }
+    return;
+  }
+
+  atomic<size_t> next(0);
+  atomic<bool> failed(false);
+  exception_ptr error;
+  mutex errorMutex;
+
+  auto worker = [&]() {
+    size_t i;
+    while (!failed && (i = next++) < tasks.size())
+    {
+      try
+      {
+        task(tasks[i]);
+      }
+      catch (...)
+      {
+        lock_guard<mutex> lock(errorMutex);
+        if (!error)
+          error = current_exception();
+        failed = true;
+      }
+    }
+  };
+
+  // The calling thread is also a worker:
+  vector<thread> threads;
+  threads.reserve(nbThreads - 1);
+  for (size_t t = 1; t < nbThreads; ++t)
+  {
+    threads.push_back(thread(worker));
+  }
+  worker();
+  for (size_t t = 0; t < threads.size(); ++t)
+  {
+    threads[t].join();
+  }
+
+  if (error)
+    rethrow_exception(error);
+}
+
+/******************************************************************************/
+
+vector<size_t> ThreadTools::getDispatchOrder(const vector<size_t>& costs)
+{
+  vector<size_t> order(costs.size());
+  for (size_t i = 0; i < costs.size(); ++i)
+  {
+    order[i] = i;
+  }
+  stable_sort(order.begin(), order.end(), [&costs](size_t a, size_t b) {
+    return costs[a] > costs[b];
+  });
+  return order;
+}
+
+/******************************************************************************/
@@ -0,0 +1,106 @@
+//
+// File: ThreadTools.h
+//
+
+/*
+   Copyright or © or Copr. Bio++ Development Tools, (November 17, 2004)
+
+   This software is a computer program whose purpose is to provide basal and
+   utilitary classes. This file belongs to the Bio++ Project.
+
+   This software is governed by the CeCILL  license under French law and
+   abiding by the rules of distribution of free software.  You can  use,
+   modify and/ or redistribute the software under the terms of the CeCILL
+   license as circulated by CEA, CNRS and INRIA at the following URL
+   "http://www.cecill.info".
+
+   As a counterpart to the access to the source code and  rights to copy,
+   modify and redistribute granted by the license, users are provided only
+   with a limited warranty  and the software's author,  the holder of the
+   economic rights,  and the successive licensors  have only  limited
+   liability.
+
+   In this respect, the user's attention is drawn to the risks associated
+   with loading,  using,  modifying and/or developing or reproducing the
+   software by the user in light of its specific status of free software,
+   that may mean  that it is complicated to manipulate,  and  that  also
+   therefore means  that it is reserved for developers  and  experienced
+   professionals having in-depth computer knowledge. Users are therefore
+   encouraged to load and test the software's suitability as regards their
+   requirements in conditions enabling the security of their systems and/or
+   data to be ensured and,  more generally, to use and operate it in the
+   same conditions as regards security.
+
+   The fact that you are presently reading this means that you have had
+   knowledge of the CeCILL license and that you accept its terms.
+ */
+
+#ifndef _THREADTOOLS_H_
+#define _THREADTOOLS_H_
+
+// From the STL:
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace bpp
+{
+/**
+ * @brief Some functions to run independent tasks on several threads.
+ *
+ * Tasks are identified by an index and dispatched dynamically: each thread
+ * picks the next pending task when it is done with the previous one. When
+ * tasks have unequal costs, passing them in decreasing order of cost gives
+ * a good load balancing (longest processing time first).
+ *
+ * Tasks must only write to memory locations which are not shared with other
+ * tasks. Reductions should be performed by the caller once all tasks are
+ * done, in a fixed order, so that results do not depend on the number of
+ * threads used.
+ *
+ * If a task throws an exception, no new task is started, and the exception
+ * is rethrown in the calling thread once all running tasks are finished.
+ */
+class ThreadTools
+{
+public:
+  ThreadTools() {}
+  virtual ~ThreadTools() {}
+
+public:
+  /**
+   * @return The number of concurrent threads supported by the hardware, or 1 if unknown.
+   */
+  static size_t getNumberOfAvailableThreads();
+
+  /**
+   * @brief Run task(i) for all i in [0, nbTasks[.
+   *
+   * @param nbTasks   The number of tasks to run.
+   * @param nbThreads The maximum number of threads to use. If 0 or 1, tasks are run sequentially in the calling thread.
+   * @param task      The function to apply to each task index.
+   */
+  static void parallelFor(size_t nbTasks, size_t nbThreads, const std::function<void (size_t)>& task);
+
+  /**
+   * @brief Run task(i) for all i in tasks, dispatched in the given order.
+   *
+   * @param tasks     The indices of the tasks to run, in dispatch order.
+   * @param nbThreads The maximum number of threads to use. If 0 or 1, tasks are run sequentially in the calling thread.
+   * @param task      The function to apply to each task index.
+   */
+  static void parallelFor(const std::vector<size_t>& tasks, size_t nbThreads, const std::function<void (size_t)>& task);
+
+  /**
+   * @brief Get the dispatch order of tasks with the given costs (longest first).
+   *
+   * Ties are broken by index, so that the order is deterministic.
+   *
+   * @param costs The cost of each task.
+   * @return Task indices sorted by decreasing cost.
+   */
+  static std::vector<size_t> getDispatchOrder(const std::vector<size_t>& costs);
+};
+} // end of namespace bpp.
+
+#endif // _THREADTOOLS_H_
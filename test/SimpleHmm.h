@@ -0,0 +1,271 @@
+//
+// File: SimpleHmm.h
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include <Bpp/Numeric/Hmm/HmmStateAlphabet.h>
+#include <Bpp/Numeric/Hmm/HmmEmissionProbabilities.h>
+#include <Bpp/Numeric/Hmm/AutoCorrelationTransitionMatrix.h>
+#include <Bpp/Numeric/AbstractParametrizable.h>
+#include <Bpp/Numeric/Number.h>
+#include <Bpp/Numeric/NumConstants.h>
+#include <Bpp/Numeric/Random/RandomTools.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <utility>
+
+using namespace bpp;
+using namespace std;
+
+/**
+ * @brief A hidden alphabet with states numbered from 0 to n-1.
+ */
+class SimpleHmmStateAlphabet:
+  public virtual HmmStateAlphabet,
+  public AbstractParametrizable
+{
+  private:
+    vector< Number<size_t> > states_;
+
+  public:
+    SimpleHmmStateAlphabet(size_t nbStates): AbstractParametrizable(""), states_() {
+      for (size_t i = 0; i < nbStates; ++i)
+        states_.push_back(Number<size_t>(i));
+    }
+
+    SimpleHmmStateAlphabet* clone() const { return new SimpleHmmStateAlphabet(*this); }
+
+  public:
+    const Clonable& getState(size_t stateIndex) const { return states_[stateIndex]; }
+    size_t getNumberOfStates() const { return states_.size(); }
+    bool worksWith(const HmmStateAlphabet* stateAlphabet) const { return stateAlphabet == this; }
+};
+
+/**
+ * @brief A transition matrix with fixed probabilities and a declared structure.
+ */
+class FixedHmmTransitionMatrix:
+  public virtual AbstractHmmTransitionMatrix,
+  public AbstractParametrizable
+{
+  private:
+    Structure structure_;
+    size_t lower_, upper_;
+
+  public:
+    FixedHmmTransitionMatrix(const HmmStateAlphabet* alph, const Matrix<double>& pij, const vector<double>& eqFreqs,
+        Structure structure, size_t lower = 0, size_t upper = 0):
+      AbstractHmmTransitionMatrix(alph), AbstractParametrizable(""),
+      structure_(structure), lower_(lower), upper_(upper)
+    {
+      for (size_t i = 0; i < pij.getNumberOfRows(); ++i)
+        for (size_t j = 0; j < pij.getNumberOfColumns(); ++j)
+          pij_(i, j) = pij(i, j);
+      eqFreq_ = eqFreqs;
+      upToDate_ = true;
+    }
+
+    FixedHmmTransitionMatrix* clone() const { return new FixedHmmTransitionMatrix(*this); }
+
+  public:
+    double Pij(size_t i, size_t j) const { return pij_(i, j); }
+    const Matrix<double>& getPij() const { return pij_; }
+    const vector<double>& getEquilibriumFrequencies() const { return eqFreq_; }
+    Structure getStructure() const { return structure_; }
+    size_t getLowerBandwidth() const { return lower_; }
+    size_t getUpperBandwidth() const { return upper_; }
+};
+
+/**
+ * @brief Gaussian emissions with unit variance, the mean of state k being k * theta.
+ *
+ * Optional windows of positions have their means shifted by parameters "shift1", "shift2", etc.
+ * Changes of these parameters are located (see getChangedPositions).
+ * Emission probabilities are also stored contiguously (see getEmissionProbabilitiesData).
+ */
+class GaussianHmmEmissionProbabilities:
+  public virtual HmmEmissionProbabilities,
+  public AbstractParametrizable
+{
+  private:
+    const HmmStateAlphabet* alph_;
+    vector<double> data_;
+    vector< pair<size_t, size_t> > windows_;
+    vector< pair<size_t, size_t> > changed_;
+    bool changeLocated_;
+    vector< vector<double> > emissions_;
+    vector<double> packed_;
+    mutable vector< vector<double> > dEmissions_;
+    mutable vector< vector<double> > d2Emissions_;
+
+  public:
+    GaussianHmmEmissionProbabilities(const HmmStateAlphabet* alph, const vector<double>& data, double theta,
+        const vector< pair<size_t, size_t> >& windows = vector< pair<size_t, size_t> >()):
+      AbstractParametrizable(""), alph_(alph), data_(data), windows_(windows), changed_(), changeLocated_(false),
+      emissions_(), packed_(), dEmissions_(), d2Emissions_()
+    {
+      addParameter_(new Parameter("theta", theta));
+      for (size_t w = 0; w < windows_.size(); ++w)
+        addParameter_(new Parameter("shift" + TextTools::toString(w + 1), 0.));
+      fireParameterChanged(getParameters());
+    }
+
+    GaussianHmmEmissionProbabilities(const GaussianHmmEmissionProbabilities& ghep):
+      AbstractParametrizable(ghep), alph_(ghep.alph_), data_(ghep.data_), windows_(ghep.windows_),
+      changed_(ghep.changed_), changeLocated_(ghep.changeLocated_), emissions_(ghep.emissions_),
+      packed_(ghep.packed_), dEmissions_(ghep.dEmissions_), d2Emissions_(ghep.d2Emissions_) {}
+
+    GaussianHmmEmissionProbabilities& operator=(const GaussianHmmEmissionProbabilities& ghep) {
+      AbstractParametrizable::operator=(ghep);
+      alph_ = ghep.alph_;
+      data_ = ghep.data_;
+      windows_ = ghep.windows_;
+      changed_ = ghep.changed_;
+      changeLocated_ = ghep.changeLocated_;
+      emissions_ = ghep.emissions_;
+      packed_ = ghep.packed_;
+      dEmissions_ = ghep.dEmissions_;
+      d2Emissions_ = ghep.d2Emissions_;
+      return *this;
+    }
+
+    GaussianHmmEmissionProbabilities* clone() const { return new GaussianHmmEmissionProbabilities(*this); }
+
+  public:
+    const HmmStateAlphabet* getHmmStateAlphabet() const { return alph_; }
+    void setHmmStateAlphabet(const HmmStateAlphabet* stateAlphabet) { alph_ = stateAlphabet; }
+
+    void fireParameterChanged(const ParameterList& pl) {
+      changed_.clear();
+      changeLocated_ = !pl.hasParameter("theta") && emissions_.size() == data_.size();
+      if (changeLocated_) {
+        for (size_t w = 0; w < windows_.size(); ++w)
+          if (pl.hasParameter("shift" + TextTools::toString(w + 1)))
+            changed_.push_back(windows_[w]);
+      } else {
+        changed_.push_back(pair<size_t, size_t>(0, data_.size()));
+      }
+      emissions_.resize(data_.size());
+      packed_.resize(data_.size() * alph_->getNumberOfStates());
+      for (size_t c = 0; c < changed_.size(); ++c)
+        for (size_t i = changed_[c].first; i < changed_[c].second; ++i)
+          computeEmissions_(i);
+    }
+
+    bool getChangedPositions(vector< pair<size_t, size_t> >& ranges) const {
+      ranges = changed_;
+      return changeLocated_;
+    }
+
+  private:
+    bool isInWindow_(size_t i, const string& variable) const {
+      for (size_t w = 0; w < windows_.size(); ++w)
+        if (variable == "shift" + TextTools::toString(w + 1))
+          return i >= windows_[w].first && i < windows_[w].second;
+      return false;
+    }
+
+    double getShift_(size_t i) const {
+      double shift = 0;
+      for (size_t w = 0; w < windows_.size(); ++w)
+        if (i >= windows_[w].first && i < windows_[w].second)
+          shift += getParameterValue("shift" + TextTools::toString(w + 1));
+      return shift;
+    }
+
+    void computeEmissions_(size_t i) {
+      double theta = getParameterValue("theta");
+      double shift = getShift_(i);
+      size_t nbStates = alph_->getNumberOfStates();
+      emissions_[i].resize(nbStates);
+      for (size_t k = 0; k < nbStates; ++k) {
+        double d = data_[i] - static_cast<double>(k) * theta - shift;
+        emissions_[i][k] = exp(-d * d / 2.) / sqrt(2. * NumConstants::PI());
+        packed_[i * nbStates + k] = emissions_[i][k];
+      }
+    }
+
+  public:
+
+    double operator()(size_t pos, size_t state) const { return emissions_[pos][state]; }
+    const vector<double>& operator()(size_t pos) const { return emissions_[pos]; }
+    const double* getEmissionProbabilitiesData() const { return &packed_[0]; }
+    size_t getNumberOfPositions() const { return data_.size(); }
+
+    void computeDEmissionProbabilities(string& variable) const {
+      double theta = getParameterValue("theta");
+      dEmissions_.resize(data_.size());
+      for (size_t i = 0; i < data_.size(); ++i) {
+        dEmissions_[i].resize(emissions_[i].size());
+        for (size_t k = 0; k < emissions_[i].size(); ++k) {
+          double kk = static_cast<double>(k);
+          double d = data_[i] - kk * theta - getShift_(i);
+          dEmissions_[i][k] = (variable == "theta") ? emissions_[i][k] * d * kk :
+            (isInWindow_(i, variable) ? emissions_[i][k] * d : 0.);
+        }
+      }
+    }
+
+    void computeD2EmissionProbabilities(string& variable) const {
+      double theta = getParameterValue("theta");
+      d2Emissions_.resize(data_.size());
+      for (size_t i = 0; i < data_.size(); ++i) {
+        d2Emissions_[i].resize(emissions_[i].size());
+        for (size_t k = 0; k < emissions_[i].size(); ++k) {
+          double kk = static_cast<double>(k);
+          double d = data_[i] - kk * theta - getShift_(i);
+          d2Emissions_[i][k] = (variable == "theta") ? emissions_[i][k] * (d * d * kk * kk - kk * kk) :
+            (isInWindow_(i, variable) ? emissions_[i][k] * (d * d - 1.) : 0.);
+        }
+      }
+    }
+
+    const vector<double>& getDEmissionProbabilities(size_t pos) const { return dEmissions_[pos]; }
+    const vector<double>& getD2EmissionProbabilities(size_t pos) const { return d2Emissions_[pos]; }
+};
+
+/**
+ * @brief Simulate data along a hidden path, with the model above.
+ */
+inline vector<double> simulateGaussianHmmData(const AbstractHmmTransitionMatrix& trans, size_t nbSites, double theta)
+{
+  vector<size_t> states = trans.sample(nbSites);
+  vector<double> data(nbSites);
+  for (size_t i = 0; i < nbSites; ++i)
+    data[i] = static_cast<double>(states[i]) * theta + RandomTools::randGaussian(0., 1.);
+  return data;
+}
@@ -0,0 +1,193 @@
+//
+// File: test_batch.cpp
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include <Bpp/Numeric/Function/BatchFunction.h>
+#include <Bpp/Numeric/Function/FunctionTools.h>
+#include <Bpp/Numeric/Function/TwoPointsNumericalDerivative.h>
+#include <Bpp/Numeric/Function/ThreePointsNumericalDerivative.h>
+#include <Bpp/Numeric/Function/FivePointsNumericalDerivative.h>
+#include <Bpp/Numeric/Function/DownhillSimplexMethod.h>
+#include <Bpp/Numeric/Function/OneDimensionOptimizationTools.h>
+#include <vector>
+#include <iostream>
+#include "PolynomialFunction.h"
+
+using namespace bpp;
+using namespace std;
+
+//A function evaluated by batches, counting the number of points passed at once:
+class BatchPolynomial:
+  public PolynomialFunction1Der1,
+  public BatchFunction
+{
+  public:
+    size_t nbBatches;
+    size_t nbPoints;
+
+  public:
+    BatchPolynomial(): nbBatches(0), nbPoints(0) {}
+
+    BatchPolynomial* clone() const { return new BatchPolynomial(*this); }
+
+  public:
+    void getValues(const vector<ParameterList>& points, vector<double>& values)
+    {
+      nbBatches++;
+      nbPoints += points.size();
+      BatchFunction::getValues(points, values);
+    }
+};
+
+bool checkDerivatives(const string& what, AbstractNumericalDerivative& nd, AbstractNumericalDerivative& ndb, BatchPolynomial& fb, const ParameterList& pl, bool d2, bool d2c) {
+  nd.setParameters(pl);
+  size_t nbBatches = fb.nbBatches;
+  ndb.setParameters(pl);
+  bool test = fb.nbBatches == nbBatches + 1 && ndb.getValue() == nd.getValue();
+  for (size_t i = 0; i < pl.size(); ++i) {
+    test &= ndb.getFirstOrderDerivative(pl[i].getName()) == nd.getFirstOrderDerivative(pl[i].getName());
+    if (d2)
+      test &= ndb.getSecondOrderDerivative(pl[i].getName()) == nd.getSecondOrderDerivative(pl[i].getName());
+    for (size_t j = 0; d2c && j < pl.size(); ++j)
+      test &= ndb.getSecondOrderDerivative(pl[i].getName(), pl[j].getName()) == nd.getSecondOrderDerivative(pl[i].getName(), pl[j].getName());
+    //The function is left at the point where derivatives are computed:
+    test &= fb.getParameterValue(pl[i].getName()) == pl[i].getValue();
+  }
+  cout << what << ":\t" << (test ? "ok" : "FAILED") << endl;
+  return test;
+}
+
+int main() {
+  bool test = true;
+
+  //Points only set some parameters, the others keeping their initial value:
+  PolynomialFunction1 f;
+  vector<ParameterList> points(3);
+  points[0].addParameter(Parameter("x", 1.));
+  points[1].addParameter(Parameter("y", 2.));
+  points[2].addParameter(Parameter("x", 3.));
+  points[2].addParameter(Parameter("z", 0.2));
+  Vdouble values;
+  FunctionTools::evaluate(f, points, values);
+  test &= values.size() == 3;
+  test &= values[0] == 16. + 4. + 6.25;
+  test &= values[1] == 25. + 16. + 6.25;
+  test &= abs(values[2] - (4. + 4. + 2.8 * 2.8)) < 1e-12;
+  test &= f.getParameterValue("x") == 3. && f.getParameterValue("y") == 0. && f.getParameterValue("z") == 0.2;
+
+  BatchPolynomial fb;
+  VVdouble gradients;
+  FunctionTools::evaluate(fb, points, fb.getParameters().getParameterNames(), values, gradients);
+  test &= gradients.size() == 3 && gradients[1].size() == 3;
+  test &= gradients[0][0] == -8. && gradients[1][1] == 8. && abs(gradients[2][2] + 5.6) < 1e-12;
+  cout << "Evaluation:\t" << (test ? "ok" : "FAILED") << endl;
+
+  //Trial points of numerical derivatives are evaluated at once:
+  ParameterList pl = f.getParameters();
+  TwoPointsNumericalDerivative nd2pt(&f), nd2ptb(&fb);
+  ThreePointsNumericalDerivative nd3pt(&f), nd3ptb(&fb);
+  FivePointsNumericalDerivative nd5pt(&f), nd5ptb(&fb);
+  nd2pt.setParametersToDerivate(pl.getParameterNames());
+  nd2ptb.setParametersToDerivate(pl.getParameterNames());
+  nd3pt.setParametersToDerivate(pl.getParameterNames());
+  nd3ptb.setParametersToDerivate(pl.getParameterNames());
+  nd5pt.setParametersToDerivate(pl.getParameterNames());
+  nd5ptb.setParametersToDerivate(pl.getParameterNames());
+  nd3pt.enableSecondOrderCrossDerivatives(true);
+  nd3ptb.enableSecondOrderCrossDerivatives(true);
+  pl[0].setValue(1.);
+  pl[1].setValue(2.);
+  pl[2].setValue(0.5);
+  test &= checkDerivatives("Two points", nd2pt, nd2ptb, fb, pl, false, false);
+  test &= checkDerivatives("Three points", nd3pt, nd3ptb, fb, pl, true, true);
+  test &= checkDerivatives("Five points", nd5pt, nd5ptb, fb, pl, true, false);
+  //Close to a bound, some points are evaluated one at a time:
+  pl[2].setValue(1.);
+  nd3pt.enableSecondOrderCrossDerivatives(false);
+  nd3ptb.enableSecondOrderCrossDerivatives(false);
+  test &= checkDerivatives("Three points at bound", nd3pt, nd3ptb, fb, pl, true, false);
+  test &= checkDerivatives("Five points at bound", nd5pt, nd5ptb, fb, pl, true, false);
+
+  //Grids are evaluated by rows:
+  ParameterGrid grid;
+  grid.addDimension("x", {0., 5., 10.});
+  grid.addDimension("y", {-2., 2.});
+  fb.nbBatches = 0;
+  unique_ptr<VVdouble> data(FunctionTools::computeGrid(fb, grid));
+  bool testGrid = fb.nbBatches == 2 && data->size() == 6;
+  for (size_t i = 0; testGrid && i < data->size(); ++i) {
+    double x = (*data)[i][0], y = (*data)[i][1];
+    testGrid &= x == grid.getPointsForDimension(0)[i % 3] && y == grid.getPointsForDimension(1)[i / 3];
+    testGrid &= (*data)[i][2] == (x - 5) * (x - 5) + (y + 2) * (y + 2) + (1. - 3.) * (1. - 3.);
+  }
+  cout << "Grid:\t" << (testGrid ? "ok" : "FAILED") << endl;
+  test &= testGrid;
+
+  //Optimizers give the same results, with multiple points evaluated at once:
+  fb.nbBatches = 0;
+  ParameterList start = f.getParameters().createSubList(vector<string>({"x", "y"}));
+  start[0].setValue(0.);
+  start[1].setValue(0.);
+  fb.setParameters(start);
+  f.setParameters(start);
+  DownhillSimplexMethod simplex(&f), simplexb(&fb);
+  simplex.setProfiler(0);
+  simplex.setMessageHandler(0);
+  simplexb.setProfiler(0);
+  simplexb.setMessageHandler(0);
+  simplex.setVerbose(0);
+  simplexb.setVerbose(0);
+  simplex.init(start);
+  simplexb.init(start);
+  double minf = simplex.optimize();
+  double minfb = simplexb.optimize();
+  bool testSimplex = fb.nbBatches > 0 && minf == minfb && abs(minf - 4.) < 1e-4
+                  && f.getParameterValue("x") == fb.getParameterValue("x")
+                  && f.getParameterValue("y") == fb.getParameterValue("y");
+  cout << "Simplex:\t" << (testSimplex ? "ok" : "FAILED") << endl;
+  test &= testSimplex;
+
+  fb.nbBatches = 0;
+  Bracket bracket = OneDimensionOptimizationTools::inwardBracketMinimum(0., 10., &f, f.getParameters().createSubList("x"), 10);
+  Bracket bracketb = OneDimensionOptimizationTools::inwardBracketMinimum(0., 10., &fb, fb.getParameters().createSubList("x"), 10);
+  bool testBracket = fb.nbBatches == 2 && bracket.c.x == bracketb.c.x && bracket.c.f == bracketb.c.f && abs(bracketb.c.x - 5.) < 1e-12;
+  cout << "Bracketing:\t" << (testBracket ? "ok" : "FAILED") << endl;
+  test &= testBracket;
+
+  cout << (test ? "Ok" : "FAILED") << endl;
+  return (test ? 0 : 1);
+}
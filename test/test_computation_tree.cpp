@@ -0,0 +1,238 @@
+//
+// File: test_computation_tree.cpp
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include <Bpp/Numeric/Function/Functions.h>
+#include <Bpp/Numeric/Function/Operators/ComputationTree.h>
+#include <Bpp/Numeric/Function/Operators/ComputationTape.h>
+#include <Bpp/Numeric/AbstractParametrizable.h>
+#include <map>
+#include <vector>
+#include <iostream>
+
+using namespace bpp;
+using namespace std;
+
+//f = x^2.y + z if kind is 0, f = x + y^2.z otherwise, with analytical derivatives:
+class SimpleFunction:
+  public virtual DerivableSecondOrder,
+  public AbstractParametrizable
+{
+  private:
+    int kind_;
+    double x_, y_, z_;
+
+  public:
+    SimpleFunction(int kind, double x, double y, double z):
+      AbstractParametrizable(""), kind_(kind), x_(x), y_(y), z_(z)
+    {
+      addParameter_(new Parameter("x", x));
+      addParameter_(new Parameter("y", y));
+      addParameter_(new Parameter("z", z));
+    }
+
+    SimpleFunction* clone() const { return new SimpleFunction(*this); }
+
+  public:
+    void setParameters(const ParameterList& pl) { matchParametersValues(pl); }
+
+    void fireParameterChanged(const ParameterList& pl) {
+      x_ = getParameterValue("x");
+      y_ = getParameterValue("y");
+      z_ = getParameterValue("z");
+    }
+
+    double getValue() const { return kind_ == 0 ? x_ * x_ * y_ + z_ : x_ + y_ * y_ * z_; }
+
+    void enableFirstOrderDerivatives(bool yn) {}
+    bool enableFirstOrderDerivatives() const { return true; }
+    void enableSecondOrderDerivatives(bool yn) {}
+    bool enableSecondOrderDerivatives() const { return true; }
+
+    double getFirstOrderDerivative(const string& variable) const {
+      if (kind_ == 0)
+        return variable == "x" ? 2 * x_ * y_ : (variable == "y" ? x_ * x_ : 1);
+      return variable == "x" ? 1 : (variable == "y" ? 2 * y_ * z_ : y_ * y_);
+    }
+
+    double getSecondOrderDerivative(const string& variable) const {
+      if (kind_ == 0)
+        return variable == "x" ? 2 * y_ : 0;
+      return variable == "y" ? 2 * z_ : 0;
+    }
+
+    double getSecondOrderDerivative(const string& variable1, const string& variable2) const {
+      if (variable1 == variable2)
+        return getSecondOrderDerivative(variable1);
+      string v = variable1 < variable2 ? variable1 + variable2 : variable2 + variable1;
+      if (kind_ == 0)
+        return v == "xy" ? 2 * x_ : 0;
+      return v == "yz" ? 2 * y_ : 0;
+    }
+};
+
+//An operator which only implements the recursive computation, f^2:
+class SquareOperator:
+  public Operator
+{
+  private:
+    std::shared_ptr<Operator> son_;
+
+  public:
+    SquareOperator(std::shared_ptr<Operator> son): son_(son) {}
+
+    SquareOperator* clone() const { return new SquareOperator(*this); }
+
+    double getValue() const { return son_->getValue() * son_->getValue(); }
+
+    double getFirstOrderDerivative(const string& variable) const { return 2 * son_->getValue() * son_->getFirstOrderDerivative(variable); }
+
+    double getSecondOrderDerivative(const string& variable) const {
+      double d = son_->getFirstOrderDerivative(variable);
+      return 2 * (d * d + son_->getValue() * son_->getSecondOrderDerivative(variable));
+    }
+
+    string output() const { return "(" + son_->output() + ")^2"; }
+};
+
+bool close(double a, double b, double tolerance) {
+  return abs(a - b) <= tolerance * max(1., abs(b));
+}
+
+int main() {
+  bool test = true;
+  vector<string> variables = { "x", "y", "z" };
+  vector<double> point = { 0.5, 1.2, 0.7 };
+  SimpleFunction f(0, point[0], point[1], point[2]), g(1, point[0], point[1], point[2]);
+  map<string, Function*> functions;
+  functions["f"] = &f;
+  functions["g"] = &g;
+  ComputationTree tree("exp(f)*g - log(g)/f + 2*-f - (g-f)", functions);
+
+  //Reverse mode gives the same derivatives as the recursive computation:
+  vector<double> gradient, d2;
+  double value = tree.getValueAndGradient(variables, gradient);
+  test &= close(value, tree.getValue(), 1e-14);
+  tree.getSecondOrderDerivatives(variables, d2);
+  for (size_t i = 0; i < variables.size(); ++i) {
+    cout << variables[i] << "\t" << gradient[i] << "\t" << tree.getFirstOrderDerivative(variables[i]) << "\t" << d2[i] << "\t" << tree.getSecondOrderDerivative(variables[i]) << endl;
+    test &= close(gradient[i], tree.getFirstOrderDerivative(variables[i]), 1e-12);
+    test &= close(d2[i], tree.getSecondOrderDerivative(variables[i]), 1e-12);
+  }
+
+  //The hessian-vector product matches finite differences of the gradient:
+  vector<double> direction = { 0.3, -1., 2. }, product;
+  tree.getHessianVectorProduct(variables, direction, product);
+  double h = 1e-5;
+  vector<double> gradientPlus, gradientMinus;
+  ParameterList pl = f.getParameters();
+  for (size_t i = 0; i < variables.size(); ++i)
+    pl[i].setValue(point[i] + h * direction[i]);
+  f.setParameters(pl);
+  g.setParameters(pl);
+  tree.getValueAndGradient(variables, gradientPlus);
+  for (size_t i = 0; i < variables.size(); ++i)
+    pl[i].setValue(point[i] - h * direction[i]);
+  f.setParameters(pl);
+  g.setParameters(pl);
+  tree.getValueAndGradient(variables, gradientMinus);
+  for (size_t i = 0; i < variables.size(); ++i) {
+    double fd = (gradientPlus[i] - gradientMinus[i]) / (2 * h);
+    cout << variables[i] << "\t" << product[i] << "\t" << fd << endl;
+    test &= close(product[i], fd, 1e-6);
+  }
+
+  //Along a variable, the product gives the second order derivatives:
+  for (size_t i = 0; i < variables.size(); ++i)
+    pl[i].setValue(point[i]);
+  f.setParameters(pl);
+  g.setParameters(pl);
+  for (size_t i = 0; i < variables.size(); ++i) {
+    vector<double> unit(variables.size(), 0.);
+    unit[i] = 1.;
+    tree.getHessianVectorProduct(variables, unit, product);
+    test &= close(product[i], d2[i], 1e-12);
+  }
+
+  //The compiled tape gives the same values as the tree, with constants folded and common subexpressions computed once:
+  ComputationTree tree2("exp(f)*g - log(g)/f + 2*-f - (g-f) + (2+3)*exp(0)*f + g*exp(f)", functions);
+  ComputationTape tape(tree2);
+  cout << "Instructions:\t" << tape.getNumberOfInstructions() << endl;
+  test &= tape.getNumberOfInstructions() == 13;
+  test &= tape.getNumberOfInputs() == 2 && tape.getInputNames()[0] == "f" && tape.getInputNames()[1] == "g";
+  test &= tape.getValue() == tree2.getValue();
+  test &= tape.getValue({ f.getValue(), g.getValue() }) == tree2.getValue();
+
+  VVdouble inputs;
+  Vdouble expected, values;
+  for (size_t p = 0; p < 5; ++p) {
+    for (size_t i = 0; i < variables.size(); ++i)
+      pl[i].setValue(point[i] + 0.1 * static_cast<double>(p * (i + 1)));
+    f.setParameters(pl);
+    g.setParameters(pl);
+    inputs.push_back({ f.getValue(), g.getValue() });
+    expected.push_back(tree2.getValue());
+  }
+  tape.getValues(inputs, values);
+  for (size_t p = 0; p < values.size(); ++p) {
+    cout << values[p] << "\t" << expected[p] << endl;
+    test &= values[p] == expected[p];
+  }
+
+  //Operators without access to their operands are rejected by reverse mode and by the tape:
+  ComputationTree tree3("f", functions);
+  shared_ptr<Operator> square(new SquareOperator(tree3.getRoot()));
+  tree3.createNode(tree3.getRoot(), square);
+  tree3.rootAt(square);
+  test &= close(tree3.getValue(), f.getValue() * f.getValue(), 1e-14);
+  bool rejected = false;
+  try {
+    tree3.getValueAndGradient(variables, gradient);
+  } catch (Exception& e) {
+    rejected = true;
+  }
+  test &= rejected;
+  rejected = false;
+  try {
+    ComputationTape tape3(tree3);
+  } catch (Exception& e) {
+    rejected = true;
+  }
+  cout << "Operator rejected:\t" << (rejected ? "ok" : "FAILED") << endl;
+  test &= rejected;
+
+  return (test ? 0 : 1);
+}
@@ -0,0 +1,144 @@
+//
+// File: test_derivative2.cpp
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include <Bpp/Numeric/Function/TwoPointsNumericalDerivative.h>
+#include <Bpp/Numeric/Function/ThreePointsNumericalDerivative.h>
+#include <Bpp/Numeric/Function/FivePointsNumericalDerivative.h>
+#include <Bpp/Numeric/Function/ReparametrizationFunctionWrapper.h>
+#include <vector>
+#include <iostream>
+#include "PolynomialFunction.h"
+
+using namespace bpp;
+using namespace std;
+
+bool checkDerivatives(const string& what, AbstractNumericalDerivative& nd, const PolynomialFunction1& f, const ParameterList& pl, double tol, bool d2) {
+  vector<double> d1 = {2. * (pl[0].getValue() - 5.), 2. * (pl[1].getValue() + 2.), 2. * (pl[2].getValue() - 3.)};
+  bool test = true;
+  for (size_t i = 0; i < pl.size(); ++i) {
+    test &= abs(nd.getFirstOrderDerivative(pl[i].getName()) - d1[i]) < tol;
+    if (d2)
+      test &= abs(nd.getSecondOrderDerivative(pl[i].getName()) - 2.) < tol;
+    //The function is left at the point where derivatives are computed:
+    test &= f.getParameterValue(pl[i].getName()) == pl[i].getValue();
+  }
+  cout << what << ":\t" << (test ? "ok" : "FAILED") << endl;
+  return test;
+}
+
+//Derivatives computed in parallel must be identical to the sequential ones:
+bool checkParallel(const string& what, AbstractNumericalDerivative& nd, AbstractNumericalDerivative& ndp, const ParameterList& pl, bool d2, bool d2c) {
+  ndp.setParameters(pl);
+  bool test = ndp.getValue() == nd.getValue();
+  for (size_t i = 0; i < pl.size(); ++i) {
+    test &= ndp.getFirstOrderDerivative(pl[i].getName()) == nd.getFirstOrderDerivative(pl[i].getName());
+    if (d2)
+      test &= ndp.getSecondOrderDerivative(pl[i].getName()) == nd.getSecondOrderDerivative(pl[i].getName());
+    for (size_t j = 0; d2c && j < pl.size(); ++j)
+      test &= ndp.getSecondOrderDerivative(pl[i].getName(), pl[j].getName()) == nd.getSecondOrderDerivative(pl[i].getName(), pl[j].getName());
+  }
+  cout << what << " in parallel:\t" << (test ? "ok" : "FAILED") << endl;
+  return test;
+}
+
+int main() {
+  PolynomialFunction1 f;
+  ParameterList pl = f.getParameters();
+  TwoPointsNumericalDerivative nd2pt(&f)  ; nd2pt.setParametersToDerivate(pl.getParameterNames());
+  ThreePointsNumericalDerivative nd3pt(&f); nd3pt.setParametersToDerivate(pl.getParameterNames());
+  FivePointsNumericalDerivative nd5pt(&f) ; nd5pt.setParametersToDerivate(pl.getParameterNames());
+  nd3pt.enableSecondOrderCrossDerivatives(true);
+  PolynomialFunction1 fp;
+  TwoPointsNumericalDerivative nd2ptp(&fp)  ; nd2ptp.setParametersToDerivate(pl.getParameterNames());
+  ThreePointsNumericalDerivative nd3ptp(&fp); nd3ptp.setParametersToDerivate(pl.getParameterNames());
+  FivePointsNumericalDerivative nd5ptp(&fp) ; nd5ptp.setParametersToDerivate(pl.getParameterNames());
+  nd3ptp.enableSecondOrderCrossDerivatives(true);
+  nd2ptp.setNumberOfThreads(4);
+  nd3ptp.setNumberOfThreads(4);
+  nd5ptp.setNumberOfThreads(4);
+
+  bool test = true;
+  vector< vector<double> > points = {{1., 2., 0.5}, {-3., 7., 0.2}, {10., -4., 0.9}};
+  for (size_t k = 0; k < points.size(); ++k) {
+    for (size_t i = 0; i < pl.size(); ++i)
+      pl[i].setValue(points[k][i]);
+    nd2pt.setParameters(pl);
+    test &= checkDerivatives("Two points", nd2pt, f, pl, 1e-2, false);
+    test &= checkParallel("Two points", nd2pt, nd2ptp, pl, false, false);
+    nd3pt.setParameters(pl);
+    test &= checkDerivatives("Three points", nd3pt, f, pl, 1e-5, true);
+    for (size_t i = 0; i < pl.size(); ++i)
+      for (size_t j = 0; j < pl.size(); ++j)
+        test &= abs(nd3pt.getSecondOrderDerivative(pl[i].getName(), pl[j].getName()) - (i == j ? 2. : 0.)) < 1e-3;
+    test &= checkParallel("Three points", nd3pt, nd3ptp, pl, true, true);
+    nd5pt.setParameters(pl);
+    test &= checkDerivatives("Five points", nd5pt, f, pl, 1e-5, true);
+    test &= checkParallel("Five points", nd5pt, nd5ptp, pl, true, false);
+  }
+
+  //Derivatives are computed near the bounds of constrained parameters:
+  pl[2].setValue(1.);
+  nd5pt.setParameters(pl);
+  test &= checkDerivatives("Five points at bound", nd5pt, f, pl, 1e-3, false);
+  test &= checkParallel("Five points at bound", nd5pt, nd5ptp, pl, true, false);
+  nd3pt.enableSecondOrderCrossDerivatives(false);
+  nd3pt.setParameters(pl);
+  test &= checkDerivatives("Three points at bound", nd3pt, f, pl, 1e-3, false);
+  nd3ptp.enableSecondOrderCrossDerivatives(false);
+  test &= checkParallel("Three points at bound", nd3pt, nd3ptp, pl, true, false);
+
+  //Copies of a wrapper share the wrapped function, which must not be modified by threads:
+  PolynomialFunction1 g, gp;
+  ReparametrizationFunctionWrapper rfw(&g, false), rfwp(&gp, false);
+  ParameterList rpl = rfw.getParameters();
+  ThreePointsNumericalDerivative nd3rfw(&rfw) ; nd3rfw.setParametersToDerivate(rpl.getParameterNames());
+  ThreePointsNumericalDerivative nd3rfwp(&rfwp); nd3rfwp.setParametersToDerivate(rpl.getParameterNames());
+  nd3rfw.enableSecondOrderCrossDerivatives(true);
+  nd3rfwp.enableSecondOrderCrossDerivatives(true);
+  nd3rfwp.setNumberOfThreads(4);
+  for (size_t k = 0; k < points.size(); ++k) {
+    for (size_t i = 0; i < rpl.size(); ++i)
+      rpl[i].setValue(points[k][i]);
+    nd3rfw.setParameters(rpl);
+    test &= checkParallel("Three points through a wrapper", nd3rfw, nd3rfwp, rpl, true, true);
+    for (size_t i = 0; i < rpl.size(); ++i)
+      test &= gp.getParameters()[i].getValue() == g.getParameters()[i].getValue();
+  }
+
+  cout << (test ? "Ok" : "FAILED") << endl;
+  return (test ? 0 : 1);
+}
@@ -0,0 +1,143 @@
+//
+// File: test_grid.cpp
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include <Bpp/Numeric/Function/FunctionTools.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <iostream>
+#include "PolynomialFunction.h"
+
+using namespace bpp;
+using namespace std;
+
+//A function failing after a given number of evaluations, shared by all its copies:
+class FailingPolynomial:
+  public PolynomialFunction1
+{
+  public:
+    static atomic<long> budget;
+
+  public:
+    FailingPolynomial* clone() const { return new FailingPolynomial(*this); }
+
+    //Fail before any parameter is set, so that the function is left in a consistent state:
+    void setParameters(const ParameterList& pl) {
+      if (budget-- <= 0)
+        throw Exception("FailingPolynomial: no more evaluations.");
+      PolynomialFunction1::setParameters(pl);
+    }
+};
+
+atomic<long> FailingPolynomial::budget(1000000);
+
+int main() {
+  ParameterGrid grid;
+  Vdouble x, y;
+  for (size_t i = 0; i < 25; ++i)
+    x.push_back(static_cast<double>(i) * 0.5);
+  for (size_t i = 0; i < 20; ++i)
+    y.push_back(-5. + static_cast<double>(i) * 0.4);
+  grid.addDimension("x", x);
+  grid.addDimension("z", {0.1, 0.4, 0.7, 1.});
+  grid.addDimension("y", y);
+  size_t nbPoints = grid.getTotalNumberOfPoints();
+
+  PolynomialFunction1 f;
+  unique_ptr<VVdouble> data(FunctionTools::computeGrid(f, grid));
+  bool test = data->size() == nbPoints;
+  for (size_t i = 0; test && i < nbPoints; ++i) {
+    Vdouble point = grid.getPoint(i);
+    for (size_t j = 0; j < 3; ++j)
+      test &= point[j] == (*data)[i][j];
+  }
+  cout << "Points:\t" << (test ? "ok" : "FAILED") << endl;
+
+  //Chunks are passed in order:
+  size_t next = 0;
+  bool testChunks = true;
+  FunctionTools::computeGrid(f, grid, [&](size_t first, const Vdouble& values) {
+      testChunks &= first == next && values.size() == min(static_cast<size_t>(37), nbPoints - first);
+      for (size_t k = 0; k < values.size(); ++k)
+        testChunks &= values[k] == (*data)[first + k][3];
+      next = first + values.size();
+    }, 4, 37);
+  testChunks &= next == nbPoints;
+  cout << "Chunks:\t" << (testChunks ? "ok" : "FAILED") << endl;
+  test &= testChunks;
+
+  //An interrupted evaluation can be resumed (the failing pass uses a single thread, so that it stops at a fixed point):
+  FailingPolynomial ff;
+  Vdouble values;
+  size_t nextPoint = 0;
+  FailingPolynomial::budget = 700;
+  bool testResume = false;
+  try {
+    FunctionTools::computeGrid(ff, grid, values, nextPoint, 1, 50);
+  } catch (Exception& e) {
+    testResume = nextPoint < nbPoints && nextPoint % 50 == 0;
+  }
+  for (size_t i = 0; i < nextPoint; ++i)
+    testResume &= values[i] == (*data)[i][3];
+  FailingPolynomial::budget = 1000000;
+  FunctionTools::computeGrid(ff, grid, values, nextPoint, 3, 50);
+  testResume &= nextPoint == nbPoints && values.size() == nbPoints;
+  for (size_t i = 0; i < nbPoints; ++i)
+    testResume &= values[i] == (*data)[i][3];
+  cout << "Resume:\t" << (testResume ? "ok" : "FAILED") << endl;
+  test &= testResume;
+
+  //Copies of a wrapper share the wrapped function, which must not be used by several threads at once:
+  PolynomialFunction1 g;
+  InfinityFunctionWrapper wrapper(&g);
+  Vdouble wrappedValues;
+  nextPoint = 0;
+  FunctionTools::computeGrid(wrapper, grid, wrappedValues, nextPoint, 4, 37);
+  bool testWrapper = nextPoint == nbPoints;
+  for (size_t i = 0; i < nbPoints; ++i)
+    testWrapper &= wrappedValues[i] == (*data)[i][3];
+  //The wrapped function is left in a consistent state:
+  PolynomialFunction1 gRef;
+  gRef.setParameters(g.getParameters());
+  testWrapper &= g.getValue() == gRef.getValue();
+  cout << "Wrapper:\t" << (testWrapper ? "ok" : "FAILED") << endl;
+  test &= testWrapper;
+
+  cout << (test ? "Ok" : "FAILED") << endl;
+  return (test ? 0 : 1);
+}
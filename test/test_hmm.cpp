@@ -0,0 +1,464 @@
+//
+// File: test_hmm.cpp
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include <Bpp/Numeric/Hmm/RescaledHmmLikelihood.h>
+#include <Bpp/Numeric/Hmm/LogsumHmmLikelihood.h>
+#include <Bpp/Numeric/Hmm/LowMemoryRescaledHmmLikelihood.h>
+#include <Bpp/Numeric/Hmm/HmmTransitionKernel.h>
+#include <Bpp/Numeric/Hmm/FullHmmTransitionMatrix.h>
+#include <Bpp/Numeric/Hmm/HmmEmissionBuffer.h>
+#include <Bpp/Numeric/Hmm/StreamingHmmLikelihood.h>
+#include <Bpp/Numeric/Hmm/HmmPathSampler.h>
+#include <Bpp/Numeric/Hmm/MultiSequenceHmmLikelihood.h>
+#include <Bpp/Numeric/Random/Uniform01K.h>
+#include <vector>
+#include <iostream>
+#include "SimpleHmm.h"
+
+using namespace bpp;
+using namespace std;
+
+// The same emissions, only available by blocks:
+class BlockGaussianHmmEmissionProbabilities:
+  public GaussianHmmEmissionProbabilities
+{
+  public:
+    BlockGaussianHmmEmissionProbabilities(const HmmStateAlphabet* alph, const vector<double>& data, double theta):
+      GaussianHmmEmissionProbabilities(alph, data, theta) {}
+
+    BlockGaussianHmmEmissionProbabilities* clone() const { return new BlockGaussianHmmEmissionProbabilities(*this); }
+
+    const double* getEmissionProbabilitiesData() const { return 0; }
+};
+
+template<class T>
+T* buildHmm(const vector<double>& data, size_t nbStates, bool dense = false,
+    const vector< pair<size_t, size_t> >& windows = vector< pair<size_t, size_t> >())
+{
+  SimpleHmmStateAlphabet* alphabet = new SimpleHmmStateAlphabet(nbStates);
+  AutoCorrelationTransitionMatrix* trans = new AutoCorrelationTransitionMatrix(alphabet);
+  for (size_t i = 0; i < nbStates; ++i)
+    trans->setParameterValue("lambda" + TextTools::toString(i + 1), 0.9);
+  GaussianHmmEmissionProbabilities* emissions = new GaussianHmmEmissionProbabilities(alphabet, data, 2., windows);
+  if (dense)
+  {
+    //Same probabilities, without the diagonal plus rank one structure:
+    FixedHmmTransitionMatrix* denseTrans = new FixedHmmTransitionMatrix(alphabet, trans->getPij(), trans->getEquilibriumFrequencies(), HmmTransitionMatrix::DENSE);
+    delete trans;
+    return new T(alphabet, denseTrans, emissions, "");
+  }
+  return new T(alphabet, trans, emissions, "");
+}
+
+bool checkEqual(const string& what, double x, double y, double tolerance) {
+  bool test = std::abs(x - y) <= tolerance * (1. + std::abs(x));
+  cout << what << ":\t" << x << "\t" << y << (test ? "" : "\tFAILED") << endl;
+  return test;
+}
+
+bool checkKernel(const string& what, const HmmTransitionMatrix& matrix) {
+  HmmTransitionKernel kernel(matrix);
+  size_t n = matrix.getNumberOfStates();
+  vector<double> f(n), lf(n), x(n), lx(n);
+  for (size_t k = 0; k < n; ++k)
+  {
+    f[k] = RandomTools::giveRandomNumberBetweenZeroAndEntry(1.);
+    lf[k] = log(f[k]);
+  }
+  bool test = true;
+  kernel.forward(&f[0], &x[0]);
+  kernel.logForward(&lf[0], &lx[0]);
+  for (size_t j = 0; j < n; ++j)
+  {
+    double y = 0;
+    for (size_t k = 0; k < n; ++k)
+      y += matrix.Pij(k, j) * f[k];
+    test &= std::abs(x[j] - y) <= 1e-12 * y && std::abs(lx[j] - log(y)) <= 1e-12;
+  }
+  kernel.backward(&f[0], &x[0]);
+  kernel.logBackward(&lf[0], &lx[0]);
+  for (size_t j = 0; j < n; ++j)
+  {
+    double y = 0;
+    for (size_t k = 0; k < n; ++k)
+      y += matrix.Pij(j, k) * f[k];
+    test &= std::abs(x[j] - y) <= 1e-12 * y && std::abs(lx[j] - log(y)) <= 1e-12;
+  }
+  cout << what << " kernel:\t" << (test ? "OK" : "FAILED") << endl;
+  return test;
+}
+
+int main() {
+  RandomTools::setSeed(42);
+  size_t nbStates = 3;
+  SimpleHmmStateAlphabet alphabet(nbStates);
+  AutoCorrelationTransitionMatrix simTrans(&alphabet);
+  for (size_t i = 0; i < nbStates; ++i)
+    simTrans.setParameterValue("lambda" + TextTools::toString(i + 1), 0.95);
+  vector<double> data = simulateGaussianHmmData(simTrans, 5000, 2.);
+
+  vector<size_t> breakPoints = {500, 1200, 1201, 3000, 4999};
+
+  unique_ptr<RescaledHmmLikelihood> rLik(buildHmm<RescaledHmmLikelihood>(data, nbStates));
+  unique_ptr<LogsumHmmLikelihood> lLik(buildHmm<LogsumHmmLikelihood>(data, nbStates));
+  unique_ptr<LowMemoryRescaledHmmLikelihood> mLik(buildHmm<LowMemoryRescaledHmmLikelihood>(data, nbStates));
+  rLik->setBreakPoints(breakPoints);
+  lLik->setBreakPoints(breakPoints);
+  mLik->setBreakPoints(breakPoints);
+
+  bool test = true;
+
+  // Batched log-sum-exp reductions:
+  vector<double> lx(11), w(11, 0.5);
+  for (size_t i = 0; i < lx.size(); ++i)
+    lx[i] = -1000. - static_cast<double>(i) * 0.7;
+  double naive = lx[0];
+  for (size_t i = 1; i < lx.size(); ++i)
+    naive = NumTools::logsum(naive, lx[i]);
+  test &= checkEqual("logSumExp", naive, VectorTools::logSumExp(lx), 1e-14);
+  test &= checkEqual("logSumExp weighted", naive + log(0.5), VectorTools::logSumExp(lx, w), 1e-14);
+  test &= checkEqual("logMeanExp", naive - log(11.), VectorTools::logMeanExp(lx), 1e-14);
+  lx += 1000.;
+  test &= checkEqual("sumExp", exp(naive + 1000.), VectorTools::sumExp(lx), 1e-12);
+  test &= checkEqual("sumExp weighted", exp(naive + 1000.) / 2., VectorTools::sumExp(lx, w), 1e-12);
+  test &= checkEqual("sumExp one element", exp(-0.7), VectorTools::sumExp(vector<double>(1, -0.7)), 1e-15);
+  test &= checkEqual("sumExp empty", 0., VectorTools::sumExp(vector<double>()), 0.);
+
+  // Emissions read from contiguous storage, or fetched by blocks in both directions:
+  const HmmEmissionProbabilities& emissions = rLik->getHmmEmissionProbabilities();
+  BlockGaussianHmmEmissionProbabilities blockEmissions(&alphabet, data, 2.);
+  HmmEmissionBuffer directBuffer(emissions, nbStates, 10, 30);
+  HmmEmissionBuffer forwardBuffer(blockEmissions, nbStates, 10, 30, false, 7);
+  HmmEmissionBuffer reverseBuffer(blockEmissions, nbStates, 10, 30, true, 7);
+  for (size_t i = 10; i < 30; ++i)
+    for (size_t k = 0; k < nbStates; ++k)
+      test &= directBuffer(i)[k] == emissions(i, k) && forwardBuffer(i)[k] == emissions(i, k) && reverseBuffer(39 - i)[k] == emissions(39 - i, k);
+  test &= directBuffer(10) == emissions.getEmissionProbabilitiesData() + 10 * nbStates;
+  test &= reinterpret_cast<uintptr_t>(forwardBuffer(10)) % HmmEmissionBuffer::ALIGNMENT == 0;
+
+  // All implementations agree:
+  double logL = rLik->getLogLikelihood();
+  test &= checkEqual("Logsum", logL, lLik->getLogLikelihood(), 1e-9);
+  test &= checkEqual("LowMemory", logL, mLik->getLogLikelihood(), 1e-9);
+  double d1 = rLik->getFirstOrderDerivative("theta");
+  double d2 = rLik->getSecondOrderDerivative("theta");
+  test &= checkEqual("Logsum d1", d1, lLik->getFirstOrderDerivative("theta"), 1e-6);
+  test &= checkEqual("Logsum d2", d2, lLik->getSecondOrderDerivative("theta"), 1e-6);
+
+  // Derivatives are consistent with finite differences:
+  double h = 1e-4;
+  unique_ptr<RescaledHmmLikelihood> rLikP(rLik->clone());
+  unique_ptr<RescaledHmmLikelihood> rLikM(rLik->clone());
+  rLikP->setParameterValue("theta", 2. + h);
+  rLikM->setParameterValue("theta", 2. - h);
+  test &= checkEqual("Numerical d1", d1, (rLikP->getValue() - rLikM->getValue()) / (2 * h), 1e-4);
+  test &= checkEqual("Numerical d2", d2, (rLikP->getValue() - 2 * rLik->getValue() + rLikM->getValue()) / (h * h), 1e-3);
+
+  // Segment-parallel computations give exactly the same results:
+  vector< vector<double> > post1, post4;
+  rLik->getHiddenStatesPosteriorProbabilities(post1);
+  unique_ptr<RescaledHmmLikelihood> rLik4(buildHmm<RescaledHmmLikelihood>(data, nbStates));
+  rLik4->setNumberOfThreads(4);
+  rLik4->setBreakPoints(breakPoints);
+  rLik4->getHiddenStatesPosteriorProbabilities(post4);
+  test &= checkEqual("Rescaled 4 threads", logL, rLik4->getLogLikelihood(), 0.);
+  test &= checkEqual("Rescaled 4 threads d1", d1, rLik4->getFirstOrderDerivative("theta"), 0.);
+  test &= checkEqual("Rescaled 4 threads d2", d2, rLik4->getSecondOrderDerivative("theta"), 0.);
+  test &= (post1 == post4);
+
+  unique_ptr<LogsumHmmLikelihood> lLik4(buildHmm<LogsumHmmLikelihood>(data, nbStates));
+  lLik4->setNumberOfThreads(4);
+  lLik4->setBreakPoints(breakPoints);
+  test &= checkEqual("Logsum 4 threads", lLik->getLogLikelihood(), lLik4->getLogLikelihood(), 0.);
+  lLik->getHiddenStatesPosteriorProbabilities(post1);
+  lLik4->getHiddenStatesPosteriorProbabilities(post4);
+  test &= (post1 == post4);
+
+  unique_ptr<LowMemoryRescaledHmmLikelihood> mLik4(buildHmm<LowMemoryRescaledHmmLikelihood>(data, nbStates));
+  mLik4->setNumberOfThreads(4);
+  mLik4->setBreakPoints(breakPoints);
+  test &= checkEqual("LowMemory 4 threads", mLik->getLogLikelihood(), mLik4->getLogLikelihood(), 0.);
+
+  // Parallel-in-time forward recursion:
+  rLik4->setScanChunkSize(300);
+  test &= checkEqual("Rescaled scan", logL, rLik4->getLogLikelihood(), 1e-12);
+  rLik4->getHiddenStatesPosteriorProbabilities(post4);
+  rLik->getHiddenStatesPosteriorProbabilities(post1);
+  for (size_t i = 0; i < post1.size(); ++i)
+    for (size_t j = 0; j < nbStates; ++j)
+      test &= std::abs(post1[i][j] - post4[i][j]) < 1e-9;
+  rLik4->setNumberOfThreads(1);
+  double logLScan = rLik4->getLogLikelihood();
+  rLik4->setScanChunkSize(300);
+  test &= checkEqual("Rescaled scan 1 thread", logLScan, rLik4->getLogLikelihood(), 0.);
+
+  // Structured transition matrices give the same results as dense ones:
+  SimpleHmmStateAlphabet bigAlphabet(20);
+  AutoCorrelationTransitionMatrix autoTrans(&bigAlphabet);
+  for (size_t i = 0; i < 20; ++i)
+    autoTrans.setParameterValue("lambda" + TextTools::toString(i + 1), 0.5 + 0.02 * static_cast<double>(i));
+  test &= checkKernel("Diagonal plus rank one", autoTrans);
+  RowMatrix<double> banded(20, 20), sparse(20, 20);
+  for (size_t i = 0; i < 20; ++i)
+  {
+    for (size_t j = (i > 2 ? i - 2 : 0); j <= min(static_cast<size_t>(19), i + 1); ++j)
+      banded(i, j) = 1. + static_cast<double>(i + j);
+    sparse(i, (i * 7) % 20) = 0.3;
+    sparse(i, (i * 3 + 1) % 20) += 0.7;
+  }
+  vector<double> uniform(20, 1. / 20.);
+  test &= checkKernel("Banded", FixedHmmTransitionMatrix(&bigAlphabet, banded, uniform, HmmTransitionMatrix::BANDED, 2, 1));
+  test &= checkKernel("Sparse", FixedHmmTransitionMatrix(&bigAlphabet, sparse, uniform, HmmTransitionMatrix::SPARSE));
+  test &= checkKernel("Dense", FixedHmmTransitionMatrix(&bigAlphabet, autoTrans.getPij(), uniform, HmmTransitionMatrix::DENSE));
+
+  unique_ptr<RescaledHmmLikelihood> rDense(buildHmm<RescaledHmmLikelihood>(data, nbStates, true));
+  unique_ptr<LogsumHmmLikelihood> lDense(buildHmm<LogsumHmmLikelihood>(data, nbStates, true));
+  unique_ptr<RescaledHmmLikelihood> rStruct(buildHmm<RescaledHmmLikelihood>(data, nbStates));
+  unique_ptr<LogsumHmmLikelihood> lStruct(buildHmm<LogsumHmmLikelihood>(data, nbStates));
+  test &= checkEqual("Rescaled structured", rDense->getLogLikelihood(), rStruct->getLogLikelihood(), 1e-12);
+  test &= checkEqual("Logsum structured", rDense->getLogLikelihood(), lStruct->getLogLikelihood(), 1e-12);
+  test &= checkEqual("Logsum dense", rDense->getLogLikelihood(), lDense->getLogLikelihood(), 1e-12);
+  test &= checkEqual("Rescaled structured d2", rDense->getSecondOrderDerivative("theta"), rStruct->getSecondOrderDerivative("theta"), 1e-9);
+  test &= checkEqual("Logsum structured d2", rDense->getSecondOrderDerivative("theta"), lStruct->getSecondOrderDerivative("theta"), 1e-9);
+  rDense->getHiddenStatesPosteriorProbabilities(post1);
+  lStruct->getHiddenStatesPosteriorProbabilities(post4);
+  for (size_t i = 0; i < post1.size(); ++i)
+    for (size_t j = 0; j < nbStates; ++j)
+      test &= std::abs(post1[i][j] - post4[i][j]) < 1e-9;
+
+  // Streaming computation, with emissions pushed in chunks of various sizes:
+  AutoCorrelationTransitionMatrix streamTrans(&alphabet);
+  for (size_t i = 0; i < nbStates; ++i)
+    streamTrans.setParameterValue("lambda" + TextTools::toString(i + 1), 0.9);
+  GaussianHmmEmissionProbabilities streamEmissions(&alphabet, data, 2.);
+  size_t lag = 20;
+  StreamingHmmLikelihood sLik(streamTrans, lag);
+  StreamingHmmLikelihood sLikFull(streamTrans, data.size());
+  vector< vector<double> > sPost, sPostFull;
+  for (size_t i = 0, c = 1; i < data.size(); i += c, c = c * 3 % 1001)
+  {
+    vector< vector<double> > chunk;
+    for (size_t k = i; k < min(i + c, data.size()); ++k)
+      chunk.push_back(streamEmissions(k));
+    sLik.addEmissions(chunk);
+    sLikFull.addEmissions(chunk);
+    sLik.getHiddenStatesPosteriorProbabilities(sPost, true);
+    size_t nbPositions = sLik.getNumberOfPositions();
+    test &= (sPost.size() == (nbPositions < 2 * lag ? 0 : (nbPositions - lag) / lag * lag));
+  }
+  test &= checkEqual("Streaming", rStruct->getLogLikelihood(), sLik.getLogLikelihood(), 1e-12);
+  sLik.flush();
+  sLikFull.flush();
+  sLik.getHiddenStatesPosteriorProbabilities(sPost, true);
+  sLikFull.getHiddenStatesPosteriorProbabilities(sPostFull);
+  test &= (sPost.size() == data.size() && sPostFull.size() == data.size());
+  rStruct->getHiddenStatesPosteriorProbabilities(post1);
+  for (size_t i = 0; i < post1.size(); ++i)
+    for (size_t j = 0; j < nbStates; ++j)
+      test &= std::abs(post1[i][j] - sPostFull[i][j]) < 1e-9 && std::abs(post1[i][j] - sPost[i][j]) < 0.5;
+  // Fixed-lag posteriors are the posteriors given the emissions up to lag positions after the block of the site:
+  for (size_t site : {0, 1000, 3456, 3459})
+  {
+    vector<double> truncated(data.begin(), data.begin() + static_cast<ptrdiff_t>(site / lag * lag + 2 * lag));
+    unique_ptr<RescaledHmmLikelihood> tLik(buildHmm<RescaledHmmLikelihood>(truncated, nbStates));
+    Vdouble probs = tLik->getHiddenStatesPosteriorProbabilitiesForASite(site);
+    for (size_t j = 0; j < nbStates; ++j)
+      test &= std::abs(probs[j] - sPost[site][j]) < 1e-9;
+  }
+  // Last positions are smoothed with all emissions:
+  test &= std::abs(post1.back()[0] - sPost.back()[0]) < 1e-9;
+
+  // Posterior sampling of hidden paths, with stored or checkpointed forward likelihoods:
+  size_t nbPaths = 2000;
+  vector< vector<size_t> > paths1, paths2;
+  Uniform01K generator1(7), generator2(7);
+  HmmPathSampler sampler(*rLik);
+  HmmPathSampler checkpointedSampler(rLik->getHmmTransitionMatrix(), rLik->getHmmEmissionProbabilities(), breakPoints, 37);
+  sampler.samplePaths(nbPaths, paths1, generator1);
+  checkpointedSampler.samplePaths(nbPaths, paths2, generator2);
+  test &= (paths1 == paths2);
+  rLik->getHiddenStatesPosteriorProbabilities(post1);
+  bool samplesOk = true;
+  for (size_t i : {0, 499, 500, 1200, 2500, 4999})
+  {
+    vector<double> freqs(nbStates, 0.);
+    for (size_t p = 0; p < nbPaths; ++p)
+      freqs[paths1[p][i]] += 1. / static_cast<double>(nbPaths);
+    for (size_t j = 0; j < nbStates; ++j)
+      samplesOk &= std::abs(freqs[j] - post1[i][j]) < 0.05;
+  }
+  cout << "Sampled paths:\t" << (samplesOk ? "OK" : "FAILED") << endl;
+  test &= samplesOk;
+  // The sampler follows the changes of the likelihood object:
+  rLik->setParameterValue("lambda1", 0.6);
+  HmmPathSampler newCheckpointedSampler(rLik->getHmmTransitionMatrix(), rLik->getHmmEmissionProbabilities(), breakPoints, 37);
+  Uniform01K generator3(11), generator4(11);
+  sampler.samplePaths(nbPaths, paths1, generator3);
+  newCheckpointedSampler.samplePaths(nbPaths, paths2, generator4);
+  test &= (paths1 == paths2);
+  rLik->setParameterValue("lambda1", 0.9);
+
+  // Incremental updates after localized changes of emissions:
+  vector< pair<size_t, size_t> > windows = {{1000, 1100}, {2990, 3010}, {4990, 5000}};
+  unique_ptr<RescaledHmmLikelihood> rInc(buildHmm<RescaledHmmLikelihood>(data, nbStates, false, windows));
+  unique_ptr<LogsumHmmLikelihood> lInc(buildHmm<LogsumHmmLikelihood>(data, nbStates, false, windows));
+  unique_ptr<LowMemoryRescaledHmmLikelihood> mInc(buildHmm<LowMemoryRescaledHmmLikelihood>(data, nbStates, false, windows));
+  rInc->setBreakPoints(breakPoints);
+  lInc->setBreakPoints(breakPoints);
+  mInc->setBreakPoints(breakPoints);
+  rInc->getHiddenStatesPosteriorProbabilities(post1);
+  lInc->getHiddenStatesPosteriorProbabilities(post1);
+  for (string shift : {"shift2", "shift1", "shift3", "shift2"})
+  {
+    double value = rInc->getParameterValue(shift) + 0.3;
+    rInc->setParameterValue(shift, value);
+    lInc->setParameterValue(shift, value);
+    mInc->setParameterValue(shift, value);
+    unique_ptr<RescaledHmmLikelihood> rRef(buildHmm<RescaledHmmLikelihood>(data, nbStates, false, windows));
+    rRef->setBreakPoints(breakPoints);
+    rRef->matchParametersValues(rInc->getParameters());
+    test &= checkEqual("Rescaled incremental " + shift, rRef->getLogLikelihood(), rInc->getLogLikelihood(), 1e-12);
+    test &= checkEqual("Logsum incremental " + shift, rRef->getLogLikelihood(), lInc->getLogLikelihood(), 1e-12);
+    test &= checkEqual("LowMemory incremental " + shift, rRef->getLogLikelihood(), mInc->getLogLikelihood(), 1e-12);
+    rRef->getHiddenStatesPosteriorProbabilities(post1);
+    rInc->getHiddenStatesPosteriorProbabilities(post4);
+    vector< vector<double> > postL;
+    lInc->getHiddenStatesPosteriorProbabilities(postL);
+    for (size_t i = 0; i < post1.size(); ++i)
+      for (size_t j = 0; j < nbStates; ++j)
+        test &= std::abs(post1[i][j] - post4[i][j]) < 1e-9 && std::abs(post1[i][j] - postL[i][j]) < 1e-9;
+  }
+  // Parameters of several components changed at once:
+  ParameterList mixed = rInc->getParameters().createSubList(vector<string>{"shift1", "lambda1"});
+  mixed.setParameterValue("shift1", mixed.getParameterValue("shift1") - 0.2);
+  mixed.setParameterValue("lambda1", 0.85);
+  rInc->setParametersValues(mixed);
+  lInc->setParametersValues(mixed);
+  unique_ptr<RescaledHmmLikelihood> rMixed(buildHmm<RescaledHmmLikelihood>(data, nbStates, false, windows));
+  rMixed->setBreakPoints(breakPoints);
+  rMixed->matchParametersValues(rInc->getParameters());
+  test &= checkEqual("Rescaled several components", rMixed->getLogLikelihood(), rInc->getLogLikelihood(), 1e-12);
+  test &= checkEqual("Logsum several components", rMixed->getLogLikelihood(), lInc->getLogLikelihood(), 1e-12);
+  test &= (rInc->getHmmTransitionMatrix().getParameterValue("lambda1") == 0.85);
+
+  // Gradient from a single forward-backward sweep:
+  vector<string> variables = rInc->getParameters().getParameterNames();
+  vector<double> rGrad, lGrad;
+  rInc->getGradient(variables, rGrad);
+  lInc->getGradient(variables, lGrad);
+  for (size_t v = 0; v < variables.size(); ++v)
+  {
+    unique_ptr<RescaledHmmLikelihood> rIncP(rInc->clone());
+    unique_ptr<RescaledHmmLikelihood> rIncM(rInc->clone());
+    double x = rInc->getParameterValue(variables[v]);
+    rIncP->setParameterValue(variables[v], x + h);
+    rIncM->setParameterValue(variables[v], x - h);
+    test &= checkEqual("Gradient " + variables[v], (rIncP->getValue() - rIncM->getValue()) / (2 * h), rGrad[v], 1e-4);
+    test &= checkEqual("Logsum gradient " + variables[v], rGrad[v], lGrad[v], 1e-9);
+  }
+  rInc->enableSingleSweepGradient(true);
+  test &= checkEqual("Single sweep d1", rInc->getFirstOrderDerivative(variables.back()), rGrad.back(), 1e-12);
+  rInc->setParameterValue("lambda2", 0.8);
+  rInc->getGradient(variables, rGrad);
+  test &= checkEqual("Single sweep d1 after change", rGrad[1], rInc->getFirstOrderDerivative(variables[1]), 1e-12);
+  rInc->enableSingleSweepGradient(false);
+  test &= checkEqual("Per variable d1", rInc->getFirstOrderDerivative("shift1"), rGrad[4], 1e-9);
+
+  // Analytical derivatives of transition probabilities agree with the finite differences default:
+  RowMatrix<double> dPij, dPijNum;
+  vector<double> dEq, dEqNum;
+  simTrans.getDPij("lambda2", dPij, dEq);
+  simTrans.AbstractHmmTransitionMatrix::getDPij("lambda2", dPijNum, dEqNum);
+  for (size_t j = 0; j < nbStates; ++j)
+  {
+    for (size_t k = 0; k < nbStates; ++k)
+      test &= std::abs(dPij(j, k) - dPijNum(j, k)) < 1e-6;
+    test &= std::abs(dEq[j] - dEqNum[j]) < 1e-6;
+  }
+  FullHmmTransitionMatrix fullTrans(&alphabet);
+  fullTrans.setParameterValue("1.theta1", 0.7);
+  fullTrans.setParameterValue("2.theta2", 0.2);
+  fullTrans.setParameterValue("3.theta1", 0.1);
+  for (const string& name : vector<string>{"1.theta1", "2.theta1", "2.theta2", "3.theta2"})
+  {
+    fullTrans.getDPij(name, dPij, dEq);
+    fullTrans.AbstractHmmTransitionMatrix::getDPij(name, dPijNum, dEqNum);
+    for (size_t j = 0; j < nbStates; ++j)
+    {
+      for (size_t k = 0; k < nbStates; ++k)
+        test &= std::abs(dPij(j, k) - dPijNum(j, k)) < 1e-6;
+      test &= checkEqual("Full transition matrix dEq " + name, dEqNum[j], dEq[j], 1e-5);
+    }
+  }
+
+  // Several sequences sharing one model behave as one concatenated sequence with break points:
+  vector<size_t> starts = {0, 1500, 1501, data.size()};
+  SimpleHmmStateAlphabet* msAlphabet = new SimpleHmmStateAlphabet(nbStates);
+  AutoCorrelationTransitionMatrix* msTrans = new AutoCorrelationTransitionMatrix(msAlphabet);
+  for (size_t i = 0; i < nbStates; ++i)
+    msTrans->setParameterValue("lambda" + TextTools::toString(i + 1), 0.9);
+  vector<HmmEmissionProbabilities*> msEmissions;
+  for (size_t s = 0; s + 1 < starts.size(); ++s)
+    msEmissions.push_back(new GaussianHmmEmissionProbabilities(msAlphabet,
+        vector<double>(data.begin() + static_cast<ptrdiff_t>(starts[s]), data.begin() + static_cast<ptrdiff_t>(starts[s + 1])), 2.));
+  MultiSequenceHmmLikelihood msLik(msAlphabet, msTrans, msEmissions);
+  unique_ptr<RescaledHmmLikelihood> catLik(buildHmm<RescaledHmmLikelihood>(data, nbStates));
+  catLik->setBreakPoints(vector<size_t>(starts.begin() + 1, starts.end() - 1));
+  test &= msLik.getNumberOfSequences() == 3;
+  test &= checkEqual("Multi-sequence logL", catLik->getLogLikelihood(), msLik.getLogLikelihood(), 1e-12);
+  vector<string> msVariables = msLik.getParameters().getParameterNames();
+  vector<double> msGrad, catGrad;
+  msLik.getGradient(msVariables, msGrad);
+  catLik->getGradient(msVariables, catGrad);
+  for (size_t v = 0; v < msVariables.size(); ++v)
+    test &= checkEqual("Multi-sequence gradient " + msVariables[v], catGrad[v], msGrad[v], 1e-9);
+  msLik.setParameterValue("theta", 2.2);
+  catLik->setParameterValue("theta", 2.2);
+  test &= checkEqual("Multi-sequence logL after change", catLik->getLogLikelihood(), msLik.getLogLikelihood(), 1e-12);
+  unique_ptr<MultiSequenceHmmLikelihood> msLik4(msLik.clone());
+  msLik4->setNumberOfThreads(4);
+  msLik4->setParameterValue("lambda1", 0.8);
+  msLik.setParameterValue("lambda1", 0.8);
+  test &= msLik4->getValue() == msLik.getValue();
+  test &= msLik4->getFirstOrderDerivative("theta") == msLik.getFirstOrderDerivative("theta");
+
+  // Posterior probabilities sum to one:
+  for (size_t i = 0; i < post1.size(); ++i)
+    test &= std::abs(VectorTools::sum(post1[i]) - 1.) < 1e-6;
+
+  return (test ? 0 : 1);
+}
@@ -0,0 +1,151 @@
+//
+// File: test_lbfgs.cpp
+//
+
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include <Bpp/Numeric/Function/LbfgsMultiDimensions.h>
+#include <Bpp/Numeric/Function/MetaOptimizer.h>
+#include <vector>
+#include <iostream>
+#include "PolynomialFunction.h"
+
+using namespace bpp;
+using namespace std;
+
+// sum_i w_i (x_i - 1)^2 + sum_i (x_i - x_{i+1})^2, with minimum 0 at x_i = 1:
+class CoupledQuadratic:
+  public virtual DerivableFirstOrder,
+  public AbstractParametrizable
+{
+  private:
+    double fval_;
+    vector<double> der_;
+
+  public:
+    CoupledQuadratic(size_t n) : AbstractParametrizable(""), fval_(0), der_(n) {
+      for (size_t i = 0; i < n; ++i)
+        addParameter_(new Parameter("x" + TextTools::toString(i), static_cast<double>(i % 7) - 3.));
+      fireParameterChanged(getParameters());
+    }
+
+    CoupledQuadratic* clone() const { return new CoupledQuadratic(*this); }
+
+  public:
+    void setParameters(const ParameterList& pl) { matchParametersValues(pl); }
+    double getValue() const { return fval_; }
+    void enableFirstOrderDerivatives(bool yn) {}
+    bool enableFirstOrderDerivatives() const { return true; }
+    double getFirstOrderDerivative(const string& variable) const {
+      return der_[static_cast<size_t>(TextTools::toInt(variable.substr(1)))];
+    }
+
+    void fireParameterChanged(const ParameterList& pl) {
+      size_t n = getNumberOfParameters();
+      fval_ = 0;
+      for (size_t i = 0; i < n; ++i) {
+        double x = getParameter_(i).getValue();
+        double w = static_cast<double>(i % 5 + 1);
+        fval_ += w * (x - 1.) * (x - 1.);
+        der_[i] = 2. * w * (x - 1.);
+        if (i + 1 < n) {
+          double d = x - getParameter_(i + 1).getValue();
+          fval_ += d * d;
+          der_[i] += 2. * d;
+        }
+        if (i > 0)
+          der_[i] -= 2. * (getParameter_(i - 1).getValue() - x);
+      }
+    }
+};
+
+bool checkBounded(const string& lineSearch) {
+  PolynomialFunction1Der1 f;
+  LbfgsMultiDimensions optimizer(&f, 3);
+  optimizer.setLineSearch(lineSearch);
+  optimizer.setVerbose(0);
+  optimizer.setProfiler(0);
+  optimizer.setMessageHandler(0);
+  optimizer.init(f.getParameters());
+  optimizer.optimize();
+  // z is bounded by 1:
+  bool test = abs(f.getParameterValue("x") - 5) + abs(f.getParameterValue("y") + 2) + abs(f.getParameterValue("z") - 1) < 0.01;
+  cout << "Bounded (" << lineSearch << "):\t" << (test ? "ok" : "FAILED") << endl;
+  return test;
+}
+
+bool checkLarge(const string& lineSearch) {
+  CoupledQuadratic f(500);
+  LbfgsMultiDimensions optimizer(&f, 7);
+  optimizer.setLineSearch(lineSearch);
+  optimizer.setVerbose(0);
+  optimizer.setProfiler(0);
+  optimizer.setMessageHandler(0);
+  optimizer.getStopCondition()->setTolerance(1e-10);
+  optimizer.setMaximumNumberOfEvaluations(10000);
+  optimizer.init(f.getParameters());
+  optimizer.optimize();
+  double dist = 0;
+  for (size_t i = 0; i < f.getNumberOfParameters(); ++i)
+    dist = max(dist, abs(f.getParameters()[i].getValue() - 1.));
+  bool test = f.getValue() < 1e-6 && dist < 1e-3;
+  cout << "Large (" << lineSearch << "):\t" << (test ? "ok" : "FAILED") << "\t" << f.getValue() << "\t" << optimizer.getNumberOfEvaluations() << endl;
+  return test;
+}
+
+int main() {
+  bool test = true;
+  test &= checkBounded(LbfgsMultiDimensions::LINE_SEARCH_BACKTRACKING);
+  test &= checkBounded(LbfgsMultiDimensions::LINE_SEARCH_STRONG_WOLFE);
+  test &= checkLarge(LbfgsMultiDimensions::LINE_SEARCH_BACKTRACKING);
+  test &= checkLarge(LbfgsMultiDimensions::LINE_SEARCH_STRONG_WOLFE);
+
+  // Within a MetaOptimizer:
+  PolynomialFunction1Der1 f;
+  MetaOptimizerInfos* desc = new MetaOptimizerInfos();
+  desc->addOptimizer("L-BFGS", new LbfgsMultiDimensions(&f), f.getParameters().getParameterNames(), 1, MetaOptimizerInfos::IT_TYPE_FULL);
+  MetaOptimizer optimizer(&f, desc);
+  optimizer.setVerbose(0);
+  optimizer.setProfiler(0);
+  optimizer.setMessageHandler(0);
+  optimizer.init(f.getParameters());
+  optimizer.optimize();
+  bool meta = abs(f.getParameterValue("x") - 5) + abs(f.getParameterValue("y") + 2) + abs(f.getParameterValue("z") - 1) < 0.01;
+  cout << "MetaOptimizer:\t" << (meta ? "ok" : "FAILED") << endl;
+  test &= meta;
+
+  return (test ? 0 : 1);
+}
@@ -0,0 +1,135 @@
+//
+// File: test_lbfgsb.cpp
+//
+
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include <Bpp/Numeric/Function/LbfgsbMultiDimensions.h>
+#include <vector>
+#include <iostream>
+#include "PolynomialFunction.h"
+
+using namespace bpp;
+using namespace std;
+
+// sum_i w_i (x_i - c_i)^2 + sum_i (x_i - x_{i+1})^2 / 10, with x_i in [0, 1]:
+class BoxedQuadratic:
+  public virtual DerivableFirstOrder,
+  public AbstractParametrizable
+{
+  private:
+    double fval_;
+    vector<double> der_;
+
+  public:
+    BoxedQuadratic(size_t n) : AbstractParametrizable(""), fval_(0), der_(n) {
+      for (size_t i = 0; i < n; ++i)
+        addParameter_(new Parameter("x" + TextTools::toString(i), 0.5, make_shared<IntervalConstraint>(0., 1., true, true)));
+      fireParameterChanged(getParameters());
+    }
+
+    BoxedQuadratic* clone() const { return new BoxedQuadratic(*this); }
+
+    static double target(size_t i) { return i % 3 == 0 ? 2. : (i % 3 == 1 ? -1. : 0.4); }
+
+  public:
+    void setParameters(const ParameterList& pl) { matchParametersValues(pl); }
+    double getValue() const { return fval_; }
+    void enableFirstOrderDerivatives(bool yn) {}
+    bool enableFirstOrderDerivatives() const { return true; }
+    double getFirstOrderDerivative(const string& variable) const {
+      return der_[static_cast<size_t>(TextTools::toInt(variable.substr(1)))];
+    }
+
+    void fireParameterChanged(const ParameterList& pl) {
+      size_t n = getNumberOfParameters();
+      fval_ = 0;
+      for (size_t i = 0; i < n; ++i) {
+        double x = getParameter_(i).getValue();
+        double w = static_cast<double>(i % 10 + 1);
+        fval_ += w * (x - target(i)) * (x - target(i));
+        der_[i] = 2. * w * (x - target(i));
+        if (i + 1 < n) {
+          double d = x - getParameter_(i + 1).getValue();
+          fval_ += d * d / 10.;
+          der_[i] += d / 5.;
+        }
+        if (i > 0)
+          der_[i] -= (getParameter_(i - 1).getValue() - x) / 5.;
+      }
+    }
+};
+
+int main() {
+  bool test = true;
+
+  PolynomialFunction1Der1 f;
+  LbfgsbMultiDimensions optimizer(&f, 3);
+  optimizer.setVerbose(0);
+  optimizer.setProfiler(0);
+  optimizer.setMessageHandler(0);
+  optimizer.init(f.getParameters());
+  optimizer.optimize();
+  // z is bounded by 1:
+  test &= abs(f.getParameterValue("x") - 5) + abs(f.getParameterValue("y") + 2) + abs(f.getParameterValue("z") - 1) < 1e-6;
+  cout << "Polynomial:\t" << (test ? "ok" : "FAILED") << "\t" << optimizer.getNumberOfEvaluations() << endl;
+
+  BoxedQuadratic bq(300);
+  LbfgsbMultiDimensions optimizer2(&bq, 5);
+  optimizer2.setVerbose(0);
+  optimizer2.setProfiler(0);
+  optimizer2.setMessageHandler(0);
+  optimizer2.getStopCondition()->setTolerance(1e-12);
+  optimizer2.setMaximumNumberOfEvaluations(10000);
+  optimizer2.init(bq.getParameters());
+  optimizer2.optimize();
+  // Variables with targets out of [0, 1] stay at the bounds, and have a positive gradient toward the outside:
+  bool box = optimizer2.getProjectedGradientNorm() < 1e-6;
+  for (size_t i = 0; i < bq.getNumberOfParameters(); ++i) {
+    double x = bq.getParameters()[i].getValue();
+    double g = bq.getFirstOrderDerivative(bq.getParameters()[i].getName());
+    if (BoxedQuadratic::target(i) > 1.)
+      box &= abs(x - 1.) < 1e-9 && g < 0;
+    else if (BoxedQuadratic::target(i) < 0.)
+      box &= abs(x) < 1e-9 && g > 0;
+    else
+      box &= x > 0 && x < 1 && abs(g) < 1e-6;
+  }
+  cout << "Box:\t" << (box ? "ok" : "FAILED") << "\t" << optimizer2.getNumberOfEvaluations() << endl;
+  test &= box;
+
+  return (test ? 0 : 1);
+}
@@ -0,0 +1,293 @@
+//
+// File: test_parameters.cpp
+//
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+#include <Bpp/Numeric/ParameterList.h>
+#include <Bpp/Numeric/ParameterBinding.h>
+#include <Bpp/Numeric/ParameterListView.h>
+#include <Bpp/Numeric/AbstractParametrizable.h>
+#include <Bpp/Numeric/AbstractParameterAliasable.h>
+#include <Bpp/Text/TextTools.h>
+#include <iostream>
+#include <memory>
+#include <set>
+
+using namespace bpp;
+using namespace std;
+
+class SimpleParametrizable:
+  public AbstractParametrizable
+{
+  public:
+    SimpleParametrizable(size_t n): AbstractParametrizable("") {
+      for (size_t i = 0; i < n; ++i)
+        addParameter_(new Parameter("p" + TextTools::toString(i), static_cast<double>(i)));
+    }
+
+    SimpleParametrizable* clone() const { return new SimpleParametrizable(*this); }
+};
+
+class ListeningParametrizable:
+  public SimpleParametrizable
+{
+  public:
+    set<string> names;
+    set<string> indexNames;
+    unsigned int nbNotifications;
+
+  public:
+    ListeningParametrizable(size_t n): SimpleParametrizable(n), names(), indexNames(), nbNotifications(0) {}
+
+    ListeningParametrizable* clone() const { return new ListeningParametrizable(*this); }
+
+    void fireParameterChanged(const ParameterList& pl) {
+      nbNotifications++;
+      names.clear();
+      for (size_t i = 0; i < pl.size(); ++i)
+        names.insert(pl[i].getName());
+    }
+
+    void fireParameterIndicesChanged(const ParameterList& pl, const ParameterChangeSet& changed) {
+      indexNames.clear();
+      for (size_t i = 0; i < changed.getNumberOfParameters(); ++i)
+        if (changed.isChanged(i))
+          indexNames.insert(getParameters()[i].getName());
+      if (indexNames.size() != changed.size())
+        indexNames.clear();
+      AbstractParametrizable::fireParameterIndicesChanged(pl, changed);
+    }
+
+    bool isConsistent() const { return nbNotifications > 0 && names == indexNames; }
+};
+
+class SimpleAliasable:
+  public AbstractParameterAliasable
+{
+  public:
+    SimpleAliasable(size_t n): AbstractParameterAliasable("") {
+      for (size_t i = 0; i < n; ++i)
+        addParameter_(new Parameter("p" + TextTools::toString(i), 0.));
+    }
+
+    SimpleAliasable* clone() const { return new SimpleAliasable(*this); }
+};
+
+bool checkValues(const string& what, const Parametrizable& p, const vector<double>& values) {
+  bool test = p.getNumberOfParameters() == values.size();
+  for (size_t i = 0; test && i < values.size(); ++i)
+    test &= p.getParameters()[i].getValue() == values[i];
+  cout << what << ":\t" << (test ? "ok" : "FAILED") << endl;
+  return test;
+}
+
+bool checkPositions(const string& what, const ParameterList& pl) {
+  bool test = true;
+  for (size_t i = 0; i < pl.size(); ++i)
+    test &= pl.hasParameter(pl[i].getName()) && pl.whichParameterHasName(pl[i].getName()) == i;
+  cout << what << ":\t" << (test ? "ok" : "FAILED") << endl;
+  return test;
+}
+
+int main() {
+  bool test = true;
+
+  // Name access through additions and deletions:
+  ParameterList pl;
+  for (size_t i = 0; i < 1000; ++i)
+    pl.addParameter(new Parameter("x" + TextTools::toString(i), static_cast<double>(i)));
+  test &= checkPositions("Add", pl);
+  test &= pl.getParameterValue("x500") == 500.;
+  test &= !pl.hasParameter("y");
+  pl.deleteParameter("x10");
+  pl.deleteParameter(0);
+  pl.deleteParameters(vector<size_t>{5, 3});
+  test &= checkPositions("Delete", pl);
+  test &= !pl.hasParameter("x10") && !pl.hasParameter("x0") && pl.size() == 996;
+  try {
+    pl.addParameter(new Parameter("x500", 0.));
+    test = false;
+  } catch (ParameterException& e) {}
+
+  // Sub lists, shared parameters and inclusions:
+  ParameterList sub = pl.createSubList(vector<size_t>{0, 10, 100});
+  test &= checkPositions("Sub list", sub);
+  ParameterListView view(pl, vector<string>{"x101", "x11"});
+  test &= view.size() == 2 && view.getPosition(0) == pl.whichParameterHasName("x101") && view[1].getName() == "x11" && view.hasParameter("x101") && !view.hasParameter("x12");
+  pl.setParameterValue("x101", -101.);
+  test &= view[0].getValue() == -101. && view.getParameterValues()[0] == -101.;
+  ParameterList viewCopy = view.createList();
+  ParameterList viewShare = view.shareList();
+  pl.setParameterValue("x101", 101.);
+  test &= viewCopy.getParameterValue("x101") == -101. && viewShare.getParameterValue("x101") == 101.;
+  cout << "View:\t" << (test ? "ok" : "FAILED") << endl;
+  ParameterList shared;
+  shared.shareParameters(pl);
+  test &= checkPositions("Share", shared);
+  ParameterList extra;
+  extra.addParameter(new Parameter("x500", -1.));
+  extra.addParameter(new Parameter("z", 1.));
+  shared.includeParameters(extra);
+  test &= checkPositions("Include", shared);
+  test &= pl.getParameterValue("x500") == -1. && shared.getParameterValue("z") == 1. && !pl.hasParameter("z");
+  shared.setParameter(0, Parameter("w", 2.));
+  test &= checkPositions("Replace", shared);
+  test &= shared.hasParameter("w") && !shared.hasParameter(pl[0].getName());
+  unsigned long sharedVersion = shared.getStructureVersion();
+  test &= shared.getSharedParameter(1) == pl.getSharedParameter(1) && shared.getStructureVersion() == sharedVersion;
+  shared.setSharedParameter(1, shared_ptr<Parameter>(new Parameter("v", 3.)));
+  test &= shared.getStructureVersion() != sharedVersion && shared.getParameterValue("v") == 3. && !shared.hasParameter(pl[1].getName());
+  test &= checkPositions("Share one", shared);
+
+  // Renaming parameters outside of the lists:
+  pl.getParameter("x999").setName("y");
+  test &= shared.hasParameter("y") && !shared.hasParameter("x999");
+  test &= checkPositions("Rename", shared);
+  SimpleParametrizable sp(100);
+  ParameterList spl;
+  spl.shareParameters(sp.getParameters());
+  sp.setNamespace("ns.");
+  test &= sp.hasParameter("p50") && sp.getParameters().hasParameter("ns.p50") && spl.hasParameter("ns.p50") && !spl.hasParameter("p50");
+
+  // Matching values:
+  ParameterList values;
+  values.addParameter(new Parameter("ns.p3", 30.));
+  values.addParameter(new Parameter("q", 1.));
+  values.addParameter(new Parameter("ns.p7", 7.));
+  vector<size_t> updated;
+  test &= sp.getParameters().testParametersValues(values);
+  test &= sp.matchParametersValues(values);
+  test &= spl.getParameterValue("ns.p3") == 30.;
+  test &= spl.size() == 100;
+  test &= spl.matchParametersValues(values, &updated) == false;
+  values.setParameterValue("ns.p7", 70.);
+  test &= spl.matchParametersValues(values, &updated) && updated.size() == 1 && updated[0] == 2;
+  spl.setParametersValues(values);
+  test &= sp.getParameterValue("p7") == 70.;
+
+  // Change sets give the positions of the same parameters as the changed lists:
+  ListeningParametrizable lp(200);
+  lp.setNamespace("lp.");
+  ParameterList lvalues;
+  lvalues.addParameter(new Parameter("lp.p150", -1.));
+  lvalues.addParameter(new Parameter("other", 0.));
+  lvalues.addParameter(new Parameter("lp.p2", 2.));
+  lvalues.addParameter(new Parameter("lp.p10", -10.));
+  test &= lp.matchParametersValues(lvalues) && lp.isConsistent() && lp.names.size() == 2;
+  lvalues.setParameterValue("lp.p2", -2.);
+  test &= lp.matchParametersValues(lvalues) && lp.isConsistent() && lp.names.size() == 1 && lp.names.count("lp.p2") == 1;
+  test &= !lp.matchParametersValues(lvalues) && lp.nbNotifications == 2;
+  lvalues.deleteParameter("other");
+  lp.setParametersValues(lvalues);
+  test &= lp.isConsistent() && lp.names.size() == 3;
+  lp.setParameterValue("p199", 1.);
+  test &= lp.isConsistent() && lp.names.size() == 1 && lp.names.count("lp.p199") == 1;
+  lp.setAllParametersValues(lp.getParameters());
+  test &= lp.isConsistent() && lp.names.size() == 200;
+  ParameterChangeSet cs(10, vector<size_t>{3, 7, 3});
+  test &= cs.size() == 2 && cs.isChanged(7) && !cs.isChanged(4) && cs.isChanged(4, 8) && !cs.isChanged(4, 7) && !cs.isChanged(8, 20);
+  cout << "Change sets:\t" << (test ? "ok" : "FAILED") << endl;
+
+  // Aliases are propagated along chains:
+  SimpleAliasable sa(5);
+  sa.aliasParameters("p0", "p1");
+  sa.aliasParameters("p1", "p2");
+  sa.aliasParameters("p0", "p3");
+  test &= sa.getNumberOfIndependentParameters() == 2 && sa.getAlias("p0").size() == 3;
+  ParameterList independent = sa.getIndependentParameters();
+  independent.setParameterValue("p0", 5.);
+  independent.setParameterValue("p4", 4.);
+  sa.matchParametersValues(independent);
+  test &= checkValues("Alias chain", sa, {5., 5., 5., 5., 4.});
+  sa.setParameterValue("p1", 7.);
+  test &= checkValues("Alias from chain", sa, {5., 7., 7., 5., 4.});
+  unique_ptr<SimpleAliasable> sac(sa.clone());
+  sac->setNamespace("ns.");
+  sac->setParameterValue("p0", 9.);
+  test &= checkValues("Alias copy", *sac, {9., 9., 9., 9., 4.});
+  test &= checkValues("Alias original", sa, {5., 7., 7., 5., 4.});
+  SimpleAliasable sb(5);
+  sb = sa;
+  sb.unaliasParameters("p1", "p2");
+  sb.setParameterValue("p0", 1.);
+  test &= checkValues("Unalias", sb, {1., 1., 7., 1., 4.});
+  sa.setParameterValue("p0", 2.);
+  test &= checkValues("Alias assigned", sa, {2., 2., 2., 2., 4.});
+
+  // Bindings transfer values by position:
+  ParameterList source, target;
+  source.addParameter(new Parameter("a", 1.));
+  source.addParameter(new Parameter("b", 2.));
+  source.addParameter(new Parameter("c", 3.));
+  target.addParameter(new Parameter("c", 0., Parameter::R_PLUS));
+  target.addParameter(new Parameter("d", 0.));
+  target.addParameter(new Parameter("a", 1.));
+  ParameterBinding binding(source, target);
+  test &= binding.size() == 2 && binding.isValidFor(source, target);
+  vector<size_t> changed;
+  test &= binding.apply(source, target, &changed);
+  test &= changed.size() == 1 && changed[0] == 2 && target.getParameterValue("c") == 3.;
+  changed.clear();
+  test &= binding.apply(vector<double>{5., 6., 3.}, target, &changed) && changed.size() == 1 && changed[0] == 0;
+  test &= target.getParameterValue("a") == 5. && target.getParameterValue("d") == 0.;
+  try {
+    binding.apply(vector<double>{7., 6., -1.}, target);
+    test = false;
+  } catch (ConstraintException& e) {
+    test &= target.getParameterValue("a") == 5.;
+  }
+  // Lists are checked again only when their structure or names change:
+  unsigned long version = target.getStructureVersion();
+  ParameterList targetCopy(target);
+  test &= targetCopy.getStructureVersion() == version && binding.isValidFor(source, targetCopy);
+  targetCopy.deleteParameter(1);
+  test &= targetCopy.getStructureVersion() != version && !binding.isValidFor(source, targetCopy);
+  targetCopy.addParameter(new Parameter("d", 0.));
+  test &= !binding.isValidFor(source, targetCopy);
+  targetCopy.setParameter(1, Parameter("d", 0.));
+  targetCopy.setParameter(2, Parameter("a", 5.));
+  test &= binding.isValidFor(source, targetCopy) && binding.isValidFor(source, target);
+  target[1].setName("f");
+  test &= !binding.isValidFor(source, target);
+  target[1].setName("d");
+  test &= binding.isValidFor(source, target);
+  source.getParameter("b").setName("e");
+  test &= !binding.isValidFor(source, target);
+  ParameterBinding names(source, vector<string>{"x", "c", "a"});
+  test &= names.size() == 2 && names.getTargetPosition(0) == 2 && names.getSourcePosition(1) == 2 && names.getTargetPosition(1) == 1;
+
+  cout << (test ? "Ok" : "FAILED") << endl;
+  return (test ? 0 : 1);
+}
@@ -40,6 +40,7 @@ knowledge of the CeCILL license and that you accept its terms.
 #include <Bpp/Numeric/Random/RandomTools.h>
 #include <Bpp/Numeric/Function/PowellMultiDimensions.h>
 #include <Bpp/Numeric/Function/ReparametrizationFunctionWrapper.h>
+#include <Bpp/Numeric/TransformedParameterArray.h>
 #include <vector>
 #include <iostream>
 
@@ -93,5 +94,47 @@ int main() {
 
   cout << setprecision(20) << (abs(x - 3.141593) + abs(y + 1.570796)) << endl;
   bool test = (abs(x - 3.141593) + abs(y + 1.570796)) < optimizer.getStopCondition()->getTolerance();
+
+  // Batch transformations give the same values as transformed parameters:
+  ParameterList tpl;
+  tpl.addParameter(new RTransformedParameter("a", 0.5, 0.2, true, 2.));
+  tpl.addParameter(new IntervalTransformedParameter("b", 0.3, -1., 1.));
+  tpl.addParameter(new PlaceboTransformedParameter("c", 4.));
+  tpl.addParameter(new RTransformedParameter("d", -3., -1., false));
+  tpl.addParameter(new IntervalTransformedParameter("e", 2., 1., 5., 1.5, false));
+  TransformedParameterArray tpa(tpl);
+  vector<double> original, transformed, d1, d2;
+  for (double shift = -2.; shift <= 2.; shift += 0.5) {
+    for (size_t i = 0; i < tpl.size(); ++i)
+      tpl[i].setValue(tpl[i].getValue() + shift);
+    vector<double> values(tpl.size());
+    for (size_t i = 0; i < tpl.size(); ++i)
+      values[i] = tpl[i].getValue();
+    tpa.getOriginalValues(values, original);
+    tpa.getFirstOrderDerivatives(values, d1);
+    tpa.getSecondOrderDerivatives(values, d2);
+    tpa.getTransformedValues(original, transformed);
+    for (size_t i = 0; i < tpl.size(); ++i) {
+      const TransformedParameter& tp = dynamic_cast<const TransformedParameter&>(tpl[i]);
+      test &= original[i] == tp.getOriginalValue() && d1[i] == tp.getFirstOrderDerivative() && d2[i] == tp.getSecondOrderDerivative();
+      unique_ptr<TransformedParameter> copy(tp.clone());
+      copy->setOriginalValue(original[i]);
+      test &= transformed[i] == copy->getValue();
+    }
+  }
+  try {
+    tpa.getTransformedValues(vector<double>{0.1, 0., 0., -2., 3.}, transformed);
+    test = false;
+  } catch (OutOfRangeException& e) {}
+
+  // Constraints are checked in one pass:
+  ConstraintArray ca;
+  ca.addConstraint(f.getParameter("x").getConstraint());
+  ca.addConstraint(shared_ptr<Constraint>());
+  ca.addConstraint(make_shared<IntervalConstraint>(0., 1., false, true));
+  test &= ca.areCorrect(vector<double>{7., -100., 1.}) && ca.findIncorrect(vector<double>{7., -100., 1.}) == 3;
+  test &= !ca.areCorrect(vector<double>{7., 0., 0.}) && ca.findIncorrect(vector<double>{8., 0., 0.}) == 0;
+  test &= ca.findIncorrect(vector<double>{0., 0., NAN}) == 2;
+  cout << "Batch transformations: " << (test ? "ok" : "FAILED") << endl;
   return (test ? 0 : 1);
 }
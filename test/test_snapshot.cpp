@@ -0,0 +1,108 @@
+//
+// File: test_snapshot.cpp
+//
+
+
+/*
+Copyright or © or Copr. Bio++ Development Team, (November 17, 2004)
+
+This software is a computer program whose purpose is to provide classes
+for numerical calculus. This file is part of the Bio++ project.
+
+This software is governed by the CeCILL  license under French law and
+abiding by the rules of distribution of free software.  You can  use, 
+modify and/ or redistribute the software under the terms of the CeCILL
+license as circulated by CEA, CNRS and INRIA at the following URL
+"http://www.cecill.info". 
+
+As a counterpart to the access to the source code and  rights to copy,
+modify and redistribute granted by the license, users are provided only
+with a limited warranty  and the software's author,  the holder of the
+economic rights,  and the successive licensors  have only  limited
+liability. 
+
+In this respect, the user's attention is drawn to the risks associated
+with loading,  using,  modifying and/or developing or reproducing the
+software by the user in light of its specific status of free software,
+that may mean  that it is complicated to manipulate,  and  that  also
+therefore means  that it is reserved for developers  and  experienced
+professionals having in-depth computer knowledge. Users are therefore
+encouraged to load and test the software's suitability as regards their
+requirements in conditions enabling the security of their systems and/or 
+data to be ensured and,  more generally, to use and operate it in the 
+same conditions as regards security. 
+
+The fact that you are presently reading this means that you have had
+knowledge of the CeCILL license and that you accept its terms.
+*/
+
+
+#include <Bpp/Numeric/ParameterSnapshot.h>
+#include <Bpp/Numeric/Function/DirectionFunction.h>
+#include <Bpp/Numeric/Function/ReparametrizationFunctionWrapper.h>
+#include <Bpp/Utils/ThreadTools.h>
+#include <vector>
+#include <iostream>
+#include "PolynomialFunction.h"
+
+using namespace bpp;
+using namespace std;
+
+int main() {
+  PolynomialFunction1 f;
+  bool test = true;
+
+  // Snapshots are immutable copies of parameter values:
+  ParameterSnapshot s0(f.getParameters());
+  shared_ptr<const ParameterSchema> schema = s0.getSchema();
+  test &= schema->size() == 3 && schema->getPosition("y") == 1 && schema->matches(f.getParameters());
+  test &= s0.getParameterValue("z") == 0.5 && s0.isCorrect();
+  ParameterSnapshot s1 = s0.withValue(2, 2.);
+  test &= s1.getSchema() == schema && s1.getValue(2) == 2. && s0.getValue(2) == 0.5 && !s1.isCorrect();
+  try {
+    ParameterSnapshot bad(schema, vector<double>{1., 2.});
+    test = false;
+  } catch (DimensionException& e) {}
+  ParameterList pl = s1.withValue(2, 0.9).createParameterList();
+  test &= pl.size() == 3 && pl.getParameterValue("z") == 0.9 && pl[2].hasConstraint();
+  cout << "Snapshots:\t" << (test ? "ok" : "FAILED") << endl;
+
+  // Concurrent evaluations do not modify the function:
+  vector<ParameterSnapshot> points;
+  for (size_t i = 0; i < 200; ++i)
+    points.push_back(s0.withValues(vector<double>{static_cast<double>(i) / 10., 3. - static_cast<double>(i) / 20., 0.01 + static_cast<double>(i) / 250.}));
+  vector<double> values(points.size());
+  ThreadTools::parallelFor(points.size(), 4, [&](size_t i) { values[i] = f.evaluate(points[i]); });
+  test &= f.getParameterValue("x") == 0. && f.getValue() == f.evaluate(s0);
+  for (size_t i = 0; i < points.size(); ++i)
+    test &= values[i] == f.f(points[i].createParameterList());
+  cout << "Concurrent:\t" << (test ? "ok" : "FAILED") << endl;
+
+  // Wrappers:
+  f.setParameters(s0.createParameterList());
+  ReparametrizationFunctionWrapper rf(&f, false);
+  ParameterList rpl = rf.getParameters();
+  rpl[2].setValue(-0.3);
+  double rv = rf.evaluate(ParameterSnapshot(rpl));
+  test &= f.getParameterValue("z") == 0.5 && rv == rf.f(rpl);
+
+  DirectionFunction df(&f);
+  df.init(f.getParameters(), vector<double>{1., 0., 0.1});
+  ParameterList line;
+  line.addParameter(new Parameter("t", 2.));
+  ParameterSnapshot ls(line);
+  double dv = df.evaluate(ls);
+  test &= dv == df.f(line);
+  //Out of the constraint of z:
+  try {
+    df.evaluate(ls.withValue(0, 10.));
+    test = false;
+  } catch (ConstraintException& e) {}
+  df.setConstraintPolicy(AutoParameter::CONSTRAINTS_AUTO);
+  df.setMessageHandler(0);
+  df.init(f.getParameters(), vector<double>{1., 0., 0.1});
+  test &= df.evaluate(ls.withValue(0, 10.)) == df.f(ls.withValue(0, 10.).createParameterList());
+  cout << "Wrappers:\t" << (test ? "ok" : "FAILED") << endl;
+
+  return (test ? 0 : 1);
+}